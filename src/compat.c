@@ -391,6 +391,39 @@ gchar *hw_file_name(const gchar *hwfile)
     return filename;
 }
 
+/*
+ * Load a data file that may be replaced while it is in use.
+ *
+ * The file is mapped into memory, except on Windows, which cannot rename
+ * over a mapped file; there it is read into memory and closed right away.
+ *
+ * @return The contents, or NULL if the file could not be read.
+ */
+GBytes *load_replaceable_file(const gchar *path, GError **err)
+{
+#ifdef G_OS_WIN32
+    gchar *data;
+    gsize len;
+
+    if (!g_file_get_contents(path, &data, &len, err))
+        return NULL;
+
+    return g_bytes_new_take(data, len);
+#else
+    GMappedFile *file;
+    GBytes *bytes;
+
+    file = g_mapped_file_new(path, FALSE, err);
+    if (file == NULL)
+        return NULL;
+
+    bytes = g_mapped_file_get_bytes(file);
+    g_mapped_file_unref(file);
+
+    return bytes;
+#endif
+}
+
 gchar const *get_locale_thousands_sep()
 {
     struct lconv *locale;
@@ -25,4 +25,6 @@ gchar *sat_file_name_from_catnum_s(gchar *catnum);
 
 gchar const *get_locale_thousands_sep();
 
+GBytes *load_replaceable_file(const gchar *path, GError **err);
+
 #endif
@@ -79,6 +79,7 @@
 #define MOD_CFG_WIN_POS_Y       "WIN_POS_Y"
 #define MOD_CFG_WIN_WIDTH       "WIN_WIDTH"
 #define MOD_CFG_WIN_HEIGHT      "WIN_HEIGHT"
+#define MOD_CFG_SHM_FEED        "SHM_FEED"    /* see shm-feed-layout.h */
 
 /* list specific */
 #define MOD_CFG_LIST_SECTION   "LIST"
@@ -116,6 +117,8 @@
 #define MOD_CFG_MAP_KEEP_RATIO        "KEEP_RATIO"
 #define MOD_CFG_MAP_SHADOW_ALPHA      "SHADOW_ALPHA"
 #define MOD_CFG_MAP_SHOWTRACKS        "SHOWTRACKS"
+#define MOD_CFG_MAP_LOD_THRESHOLD     "LOD_THRESHOLD"
+#define MOD_CFG_MAP_CLUSTER_SIZE      "CLUSTER_SIZE"
 #define MOD_CFG_MAP_HIDECOVS          "HIDECOVS"		// FIXME: redundant
 
 /* polar view specific */
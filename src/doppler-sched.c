@@ -0,0 +1,189 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Doppler schedules.
+ *
+ * The range rate of a satellite is propagated once for a whole pass and
+ * then interpolated, so that Doppler corrections can be computed at any rate
+ * without running SGP4/SDP4 each time.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "doppler-sched.h"
+#include "predict-tools.h"
+#include "sat-log.h"
+
+/*
+ * Create a new Doppler schedule.
+ *
+ * @param sat The satellite; it is not modified.
+ * @param qth The observer.
+ * @param start Start of the schedule (Julian date).
+ * @param end End of the schedule (Julian date).
+ * @param step Time between samples in seconds. It is increased if the
+ *             schedule would have more than DOPPLER_SCHED_MAX samples.
+ * @return A new schedule with a reference count of 1, or NULL if the
+ *         interval is empty.
+ */
+doppler_sched_t *doppler_sched_new(sat_t *sat, qth_t *qth, gdouble start,
+                                   gdouble end, gdouble step)
+{
+    doppler_sched_t *sched;
+    sat_t sat_working;
+    gdouble duration;
+    guint i;
+
+    duration = (end - start) * 86400.0;
+    if (duration <= 0.0 || step <= 0.0)
+        return NULL;
+
+    if (duration / step > DOPPLER_SCHED_MAX - 1)
+        step = duration / (DOPPLER_SCHED_MAX - 1);
+
+    sched = g_new0(doppler_sched_t, 1);
+    sched->refcount = 1;
+    sched->catnum = sat->tle.catnr;
+    sched->start = start;
+    sched->step = step;
+    sched->n = (guint)ceil(duration / step) + 1;
+    sched->rr = g_new(gdouble, sched->n);
+
+    memcpy(&sat_working, sat, sizeof(sat_t));
+    for (i = 0; i < sched->n; i++)
+    {
+        predict_calc(&sat_working, qth, start + i * step / 86400.0);
+        sched->rr[i] = sat_working.range_rate;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Computed %u samples for satellite %d"), __func__,
+                sched->n, sched->catnum);
+
+    return sched;
+}
+
+doppler_sched_t *doppler_sched_ref(doppler_sched_t *sched)
+{
+    if (sched != NULL)
+        g_atomic_int_inc(&sched->refcount);
+
+    return sched;
+}
+
+void doppler_sched_unref(doppler_sched_t *sched)
+{
+    if (sched == NULL)
+        return;
+
+    if (g_atomic_int_dec_and_test(&sched->refcount))
+    {
+        g_free(sched->rr);
+        g_free(sched);
+    }
+}
+
+/*
+ * Look up the range rate at time t (Julian date).
+ *
+ * The samples are interpolated linearly; rrdot is set to the slope between
+ * the two samples around t. Returns FALSE if t is outside the schedule.
+ */
+gboolean doppler_sched_lookup(const doppler_sched_t *sched, gdouble t,
+                              gdouble *rr, gdouble *rrdot)
+{
+    gdouble x, frac;
+    guint i;
+
+    x = (t - sched->start) * 86400.0 / sched->step;
+    if (x < 0.0 || x > sched->n - 1)
+        return FALSE;
+
+    i = MIN((guint)x, sched->n - 2);
+    frac = x - i;
+
+    *rr = sched->rr[i] + frac * (sched->rr[i + 1] - sched->rr[i]);
+    *rrdot = (sched->rr[i + 1] - sched->rr[i]) / sched->step;
+
+    return TRUE;
+}
+
+/*
+ * Save the schedule as comma separated values.
+ *
+ * Each line has the time as UTC and Julian date, the range rate and, if a
+ * transponder is given, the Doppler shift at the center of its downlink and
+ * uplink passbands.
+ */
+gboolean doppler_sched_save(const doppler_sched_t *sched, const trsp_t *trsp,
+                            const gchar *filename)
+{
+    GString *buff;
+    GDateTime *dt;
+    GError *err = NULL;
+    gchar *tstr;
+    gdouble t, down = 0.0, up = 0.0;
+    gboolean retval;
+    guint i;
+
+    if (trsp != NULL)
+    {
+        down = (trsp->downlow + trsp->downhigh) / 2.0;
+        up = (trsp->uplow + trsp->uphigh) / 2.0;
+    }
+
+    buff = g_string_new("# time,julian date,range rate (km/s)");
+    if (trsp != NULL)
+        g_string_append(buff, ",downlink Doppler (Hz),uplink Doppler (Hz)");
+    g_string_append_c(buff, '\n');
+
+    for (i = 0; i < sched->n; i++)
+    {
+        t = sched->start + i * sched->step / 86400.0;
+        dt = g_date_time_new_from_unix_utc((gint64)rint((t - 2440587.5) *
+                                                        86400.0));
+        tstr = g_date_time_format(dt, "%Y-%m-%dT%H:%M:%SZ");
+        g_string_append_printf(buff, "%s,%.8f,%.6f", tstr, t, sched->rr[i]);
+        if (trsp != NULL)
+            g_string_append_printf(buff, ",%.1f,%.1f",
+                                   -down * sched->rr[i] / 299792.4580,
+                                   up * sched->rr[i] / 299792.4580);
+        g_string_append_c(buff, '\n');
+        g_free(tstr);
+        g_date_time_unref(dt);
+    }
+
+    retval = g_file_set_contents(filename, buff->str, buff->len, &err);
+    if (!retval)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not save %s (%s)"),
+                    __func__, filename, err->message);
+        g_clear_error(&err);
+    }
+
+    g_string_free(buff, TRUE);
+
+    return retval;
+}
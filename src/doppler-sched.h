@@ -0,0 +1,58 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef DOPPLER_SCHED_H
+#define DOPPLER_SCHED_H 1
+
+#include <glib.h>
+
+#include "gtk-sat-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+#include "trsp-conf.h"
+
+#define DOPPLER_SCHED_STEP 1.0   /* Default time between samples (sec) */
+#define DOPPLER_SCHED_MAX 10800  /* Max number of samples in a schedule */
+
+/*
+ * Range rate of a satellite sampled over a time interval, usually a pass.
+ *
+ * The Doppler shift of any frequency follows from the range rate, so one
+ * schedule serves the downlink and the uplink of every transponder. A
+ * schedule is immutable once created and reference counted, which allows it
+ * to be shared with other threads.
+ */
+typedef struct {
+    gint refcount;  /* Reference count; use doppler_sched_ref/unref() */
+    gint catnum;    /* Catalogue number of the satellite */
+    gdouble start;  /* Time of the first sample (Julian date) */
+    gdouble step;   /* Time between samples (sec) */
+    guint n;        /* Number of samples; at least 2 */
+    gdouble *rr;    /* Range rate at each sample (km/s) */
+} doppler_sched_t;
+
+doppler_sched_t *doppler_sched_new(sat_t *sat, qth_t *qth, gdouble start,
+                                   gdouble end, gdouble step);
+doppler_sched_t *doppler_sched_ref(doppler_sched_t *sched);
+void doppler_sched_unref(doppler_sched_t *sched);
+
+gboolean doppler_sched_lookup(const doppler_sched_t *sched, gdouble t,
+                              gdouble *rr, gdouble *rrdot);
+gboolean doppler_sched_save(const doppler_sched_t *sched, const trsp_t *trsp,
+                            const gchar *filename);
+
+#endif
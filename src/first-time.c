@@ -31,6 +31,7 @@
 #include "compat.h"
 #include "first-time.h"
 #include "gpredict-utils.h"
+#include "sat-catalogue.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 
@@ -604,12 +605,14 @@ static void create_cat_files(guint *error)
  *
  * 5. Check if there are any .sat files in USER_CONF_DIR/satdata/ - if not
  * extract PACKAGE_DATA_DIR/data/satdata/satellites.dat to .sat files. Do the
- * same with .cat files.
+ * same with .cat files. Finally, build the satellite catalogue from the .sat
+ * files if there is none, which also converts existing configurations.
  *
  */
 static void first_time_check_step_05(guint *error)
 {
     gchar *datadir_str;
+    gchar *catfile;
     GDir *datadir;
     const gchar *filename;
     gboolean have_sat = FALSE;
@@ -626,7 +629,6 @@ static void first_time_check_step_05(guint *error)
         if (g_str_has_suffix(filename, ".cat"))
             have_cat = TRUE;
     }
-    g_free(datadir_str);
     g_dir_close(datadir);
 
     if (!have_sat)
@@ -634,6 +636,13 @@ static void first_time_check_step_05(guint *error)
 
     if (!have_cat)
         create_cat_files(error);
+
+    catfile = sat_catalogue_file_name();
+    if (!g_file_test(catfile, G_FILE_TEST_EXISTS) &&
+        sat_catalogue_import(datadir_str) < 0)
+        *error |= FTC_ERROR_STEP_05;
+    g_free(catfile);
+    g_free(datadir_str);
 }
 
 /**
@@ -0,0 +1,868 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  Comments, questions and bugreports should be submitted via
+  http://sourceforge.net/projects/gpredict/
+  More details can be found at the project home page:
+
+  http://gpredict.oz9aec.net/
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+#include "gtk-event-list-model.h"
+#include "gtk-event-list.h"
+#include "orbit-tools.h"
+#include "sat-log.h"
+
+/* Per-satellite row data. Column values are read from sat on demand. */
+typedef struct {
+    gint catnum;         /* catalogue number, key in the index */
+    sat_t *sat;          /* the satellite */
+    gchar *collate;      /* collation key for the name */
+    gboolean los;        /* TRUE if the next event is LOS */
+    gdouble event;       /* Julian date of the next event, -1 if none */
+    gdouble key;         /* numeric sort key */
+    gint pos;            /* position before the last reordering */
+    gboolean dirty;      /* event changed since the last refresh */
+    GSequenceIter *iter; /* position in the sequence, NULL if hidden */
+} event_row_t;
+
+#define ROW(iter) ((event_row_t *)(iter)->user_data)
+
+/* Above this many moved rows a full sort is cheaper than re-inserting */
+#define EVENT_LIST_RESORT_RATIO 4
+
+/* clang-format off */
+static const GType EVENT_LIST_COL_TYPE[EVENT_LIST_COL_NUMBER] = {
+    G_TYPE_STRING,   // name
+    G_TYPE_INT,      // catnum
+    G_TYPE_DOUBLE,   // az
+    G_TYPE_DOUBLE,   // el
+    G_TYPE_BOOLEAN,  // TRUE if LOS, FALSE if AOS
+    G_TYPE_DOUBLE,   // time
+    G_TYPE_BOOLEAN,  // decayed
+    G_TYPE_INT       // bold for storing weight
+};
+/* clang-format on */
+
+static void gtk_event_list_model_class_init(GtkEventListModelClass *class,
+                                            gpointer class_data);
+static void gtk_event_list_model_init(GtkEventListModel *model,
+                                      gpointer g_class);
+static void gtk_event_list_model_tree_model_init(GtkTreeModelIface *iface,
+                                                 gpointer iface_data);
+static void gtk_event_list_model_sortable_init(GtkTreeSortableIface *iface,
+                                               gpointer iface_data);
+static void gtk_event_list_model_finalize(GObject *object);
+
+static GObjectClass *parent_class = NULL;
+
+GType gtk_event_list_model_get_type()
+{
+    static GType gtk_event_list_model_type = 0;
+
+    if (!gtk_event_list_model_type)
+    {
+        static const GTypeInfo gtk_event_list_model_info = {
+            sizeof(GtkEventListModelClass),
+            NULL, /* base_init */
+            NULL, /* base_finalize */
+            (GClassInitFunc)gtk_event_list_model_class_init,
+            NULL, /* class_finalize */
+            NULL, /* class_data */
+            sizeof(GtkEventListModel),
+            5, /* n_preallocs */
+            (GInstanceInitFunc)gtk_event_list_model_init,
+            NULL};
+        static const GInterfaceInfo tree_model_info = {
+            (GInterfaceInitFunc)gtk_event_list_model_tree_model_init, NULL,
+            NULL};
+        static const GInterfaceInfo sortable_info = {
+            (GInterfaceInitFunc)gtk_event_list_model_sortable_init, NULL,
+            NULL};
+
+        gtk_event_list_model_type =
+            g_type_register_static(G_TYPE_OBJECT, "GtkEventListModel",
+                                   &gtk_event_list_model_info, 0);
+        g_type_add_interface_static(gtk_event_list_model_type,
+                                    GTK_TYPE_TREE_MODEL, &tree_model_info);
+        g_type_add_interface_static(gtk_event_list_model_type,
+                                    GTK_TYPE_TREE_SORTABLE, &sortable_info);
+    }
+
+    return gtk_event_list_model_type;
+}
+
+static void gtk_event_list_model_class_init(GtkEventListModelClass *class,
+                                            gpointer class_data)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(class);
+
+    (void)class_data;
+
+    object_class->finalize = gtk_event_list_model_finalize;
+    parent_class = g_type_class_peek_parent(class);
+}
+
+static void row_free(gpointer data)
+{
+    event_row_t *row = data;
+
+    g_free(row->collate);
+    g_free(row);
+}
+
+static void gtk_event_list_model_init(GtkEventListModel *model,
+                                      gpointer g_class)
+{
+    (void)g_class;
+
+    model->stamp = g_random_int();
+    model->rows = g_ptr_array_new_with_free_func(row_free);
+    model->index = g_hash_table_new(g_int_hash, g_int_equal);
+    model->seq = g_sequence_new(NULL);
+    model->moved = g_ptr_array_new();
+    model->shown = g_ptr_array_new();
+    model->sort_column = EVENT_LIST_COL_TIME;
+    model->sort_order = GTK_SORT_ASCENDING;
+}
+
+static void gtk_event_list_model_finalize(GObject *object)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(object);
+
+    g_ptr_array_free(model->moved, TRUE);
+    g_ptr_array_free(model->shown, TRUE);
+    g_sequence_free(model->seq);
+    g_hash_table_destroy(model->index);
+    g_ptr_array_free(model->rows, TRUE);
+
+    (*parent_class->finalize)(object);
+}
+
+static void fill_iter(GtkEventListModel *model, event_row_t *row,
+                      GtkTreeIter *iter)
+{
+    iter->stamp = model->stamp;
+    iter->user_data = row;
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+/**
+ * Update the next event of a row.
+ * @return TRUE if the event type or time has changed.
+ */
+static gboolean row_update_event(event_row_t *row)
+{
+    sat_t *sat = row->sat;
+    gboolean los = (sat->el > 0.0);
+    gdouble event = los ? sat->los : sat->aos;
+
+    /* Sat is stationary or there is no event */
+    if (event <= 0.0)
+        event = -1.0;
+
+    if (los == row->los && event == row->event)
+        return FALSE;
+
+    row->los = los;
+    row->event = event;
+
+    return TRUE;
+}
+
+/* Numeric sort key of a row for the current sort column */
+static gdouble row_key(GtkEventListModel *model, event_row_t *row)
+{
+    switch (model->sort_column)
+    {
+    case EVENT_LIST_COL_CATNUM:
+        return row->catnum;
+    case EVENT_LIST_COL_AZ:
+        return row->sat->az;
+    case EVENT_LIST_COL_EL:
+    case EVENT_LIST_COL_BOLD:
+        return row->sat->el;
+    case EVENT_LIST_COL_EVT:
+        return row->los;
+    case EVENT_LIST_COL_TIME:
+        /* the countdown orders the same way as the absolute time */
+        return row->event;
+    default:
+        return 0.0;
+    }
+}
+
+static gint row_compare(gconstpointer a, gconstpointer b, gpointer data)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(data);
+    const event_row_t *ra = a;
+    const event_row_t *rb = b;
+    gint result;
+
+    if (model->sort_column == EVENT_LIST_COL_NAME)
+        result = strcmp(ra->collate, rb->collate);
+    else
+        result = (ra->key > rb->key) - (ra->key < rb->key);
+
+    /* keep the order of equal rows deterministic */
+    if (result == 0)
+        result = (ra->catnum > rb->catnum) - (ra->catnum < rb->catnum);
+
+    return (model->sort_order == GTK_SORT_DESCENDING) ? -result : result;
+}
+
+/* Remember the current position of each visible row */
+static void number_rows(GtkEventListModel *model)
+{
+    GSequenceIter *iter;
+    gint i = 0;
+
+    for (iter = g_sequence_get_begin_iter(model->seq);
+         !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+        ((event_row_t *)g_sequence_get(iter))->pos = i++;
+}
+
+/* Emit rows-reordered if the rows have moved since number_rows() */
+static void emit_reordered(GtkEventListModel *model)
+{
+    GSequenceIter *iter;
+    GtkTreePath *path;
+    event_row_t *row;
+    gint *new_order;
+    gint i = 0;
+    gboolean moved = FALSE;
+
+    new_order = g_new(gint, g_sequence_get_length(model->seq));
+    for (iter = g_sequence_get_begin_iter(model->seq);
+         !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+    {
+        row = g_sequence_get(iter);
+        new_order[i] = row->pos;
+        moved |= (row->pos != i);
+        i++;
+    }
+
+    if (moved)
+    {
+        path = gtk_tree_path_new();
+        gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, NULL,
+                                      new_order);
+        gtk_tree_path_free(path);
+    }
+
+    g_free(new_order);
+}
+
+/* Sort all visible rows, e.g. after the sort column has changed */
+static void sort_rows(GtkEventListModel *model)
+{
+    GSequenceIter *iter;
+    event_row_t *row;
+
+    if (g_sequence_get_length(model->seq) < 2)
+        return;
+
+    for (iter = g_sequence_get_begin_iter(model->seq);
+         !g_sequence_iter_is_end(iter); iter = g_sequence_iter_next(iter))
+    {
+        row = g_sequence_get(iter);
+        row->key = row_key(model, row);
+    }
+
+    number_rows(model);
+    g_sequence_sort(model->seq, row_compare, model);
+    emit_reordered(model);
+}
+
+/**
+ * Move the rows in model->moved to their new place.
+ *
+ * The rows are taken out of the sequence first, so the remaining rows are
+ * still sorted, and then inserted again using a binary search. This costs
+ * O(k log n) for k moved rows.
+ */
+static void resort_moved_rows(GtkEventListModel *model)
+{
+    event_row_t *row;
+    guint i;
+
+    number_rows(model);
+
+    if (model->moved->len * EVENT_LIST_RESORT_RATIO >
+        (guint)g_sequence_get_length(model->seq))
+    {
+        g_sequence_sort(model->seq, row_compare, model);
+    }
+    else
+    {
+        for (i = 0; i < model->moved->len; i++)
+        {
+            row = g_ptr_array_index(model->moved, i);
+            g_sequence_remove(row->iter);
+        }
+        for (i = 0; i < model->moved->len; i++)
+        {
+            row = g_ptr_array_index(model->moved, i);
+            row->iter = g_sequence_insert_sorted(model->seq, row, row_compare,
+                                                 model);
+        }
+    }
+
+    g_ptr_array_set_size(model->moved, 0);
+    emit_reordered(model);
+}
+
+/* Insert a row into the view at its sorted position */
+static void show_row(GtkEventListModel *model, event_row_t *row)
+{
+    GtkTreePath *path;
+    GtkTreeIter iter;
+
+    row->key = row_key(model, row);
+    row->iter = g_sequence_insert_sorted(model->seq, row, row_compare, model);
+
+    path = gtk_tree_path_new_from_indices(
+        g_sequence_iter_get_position(row->iter), -1);
+    fill_iter(model, row, &iter);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+/* Remove a row from the view. The row itself is kept. */
+static void hide_row(GtkEventListModel *model, event_row_t *row)
+{
+    GtkTreePath *path;
+
+    if (row->iter == NULL)
+        return;
+
+    path = gtk_tree_path_new_from_indices(
+        g_sequence_iter_get_position(row->iter), -1);
+    g_sequence_remove(row->iter);
+    row->iter = NULL;
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    gtk_tree_path_free(path);
+}
+
+static void emit_row_changed(GtkEventListModel *model, event_row_t *row,
+                             gint pos)
+{
+    GtkTreePath *path;
+    GtkTreeIter iter;
+
+    path = gtk_tree_path_new_from_indices(pos, -1);
+    fill_iter(model, row, &iter);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+static void add_sat(gpointer key, gpointer value, gpointer data)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(data);
+    sat_t *sat = SAT(value);
+    event_row_t *row;
+
+    (void)key;
+
+    if (g_hash_table_lookup(model->index, &sat->tle.catnr) != NULL)
+        return;
+
+    row = g_new0(event_row_t, 1);
+    row->catnum = sat->tle.catnr;
+    row->sat = sat;
+    row->collate = g_utf8_collate_key(sat->nickname, -1);
+    row_update_event(row);
+
+    g_ptr_array_add(model->rows, row);
+    g_hash_table_insert(model->index, &row->catnum, row);
+
+    if (!decayed(sat))
+        show_row(model, row);
+}
+
+GtkEventListModel *gtk_event_list_model_new(GHashTable *sats)
+{
+    GtkEventListModel *model;
+
+    model =
+        GTK_EVENT_LIST_MODEL(g_object_new(GTK_TYPE_EVENT_LIST_MODEL, NULL));
+    gtk_event_list_model_set_sats(model, sats);
+
+    return model;
+}
+
+/**
+ * Synchronise the rows with a (re)loaded satellite hash table.
+ * @param model The event list model.
+ * @param sats The satellites of the module.
+ *
+ * Existing rows are re-pointed to the new sat_t objects, rows of satellites
+ * no longer in the table are removed and new satellites are inserted.
+ */
+void gtk_event_list_model_set_sats(GtkEventListModel *model, GHashTable *sats)
+{
+    event_row_t *row;
+    sat_t *sat;
+    gint i;
+
+    g_return_if_fail(IS_GTK_EVENT_LIST_MODEL(model));
+
+    model->satellites = sats;
+
+    for (i = (gint)model->rows->len - 1; i >= 0; i--)
+    {
+        row = g_ptr_array_index(model->rows, i);
+        sat = SAT(g_hash_table_lookup(sats, &row->catnum));
+
+        if (sat == NULL)
+        {
+            hide_row(model, row);
+            g_hash_table_remove(model->index, &row->catnum);
+            g_ptr_array_remove_index_fast(model->rows, i);
+            continue;
+        }
+
+        row->sat = sat;
+        g_free(row->collate);
+        row->collate = g_utf8_collate_key(sat->nickname, -1);
+        row_update_event(row);
+        row->dirty = TRUE;
+    }
+
+    g_hash_table_foreach(sats, add_sat, model);
+
+    sort_rows(model);
+}
+
+/**
+ * Update the row of a satellite whose elements have changed.
+ * @param model The event list model.
+ * @param sat The satellite.
+ *
+ * The next event is moved by the next refresh; a new name is sorted in
+ * right away.
+ */
+void gtk_event_list_model_reload_sat(GtkEventListModel *model, sat_t *sat)
+{
+    event_row_t *row;
+
+    g_return_if_fail(IS_GTK_EVENT_LIST_MODEL(model));
+
+    row = g_hash_table_lookup(model->index, &sat->tle.catnr);
+    if (row == NULL)
+        return;
+
+    g_free(row->collate);
+    row->collate = g_utf8_collate_key(sat->nickname, -1);
+    row_update_event(row);
+    row->dirty = TRUE;
+
+    if (row->iter != NULL && model->sort_column == EVENT_LIST_COL_NAME)
+    {
+        g_ptr_array_add(model->moved, row);
+        resort_moved_rows(model);
+    }
+}
+
+/**
+ * Refresh the model after the satellites have been updated.
+ * @param model The event list model.
+ * @param tstamp The current time.
+ * @param first Index of the first row visible in the view.
+ * @param last Index of the last row visible in the view.
+ *
+ * Only rows whose next event has changed are moved and redrawn. The
+ * countdown of the visible rows is redrawn when tstamp crosses a whole
+ * second.
+ */
+void gtk_event_list_model_refresh(GtkEventListModel *model, gdouble tstamp,
+                                  gint first, gint last)
+{
+    event_row_t *row;
+    GSequenceIter *iter;
+    gdouble key;
+    gint64 second;
+    gint pos;
+    guint i;
+
+    g_return_if_fail(IS_GTK_EVENT_LIST_MODEL(model));
+
+    model->tstamp = tstamp;
+
+    for (i = 0; i < model->rows->len; i++)
+    {
+        row = g_ptr_array_index(model->rows, i);
+
+        if (decayed(row->sat))
+        {
+            hide_row(model, row);
+            continue;
+        }
+
+        row->dirty |= row_update_event(row);
+
+        /* shown once the other rows are in order again */
+        if (row->iter == NULL)
+        {
+            g_ptr_array_add(model->shown, row);
+            continue;
+        }
+
+        if (model->sort_column == EVENT_LIST_COL_NAME)
+            continue;
+
+        key = row_key(model, row);
+        if (key != row->key)
+        {
+            row->key = key;
+            g_ptr_array_add(model->moved, row);
+        }
+    }
+
+    if (model->moved->len > 0)
+        resort_moved_rows(model);
+
+    for (i = 0; i < model->shown->len; i++)
+        show_row(model, g_ptr_array_index(model->shown, i));
+    g_ptr_array_set_size(model->shown, 0);
+
+    second = (gint64)floor(tstamp * 86400.0);
+    if (second != model->second)
+    {
+        model->second = second;
+
+        first = MAX(first, 0);
+        iter = g_sequence_get_iter_at_pos(model->seq, first);
+        for (pos = first; pos <= last && !g_sequence_iter_is_end(iter);
+             pos++, iter = g_sequence_iter_next(iter))
+        {
+            row = g_sequence_get(iter);
+            emit_row_changed(model, row, pos);
+            row->dirty = FALSE;
+        }
+    }
+
+    for (i = 0; i < model->rows->len; i++)
+    {
+        row = g_ptr_array_index(model->rows, i);
+        if (row->dirty && row->iter != NULL)
+            emit_row_changed(model, row,
+                             g_sequence_iter_get_position(row->iter));
+        row->dirty = FALSE;
+    }
+}
+
+/** Get the satellite shown in the row pointed to by iter. */
+sat_t *gtk_event_list_model_get_sat(GtkEventListModel *model,
+                                    GtkTreeIter *iter)
+{
+    g_return_val_if_fail(IS_GTK_EVENT_LIST_MODEL(model), NULL);
+    g_return_val_if_fail(iter->stamp == model->stamp, NULL);
+
+    return ROW(iter)->sat;
+}
+
+/** Get an iterator pointing to the row of a satellite. */
+gboolean gtk_event_list_model_get_iter(GtkEventListModel *model, gint catnum,
+                                       GtkTreeIter *iter)
+{
+    event_row_t *row;
+
+    g_return_val_if_fail(IS_GTK_EVENT_LIST_MODEL(model), FALSE);
+
+    row = g_hash_table_lookup(model->index, &catnum);
+    if (row == NULL || row->iter == NULL)
+        return FALSE;
+
+    fill_iter(model, row, iter);
+
+    return TRUE;
+}
+
+/* GtkTreeModel interface */
+
+static GtkTreeModelFlags get_flags(GtkTreeModel *tree_model)
+{
+    (void)tree_model;
+
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint get_n_columns(GtkTreeModel *tree_model)
+{
+    (void)tree_model;
+
+    return EVENT_LIST_COL_NUMBER;
+}
+
+static GType get_column_type(GtkTreeModel *tree_model, gint index)
+{
+    (void)tree_model;
+
+    g_return_val_if_fail(index >= 0 && index < EVENT_LIST_COL_NUMBER,
+                         G_TYPE_INVALID);
+
+    return EVENT_LIST_COL_TYPE[index];
+}
+
+static gboolean iter_nth_child(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                               GtkTreeIter *parent, gint n)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(tree_model);
+
+    if (parent != NULL || n < 0 || n >= g_sequence_get_length(model->seq))
+        return FALSE;
+
+    fill_iter(model, g_sequence_get(g_sequence_get_iter_at_pos(model->seq, n)),
+              iter);
+
+    return TRUE;
+}
+
+static gboolean get_iter(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                         GtkTreePath *path)
+{
+    if (gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    return iter_nth_child(tree_model, iter, NULL,
+                          gtk_tree_path_get_indices(path)[0]);
+}
+
+static GtkTreePath *get_path(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    g_return_val_if_fail(
+        iter->stamp == GTK_EVENT_LIST_MODEL(tree_model)->stamp, NULL);
+    g_return_val_if_fail(ROW(iter)->iter != NULL, NULL);
+
+    return gtk_tree_path_new_from_indices(
+        g_sequence_iter_get_position(ROW(iter)->iter), -1);
+}
+
+static void get_value(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                      gint column, GValue *value)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(tree_model);
+    event_row_t *row = ROW(iter);
+
+    g_return_if_fail(iter->stamp == model->stamp);
+    g_return_if_fail(column >= 0 && column < EVENT_LIST_COL_NUMBER);
+
+    g_value_init(value, EVENT_LIST_COL_TYPE[column]);
+
+    switch (column)
+    {
+    case EVENT_LIST_COL_NAME:
+        g_value_set_string(value, row->sat->nickname);
+        break;
+    case EVENT_LIST_COL_CATNUM:
+        g_value_set_int(value, row->catnum);
+        break;
+    case EVENT_LIST_COL_AZ:
+        g_value_set_double(value, row->sat->az);
+        break;
+    case EVENT_LIST_COL_EL:
+        g_value_set_double(value, row->sat->el);
+        break;
+    case EVENT_LIST_COL_EVT:
+        g_value_set_boolean(value, row->los);
+        break;
+    case EVENT_LIST_COL_TIME:
+        g_value_set_double(value, (row->event < 0.0) ?
+                                      -1.0 : row->event - model->tstamp);
+        break;
+    case EVENT_LIST_COL_DECAY:
+        g_value_set_boolean(value, !decayed(row->sat));
+        break;
+    case EVENT_LIST_COL_BOLD:
+        g_value_set_int(value, (row->sat->el > 0.0) ? PANGO_WEIGHT_BOLD :
+                                                      PANGO_WEIGHT_NORMAL);
+        break;
+    default:
+        break;
+    }
+}
+
+static gboolean iter_next(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    GSequenceIter *next;
+
+    (void)tree_model;
+
+    if (ROW(iter)->iter == NULL)
+        return FALSE;
+
+    next = g_sequence_iter_next(ROW(iter)->iter);
+    if (g_sequence_iter_is_end(next))
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = g_sequence_get(next);
+
+    return TRUE;
+}
+
+static gboolean iter_previous(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    (void)tree_model;
+
+    if (ROW(iter)->iter == NULL || g_sequence_iter_is_begin(ROW(iter)->iter))
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = g_sequence_get(g_sequence_iter_prev(ROW(iter)->iter));
+
+    return TRUE;
+}
+
+static gboolean iter_children(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                              GtkTreeIter *parent)
+{
+    return iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean iter_has_child(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    (void)tree_model;
+    (void)iter;
+
+    return FALSE;
+}
+
+static gint iter_n_children(GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+    if (iter != NULL)
+        return 0;
+
+    return g_sequence_get_length(GTK_EVENT_LIST_MODEL(tree_model)->seq);
+}
+
+static gboolean iter_parent(GtkTreeModel *tree_model, GtkTreeIter *iter,
+                            GtkTreeIter *child)
+{
+    (void)tree_model;
+    (void)iter;
+    (void)child;
+
+    return FALSE;
+}
+
+static void gtk_event_list_model_tree_model_init(GtkTreeModelIface *iface,
+                                                 gpointer iface_data)
+{
+    (void)iface_data;
+
+    iface->get_flags = get_flags;
+    iface->get_n_columns = get_n_columns;
+    iface->get_column_type = get_column_type;
+    iface->get_iter = get_iter;
+    iface->get_path = get_path;
+    iface->get_value = get_value;
+    iface->iter_next = iter_next;
+    iface->iter_previous = iter_previous;
+    iface->iter_children = iter_children;
+    iface->iter_has_child = iter_has_child;
+    iface->iter_n_children = iter_n_children;
+    iface->iter_nth_child = iter_nth_child;
+    iface->iter_parent = iter_parent;
+}
+
+/* GtkTreeSortable interface */
+
+static gboolean get_sort_column_id(GtkTreeSortable *sortable,
+                                   gint *sort_column_id, GtkSortType *order)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(sortable);
+
+    if (sort_column_id)
+        *sort_column_id = model->sort_column;
+    if (order)
+        *order = model->sort_order;
+
+    return TRUE;
+}
+
+static void set_sort_column_id(GtkTreeSortable *sortable, gint sort_column_id,
+                               GtkSortType order)
+{
+    GtkEventListModel *model = GTK_EVENT_LIST_MODEL(sortable);
+
+    /* there is no unsorted state; the default is sorting by time */
+    if (sort_column_id < 0 || sort_column_id >= EVENT_LIST_COL_NUMBER)
+        sort_column_id = EVENT_LIST_COL_TIME;
+
+    if (model->sort_column == sort_column_id && model->sort_order == order)
+        return;
+
+    model->sort_column = sort_column_id;
+    model->sort_order = order;
+    gtk_tree_sortable_sort_column_changed(sortable);
+    sort_rows(model);
+}
+
+static void set_sort_func(GtkTreeSortable *sortable, gint sort_column_id,
+                          GtkTreeIterCompareFunc sort_func, gpointer data,
+                          GDestroyNotify destroy)
+{
+    (void)sortable;
+    (void)sort_column_id;
+    (void)sort_func;
+    (void)data;
+    (void)destroy;
+
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Custom sort functions are not supported"), __func__);
+}
+
+static void set_default_sort_func(GtkTreeSortable *sortable,
+                                  GtkTreeIterCompareFunc sort_func,
+                                  gpointer data, GDestroyNotify destroy)
+{
+    set_sort_func(sortable, 0, sort_func, data, destroy);
+}
+
+static gboolean has_default_sort_func(GtkTreeSortable *sortable)
+{
+    (void)sortable;
+
+    return FALSE;
+}
+
+static void gtk_event_list_model_sortable_init(GtkTreeSortableIface *iface,
+                                               gpointer iface_data)
+{
+    (void)iface_data;
+
+    iface->get_sort_column_id = get_sort_column_id;
+    iface->set_sort_column_id = set_sort_column_id;
+    iface->set_sort_func = set_sort_func;
+    iface->set_default_sort_func = set_default_sort_func;
+    iface->has_default_sort_func = has_default_sort_func;
+}
@@ -0,0 +1,94 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2009  Alexandru Csete, OZ9AEC.
+
+    Authors: Alexandru Csete <oz9aec@gmail.com>
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+#ifndef GTK_EVENT_LIST_MODEL_H
+#define GTK_EVENT_LIST_MODEL_H 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "gtk-sat-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define GTK_TYPE_EVENT_LIST_MODEL (gtk_event_list_model_get_type())
+#define GTK_EVENT_LIST_MODEL(obj)                                              \
+    G_TYPE_CHECK_INSTANCE_CAST(obj, gtk_event_list_model_get_type(),           \
+                               GtkEventListModel)
+
+#define IS_GTK_EVENT_LIST_MODEL(obj)                                           \
+    G_TYPE_CHECK_INSTANCE_TYPE(obj, gtk_event_list_model_get_type())
+
+typedef struct _gtk_event_list_model GtkEventListModel;
+typedef struct _GtkEventListModelClass GtkEventListModelClass;
+
+/*
+ * Tree model for the GtkEventList.
+ *
+ * The visible rows are kept in a GSequence ordered by the current sort key.
+ * When sorting by time the key is the Julian date of the next event, which
+ * only changes when a satellite passes AOS or LOS, so the order is stable
+ * between events and no re-sorting is needed on each tick.
+ */
+struct _gtk_event_list_model {
+    GObject parent;
+
+    gint stamp;             /* iterator stamp */
+    GHashTable *satellites; /* satellites (not owned) */
+    gdouble tstamp;         /* time of the last refresh */
+    gint64 second;          /* tstamp in whole seconds */
+
+    GPtrArray *rows;   /* all rows, owns the row data */
+    GHashTable *index; /* catnum -> row */
+    GSequence *seq;    /* visible rows in sort order */
+    GPtrArray *moved;  /* scratch list of rows whose sort key changed */
+    GPtrArray *shown;  /* scratch list of rows that became visible */
+
+    gint sort_column;
+    GtkSortType sort_order;
+};
+
+struct _GtkEventListModelClass {
+    GObjectClass parent_class;
+};
+
+GType gtk_event_list_model_get_type(void);
+GtkEventListModel *gtk_event_list_model_new(GHashTable *sats);
+void gtk_event_list_model_set_sats(GtkEventListModel *model, GHashTable *sats);
+void gtk_event_list_model_reload_sat(GtkEventListModel *model, sat_t *sat);
+void gtk_event_list_model_refresh(GtkEventListModel *model, gdouble tstamp,
+                                  gint first, gint last);
+sat_t *gtk_event_list_model_get_sat(GtkEventListModel *model,
+                                    GtkTreeIter *iter);
+gboolean gtk_event_list_model_get_iter(GtkEventListModel *model, gint catnum,
+                                       GtkTreeIter *iter);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif
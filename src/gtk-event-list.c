@@ -94,13 +94,6 @@ static void gtk_event_list_class_init(GtkEventListClass *class,
                                       gpointer class_data);
 static void gtk_event_list_init(GtkEventList *list, gpointer g_class);
 static void gtk_event_list_destroy(GtkWidget *widget);
-static GtkTreeModel *create_and_fill_model(GHashTable *sats);
-static void event_list_add_satellites(gpointer key, gpointer value,
-                                      gpointer user_data);
-static gboolean event_list_update_sats(GtkTreeModel *model, GtkTreePath *path,
-                                       GtkTreeIter *iter, gpointer data);
-
-/* cell rendering related functions */
 static void check_and_set_cell_renderer(GtkTreeViewColumn *column,
                                         GtkCellRenderer *renderer, gint i);
 static void evtype_cell_data_function(GtkTreeViewColumn *col,
@@ -115,9 +108,6 @@ static void degree_cell_data_function(GtkTreeViewColumn *col,
                                       GtkCellRenderer *renderer,
                                       GtkTreeModel *model, GtkTreeIter *iter,
                                       gpointer column);
-static gint event_cell_compare_function(GtkTreeModel *model, GtkTreeIter *a,
-                                        GtkTreeIter *b, gpointer user_data);
-
 static gboolean popup_menu_cb(GtkWidget *treeview, gpointer list);
 static gboolean button_press_cb(GtkWidget *treeview, GdkEventButton *event,
                                 gpointer list);
@@ -174,6 +164,15 @@ static void gtk_event_list_destroy(GtkWidget *widget)
 {
     GtkEventList *evlist = GTK_EVENT_LIST(widget);
 
+    if (evlist->model != NULL)
+    {
+        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(evlist->model),
+                                             &evlist->sort_column,
+                                             &evlist->sort_order);
+        g_object_unref(evlist->model);
+        evlist->model = NULL;
+    }
+
     g_key_file_set_integer(evlist->cfgdata, MOD_CFG_EVENT_LIST_SECTION,
                            MOD_CFG_EVENT_LIST_SORT_COLUMN, evlist->sort_column);
 
@@ -196,7 +195,6 @@ GtkWidget *gtk_event_list_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
 {
     GtkWidget *widget;
     GtkEventList *evlist;
-    GtkTreeModel *model, *filter, *sortable;
     guint i;
     GtkCellRenderer *renderer;
     GtkTreeViewColumn *column;
@@ -267,26 +265,13 @@ GtkWidget *gtk_event_list_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
         }
     }
 
-    /* create model and finalise treeview */
-    model = create_and_fill_model(evlist->satellites);
-    filter = gtk_tree_model_filter_new(model, NULL);
-    sortable = gtk_tree_model_sort_new_with_model(filter);
-    evlist->sortable = sortable;
-    gtk_tree_model_filter_set_visible_column(GTK_TREE_MODEL_FILTER(filter),
-                                             EVENT_LIST_COL_DECAY);
-    gtk_tree_view_set_model(GTK_TREE_VIEW(evlist->treeview), sortable);
-
-    /* The time sort function needs to be special */
-    gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(sortable),
-                                    EVENT_LIST_COL_TIME,
-                                    event_cell_compare_function, NULL, NULL);
-
-    gtk_tree_sortable_set_sort_column_id(
-        GTK_TREE_SORTABLE(sortable), evlist->sort_column, evlist->sort_order);
-
-    g_object_unref(model);
-    g_object_unref(filter);
-    g_object_unref(sortable);
+    /* create model and finalise treeview; decayed satellites are not shown */
+    evlist->model = gtk_event_list_model_new(evlist->satellites);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(evlist->model),
+                                         evlist->sort_column,
+                                         evlist->sort_order);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(evlist->treeview),
+                            GTK_TREE_MODEL(evlist->model));
 
     g_signal_connect(evlist->treeview, "button-press-event",
                      G_CALLBACK(button_press_cb), widget);
@@ -307,57 +292,18 @@ GtkWidget *gtk_event_list_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth,
     return widget;
 }
 
-/** Create and file the tree model for the even list. */
-static GtkTreeModel *create_and_fill_model(GHashTable *sats)
-{
-    GtkListStore *liststore;
-
-    liststore = gtk_list_store_new(EVENT_LIST_COL_NUMBER, G_TYPE_STRING, // name
-                                   G_TYPE_INT,     // catnum
-                                   G_TYPE_DOUBLE,  // az
-                                   G_TYPE_DOUBLE,  // el
-                                   G_TYPE_BOOLEAN, // TRUE if AOS, FALSE if LOS
-                                   G_TYPE_DOUBLE,  // time
-                                   G_TYPE_BOOLEAN, // decayed
-                                   G_TYPE_INT);    // bold for storing weight
-
-    g_hash_table_foreach(sats, event_list_add_satellites, liststore);
-
-    return GTK_TREE_MODEL(liststore);
-}
-
 /**
- * Add satellites. This function is a g_hash_table_foreach() callback.
- * @param key The key of the satellite in the hash table.
- * @param value Pointer to the satellite (sat_t structure) that should be added.
- * @param user_data Pointer to the GtkListStore where the satellite should be
- * added
+ * Update satellites.
  *
- * This function is called by by the create_and_fill_models() function for
- * adding the satellites to the internal liststore.
+ * The model only moves rows whose next event has changed and redraws the
+ * countdown once per second, so we just hand it the visible range.
  */
-static void event_list_add_satellites(gpointer key, gpointer value,
-                                      gpointer user_data)
-{
-    GtkListStore *store = GTK_LIST_STORE(user_data);
-    GtkTreeIter item;
-    sat_t *sat = SAT(value);
-
-    (void)key;
-
-    gtk_list_store_append(store, &item);
-    gtk_list_store_set(store, &item, EVENT_LIST_COL_NAME, sat->nickname,
-                       EVENT_LIST_COL_CATNUM, sat->tle.catnr, EVENT_LIST_COL_AZ,
-                       sat->az, EVENT_LIST_COL_EL, sat->el, EVENT_LIST_COL_EVT,
-                       (sat->el >= 0) ? TRUE : FALSE, EVENT_LIST_COL_TIME, 0.0,
-                       EVENT_LIST_COL_DECAY, !decayed(sat), -1);
-}
-
-/** Update satellites */
 void gtk_event_list_update(GtkWidget *widget)
 {
-    GtkTreeModel *model;
     GtkEventList *evlist = GTK_EVENT_LIST(widget);
+    GtkTreePath *start, *end;
+    gint first = 0;
+    gint last = -1;
 
     /* first, do some sanity checks */
     if ((evlist == NULL) || !IS_GTK_EVENT_LIST(evlist))
@@ -367,114 +313,16 @@ void gtk_event_list_update(GtkWidget *widget)
         return;
     }
 
-    /* get and tranverse the model */
-    model = gtk_tree_model_filter_get_model(
-        GTK_TREE_MODEL_FILTER(gtk_tree_model_sort_get_model(GTK_TREE_MODEL_SORT(
-            gtk_tree_view_get_model(GTK_TREE_VIEW(evlist->treeview))))));
-
-    /* save the sort information */
-    gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(evlist->sortable),
-                                         &(evlist->sort_column),
-                                         &(evlist->sort_order));
-
-    /* update */
-    gtk_tree_model_foreach(model, event_list_update_sats, evlist);
-
-#if 0
-    /* check refresh rate */
-    if (evlist->counter < evlist->refresh)
+    if (gtk_tree_view_get_visible_range(GTK_TREE_VIEW(evlist->treeview),
+                                        &start, &end))
     {
-        evlist->counter++;
+        first = gtk_tree_path_get_indices(start)[0];
+        last = gtk_tree_path_get_indices(end)[0];
+        gtk_tree_path_free(start);
+        gtk_tree_path_free(end);
     }
-    else
-    {
-        evlist->counter = 1;
 
-        /* get and tranverse the model */
-        model =
-            gtk_tree_model_filter_get_model(gtk_tree_view_get_model
-                                            (GTK_TREE_VIEW(evlist->treeview)));
-
-
-        /* update */
-        gtk_tree_model_foreach(model, event_list_update_sats, evlist);
-    }
-#endif
-}
-
-/** Update data in each column in a given row */
-static gboolean event_list_update_sats(GtkTreeModel *model, GtkTreePath *path,
-                                       GtkTreeIter *iter, gpointer data)
-{
-    GtkEventList *evlist = GTK_EVENT_LIST(data);
-    guint *catnum;
-    sat_t *sat;
-    gdouble number, now;
-
-    (void)path;
-
-    /* get the catalogue number for this row
-       then look it up in the hash table
-     */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, EVENT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(evlist->satellites, catnum));
-
-    if (sat == NULL)
-    {
-        /* satellite not tracked anymore => remove */
-        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Failed to get data for #%d."),
-                    __func__, *catnum);
-
-        gtk_list_store_remove(GTK_LIST_STORE(model), iter);
-
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Satellite #%d removed from list."), __func__,
-                    *catnum);
-    }
-    else
-    {
-        /* update data */
-        now = evlist->tstamp;
-
-        if (sat->el > 0.0)
-        {
-            if (sat->los > 0.0)
-            {
-                number = sat->los - now;
-            }
-            else
-            {
-                number = -1.0; /* Sat is staionary or no event */
-            }
-        }
-        else
-        {
-            if (sat->aos > 0.0)
-            {
-                number = sat->aos - now;
-            }
-            else
-            {
-                number = -1.0; /* Sat is staionary or no event */
-            }
-        }
-
-        /* store new data */
-        gtk_list_store_set(
-            GTK_LIST_STORE(model), iter, EVENT_LIST_COL_AZ, sat->az,
-            EVENT_LIST_COL_EL, sat->el, EVENT_LIST_COL_EVT,
-            (sat->el >= 0) ? TRUE : FALSE, EVENT_LIST_COL_TIME, number,
-            EVENT_LIST_COL_DECAY, !decayed(sat), EVENT_LIST_COL_BOLD,
-            (sat->el > 0.0) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL, -1);
-    }
-
-    g_free(catnum);
-
-    /* Return value not documented what to return, but it seems that
-       FALSE continues to next row while TRUE breaks
-     */
-    return FALSE;
+    gtk_event_list_model_refresh(evlist->model, evlist->tstamp, first, last);
 }
 
 /** Set cell renderer function. */
@@ -617,54 +465,6 @@ static void degree_cell_data_function(GtkTreeViewColumn *col,
     g_free(buff);
 }
 
-/**
- * Function to compare to Event cells.
- * @param model Pointer to the GtkTreeModel.
- * @param a Pointer to the first element.
- * @param b Pointer to the second element.
- * @param user_data Always NULL (TBC).
- * @return See detailed description.
- *
- * This function is used by the SatList sort function to determine whether
- * AOS/LOS cell a is greater than b or not. The cells a and b contain the
- * time of the event in Julian days, thus the result can be computed by a
- * simple comparison between the two numbers contained in the cells.
- *
- * The function returns -1 if a < b; +1 if a > b; 0 otherwise.
- */
-static gint event_cell_compare_function(GtkTreeModel *model, GtkTreeIter *a,
-                                        GtkTreeIter *b, gpointer user_data)
-{
-    gint result;
-    gdouble ta, tb;
-    gint sort_col =
-        EVENT_LIST_COL_TIME; /* hard coded as it is the only option */
-
-    /* extracting from models was not working */
-    /* with filter and sorting */
-
-    (void)user_data;
-
-    /* get a and b */
-    gtk_tree_model_get(model, a, sort_col, &ta, -1);
-    gtk_tree_model_get(model, b, sort_col, &tb, -1);
-
-    if (ta < tb)
-    {
-        result = -1;
-    }
-    else if (ta > tb)
-    {
-        result = 1;
-    }
-    else
-    {
-        result = 0;
-    }
-
-    return result;
-}
-
 /** Reload configuration */
 void gtk_event_list_reconf(GtkWidget *widget, GKeyFile *cfgdat)
 {
@@ -740,58 +540,47 @@ static gboolean button_press_cb(GtkWidget *treeview, GdkEventButton *event,
 static void row_activated_cb(GtkTreeView *tree_view, GtkTreePath *path,
                              GtkTreeViewColumn *column, gpointer list)
 {
-    GtkTreeModel *model;
     GtkTreeIter iter;
-    guint *catnum;
     sat_t *sat;
 
     (void)column;
 
-    catnum = g_new0(guint, 1);
-    model = gtk_tree_view_get_model(tree_view);
-    gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, EVENT_LIST_COL_CATNUM, catnum, -1);
+    if (!gtk_tree_model_get_iter(gtk_tree_view_get_model(tree_view), &iter,
+                                 path))
+        return;
 
-    sat = SAT(g_hash_table_lookup(GTK_EVENT_LIST(list)->satellites, catnum));
+    sat = gtk_event_list_model_get_sat(GTK_EVENT_LIST(list)->model, &iter);
 
     if (sat == NULL)
     {
-        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s:%d Failed to get data for %d."),
-                    __FILE__, __LINE__, *catnum);
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s:%d Failed to get satellite data."), __FILE__,
+                    __LINE__);
     }
     else
     {
         show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(list)));
     }
-
-    g_free(catnum);
 }
 
 static void view_popup_menu(GtkWidget *treeview, GdkEventButton *event,
                             gpointer list)
 {
     GtkTreeSelection *selection;
-    GtkTreeModel *model;
     GtkTreeIter iter;
-    guint *catnum;
     sat_t *sat;
 
-    catnum = g_new0(guint, 1);
-
     /* get selected satellite */
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
-    if (gtk_tree_selection_get_selected(selection, &model, &iter))
+    if (gtk_tree_selection_get_selected(selection, NULL, &iter))
     {
-        gtk_tree_model_get(model, &iter, EVENT_LIST_COL_CATNUM, catnum, -1);
-
-        sat =
-            SAT(g_hash_table_lookup(GTK_EVENT_LIST(list)->satellites, catnum));
+        sat = gtk_event_list_model_get_sat(GTK_EVENT_LIST(list)->model, &iter);
 
         if (sat == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s:%d Failed to get data for %d."), __FILE__,
-                        __LINE__, *catnum);
+                        _("%s:%d Failed to get satellite data."), __FILE__,
+                        __LINE__);
         }
         else
         {
@@ -805,49 +594,31 @@ static void view_popup_menu(GtkWidget *treeview, GdkEventButton *event,
                     _("%s:%d: There is no selection; skip popup."), __FILE__,
                     __LINE__);
     }
-
-    g_free(catnum);
 }
 
 /** Reload reference to satellites (e.g. after TLE update). */
 void gtk_event_list_reload_sats(GtkWidget *evlist, GHashTable *sats)
 {
     GTK_EVENT_LIST(evlist)->satellites = sats;
+    gtk_event_list_model_set_sats(GTK_EVENT_LIST(evlist)->model, sats);
+}
+
+/** Reload a satellite whose elements have changed. */
+void gtk_event_list_reload_sat(GtkWidget *evlist, sat_t *sat)
+{
+    gtk_event_list_model_reload_sat(GTK_EVENT_LIST(evlist)->model, sat);
 }
 
 /** Select satellite. */
 void gtk_event_list_select_sat(GtkWidget *widget, gint catnum)
 {
     GtkEventList *list;
-    GtkTreeModel *model;
     GtkTreeSelection *selection;
     GtkTreeIter iter;
-    gint i, n;
-    gint sat;
 
     list = GTK_EVENT_LIST(widget);
-    model = gtk_tree_view_get_model(GTK_TREE_VIEW(list->treeview));
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(list->treeview));
 
-    /* iterate over the satellite list until a amtch is found */
-    n = g_hash_table_size(list->satellites);
-    for (i = 0; i < n; i++)
-    {
-
-        if (gtk_tree_model_iter_nth_child(model, &iter, NULL, i))
-        {
-            gtk_tree_model_get(model, &iter, EVENT_LIST_COL_CATNUM, &sat, -1);
-            if (sat == catnum)
-            {
-                gtk_tree_selection_select_iter(selection, &iter);
-                i = n;
-            }
-        }
-        else
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: GtkEventList has not child with index %d"),
-                        __func__, i);
-        }
-    }
+    if (gtk_event_list_model_get_iter(list->model, catnum, &iter))
+        gtk_tree_selection_select_iter(selection, &iter);
 }
@@ -6,6 +6,7 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "gtk-event-list-model.h"
 #include "gtk-sat-data.h"
 
 #ifdef __cplusplus
@@ -40,7 +41,7 @@ struct _gtk_event_list {
     GKeyFile *cfgdata;
     gint sort_column;
     GtkSortType sort_order;
-    GtkTreeModel *sortable;
+    GtkEventListModel *model; /* tree model ordered by next event */
 
     void (*update)(GtkWidget *widget); /* update function */
 };
@@ -79,6 +80,7 @@ void gtk_event_list_update(GtkWidget *widget);
 void gtk_event_list_reconf(GtkWidget *widget, GKeyFile *cfgdat);
 
 void gtk_event_list_reload_sats(GtkWidget *satlist, GHashTable *sats);
+void gtk_event_list_reload_sat(GtkWidget *evlist, sat_t *sat);
 void gtk_event_list_select_sat(GtkWidget *widget, gint catnum);
 
 #ifdef __cplusplus
@@ -46,6 +46,7 @@
 #define POLV_LINE_EXTRA 5
 
 static void update_sat(gpointer key, gpointer value, gpointer data);
+static void update_sats(GtkPolarView *polv);
 
 static GtkBoxClass *parent_class = NULL;
 
@@ -86,8 +87,7 @@ static void free_sat_obj(gpointer data)
     if (obj)
     {
         g_free(obj->nickname);
-        g_free(obj->tooltip);
-        g_slist_free_full(obj->track_points, g_free);
+        g_free(obj->track_points);
         if (obj->pass)
             free_pass(obj->pass);
         g_free(obj);
@@ -112,6 +112,12 @@ static void gtk_polar_view_destroy(GtkWidget *widget)
     g_free(polv->font);
     polv->font = NULL;
 
+    if (polv->visible)
+    {
+        g_ptr_array_free(polv->visible, TRUE);
+        polv->visible = NULL;
+    }
+
     if (polv->obj)
     {
         g_hash_table_destroy(polv->obj);
@@ -152,6 +158,7 @@ static void gtk_polar_view_init(GtkPolarView *polview, gpointer g_class)
     polview->sats = NULL;
     polview->qth = NULL;
     polview->obj = NULL;
+    polview->visible = NULL;
     polview->naos = 0.0;
     polview->ncat = 0;
     polview->size = 0;
@@ -367,12 +374,8 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     PangoLayout *layout;
     PangoFontDescription *font_desc;
     gint tw, th;
-    GHashTableIter iter;
-    gpointer key, value;
     sat_obj_t *obj;
-    GSList *node;
-    gdouble *point;
-    guint i;
+    guint i, j;
 
     (void)widget;
 
@@ -506,35 +509,24 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
     }
 
     /* Draw satellite objects */
-    if (polv->obj)
+    if (polv->visible)
     {
-        g_hash_table_iter_init(&iter, polv->obj);
-        while (g_hash_table_iter_next(&iter, &key, &value))
+        for (j = 0; j < polv->visible->len; j++)
         {
-            obj = SAT_OBJ(value);
+            obj = SAT_OBJ(g_ptr_array_index(polv->visible, j));
 
             /* Draw track if enabled */
-            if (obj->showtrack && obj->track_points)
+            if (obj->showtrack && obj->track_num > 0)
             {
                 rgba_to_cairo(polv->col_track, &r, &g, &b, &a);
                 cairo_set_source_rgba(cr, r, g, b, a);
                 cairo_set_line_width(cr, 1.0);
 
-                node = obj->track_points;
-                if (node)
-                {
-                    point = (gdouble *)node->data;
-                    cairo_move_to(cr, point[0], point[1]);
-                    node = node->next;
-
-                    while (node)
-                    {
-                        point = (gdouble *)node->data;
-                        cairo_line_to(cr, point[0], point[1]);
-                        node = node->next;
-                    }
-                    cairo_stroke(cr);
-                }
+                cairo_move_to(cr, obj->track_points[0], obj->track_points[1]);
+                for (i = 1; i < obj->track_num; i++)
+                    cairo_line_to(cr, obj->track_points[2 * i],
+                                  obj->track_points[2 * i + 1]);
+                cairo_stroke(cr);
 
                 /* Draw time ticks */
                 for (i = 0; i < TRACK_TICK_NUM; i++)
@@ -596,19 +588,17 @@ static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data)
 
 static sat_obj_t *find_sat_at_pos(GtkPolarView *polv, gfloat mx, gfloat my)
 {
-    GHashTableIter iter;
-    gpointer key, value;
     sat_obj_t *obj;
     gfloat dx, dy;
     const gfloat hit_radius = 10.0;
+    guint i;
 
-    if (polv->obj == NULL)
+    if (polv->visible == NULL)
         return NULL;
 
-    g_hash_table_iter_init(&iter, polv->obj);
-    while (g_hash_table_iter_next(&iter, &key, &value))
+    for (i = 0; i < polv->visible->len; i++)
     {
-        obj = SAT_OBJ(value);
+        obj = SAT_OBJ(g_ptr_array_index(polv->visible, i));
         dx = mx - obj->x;
         dy = my - obj->y;
         if (dx * dx + dy * dy < hit_radius * hit_radius)
@@ -623,7 +613,6 @@ static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event,
     GtkPolarView *polv = GTK_POLAR_VIEW(data);
     sat_obj_t *obj;
     sat_t *sat = NULL;
-    gint *catpoint = NULL;
 
     (void)widget;
 
@@ -638,29 +627,23 @@ static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event,
         if (event->type == GDK_2BUTTON_PRESS)
         {
             /* Double-click: show satellite info */
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = obj->catnum;
-            sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+            sat = SAT(g_hash_table_lookup(polv->sats, &obj->catnum));
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(polv)));
             }
-            g_free(catpoint);
         }
         break;
 
     case 3:
         /* Right-click: popup menu */
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = obj->catnum;
-        sat = SAT(g_hash_table_lookup(polv->sats, catpoint));
+        sat = SAT(g_hash_table_lookup(polv->sats, &obj->catnum));
         if (sat != NULL)
         {
             gtk_polar_view_popup_exec(
                 sat, polv->qth, polv, event,
                 gtk_widget_get_toplevel(GTK_WIDGET(polv)));
         }
-        g_free(catpoint);
         break;
 
     default:
@@ -687,7 +670,7 @@ static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event,
 {
     GtkPolarView *polv = GTK_POLAR_VIEW(data);
     sat_obj_t *obj;
-    gint *catpoint;
+    gint catnum;
 
     (void)widget;
 
@@ -701,20 +684,17 @@ static gboolean on_button_release(GtkWidget *widget, GdkEventButton *event,
 
     obj->selected = !obj->selected;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = obj->catnum;
+    catnum = obj->catnum;
 
     if (!obj->selected)
     {
         g_free(polv->sel_text);
         polv->sel_text = NULL;
-        *catpoint = 0;
+        catnum = 0;
     }
 
     /* clear other selections */
-    g_hash_table_foreach(polv->obj, clear_selection, catpoint);
-
-    g_free(catpoint);
+    g_hash_table_foreach(polv->obj, clear_selection, &catnum);
 
     gtk_widget_queue_draw(polv->canvas);
 
@@ -751,6 +731,70 @@ static gboolean on_motion_notify(GtkWidget *widget, GdkEventMotion *event,
     return TRUE;
 }
 
+/* Convert LOS timestamp to human readable countdown string */
+static void los_time_to_str(GtkPolarView *polv, sat_t *sat, gchar *buf,
+                            gsize len)
+{
+    guint h, m, s;
+    gdouble number;
+
+    if (sat->los <= 0.0)
+    {
+        g_strlcpy(buf, _("Always in range"), len);
+        return;
+    }
+
+    number = sat->los - polv->tstamp;
+
+    /* convert julian date to seconds */
+    s = (guint)(number * 86400);
+
+    /* extract hours */
+    h = (guint)floor(s / 3600);
+    s -= 3600 * h;
+
+    /* extract minutes */
+    m = (guint)floor(s / 60);
+    s -= 60 * m;
+
+    if (h > 0)
+        g_snprintf(buf, len, _("LOS in %02d:%02d:%02d"), h, m, s);
+    else
+        g_snprintf(buf, len, _("LOS in %02d:%02d"), m, s);
+}
+
+/* Build the tooltip on demand for the satellite under the cursor */
+static gboolean on_query_tooltip(GtkWidget *widget, gint x, gint y,
+                                 gboolean keyboard_mode, GtkTooltip *tooltip,
+                                 gpointer data)
+{
+    GtkPolarView *polv = GTK_POLAR_VIEW(data);
+    sat_obj_t *obj;
+    sat_t *sat;
+    gchar losstr[64];
+    gchar *markup;
+
+    (void)widget;
+    (void)keyboard_mode;
+
+    obj = find_sat_at_pos(polv, x, y);
+    if (obj == NULL)
+        return FALSE;
+
+    sat = SAT(g_hash_table_lookup(polv->sats, &obj->catnum));
+    if (sat == NULL)
+        return FALSE;
+
+    los_time_to_str(polv, sat, losstr, sizeof(losstr));
+    markup = g_markup_printf_escaped(
+        "<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n%s",
+        sat->nickname, sat->az, sat->el, losstr);
+    gtk_tooltip_set_markup(tooltip, markup);
+    g_free(markup);
+
+    return TRUE;
+}
+
 static void size_allocate_cb(GtkWidget *widget, GtkAllocation *allocation,
                              gpointer data)
 {
@@ -778,8 +822,10 @@ GtkWidget *gtk_polar_view_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth)
     polv->sats = sats;
     polv->qth = qth;
 
+    /* the keys point to the catnum inside the objects */
     polv->obj =
-        g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_sat_obj);
+        g_hash_table_new_full(g_int_hash, g_int_equal, NULL, free_sat_obj);
+    polv->visible = g_ptr_array_new();
     polv->showtracks_on =
         g_hash_table_new_full(g_int_hash, g_int_equal, g_free, NULL);
     polv->showtracks_off =
@@ -878,6 +924,8 @@ GtkWidget *gtk_polar_view_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth)
                      G_CALLBACK(on_button_press), polv);
     g_signal_connect(polv->canvas, "button-release-event",
                      G_CALLBACK(on_button_release), polv);
+    g_signal_connect(polv->canvas, "query-tooltip",
+                     G_CALLBACK(on_query_tooltip), polv);
     g_signal_connect(polv->canvas, "size-allocate",
                      G_CALLBACK(size_allocate_cb), polv);
     g_signal_connect_after(polv->canvas, "realize",
@@ -892,6 +940,8 @@ GtkWidget *gtk_polar_view_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth)
 static void update_polv_size(GtkPolarView *polv)
 {
     GtkAllocation allocation;
+    sat_obj_t *obj;
+    guint i;
 
     if (gtk_widget_get_realized(GTK_WIDGET(polv)))
     {
@@ -902,38 +952,22 @@ static void update_polv_size(GtkPolarView *polv)
         polv->cx = allocation.width / 2;
         polv->cy = allocation.height / 2;
 
-        /* Update satellite positions */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        /* Update satellite positions and sky tracks */
+        update_sats(polv);
+        for (i = 0; i < polv->visible->len; i++)
+        {
+            obj = SAT_OBJ(g_ptr_array_index(polv->visible, i));
+            if (obj->showtrack && obj->pass)
+                gtk_polar_view_create_track(polv, obj, NULL);
+        }
     }
 }
 
-/* Convert LOS timestamp to human readable countdown string */
-static gchar *los_time_to_str(GtkPolarView *polv, sat_t *sat)
+/* Update all satellites and rebuild the list of visible objects */
+static void update_sats(GtkPolarView *polv)
 {
-    guint h, m, s;
-    gdouble number, now;
-    gchar *text = NULL;
-
-    now = polv->tstamp;
-    number = sat->los - now;
-
-    /* convert julian date to seconds */
-    s = (guint)(number * 86400);
-
-    /* extract hours */
-    h = (guint)floor(s / 3600);
-    s -= 3600 * h;
-
-    /* extract minutes */
-    m = (guint)floor(s / 60);
-    s -= 60 * m;
-
-    if (h > 0)
-        text = g_strdup_printf(_("LOS in %02d:%02d:%02d"), h, m, s);
-    else
-        text = g_strdup_printf(_("LOS in %02d:%02d"), m, s);
-
-    return text;
+    g_ptr_array_set_size(polv->visible, 0);
+    g_hash_table_foreach(polv->sats, update_sat, polv);
 }
 
 void gtk_polar_view_update(GtkWidget *widget)
@@ -943,7 +977,6 @@ void gtk_polar_view_update(GtkWidget *widget)
     gchar *buff;
     guint h, m, s;
     sat_t *sat = NULL;
-    gint *catnr;
 
     if (polv->resize)
     {
@@ -965,17 +998,14 @@ void gtk_polar_view_update(GtkWidget *widget)
         polv->ncat = 0;
 
         /* update sats */
-        g_hash_table_foreach(polv->sats, update_sat, polv);
+        update_sats(polv);
 
         /* update countdown to NEXT AOS label */
         if (polv->eventinfo)
         {
             if (polv->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = polv->ncat;
-                sat = SAT(g_hash_table_lookup(polv->sats, catnr));
-                g_free(catnr);
+                sat = SAT(g_hash_table_lookup(polv->sats, &polv->ncat));
 
                 if (sat != NULL)
                 {
@@ -1023,21 +1053,38 @@ void gtk_polar_view_update(GtkWidget *widget)
     }
 }
 
+/* Create a new satellite object when a satellite rises for the first time */
+static sat_obj_t *new_sat_obj(GtkPolarView *polv, sat_t *sat)
+{
+    sat_obj_t *obj;
+
+    obj = g_new0(sat_obj_t, 1);
+    obj->catnum = sat->tle.catnr;
+    obj->nickname = g_strdup(sat->nickname);
+
+    if (g_hash_table_lookup_extended(polv->showtracks_on, &obj->catnum, NULL,
+                                     NULL))
+        obj->showtrack = TRUE;
+    else if (g_hash_table_lookup_extended(polv->showtracks_off, &obj->catnum,
+                                          NULL, NULL))
+        obj->showtrack = FALSE;
+    else
+        obj->showtrack = polv->showtrack;
+
+    return obj;
+}
+
 static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    gint *catnum;
     sat_t *sat = SAT(value);
     GtkPolarView *polv = GTK_POLAR_VIEW(data);
     sat_obj_t *obj = NULL;
-    gfloat x, y;
     gdouble now;
-    gchar *losstr;
+    gchar losstr[64];
+    gboolean newpass;
 
     (void)key;
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
-
     now = polv->tstamp;
 
     /* update next AOS */
@@ -1050,12 +1097,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &sat->tle.catnr));
+
     /* if sat is out of range */
     if ((sat->el < 0.00) || decayed(sat))
     {
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
-
-        if (obj != NULL)
+        if (obj != NULL && obj->visible)
         {
             /* if this was the selected satellite we need to
                clear the info text
@@ -1064,143 +1111,111 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             {
                 g_free(polv->sel_text);
                 polv->sel_text = NULL;
+                obj->selected = FALSE;
             }
 
-            /* remove sat object from hash table (this will free it) */
-            g_hash_table_remove(polv->obj, catnum);
+            obj->visible = FALSE;
         }
 
-        g_free(catnum);
+        return;
     }
-    else
-    {
-        /* sat is within range */
-        obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catnum));
-        azel_to_xy(polv, sat->az, sat->el, &x, &y);
-
-        if (obj != NULL)
-        {
-            /* update existing satellite */
-            obj->x = x;
-            obj->y = y;
-
-            /* update nickname */
-            g_free(obj->nickname);
-            obj->nickname = g_strdup(sat->nickname);
-
-            /* update LOS count down */
-            if (sat->los > 0.0)
-                losstr = los_time_to_str(polv, sat);
-            else
-                losstr =
-                    g_strdup_printf(_("%s\nAlways in range"), sat->nickname);
 
-            /* update tooltip */
-            g_free(obj->tooltip);
-            obj->tooltip = g_markup_printf_escaped(
-                "<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n%s",
-                sat->nickname, sat->az, sat->el, losstr);
+    /* sat is within range */
+    if (obj == NULL)
+    {
+        obj = new_sat_obj(polv, sat);
+        g_hash_table_insert(polv->obj, &obj->catnum, obj);
+    }
 
-            /* update selection info */
-            if (obj->selected)
-            {
-                g_free(polv->sel_text);
-                polv->sel_text =
-                    g_strdup_printf("%s\n%s", sat->nickname, losstr);
-            }
+    azel_to_xy(polv, sat->az, sat->el, &obj->x, &obj->y);
 
-            /* Check if pass needs update */
-            if (obj->pass)
-            {
-                /** FIXME: threshold */
-                gboolean qth_upd =
-                    qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
-                gboolean time_upd =
-                    !((obj->pass->aos <= now) && (obj->pass->los >= now));
+    /* update nickname */
+    if (g_strcmp0(obj->nickname, sat->nickname))
+    {
+        g_free(obj->nickname);
+        obj->nickname = g_strdup(sat->nickname);
+    }
 
-                if (qth_upd || time_upd)
-                {
-                    sat_log_log(
-                        SAT_LOG_LEVEL_DEBUG,
+    /* Check if pass needs update; if there is no pass we only try again
+       when the satellite rises */
+    if (obj->pass)
+    {
+        /** FIXME: threshold */
+        gboolean qth_upd =
+            qth_small_dist(polv->qth, (obj->pass->qth_comp)) > 1.0;
+        gboolean time_upd =
+            !((obj->pass->aos <= now) && (obj->pass->los >= now));
+
+        newpass = qth_upd || time_upd;
+        if (newpass)
+        {
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
                         _("%s:%s: Updating satellite pass SAT:%d Q:%d T:%d\n"),
-                        __FILE__, __func__, *catnum, qth_upd, time_upd);
-
-                    /* Free old track and pass */
-                    g_slist_free_full(obj->track_points, g_free);
-                    obj->track_points = NULL;
-                    free_pass(obj->pass);
-                    obj->pass = NULL;
+                        __FILE__, __func__, obj->catnum, qth_upd, time_upd);
 
-                    /* Compute new pass */
-                    obj->pass = get_current_pass(sat, polv->qth, now);
-
-                    /* Recreate track if needed */
-                    if (obj->showtrack && obj->pass)
-                        gtk_polar_view_create_track(polv, obj, sat);
-                }
-            }
-
-            g_free(losstr);
-            g_free(catnum); // FIXME: why free here, what about else?
+            free_pass(obj->pass);
+            obj->pass = NULL;
         }
-        else
-        {
-            /* add new satellite */
-            obj = g_try_new0(sat_obj_t, 1);
-
-            if (obj != NULL)
-            {
-                obj->selected = FALSE;
-                obj->x = x;
-                obj->y = y;
-                obj->catnum = sat->tle.catnr;
-                obj->nickname = g_strdup(sat->nickname);
-                obj->track_points = NULL;
-
-                if (g_hash_table_lookup_extended(polv->showtracks_on, catnum,
-                                                 NULL, NULL))
-                    obj->showtrack = TRUE;
-                else if (g_hash_table_lookup_extended(polv->showtracks_off,
-                                                      catnum, NULL, NULL))
-                    obj->showtrack = FALSE;
-                else
-                    obj->showtrack = polv->showtrack;
+    }
+    else
+    {
+        newpass = !obj->visible;
+    }
 
-                obj->istarget = FALSE;
+    if (newpass)
+    {
+        obj->pass = get_current_pass(sat, polv->qth, now);
 
-                /* create tooltip */
-                obj->tooltip = g_markup_printf_escaped(
-                    "<b>%s</b>\nAz: %5.1f\302\260\nEl: %5.1f\302\260\n",
-                    sat->nickname, sat->az, sat->el);
+        /* Recreate track from the new pass */
+        if (obj->showtrack)
+        {
+            if (obj->pass)
+                gtk_polar_view_create_track(polv, obj, sat);
+            else
+                gtk_polar_view_delete_track(polv, obj, sat);
+        }
+    }
 
-                /* get info about the current pass */
-                obj->pass = get_current_pass(sat, polv->qth, now);
+    /* update selection info */
+    if (obj->selected)
+    {
+        los_time_to_str(polv, sat, losstr, sizeof(losstr));
+        g_free(polv->sel_text);
+        polv->sel_text = g_strdup_printf("%s\n%s", sat->nickname, losstr);
+    }
 
-                /* add sat to hash table */
-                g_hash_table_insert(polv->obj, catnum, obj);
+    obj->visible = TRUE;
+    g_ptr_array_add(polv->visible, obj);
+}
 
-                /* create the sky track if necessary */
-                if (obj->showtrack)
-                    gtk_polar_view_create_track(polv, obj, sat);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s: Cannot allocate memory for satellite %d."),
-                            __func__, sat->tle.catnr);
-                g_free(catnum);
-                return;
-            }
-        }
+/* Append a point to the sky track, growing the buffer if necessary */
+static void track_append(sat_obj_t *obj, gfloat x, gfloat y)
+{
+    if (obj->track_num == obj->track_size)
+    {
+        obj->track_size = MAX(2 * obj->track_size, 64);
+        obj->track_points =
+            g_renew(gdouble, obj->track_points, 2 * obj->track_size);
     }
+
+    obj->track_points[2 * obj->track_num] = x;
+    obj->track_points[2 * obj->track_num + 1] = y;
+    obj->track_num++;
 }
 
+/*
+ * Create the sky track of a satellite.
+ *
+ * The track is built from the pass data already stored in the satellite
+ * object; no prediction takes place. The point buffer is reused between
+ * passes so that a new track normally does not allocate any memory.
+ */
 void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
 {
     guint num, i;
+    GSList *node;
     pass_detail_t *detail;
     gfloat x, y;
-    gdouble *point;
     guint tres, ttidx;
 
     (void)sat;
@@ -1222,8 +1237,8 @@ void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
     }
 
     /* Clear existing track points */
-    g_slist_free_full(obj->track_points, g_free);
-    obj->track_points = NULL;
+    obj->track_num = 0;
+    memset(obj->trtick, 0, sizeof(obj->trtick));
 
     /* Create points */
     num = g_slist_length(obj->pass->details);
@@ -1239,10 +1254,7 @@ void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
 
     /* first point should be (aos_az,0.0) */
     azel_to_xy(pv, obj->pass->aos_az, 0.0, &x, &y);
-    point = g_new(gdouble, 2);
-    point[0] = x;
-    point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
+    track_append(obj, x, y);
 
     /* first time tick */
     obj->trtick[0].x = x;
@@ -1251,16 +1263,14 @@ void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
 
     ttidx = 1;
 
-    for (i = 1; i < num - 1; i++)
+    node = obj->pass->details->next;
+    for (i = 1; i < num - 1; i++, node = node->next)
     {
-        detail = PASS_DETAIL(g_slist_nth_data(obj->pass->details, i));
+        detail = PASS_DETAIL(node->data);
         if (detail->el >= 0.0)
             azel_to_xy(pv, detail->az, detail->el, &x, &y);
 
-        point = g_new(gdouble, 2);
-        point[0] = x;
-        point[1] = y;
-        obj->track_points = g_slist_append(obj->track_points, point);
+        track_append(obj, x, y);
 
         if (tres != 0 && !(i % tres))
         {
@@ -1283,10 +1293,7 @@ void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
 
     /* last point should be (los_az, 0.0) */
     azel_to_xy(pv, obj->pass->los_az, 0.0, &x, &y);
-    point = g_new(gdouble, 2);
-    point[0] = x;
-    point[1] = y;
-    obj->track_points = g_slist_append(obj->track_points, point);
+    track_append(obj, x, y);
 }
 
 void gtk_polar_view_delete_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
@@ -1296,8 +1303,8 @@ void gtk_polar_view_delete_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat)
 
     if (obj)
     {
-        g_slist_free_full(obj->track_points, g_free);
-        obj->track_points = NULL;
+        /* keep the buffer for the next track */
+        obj->track_num = 0;
 
         /* Clear time ticks */
         memset(obj->trtick, 0, sizeof(obj->trtick));
@@ -1311,17 +1318,51 @@ void gtk_polar_view_reload_sats(GtkWidget *polv, GHashTable *sats)
     GTK_POLAR_VIEW(polv)->ncat = 0;
 }
 
-void gtk_polar_view_select_sat(GtkWidget *widget, gint catnum)
+/*
+ * Reload a satellite whose elements have changed.
+ *
+ * The pass and sky track of the satellite are calculated again if it is
+ * above the horizon; those of the other satellites are kept.
+ */
+void gtk_polar_view_reload_sat(GtkWidget *widget, sat_t *sat)
 {
     GtkPolarView *polv = GTK_POLAR_VIEW(widget);
-    gint *catpoint = NULL;
-    sat_obj_t *obj = NULL;
+    sat_obj_t *obj;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
+    /* next event may have changed */
+    polv->naos = 0.0;
+    polv->ncat = 0;
 
-    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, catpoint));
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &sat->tle.catnr));
     if (obj == NULL)
+        return;
+
+    if (obj->pass)
+    {
+        free_pass(obj->pass);
+        obj->pass = NULL;
+    }
+
+    /* otherwise the pass is calculated when the satellite rises */
+    if (obj->visible)
+        obj->pass = get_current_pass(sat, polv->qth, polv->tstamp);
+
+    if (obj->showtrack)
+    {
+        if (obj->pass)
+            gtk_polar_view_create_track(polv, obj, sat);
+        else
+            gtk_polar_view_delete_track(polv, obj, sat);
+    }
+}
+
+void gtk_polar_view_select_sat(GtkWidget *widget, gint catnum)
+{
+    GtkPolarView *polv = GTK_POLAR_VIEW(widget);
+    sat_obj_t *obj = NULL;
+
+    obj = SAT_OBJ(g_hash_table_lookup(polv->obj, &catnum));
+    if (obj == NULL || !obj->visible)
     {
         sat_log_log(SAT_LOG_LEVEL_DEBUG,
                     _("%s Requested satellite (%d) is not within range"),
@@ -1333,9 +1374,7 @@ void gtk_polar_view_select_sat(GtkWidget *widget, gint catnum)
     }
 
     /* clear previous selection, if any */
-    g_hash_table_foreach(polv->obj, clear_selection, catpoint);
-
-    g_free(catpoint);
+    g_hash_table_foreach(polv->obj, clear_selection, &catnum);
 
     gtk_widget_queue_draw(polv->canvas);
 }
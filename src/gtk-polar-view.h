@@ -33,8 +33,15 @@ typedef struct {
     gchar text[6]; /* Time string */
 } track_tick_t;
 
-/* Satellite object on graph. */
+/*
+ * Satellite object on graph.
+ *
+ * Objects are created the first time a satellite rises above the horizon and
+ * are kept for the lifetime of the view; the visible flag is toggled as the
+ * satellite crosses the horizon.
+ */
 typedef struct {
+    gboolean visible;                    /* Satellite is above the horizon. */
     gboolean selected;                   /* Satellite is selected. */
     gboolean showtrack;                  /* Show ground track. */
     gboolean istarget;                   /* Is this object the target. */
@@ -42,8 +49,9 @@ typedef struct {
     gfloat x;                            /* X position of marker */
     gfloat y;                            /* Y position of marker */
     gchar *nickname;                     /* Satellite nickname for label */
-    gchar *tooltip;                      /* Tooltip text */
-    GSList *track_points;                /* pairs of gdoubles: x,y */
+    gdouble *track_points;               /* pairs of gdoubles: x,y */
+    guint track_num;                     /* Number of points in the track */
+    guint track_size;                    /* Allocated number of points */
     track_tick_t trtick[TRACK_TICK_NUM]; /* Time ticks on sky track */
     gint catnum;                         /* Catalogue number */
 } sat_obj_t;
@@ -97,8 +105,8 @@ struct _GtkPolarView {
     GHashTable *sats;  /* Satellites. */
     qth_t *qth;        /* Pointer to current location. */
 
-    GHashTable
-        *obj; /* Satellite objects (sat_obj_t) for each visible satellite */
+    GHashTable *obj;    /* Satellite objects (sat_obj_t) keyed by catnum */
+    GPtrArray *visible; /* Objects above the horizon in the current cycle */
 
     guint cx;   /* center X */
     guint cy;   /* center Y */
@@ -132,6 +140,7 @@ GtkWidget *gtk_polar_view_new(GKeyFile *cfgdata, GHashTable *sats, qth_t *qth);
 void gtk_polar_view_update(GtkWidget *widget);
 void gtk_polar_view_reconf(GtkWidget *widget, GKeyFile *cfgdat);
 void gtk_polar_view_reload_sats(GtkWidget *polv, GHashTable *sats);
+void gtk_polar_view_reload_sat(GtkWidget *widget, sat_t *sat);
 void gtk_polar_view_select_sat(GtkWidget *widget, gint catnum);
 void gtk_polar_view_create_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat);
 void gtk_polar_view_delete_track(GtkPolarView *pv, sat_obj_t *obj, sat_t *sat);
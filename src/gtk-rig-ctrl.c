@@ -44,20 +44,12 @@
 #include <gtk/gtk.h>
 #include <math.h>
 
-/* NETWORK */
-#ifndef WIN32
-#include <arpa/inet.h>  /* htons() */
-#include <netdb.h>      /* gethostbyname() */
-#include <netinet/in.h> /* struct sockaddr_in */
-#include <sys/socket.h> /* socket(), connect(), send() */
-#else
-#include <winsock2.h>
-#endif
-
 #include "compat.h"
+#include "doppler-sched.h"
 #include "gpredict-utils.h"
 #include "gtk-freq-knob.h"
 #include "gtk-rig-ctrl.h"
+#include "hamlib-client.h"
 #include "predict-tools.h"
 #include "radio-conf.h"
 #include "sat-cfg.h"
@@ -66,7 +58,11 @@
 
 #define AZEL_FMTSTR "%7.2f\302\260"
 #define MAX_ERROR_COUNT 5
-#define WR_DEL 5000 /* delay in usec to wait between write and read commands */
+#define CONNECT_TIMEOUT 2000 /* msec to wait for connection to rigctld */
+#define MIN_TIMEOUT 500      /* min msec to wait for rigctld to respond */
+#define RR_DT 1.0   /* time step in sec used to estimate range rate derivative */
+#define LATENCY_AVG 8.0 /* weight of old latency in running average */
+#define MIN_REFRESH 100 /* min msec between UI refreshes while engaged */
 
 /* radio control functions */
 static void exec_rx_cycle(GtkRigCtrl *ctrl);
@@ -77,8 +73,15 @@ static void exec_toggle_tx_cycle(GtkRigCtrl *ctrl);
 static void exec_duplex_cycle(GtkRigCtrl *ctrl);
 static void exec_duplex_tx_cycle(GtkRigCtrl *ctrl);
 static void exec_dual_rig_cycle(GtkRigCtrl *ctrl);
+static void predict_doppler(GtkRigCtrl *ctrl);
+static gdouble round_to_step(radio_conf_t *conf, gdouble freq);
+static gboolean freq_needs_update(GtkRigCtrl *ctrl, radio_conf_t *conf,
+                                  gdouble freq, gboolean uplink);
+static void update_latency(GtkRigCtrl *ctrl, gint sock, gdouble sample);
 static gboolean check_aos_los(GtkRigCtrl *ctrl);
-static gboolean set_freq_simplex(GtkRigCtrl *ctrl, gint sock, gdouble freq);
+static gboolean set_freq_simplex(GtkRigCtrl *ctrl, gint sock, gdouble *freq);
+static void get_freq_dual(GtkRigCtrl *ctrl, gdouble *rxfreq, gdouble *txfreq);
+static void set_freq_dual(GtkRigCtrl *ctrl, gboolean rx, gboolean tx);
 static gboolean get_freq_simplex(GtkRigCtrl *ctrl, gint sock, gdouble *freq);
 static gboolean set_freq_toggle(GtkRigCtrl *ctrl, gint sock, gdouble freq);
 static gboolean set_toggle(GtkRigCtrl *ctrl, gint sock);
@@ -89,11 +92,13 @@ static gboolean set_ptt(GtkRigCtrl *ctrl, gint sock, gboolean ptt);
 
 /*  add thread for hamlib communication */
 gpointer rigctl_run(gpointer data);
-static void rigctrl_open(GtkRigCtrl *data);
+static gboolean rigctrl_open(GtkRigCtrl *data);
 static void rigctrl_close(GtkRigCtrl *data);
 static void setconfig(gpointer data);
 static void remove_timer(GtkRigCtrl *data);
 static void start_timer(GtkRigCtrl *data);
+static void start_engine(GtkRigCtrl *ctrl);
+static void stop_engine(GtkRigCtrl *ctrl);
 
 static GtkBoxClass *parent_class = NULL;
 
@@ -101,18 +106,10 @@ static void gtk_rig_ctrl_destroy(GtkWidget *widget)
 {
     GtkRigCtrl *ctrl = GTK_RIG_CTRL(widget);
 
-    if (ctrl->rigctl_thread != NULL)
-    {
-        g_mutex_lock(&ctrl->widgetsync);
-
-        ctrl->engaged = 0;
-        setconfig(ctrl);
+    stop_engine(ctrl);
 
-        /* synchronization */
-        g_cond_wait(&ctrl->widgetready, &ctrl->widgetsync);
-        g_mutex_unlock(&ctrl->widgetsync);
-        ctrl->rigctl_thread = NULL;
-    }
+    doppler_sched_unref(ctrl->sched);
+    ctrl->sched = NULL;
 
     if (ctrl->conf != NULL)
     {
@@ -165,18 +162,36 @@ static void gtk_rig_ctrl_init(GtkRigCtrl *ctrl, gpointer g_class)
     ctrl->trsplock = FALSE;
     ctrl->tracking = FALSE;
     ctrl->prev_ele = 0.0;
-    ctrl->sock = 0;
-    ctrl->sock2 = 0;
-    g_mutex_init(&(ctrl->busy));
+    ctrl->sock = -1;
+    ctrl->sock2 = -1;
     ctrl->engaged = FALSE;
     ctrl->delay = 1000;
     ctrl->timerid = 0;
     ctrl->errcnt = 0;
+    ctrl->satseq = 0;
+    ctrl->rxsync = 0;
+    ctrl->txsync = 0;
+    ctrl->pttreq = 0;
+    ctrl->cmdslot = NULL;
+    ctrl->stateslot = NULL;
+    ctrl->failed = FALSE;
+    ctrl->resync = FALSE;
+    ctrl->sched = NULL;
+    ctrl->DopExport = NULL;
     ctrl->lastrxptt = FALSE;
     ctrl->lasttxptt = TRUE;
     ctrl->lastrxf = 0.0;
     ctrl->lasttxf = 0.0;
     ctrl->last_toggle_tx = -1;
+    ctrl->rr = 0.0;
+    ctrl->rrdot = 0.0;
+    ctrl->trate = 1.0;
+    ctrl->rrtime = 0;
+    ctrl->tprev = 0.0;
+    ctrl->ddrate = 0.0;
+    ctrl->durate = 0.0;
+    ctrl->latency = 0.0;
+    ctrl->latency2 = 0.0;
 }
 
 GType gtk_rig_ctrl_get_type()
@@ -252,6 +267,294 @@ static void update_count_down(GtkRigCtrl *ctrl, gdouble t)
     g_free(aoslos);
 }
 
+/*
+ * Store the range rate of the target together with its derivative and the
+ * time of the update, so that the rig thread can predict the Doppler shift
+ * at the time its commands take effect.
+ *
+ * The derivative is taken from the Doppler schedule if it covers t.
+ * Otherwise it is estimated by propagating a copy of the target RR_DT
+ * seconds ahead.
+ */
+static void update_range_rate(GtkRigCtrl *ctrl, gdouble t)
+{
+    sat_t sat;
+    gdouble rr;
+    gint64 now = g_get_monotonic_time();
+
+    if (ctrl->sched == NULL ||
+        !doppler_sched_lookup(ctrl->sched, t, &rr, &ctrl->rrdot))
+    {
+        memcpy(&sat, ctrl->target, sizeof(sat_t));
+        predict_calc(&sat, ctrl->qth, t + RR_DT / 86400.0);
+        ctrl->rrdot = (sat.range_rate - ctrl->target->range_rate) / RR_DT;
+    }
+
+    /* the module time may run faster, slower or backwards in the time
+       controller; track how it relates to real time */
+    if (ctrl->rrtime > 0 && now > ctrl->rrtime)
+        ctrl->trate = (t - ctrl->tprev) * 86400.0 * 1.0e6 /
+                      (gdouble)(now - ctrl->rrtime);
+
+    ctrl->rr = ctrl->target->range_rate;
+    ctrl->rrtime = now;
+    ctrl->tprev = t;
+}
+
+/*
+ * Compute the Doppler schedule for the current pass of the target.
+ *
+ * This is done whenever a new pass is predicted, i.e. well before AOS, so
+ * neither the module updates nor the rig thread have to propagate the orbit
+ * to predict the Doppler shift during the pass.
+ */
+static void update_doppler_sched(GtkRigCtrl *ctrl)
+{
+    doppler_sched_unref(ctrl->sched);
+    ctrl->sched = NULL;
+
+    if (ctrl->target == NULL || ctrl->pass == NULL)
+        return;
+
+    ctrl->sched = doppler_sched_new(ctrl->target, ctrl->qth, ctrl->pass->aos,
+                                    ctrl->pass->los, DOPPLER_SCHED_STEP);
+
+    if (ctrl->DopExport != NULL)
+        gtk_widget_set_sensitive(ctrl->DopExport, ctrl->sched != NULL);
+}
+
+/*
+ * Get the Doppler schedule for the current pass of the target, e.g. for
+ * plotting or exporting it with doppler_sched_save().
+ *
+ * Returns a new reference or NULL if there is no upcoming pass. Release it
+ * with doppler_sched_unref().
+ */
+doppler_sched_t *gtk_rig_ctrl_get_doppler_sched(GtkRigCtrl *ctrl)
+{
+    return doppler_sched_ref(ctrl->sched);
+}
+
+/*
+ * Put a snapshot into a single-slot mailbox.
+ *
+ * A snapshot that has not been claimed yet is replaced and freed with
+ * free_func; the reader only ever sees the most recent one and neither side
+ * has to wait for the other. There must be only one writer and one reader
+ * per slot.
+ */
+static void snapshot_put(gpointer *slot, gpointer snap,
+                         GDestroyNotify free_func)
+{
+    gpointer old;
+
+    do
+    {
+        old = g_atomic_pointer_get(slot);
+    } while (!g_atomic_pointer_compare_and_exchange(slot, old, snap));
+
+    if (old != NULL)
+        free_func(old);
+}
+
+/* Claim the snapshot in a mailbox; returns NULL if there is none. */
+static gpointer snapshot_take(gpointer *slot)
+{
+    gpointer snap;
+
+    do
+    {
+        snap = g_atomic_pointer_get(slot);
+    } while (snap != NULL &&
+             !g_atomic_pointer_compare_and_exchange(slot, snap, NULL));
+
+    return snap;
+}
+
+static void rig_cmd_free(gpointer data)
+{
+    rig_cmd_t *cmd = data;
+
+    doppler_sched_unref(cmd->sched);
+    g_free(cmd);
+}
+
+/*
+ * Publish the current settings for the rig thread.
+ *
+ * Must be called whenever the user changes something the rig thread
+ * depends on; see rig_cmd_t.
+ */
+static void publish_rig_cmd(GtkRigCtrl *ctrl)
+{
+    rig_cmd_t *cmd;
+
+    if (!ctrl->engaged)
+        return;
+
+    cmd = g_new0(rig_cmd_t, 1);
+    cmd->satdown = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
+    cmd->satup = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
+    cmd->satseq = ctrl->satseq;
+    cmd->rxsync = ctrl->rxsync;
+    cmd->txsync = ctrl->txsync;
+    cmd->pttreq = ctrl->pttreq;
+    cmd->tracking = ctrl->tracking;
+    cmd->trsplock = ctrl->trsplock;
+    cmd->delay = ctrl->delay;
+
+    if (ctrl->trsp != NULL)
+    {
+        /* the transponder list may be freed while the rig thread runs */
+        cmd->havetrsp = TRUE;
+        cmd->trsp = *ctrl->trsp;
+        cmd->trsp.name = NULL;
+        cmd->trsp.mode = NULL;
+    }
+
+    if (ctrl->target != NULL)
+    {
+        cmd->catnum = ctrl->target->tle.catnr;
+        cmd->el = ctrl->target->el;
+        cmd->trate = 1.0;
+        if (ctrl->rrtime > 0)
+        {
+            cmd->rr = ctrl->rr;
+            cmd->rrdot = ctrl->rrdot;
+            cmd->trate = ctrl->trate;
+            cmd->rrtime = ctrl->rrtime;
+            cmd->tmod = ctrl->tprev;
+            cmd->sched = doppler_sched_ref(ctrl->sched);
+        }
+        else
+        {
+            /* no update since the target was selected */
+            cmd->rr = ctrl->target->range_rate;
+        }
+    }
+
+    snapshot_put(&ctrl->cmdslot, cmd, rig_cmd_free);
+}
+
+/* Show the I/O statistics of the last rig state in the settings */
+static void update_io_summary(GtkRigCtrl *ctrl)
+{
+    gchar *text, *text2, *buff;
+
+    text = io_stats_summary(&ctrl->laststate.io[0]);
+    if (ctrl->conf2 != NULL)
+    {
+        text2 = io_stats_summary(&ctrl->laststate.io[1]);
+        buff = g_strdup_printf("%s / %s", text, text2);
+        g_free(text);
+        g_free(text2);
+        text = buff;
+    }
+    if (ctrl->laststate.missed > 0)
+    {
+        buff = g_strdup_printf(_("%s, %u missed cycles"), text,
+                               ctrl->laststate.missed);
+        g_free(text);
+        text = buff;
+    }
+
+    gtk_label_set_text(GTK_LABEL(ctrl->IoStats), text);
+    g_free(text);
+}
+
+/* Show the I/O statistics of the radios */
+static void io_stats_cb(GtkButton *button, gpointer data)
+{
+    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+    rig_state_t *state = &ctrl->laststate;
+    io_report_t report = {0};
+
+    if (ctrl->conf != NULL)
+        io_report_add_io(&report, ctrl->conf->name, &state->io[0]);
+    if (ctrl->conf2 != NULL)
+        io_report_add_io(&report, ctrl->conf2->name, &state->io[1]);
+    io_report_add_io(&report, _("Control cycle"), &state->cycles);
+    io_report_add_error(&report, _("Downlink frequency error (Hz)"),
+                        &state->freqerr[0]);
+    io_report_add_error(&report, _("Uplink frequency error (Hz)"),
+                        &state->freqerr[1]);
+
+    io_report_dialog(GTK_WIDGET(button), _("Radio I/O Statistics"), &report);
+}
+
+/* Save the Doppler schedule of the current pass to a CSV file */
+static void doppler_export_cb(GtkButton *button, gpointer data)
+{
+    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+    doppler_sched_t *sched;
+    GtkWidget *dialog;
+    GtkFileFilter *filter;
+    gchar *filename;
+
+    sched = gtk_rig_ctrl_get_doppler_sched(ctrl);
+    if (sched == NULL)
+        return;
+
+    dialog = gtk_file_chooser_dialog_new(
+        _("Export Doppler Schedule"),
+        GTK_WINDOW(gtk_widget_get_toplevel(GTK_WIDGET(button))),
+        GTK_FILE_CHOOSER_ACTION_SAVE, "_Cancel", GTK_RESPONSE_CANCEL, "_Save",
+        GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog),
+                                                   TRUE);
+    filename = g_strdup_printf("doppler-%d.csv", sched->catnum);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), filename);
+    g_free(filename);
+
+    filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, _("CSV files"));
+    gtk_file_filter_add_pattern(filter, "*.csv");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+    {
+        filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        doppler_sched_save(sched, ctrl->trsp, filename);
+        g_free(filename);
+    }
+
+    gtk_widget_destroy(dialog);
+    doppler_sched_unref(sched);
+}
+
+/* Show the latest state published by the rig thread, if any */
+static void apply_rig_state(GtkRigCtrl *ctrl)
+{
+    rig_state_t *state;
+    gboolean failed;
+
+    state = snapshot_take(&ctrl->stateslot);
+    if (state == NULL)
+        return;
+
+    gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown), state->rigdown);
+    gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp), state->rigup);
+
+    /* the satellite frequencies may have been changed with the radio dial;
+       keep what the user has entered since the rig thread last saw it */
+    if (state->satseq == ctrl->satseq)
+    {
+        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown),
+                                state->satdown);
+        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), state->satup);
+    }
+
+    failed = state->failed;
+    ctrl->laststate = *state;
+    g_free(state);
+
+    update_io_summary(ctrl);
+
+    /* disengage device */
+    if (failed)
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ctrl->LockBut), FALSE);
+}
+
 /*
  * Update rig control state.
  *
@@ -261,7 +564,7 @@ static void update_count_down(GtkRigCtrl *ctrl, gdouble t)
  */
 void gtk_rig_ctrl_update(GtkRigCtrl *ctrl, gdouble t)
 {
-    gdouble satfreq;
+    gdouble satfreq, doppler;
     gchar *buff;
 
     g_mutex_lock(&ctrl->rig_ctrl_updatelock);
@@ -302,18 +605,21 @@ void gtk_rig_ctrl_update(GtkRigCtrl *ctrl, gdouble t)
 
         /* Doppler shift down */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-        ctrl->dd = -satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
-        buff = g_strdup_printf("%.0f Hz", ctrl->dd);
+        doppler = -satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
+        buff = g_strdup_printf("%.0f Hz", doppler);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopDown), buff);
         g_free(buff);
 
         /* Doppler shift up */
         satfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-        ctrl->du = satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
-        buff = g_strdup_printf("%.0f Hz", ctrl->du);
+        doppler = satfreq * (ctrl->target->range_rate / 299792.4580); // Hz
+        buff = g_strdup_printf("%.0f Hz", doppler);
         gtk_label_set_text(GTK_LABEL(ctrl->SatDopUp), buff);
         g_free(buff);
 
+        update_range_rate(ctrl, t);
+        publish_rig_cmd(ctrl);
+
         /* update next pass if necessary */
         if (ctrl->pass != NULL)
         {
@@ -321,42 +627,82 @@ void gtk_rig_ctrl_update(GtkRigCtrl *ctrl, gdouble t)
             {
                 free_pass(ctrl->pass);
                 ctrl->pass = get_next_pass(ctrl->target, ctrl->qth, 3.0);
+                update_doppler_sched(ctrl);
             }
         }
         else
         {
             /* we don't have any current pass; store the current one */
             ctrl->pass = get_next_pass(ctrl->target, ctrl->qth, 3.0);
+            update_doppler_sched(ctrl);
         }
     }
 
     g_mutex_unlock(&ctrl->rig_ctrl_updatelock);
 }
 
+/*
+ * Calculate the uplink frequency corresponding to a downlink frequency
+ * according to the lower limit of the downlink passband.
+ *
+ * Returns FALSE if the transponder config is not usable.
+ */
+static gboolean trsp_down_to_up(const trsp_t *trsp, gdouble down, gdouble *up)
+{
+    gdouble delta;
+
+    /* ensure that we have a usable transponder config */
+    if ((trsp->downlow <= 0) || (trsp->uplow <= 0))
+        return FALSE;
+
+    delta = down - trsp->downlow;
+
+    if (trsp->invert)
+        *up = trsp->uphigh - delta;
+    else
+        *up = trsp->uplow + delta;
+
+    return TRUE;
+}
+
+/*
+ * Calculate the downlink frequency corresponding to an uplink frequency
+ * according to the offset from the lower limit on the uplink passband.
+ *
+ * Returns FALSE if the transponder config is not usable.
+ */
+static gboolean trsp_up_to_down(const trsp_t *trsp, gdouble up, gdouble *down)
+{
+    gdouble delta;
+
+    /* ensure that we have a usable transponder config */
+    if ((trsp->downlow <= 0) || (trsp->uplow <= 0))
+        return FALSE;
+
+    delta = up - trsp->uplow;
+
+    if (trsp->invert)
+        *down = trsp->downhigh - delta;
+    else
+        *down = trsp->downlow + delta;
+
+    return TRUE;
+}
+
 /*
  * Track the downlink frequency by setting the uplink frequency
  * according to the lower limit of the downlink passband.
  */
 static void track_downlink(GtkRigCtrl *ctrl)
 {
-    gdouble delta, down, up;
+    gdouble down, up;
 
     if (ctrl->trsp == NULL)
         return;
 
-    /* ensure that we have a usable transponder config */
-    if ((ctrl->trsp->downlow > 0) && (ctrl->trsp->uplow > 0))
-    {
-        down = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-        delta = down - ctrl->trsp->downlow;
-
-        if (ctrl->trsp->invert)
-            up = ctrl->trsp->uphigh - delta;
-        else
-            up = ctrl->trsp->uplow + delta;
-
+    down = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
+    if (trsp_down_to_up(ctrl->trsp, down, &up))
         gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), up);
-    }
 }
 
 /*
@@ -365,24 +711,28 @@ static void track_downlink(GtkRigCtrl *ctrl)
  */
 static void track_uplink(GtkRigCtrl *ctrl)
 {
-    gdouble delta, down, up;
+    gdouble down, up;
 
     if (ctrl->trsp == NULL)
         return;
 
-    /* ensure that we have a usable transponder config */
-    if ((ctrl->trsp->downlow > 0) && (ctrl->trsp->uplow > 0))
-    {
-        up = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-        delta = up - ctrl->trsp->uplow;
+    up = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
+    if (trsp_up_to_down(ctrl->trsp, up, &down))
+        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), down);
+}
 
-        if (ctrl->trsp->invert)
-            down = ctrl->trsp->downhigh - delta;
-        else
-            down = ctrl->trsp->downlow + delta;
+/* Rig thread version of track_downlink() */
+static void rig_track_downlink(GtkRigCtrl *ctrl)
+{
+    if (ctrl->cmd.havetrsp)
+        trsp_down_to_up(&ctrl->cmd.trsp, ctrl->satdown, &ctrl->satup);
+}
 
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), down);
-    }
+/* Rig thread version of track_uplink() */
+static void rig_track_uplink(GtkRigCtrl *ctrl)
+{
+    if (ctrl->cmd.havetrsp)
+        trsp_up_to_down(&ctrl->cmd.trsp, ctrl->satup, &ctrl->satdown);
 }
 
 void gtk_rig_ctrl_select_sat(GtkRigCtrl *ctrl, gint catnum)
@@ -415,6 +765,9 @@ static void downlink_changed_cb(GtkFreqKnob *knob, gpointer data)
 
     if (ctrl->trsplock)
         track_downlink(ctrl);
+
+    ctrl->satseq++;
+    publish_rig_cmd(ctrl);
 }
 
 static void uplink_changed_cb(GtkFreqKnob *knob, gpointer data)
@@ -425,6 +778,9 @@ static void uplink_changed_cb(GtkFreqKnob *knob, gpointer data)
 
     if (ctrl->trsplock)
         track_uplink(ctrl);
+
+    ctrl->satseq++;
+    publish_rig_cmd(ctrl);
 }
 
 /*
@@ -676,12 +1032,14 @@ static void sat_selected_cb(GtkComboBox *satsel, gpointer data)
                 break;
             }
         }
-        ctrl->prev_ele = ctrl->target->el;
+        /* range rate belongs to the previous target until next update */
+        ctrl->rrtime = 0;
 
         /* update next pass */
         if (ctrl->pass != NULL)
             free_pass(ctrl->pass);
         ctrl->pass = get_next_pass(ctrl->target, ctrl->qth, 3.0);
+        update_doppler_sched(ctrl);
 
         /* read transponders for new target */
         load_trsp_list(ctrl);
@@ -694,7 +1052,10 @@ static void sat_selected_cb(GtkComboBox *satsel, gpointer data)
             free_pass(ctrl->pass);
             ctrl->pass = NULL;
         }
+        update_doppler_sched(ctrl);
     }
+
+    publish_rig_cmd(ctrl);
 }
 
 /*
@@ -729,7 +1090,7 @@ static void trsp_tune_cb(GtkButton *button, gpointer data)
         gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), freq);
 
         /* invalidate RIG<->GPREDICT sync */
-        ctrl->lastrxf = 0.0;
+        ctrl->rxsync++;
     }
 
     /* tune uplink */
@@ -740,8 +1101,11 @@ static void trsp_tune_cb(GtkButton *button, gpointer data)
         gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), freq);
 
         /* invalidate RIG<->GPREDICT sync */
-        ctrl->lasttxf = 0.0;
+        ctrl->txsync++;
     }
+
+    ctrl->satseq++;
+    publish_rig_cmd(ctrl);
 }
 
 /*
@@ -760,6 +1124,7 @@ static void trsp_selected_cb(GtkComboBox *box, gpointer data)
     {
         /* clear transponder data */
         ctrl->trsp = NULL;
+        publish_rig_cmd(ctrl);
     }
     else if (i < n)
     {
@@ -795,7 +1160,12 @@ static void trsp_lock_cb(GtkToggleButton *button, gpointer data)
 
     /* set uplink according to downlink */
     if (ctrl->trsplock)
+    {
         track_downlink(ctrl);
+        ctrl->satseq++;
+    }
+
+    publish_rig_cmd(ctrl);
 }
 
 static void track_toggle_cb(GtkToggleButton *button, gpointer data)
@@ -805,8 +1175,9 @@ static void track_toggle_cb(GtkToggleButton *button, gpointer data)
     ctrl->tracking = gtk_toggle_button_get_active(button);
 
     /* invalidate sync with radio */
-    ctrl->lastrxf = 0.0;
-    ctrl->lasttxf = 0.0;
+    ctrl->rxsync++;
+    ctrl->txsync++;
+    publish_rig_cmd(ctrl);
 }
 
 /* Called when the user changes the value of the cycle delay */
@@ -819,7 +1190,10 @@ static void delay_changed_cb(GtkSpinButton *spin, gpointer data)
         ctrl->conf->cycle = ctrl->delay;
 
     if (ctrl->engaged)
+    {
+        publish_rig_cmd(ctrl);
         start_timer(ctrl);
+    }
 }
 
 static void primary_rig_selected_cb(GtkComboBox *box, gpointer data)
@@ -994,25 +1368,17 @@ static void rig_engaged_cb(GtkToggleButton *button, gpointer data)
         /* close socket */
         gtk_widget_set_sensitive(ctrl->DevSel, TRUE);
         gtk_widget_set_sensitive(ctrl->DevSel2, TRUE);
-        ctrl->engaged = FALSE;
 
         /*  stop worker thread and wait for it to close sockets */
-        g_mutex_lock(&ctrl->widgetsync);
-        setconfig(ctrl);
-        g_cond_wait(&ctrl->widgetready, &ctrl->widgetsync);
-        g_mutex_unlock(&ctrl->widgetsync);
-        ctrl->rigctl_thread = NULL;
+        stop_engine(ctrl);
     }
     else
     {
         gtk_widget_set_sensitive(ctrl->DevSel, FALSE);
         gtk_widget_set_sensitive(ctrl->DevSel2, FALSE);
-        ctrl->engaged = TRUE;
 
         /*  start worker thread... */
-        ctrl->rigctlq = g_async_queue_new();
-        ctrl->rigctl_thread = g_thread_new("rigctl_run", rigctl_run, ctrl);
-        setconfig(ctrl);
+        start_engine(ctrl);
     }
 }
 
@@ -1143,10 +1509,21 @@ static GtkWidget *create_target_widgets(GtkRigCtrl *ctrl)
                                   "frequency."));
     g_signal_connect(trsplock, "toggled", G_CALLBACK(trsp_lock_cb), ctrl);
 
+    ctrl->DopExport = gtk_button_new_with_label(_("E"));
+    gtk_widget_set_tooltip_text(ctrl->DopExport,
+                                _("Export the Doppler shift of the next pass "
+                                  "as a CSV file, sampled every second. The "
+                                  "shift is given for the center of the "
+                                  "selected transponder."));
+    gtk_widget_set_sensitive(ctrl->DopExport, ctrl->sched != NULL);
+    g_signal_connect(ctrl->DopExport, "clicked",
+                     G_CALLBACK(doppler_export_cb), ctrl);
+
     /* box for packing buttons */
     hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5);
     gtk_box_pack_start(GTK_BOX(hbox), tune, TRUE, TRUE, 0);
     gtk_box_pack_start(GTK_BOX(hbox), trsplock, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), ctrl->DopExport, TRUE, TRUE, 0);
     gtk_grid_attach(GTK_GRID(table), hbox, 3, 2, 1, 1);
 
     /* Azimuth */
@@ -1253,7 +1630,7 @@ static gint rig_name_compare(const gchar *a, const gchar *b)
 
 static GtkWidget *create_conf_widgets(GtkRigCtrl *ctrl)
 {
-    GtkWidget *frame, *table, *label;
+    GtkWidget *frame, *table, *label, *button;
     GDir *dir = NULL;     /* directory handle */
     GError *error = NULL; /* error flag and info */
     gchar *dirname;       /* directory name */
@@ -1402,6 +1779,25 @@ static GtkWidget *create_conf_widgets(GtkRigCtrl *ctrl)
     g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 2, 3, 1, 1);
 
+    /* I/O statistics */
+    label = gtk_label_new(_("I/O:"));
+    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
+
+    ctrl->IoStats = gtk_label_new(_("No commands"));
+    g_object_set(ctrl->IoStats, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_widget_set_tooltip_text(ctrl->IoStats,
+                                _("Mean round-trip time, rate and number of "
+                                  "failed commands since the radio was "
+                                  "engaged"));
+    gtk_grid_attach(GTK_GRID(table), ctrl->IoStats, 1, 4, 1, 1);
+
+    button = gtk_button_new_with_label(_("Stats"));
+    gtk_widget_set_tooltip_text(button,
+                                _("Show the I/O statistics of the radio"));
+    g_signal_connect(button, "clicked", G_CALLBACK(io_stats_cb), ctrl);
+    gtk_grid_attach(GTK_GRID(table), button, 2, 4, 1, 1);
+
     frame = gtk_frame_new(_("Settings"));
     gtk_container_add(GTK_CONTAINER(frame), table);
 
@@ -1446,88 +1842,193 @@ static void store_sats(gpointer key, gpointer value, gpointer user_data)
         g_slist_insert_sorted(ctrl->sats, sat, (GCompareFunc)sat_name_compare);
 }
 
-static gboolean _send_rigctld_command(GtkRigCtrl *ctrl, gint sock, gchar *buff,
-                                      gchar *buffout, gint sizeout)
+/* Time rigctld has to respond to a request; at least one cycle */
+static gint rigctld_timeout(GtkRigCtrl *ctrl)
 {
-    gint written;
-    gint size;
+    return MAX((gint)ctrl->cmd.delay, MIN_TIMEOUT);
+}
 
-    size = strlen(buff);
+/* Index of the radio on sock, 0 for radio 1 and 1 for radio 2 */
+static guint rig_index(GtkRigCtrl *ctrl, gint sock)
+{
+    return (ctrl->conf2 != NULL && sock == ctrl->sock2) ? 1 : 0;
+}
 
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s:%s: sending %d bytes to rigctld as \"%s\""), __FILE__,
-                __func__, size, buff);
-    /* send command */
-    written = send(sock, buff, strlen(buff), 0);
-    if (written != size)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: SIZE ERROR %d / %d"), __func__,
-                    written, size);
-    }
-    if (written == -1)
+/* I/O statistics of the radio on sock */
+static io_stats_t *rig_io_stats(GtkRigCtrl *ctrl, gint sock)
+{
+    return &ctrl->io[rig_index(ctrl, sock)];
+}
+
+/*
+ * Account for the outcome of a set-frequency command to the radio on sock.
+ *
+ * The frequency of a failed command is not taken over, so the next cycle
+ * sends it again. That command is counted as a retry.
+ */
+static void account_set_freq(GtkRigCtrl *ctrl, gint sock, gboolean ok)
+{
+    guint i = rig_index(ctrl, sock);
+
+    if (ctrl->setfailed[i])
+        io_stats_retry(&ctrl->io[i]);
+    ctrl->setfailed[i] = !ok;
+}
+
+/* Add the outcome of a request to the I/O statistics of its radio */
+static void update_io_stats(GtkRigCtrl *ctrl, hamlib_req_t *req)
+{
+    io_stats_t *stats = rig_io_stats(ctrl, req->sock);
+    gboolean ok;
+    guint j;
+
+    /* the commands are pipelined, so each one takes from the start */
+    for (j = 0; j < req->nresp; j++)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rigctld port closed"),
-                    __func__);
-        return FALSE;
+        ok = (strncmp(req->resp[j], "RPRT", 4) != 0 ||
+              strncmp(req->resp[j], "RPRT 0", 6) == 0);
+        io_stats_response(stats, req->rtime[j] - req->start, ok);
     }
-    /* try to read answer */
-    size = recv(sock, buffout, sizeout - 1, 0);
-    if (size == -1)
+
+    if (req->nresp < req->ncmd)
+        io_stats_timeout(stats, req->ncmd - req->nresp);
+}
+
+/* Execute requests to one or both radios and log the outcome */
+static gboolean _run_rigctld_requests(GtkRigCtrl *ctrl, hamlib_req_t *reqs,
+                                      guint n)
+{
+    gboolean retval;
+    gint64 start;
+    guint i;
+
+    /* replies can not be matched to commands until rigctrl_resync() */
+    if (ctrl->resync)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rigctld port closed"),
-                    __func__);
+        for (i = 0; i < n; i++)
+            reqs[i].status = HAMLIB_REQ_FAILED;
         return FALSE;
     }
 
-    buffout[size] = '\0';
-    if (size == 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%s: Got 0 bytes from rigctld"),
-                    __FILE__, __func__);
-    }
-    else
+    for (i = 0; i < n; i++)
+        io_stats_request(rig_io_stats(ctrl, reqs[i].sock), reqs[i].ncmd);
+
+    start = g_get_monotonic_time();
+    retval = hamlib_req_run(reqs, n);
+    ctrl->iotime += g_get_monotonic_time() - start;
+
+    for (i = 0; i < n; i++)
     {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s:%s: Read %d bytes from rigctld"),
-                    __FILE__, __func__, size);
+        update_io_stats(ctrl, &reqs[i]);
+
+        switch (reqs[i].status)
+        {
+        case HAMLIB_REQ_DONE:
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s:%s: Got %u responses from rigctld in %d usec"),
+                        __FILE__, __func__, reqs[i].nresp,
+                        (gint)(reqs[i].rtime[reqs[i].nresp - 1] -
+                               reqs[i].start));
+            break;
+
+        case HAMLIB_REQ_TIMEOUT:
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: rigctld did not respond within %d msec"),
+                        __func__, rigctld_timeout(ctrl));
+            ctrl->resync = TRUE;
+            break;
+
+        default:
+            sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rigctld port closed"),
+                        __func__);
+            ctrl->resync = TRUE;
+            break;
+        }
     }
     ctrl->wrops++;
 
-    return TRUE;
+    return retval;
 }
 
-static gboolean send_rigctld_command(GtkRigCtrl *ctrl, gint sock, gchar *buff,
-                                     gchar *buffout, gint sizeout)
+static gboolean run_rigctld_requests(GtkRigCtrl *ctrl, hamlib_req_t *reqs,
+                                     guint n)
 {
     gboolean retval;
 
     /* Enter critical section! */
     g_mutex_lock(&ctrl->writelock);
 
-    retval = _send_rigctld_command(ctrl, sock, buff, buffout, sizeout);
+    retval = _run_rigctld_requests(ctrl, reqs, n);
 
     /* Leave critical section! */
     g_mutex_unlock(&ctrl->writelock);
     return (retval);
 }
 
-static inline gboolean check_set_response(gchar *buffback, gboolean retcode,
-                                          const gchar *function)
+static gboolean _send_rigctld_command(GtkRigCtrl *ctrl, gint sock, gchar *buff,
+                                      gchar *buffout, gint sizeout)
 {
-    if (retcode == TRUE)
-    {
-        if (strncmp(buffback, "RPRT 0", 6) != 0)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: %s rigctld returned error (%s)"), __FILE__,
-                        __func__, function, buffback);
+    hamlib_req_t req;
+    gboolean retval;
 
-            retcode = FALSE;
-        }
+    if (sock < 0)
+    {
+        buffout[0] = '\0';
+        return FALSE;
     }
 
-    return retcode;
-}
-
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s:%s: sending %d bytes to rigctld as \"%s\""), __FILE__,
+                __func__, (gint)strlen(buff), buff);
+
+    /* every command we use returns exactly one line */
+    hamlib_req_init(&req, sock, rigctld_timeout(ctrl));
+    if (!hamlib_req_add(&req, buff, 1))
+        return FALSE;
+
+    retval = _run_rigctld_requests(ctrl, &req, 1);
+
+    if (retval)
+        g_strlcpy(buffout, req.resp[0], sizeout);
+    else
+        buffout[0] = '\0';
+
+    return retval;
+}
+
+static gboolean send_rigctld_command(GtkRigCtrl *ctrl, gint sock, gchar *buff,
+                                     gchar *buffout, gint sizeout)
+{
+    gboolean retval;
+
+    /* Enter critical section! */
+    g_mutex_lock(&ctrl->writelock);
+
+    retval = _send_rigctld_command(ctrl, sock, buff, buffout, sizeout);
+
+    /* Leave critical section! */
+    g_mutex_unlock(&ctrl->writelock);
+    return (retval);
+}
+
+static inline gboolean check_set_response(gchar *buffback, gboolean retcode,
+                                          const gchar *function)
+{
+    if (retcode == TRUE)
+    {
+        if (strncmp(buffback, "RPRT 0", 6) != 0)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s:%s: %s rigctld returned error (%s)"), __FILE__,
+                        __func__, function, buffback);
+
+            retcode = FALSE;
+        }
+    }
+
+    return retcode;
+}
+
 static inline gboolean check_get_response(gchar *buffback, gboolean retcode,
                                           const gchar *function)
 {
@@ -1646,28 +2147,119 @@ static gboolean setup_split(GtkRigCtrl *ctrl)
     return (check_set_response(buffback, retcode, __func__));
 }
 
-static gboolean rig_ctrl_timeout_cb(gpointer data)
+/*
+ * Predict the range rate and its rate of change (per real time second) dt
+ * seconds after the last module update.
+ *
+ * The values are interpolated from the Doppler schedule if it covers that
+ * time; otherwise the range rate of the last update is extrapolated.
+ */
+static void predict_range_rate(const rig_cmd_t *cmd, gdouble dt, gdouble *rr,
+                               gdouble *rrdot)
 {
-    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+    gdouble t = cmd->tmod + dt * cmd->trate / 86400.0;
 
-    if (ctrl->conf == NULL)
+    if (cmd->sched != NULL && doppler_sched_lookup(cmd->sched, t, rr, rrdot))
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Controller does not have a valid configuration"),
-                    __func__);
-        return FALSE;
+        *rrdot *= cmd->trate;
+        return;
     }
 
-    if (g_mutex_trylock(&(ctrl->busy)) == FALSE)
+    *rr = cmd->rr + cmd->rrdot * dt * cmd->trate;
+    *rrdot = cmd->rrdot * cmd->trate;
+}
+
+/*
+ * Predict the Doppler shifts at the time a frequency command sent now will
+ * take effect in the radio.
+ *
+ * The range rate is predicted for the time elapsed since the last module
+ * update plus the measured latency of the radio. The rates of change of the
+ * shifts are stored as well; they are used to decide whether a new command
+ * is necessary in this cycle.
+ */
+static void predict_doppler(GtkRigCtrl *ctrl)
+{
+    rig_cmd_t *cmd = &ctrl->cmd;
+    gdouble elapsed = 0.0;
+    gdouble latency, rr, rrdot;
+
+    if (cmd->catnum == 0)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s missed the deadline"), __func__);
-        return TRUE;
+        ctrl->dd = 0.0;
+        ctrl->du = 0.0;
+        ctrl->ddrate = 0.0;
+        ctrl->durate = 0.0;
+        return;
     }
 
-    setconfig(ctrl);
-    g_mutex_unlock(&(ctrl->busy));
+    /* without an update for the current target rrdot is 0 */
+    if (cmd->rrtime > 0)
+        elapsed = (g_get_monotonic_time() - cmd->rrtime) / 1.0e6;
 
-    return TRUE;
+    /* downlink */
+    predict_range_rate(cmd, elapsed + ctrl->latency, &rr, &rrdot);
+    ctrl->dd = -ctrl->satdown * (rr / 299792.4580);
+    ctrl->ddrate = -ctrl->satdown * (rrdot / 299792.4580);
+
+    /* uplink; goes through the second radio if we have one */
+    latency = (ctrl->conf2 != NULL) ? ctrl->latency2 : ctrl->latency;
+    predict_range_rate(cmd, elapsed + latency, &rr, &rrdot);
+    ctrl->du = ctrl->satup * (rr / 299792.4580);
+    ctrl->durate = ctrl->satup * (rrdot / 299792.4580);
+}
+
+/* Round frequency to the tuning step of the radio */
+static gdouble round_to_step(radio_conf_t *conf, gdouble freq)
+{
+    if (conf->step > 1)
+        return conf->step * rint(freq / conf->step);
+
+    return freq;
+}
+
+/*
+ * Check whether a new frequency has to be sent to the radio.
+ *
+ * The frequency is sent if the radio is off by more than the tolerance now or
+ * will be by the time of the next cycle. Otherwise the command is deferred,
+ * which keeps the CAT traffic down while the Doppler shift changes slowly.
+ */
+static gboolean freq_needs_update(GtkRigCtrl *ctrl, radio_conf_t *conf,
+                                  gdouble freq, gboolean uplink)
+{
+    gdouble last = uplink ? ctrl->lasttxf : ctrl->lastrxf;
+    gdouble rate = 0.0;
+    gdouble tol;
+
+    if (ctrl->cmd.tracking)
+        rate = uplink ? ctrl->durate : ctrl->ddrate;
+
+    tol = MAX(conf->tolerance, conf->step);
+    if (tol < 1.0)
+        tol = 1.0;
+
+    return (fabs(freq - last) >= tol ||
+            fabs(freq + rate * ctrl->cmd.delay / 1000.0 - last) >= tol);
+}
+
+/*
+ * Update the running average of the time it takes the radio on sock to
+ * process a set-frequency command. The sample is in seconds.
+ */
+static void update_latency(GtkRigCtrl *ctrl, gint sock, gdouble sample)
+{
+    gdouble *latency;
+
+    if (ctrl->conf2 != NULL && sock == ctrl->sock2)
+        latency = &ctrl->latency2;
+    else
+        latency = &ctrl->latency;
+
+    if (*latency == 0.0)
+        *latency = sample;
+    else
+        *latency += (sample - *latency) / LATENCY_AVG;
 }
 
 static void exec_rx_cycle(GtkRigCtrl *ctrl)
@@ -1698,11 +2290,11 @@ static void exec_rx_cycle(GtkRigCtrl *ctrl)
         {
             /* user might have altered radio frequency => update transponder
              * knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown), readfreq);
+            ctrl->rigdown = readfreq;
             ctrl->lastrxf = readfreq;
 
             /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
+            if (ctrl->cmd.tracking)
             {
                 satfreqd = (readfreq - ctrl->dd + ctrl->conf->lo);
             }
@@ -1710,12 +2302,12 @@ static void exec_rx_cycle(GtkRigCtrl *ctrl)
             {
                 satfreqd = readfreq + ctrl->conf->lo;
             }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), satfreqd);
+            ctrl->satdown = satfreqd;
 
             /* Update uplink if locked to downlink */
-            if (ctrl->trsplock)
+            if (ctrl->cmd.trsplock)
             {
-                track_downlink(ctrl);
+                rig_track_downlink(ctrl);
             }
 
             /* no need to forward track */
@@ -1729,44 +2321,38 @@ static void exec_rx_cycle(GtkRigCtrl *ctrl)
        shift and tranverter LO frequency. If we are not tracking, apply only LO
        frequency.
      */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
+    satfreqd = ctrl->satdown;
+    satfrequ = ctrl->satup;
+    if (ctrl->cmd.tracking)
     {
         /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
+        ctrl->rigdown = satfreqd + ctrl->dd - ctrl->conf->lo;
         /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
+        ctrl->rigup = satfrequ + ctrl->du - ctrl->conf->loup;
     }
     else
     {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
+        ctrl->rigdown = satfreqd - ctrl->conf->lo;
+        ctrl->rigup = satfrequ - ctrl->conf->loup;
     }
 
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
+    tmpfreq = ctrl->rigdown;
+    tmpfreq = round_to_step(ctrl->conf, tmpfreq);
 
     /* if device is engaged, send freq command to radio */
     if ((ctrl->engaged) && (ptt == FALSE) &&
-        (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
+        freq_needs_update(ctrl, ctrl->conf, tmpfreq, FALSE))
     {
-        if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
+        if (set_freq_simplex(ctrl, ctrl->sock, &tmpfreq))
         {
             /* reset error counter */
             ctrl->errcnt = 0;
 
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
             /* The actual frequency might be different from what we have set
                because the tuning step is larger than what we work with (e.g.
-               FT-817 has a smallest tuning step of 10 Hz). Therefore we read
-               back the actual frequency from the rig. */
-            get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
+               FT-817 has a smallest tuning step of 10 Hz). Therefore
+               set_freq_simplex() reads back the actual frequency from the rig
+               in the same round trip. */
             ctrl->lastrxf = tmpfreq;
 
             /* This is only effective in RIG_TYPE_TRX mode.
@@ -1823,11 +2409,11 @@ static void exec_tx_cycle(GtkRigCtrl *ctrl)
         {
             /* user might have altered radio frequency => update transponder
              * knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp), readfreq);
+            ctrl->rigup = readfreq;
             ctrl->lasttxf = readfreq;
 
             /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
+            if (ctrl->cmd.tracking)
             {
                 satfrequ = readfreq - ctrl->du + ctrl->conf->loup;
             }
@@ -1835,12 +2421,12 @@ static void exec_tx_cycle(GtkRigCtrl *ctrl)
             {
                 satfrequ = readfreq + ctrl->conf->loup;
             }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), satfrequ);
+            ctrl->satup = satfrequ;
 
             /* Follow with downlink if transponder is locked */
-            if (ctrl->trsplock)
+            if (ctrl->cmd.trsplock)
             {
-                track_uplink(ctrl);
+                rig_track_uplink(ctrl);
             }
 
             /* no need to forward track */
@@ -1854,44 +2440,38 @@ static void exec_tx_cycle(GtkRigCtrl *ctrl)
        shift and tranverter LO frequency. If we are not tracking, apply only LO
        frequency.
      */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
+    satfreqd = ctrl->satdown;
+    satfrequ = ctrl->satup;
+    if (ctrl->cmd.tracking)
     {
         /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
+        ctrl->rigdown = satfreqd + ctrl->dd - ctrl->conf->lo;
         /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
+        ctrl->rigup = satfrequ + ctrl->du - ctrl->conf->loup;
     }
     else
     {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
+        ctrl->rigdown = satfreqd - ctrl->conf->lo;
+        ctrl->rigup = satfrequ - ctrl->conf->loup;
     }
 
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
+    tmpfreq = ctrl->rigup;
+    tmpfreq = round_to_step(ctrl->conf, tmpfreq);
 
     /* if device is engaged, send freq command to radio */
     if ((ctrl->engaged) && (ptt == TRUE) &&
-        (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
+        freq_needs_update(ctrl, ctrl->conf, tmpfreq, TRUE))
     {
-        if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
+        if (set_freq_simplex(ctrl, ctrl->sock, &tmpfreq))
         {
             /* reset error counter */
             ctrl->errcnt = 0;
 
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
             /* The actual frequency migh be different from what we have set
                because the tuning step is larger than what we work with (e.g.
-               FT-817 has a smallest tuning step of 10 Hz). Therefore we read
-               back the actual frequency from the rig. */
-            get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
+               FT-817 has a smallest tuning step of 10 Hz). Therefore
+               set_freq_simplex() reads back the actual frequency from the rig
+               in the same round trip. */
             ctrl->lasttxf = tmpfreq;
 
             /* This is only effective in RIG_TYPE_TRX mode.
@@ -1986,10 +2566,11 @@ static void exec_toggle_tx_cycle(GtkRigCtrl *ctrl)
     }
 
     /* Get the desired uplink frequency from controller */
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
+    tmpfreq = ctrl->rigup;
+    tmpfreq = round_to_step(ctrl->conf, tmpfreq);
 
     /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 10.0))
+    if ((ctrl->engaged) && freq_needs_update(ctrl, ctrl->conf, tmpfreq, TRUE))
     {
         if (set_freq_toggle(ctrl, ctrl->sock, tmpfreq))
         {
@@ -2034,11 +2615,11 @@ static void exec_duplex_tx_cycle(GtkRigCtrl *ctrl)
 
             /* user might have altered radio frequency => update transponder
              * knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp), readfreq);
+            ctrl->rigup = readfreq;
             ctrl->lasttxf = readfreq;
 
             /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
+            if (ctrl->cmd.tracking)
             {
                 satfrequ = readfreq - ctrl->du + ctrl->conf->loup;
             }
@@ -2046,12 +2627,12 @@ static void exec_duplex_tx_cycle(GtkRigCtrl *ctrl)
             {
                 satfrequ = readfreq + ctrl->conf->loup;
             }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp), satfrequ);
+            ctrl->satup = satfrequ;
 
             /* Follow with downlink if transponder is locked */
-            if (ctrl->trsplock)
+            if (ctrl->cmd.trsplock)
             {
-                track_uplink(ctrl);
+                rig_track_uplink(ctrl);
             }
         }
     }
@@ -2067,38 +2648,32 @@ static void exec_duplex_tx_cycle(GtkRigCtrl *ctrl)
        shift and tranverter LO frequency. If we are not tracking, apply only LO
        frequency.
      */
-    satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-    satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-    if (ctrl->tracking)
+    satfreqd = ctrl->satdown;
+    satfrequ = ctrl->satup;
+    if (ctrl->cmd.tracking)
     {
         /* downlink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd + ctrl->dd - ctrl->conf->lo);
+        ctrl->rigdown = satfreqd + ctrl->dd - ctrl->conf->lo;
         /* uplink */
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ + ctrl->du - ctrl->conf->loup);
+        ctrl->rigup = satfrequ + ctrl->du - ctrl->conf->loup;
     }
     else
     {
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                satfreqd - ctrl->conf->lo);
-        gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                satfrequ - ctrl->conf->loup);
+        ctrl->rigdown = satfreqd - ctrl->conf->lo;
+        ctrl->rigup = satfrequ - ctrl->conf->loup;
     }
 
-    tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
+    tmpfreq = ctrl->rigup;
+    tmpfreq = round_to_step(ctrl->conf, tmpfreq);
 
     /* if device is engaged, send freq command to radio */
-    if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
+    if ((ctrl->engaged) && freq_needs_update(ctrl, ctrl->conf, tmpfreq, TRUE))
     {
         if (set_freq_toggle(ctrl, ctrl->sock, tmpfreq))
         {
             /* reset error counter */
             ctrl->errcnt = 0;
 
-            /* give radio a chance to set frequency */
-            g_usleep(WR_DEL);
-
             /* The actual frequency migh be different from what we have set
                because the tuning step is larger than what we work with (e.g.
                FT-817 has a smallest tuning step of 10 Hz). Therefore we read
@@ -2121,19 +2696,21 @@ static void exec_duplex_cycle(GtkRigCtrl *ctrl)
 
 static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
 {
-    gdouble tmpfreq, readfreq, satfreqd, satfrequ;
+    gdouble readfreq, satfreqd, satfrequ;
+    gdouble rxfreq = 0.0;
+    gdouble txfreq = 0.0;
     gboolean dialchanged = FALSE;
+    gboolean setrx = FALSE;
+    gboolean settx = FALSE;
 
-    /* Execute downlink cycle using ctrl->conf */
+    /* read both dials at once */
+    if (ctrl->engaged)
+        get_freq_dual(ctrl, &rxfreq, &txfreq);
+
+    /* Check downlink dial using ctrl->conf */
     if (ctrl->engaged && (ctrl->lastrxf > 0.0))
     {
-        /* get frequency from receiver */
-        if (!get_freq_simplex(ctrl, ctrl->sock, &readfreq))
-        {
-            /* error => use a passive value */
-            readfreq = ctrl->lastrxf;
-            ctrl->errcnt++;
-        }
+        readfreq = rxfreq;
 
         if (fabs(readfreq - ctrl->lastrxf) >= 1.0)
         {
@@ -2141,11 +2718,11 @@ static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
 
             /* user might have altered radio frequency => update transponder
              * knob */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown), readfreq);
+            ctrl->rigdown = readfreq;
             ctrl->lastrxf = readfreq;
 
             /* doppler shift; only if we are tracking */
-            if (ctrl->tracking)
+            if (ctrl->cmd.tracking)
             {
                 satfreqd = readfreq - ctrl->dd + ctrl->conf->lo;
             }
@@ -2153,12 +2730,12 @@ static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
             {
                 satfreqd = readfreq + ctrl->conf->lo;
             }
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqDown), satfreqd);
+            ctrl->satdown = satfreqd;
 
             /* Update uplink if locked to downlink */
-            if (ctrl->trsplock)
+            if (ctrl->cmd.trsplock)
             {
-                track_downlink(ctrl);
+                rig_track_downlink(ctrl);
             }
         }
     }
@@ -2166,105 +2743,49 @@ static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
     if (dialchanged)
     {
         /* update uplink */
-        satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-        if (ctrl->tracking)
+        satfrequ = ctrl->satup;
+        if (ctrl->cmd.tracking)
         {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                    satfrequ + ctrl->du - ctrl->conf2->loup);
+            ctrl->rigup = satfrequ + ctrl->du - ctrl->conf2->loup;
         }
         else
         {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                    satfrequ - ctrl->conf2->loup);
-        }
-
-        tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-        /* if device is engaged, send freq command to radio */
-        if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-        {
-            if (set_freq_simplex(ctrl, ctrl->sock2, tmpfreq))
-            {
-                /* reset error counter */
-                ctrl->errcnt = 0;
-
-                /* give radio a chance to set frequency */
-                g_usleep(WR_DEL);
-
-                /* The actual frequency migh be different from what we have set
-                 */
-                get_freq_simplex(ctrl, ctrl->sock2, &tmpfreq);
-                ctrl->lasttxf = tmpfreq;
-            }
-            else
-            {
-                ctrl->errcnt++;
-            }
+            ctrl->rigup = satfrequ - ctrl->conf2->loup;
         }
+        settx = TRUE;
     } /* dialchanged on downlink */
     else
     {
         /* if no dial change on downlink perform forward tracking on downlink
            and execute uplink controller too */
-        satfreqd = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-        if (ctrl->tracking)
+        satfreqd = ctrl->satdown;
+        if (ctrl->cmd.tracking)
         {
             /* downlink */
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    satfreqd + ctrl->dd - ctrl->conf->lo);
+            ctrl->rigdown = satfreqd + ctrl->dd - ctrl->conf->lo;
         }
         else
         {
-            gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                    satfreqd - ctrl->conf->lo);
-        }
-
-        tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
-
-        /* if device is engaged, send freq command to radio */
-        if ((ctrl->engaged) && (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
-        {
-            if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-            {
-                /* reset error counter */
-                ctrl->errcnt = 0;
-
-                /* give radio a chance to set frequency */
-                g_usleep(WR_DEL);
-
-                /* The actual frequency migh be different from what we have set
-                 */
-                get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-                ctrl->lastrxf = tmpfreq;
-            }
-            else
-            {
-                ctrl->errcnt++;
-            }
+            ctrl->rigdown = satfreqd - ctrl->conf->lo;
         }
+        setrx = TRUE;
 
         /* Now execute uplink controller */
 
         /* check if uplink dial has changed */
         if ((ctrl->engaged) && (ctrl->lasttxf > 0.0))
         {
-            if (!get_freq_simplex(ctrl, ctrl->sock2, &readfreq))
-            {
-                /* error => use a passive value */
-                readfreq = ctrl->lasttxf;
-                ctrl->errcnt++;
-            }
+            readfreq = txfreq;
 
             if (fabs(readfreq - ctrl->lasttxf) >= 1.0)
             {
                 dialchanged = TRUE;
 
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        readfreq);
+                ctrl->rigup = readfreq;
                 ctrl->lasttxf = readfreq;
 
                 /* doppler shift; only if we are tracking */
-                if (ctrl->tracking)
+                if (ctrl->cmd.tracking)
                 {
                     satfrequ = readfreq - ctrl->du + ctrl->conf2->loup;
                 }
@@ -2272,13 +2793,12 @@ static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
                 {
                     satfrequ = readfreq + ctrl->conf2->loup;
                 }
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->SatFreqUp),
-                                        satfrequ);
+                ctrl->satup = satfrequ;
 
                 /* Follow with downlink if transponder is locked */
-                if (ctrl->trsplock)
+                if (ctrl->cmd.trsplock)
                 {
-                    track_uplink(ctrl);
+                    rig_track_uplink(ctrl);
                 }
             }
         }
@@ -2286,84 +2806,35 @@ static void exec_dual_rig_cycle(GtkRigCtrl *ctrl)
         if (dialchanged)
         { /* on uplink */
             /* update downlink */
-            satfreqd =
-                gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqDown));
-            if (ctrl->tracking)
+            satfreqd = ctrl->satdown;
+            if (ctrl->cmd.tracking)
             {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                        satfreqd + ctrl->dd - ctrl->conf->lo);
+                ctrl->rigdown = satfreqd + ctrl->dd - ctrl->conf->lo;
             }
             else
             {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqDown),
-                                        satfreqd - ctrl->conf->lo);
-            }
-
-            tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqDown));
-
-            /* if device is engaged, send freq command to radio */
-            if ((ctrl->engaged) && (fabs(ctrl->lastrxf - tmpfreq) >= 1.0))
-            {
-                if (set_freq_simplex(ctrl, ctrl->sock, tmpfreq))
-                {
-                    /* reset error counter */
-                    ctrl->errcnt = 0;
-
-                    /* give radio a chance to set frequency */
-                    g_usleep(WR_DEL);
-
-                    /* The actual frequency migh be different from what we have
-                     * set */
-                    get_freq_simplex(ctrl, ctrl->sock, &tmpfreq);
-                    ctrl->lastrxf = tmpfreq;
-                }
-                else
-                {
-                    ctrl->errcnt++;
-                }
+                ctrl->rigdown = satfreqd - ctrl->conf->lo;
             }
         } /* dialchanged on uplink */
         else
         {
             /* perform forward tracking on uplink */
-            satfrequ = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->SatFreqUp));
-            if (ctrl->tracking)
+            satfrequ = ctrl->satup;
+            if (ctrl->cmd.tracking)
             {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        satfrequ + ctrl->du -
-                                            ctrl->conf2->loup);
+                ctrl->rigup = satfrequ + ctrl->du - ctrl->conf2->loup;
             }
             else
             {
-                gtk_freq_knob_set_value(GTK_FREQ_KNOB(ctrl->RigFreqUp),
-                                        satfrequ - ctrl->conf2->loup);
-            }
-
-            tmpfreq = gtk_freq_knob_get_value(GTK_FREQ_KNOB(ctrl->RigFreqUp));
-
-            /* if device is engaged, send freq command to radio */
-            if ((ctrl->engaged) && (fabs(ctrl->lasttxf - tmpfreq) >= 1.0))
-            {
-                if (set_freq_simplex(ctrl, ctrl->sock2, tmpfreq))
-                {
-                    /* reset error counter */
-                    ctrl->errcnt = 0;
-
-                    /* give radio a chance to set frequency */
-                    g_usleep(WR_DEL);
-
-                    /* The actual frequency might be different from what we have
-                     * set. */
-                    get_freq_simplex(ctrl, ctrl->sock2, &tmpfreq);
-                    ctrl->lasttxf = tmpfreq;
-                }
-                else
-                {
-                    ctrl->errcnt++;
-                }
+                ctrl->rigup = satfrequ - ctrl->conf2->loup;
             }
+            settx = TRUE;
         } /* else dialchange on uplink */
     } /* else dialchange on downlink */
+
+    /* if device is engaged, send freq commands to both radios at once */
+    if (ctrl->engaged)
+        set_freq_dual(ctrl, setrx, settx);
 }
 
 static gboolean get_ptt(GtkRigCtrl *ctrl, gint sock)
@@ -2447,9 +2918,12 @@ static gboolean check_aos_los(GtkRigCtrl *ctrl)
     gboolean retcode = TRUE;
     gchar retbuf[10];
 
-    if (ctrl->engaged && ctrl->tracking)
+    if (ctrl->cmd.catnum == 0)
+        return retcode;
+
+    if (ctrl->engaged && ctrl->cmd.tracking)
     {
-        if (ctrl->prev_ele < 0.0 && ctrl->target->el >= 0.0)
+        if (ctrl->prev_ele < 0.0 && ctrl->cmd.el >= 0.0)
         {
             /* AOS has occurred */
             if (ctrl->conf->signal_aos)
@@ -2466,7 +2940,7 @@ static gboolean check_aos_los(GtkRigCtrl *ctrl)
                 }
             }
         }
-        else if (ctrl->prev_ele >= 0.0 && ctrl->target->el < 0.0)
+        else if (ctrl->prev_ele >= 0.0 && ctrl->cmd.el < 0.0)
         {
             /* LOS has occurred */
             if (ctrl->conf->signal_los)
@@ -2485,7 +2959,58 @@ static gboolean check_aos_los(GtkRigCtrl *ctrl)
         }
     }
 
-    ctrl->prev_ele = ctrl->target->el;
+    ctrl->prev_ele = ctrl->cmd.el;
+
+    return retcode;
+}
+
+/*
+ * Prepare a request that sets the frequency in simplex mode and reads back
+ * the actual frequency in the same round trip.
+ */
+static void prepare_set_freq(GtkRigCtrl *ctrl, hamlib_req_t *req, gint sock,
+                             gdouble freq)
+{
+    gchar buff[64];
+
+    hamlib_req_init(req, sock, rigctld_timeout(ctrl));
+
+    if (ctrl->conf->vfo_opt)
+    {
+        g_snprintf(buff, sizeof(buff), "F currVFO %10.0f\x0a", freq);
+        hamlib_req_add(req, buff, 1);
+        hamlib_req_add(req, "f currVFO\x0a", 1);
+    }
+    else
+    {
+        g_snprintf(buff, sizeof(buff), "F %10.0f\x0a", freq);
+        hamlib_req_add(req, buff, 1);
+        hamlib_req_add(req, "f\x0a", 1);
+    }
+}
+
+/*
+ * Check the responses to a request made by prepare_set_freq().
+ *
+ * Returns TRUE if the frequency was set. If the read back succeeded as well
+ * the actual frequency is returned in freq.
+ */
+static gboolean finish_set_freq(GtkRigCtrl *ctrl, hamlib_req_t *req,
+                                gdouble *freq)
+{
+    gboolean retcode;
+
+    retcode = (req->nresp > 0 &&
+               check_set_response(req->resp[0], TRUE, __func__));
+    account_set_freq(ctrl, req->sock, retcode);
+    if (retcode)
+    {
+        update_latency(ctrl, req->sock, (req->rtime[0] - req->start) / 1.0e6);
+
+        if (req->nresp == 2 &&
+            check_get_response(req->resp[1], TRUE, __func__))
+            *freq = g_ascii_strtod(req->resp[1], NULL);
+    }
 
     return retcode;
 }
@@ -2493,22 +3018,125 @@ static gboolean check_aos_los(GtkRigCtrl *ctrl)
 /*
  * Set frequency in simplex mode
  *
+ * The frequency is read back from the radio in the same round trip and
+ * returned in freq, since it may differ from what we have set.
+ *
  * Returns TRUE if the operation was successful, FALSE otherwise
  */
-static gboolean set_freq_simplex(GtkRigCtrl *ctrl, gint sock, gdouble freq)
+static gboolean set_freq_simplex(GtkRigCtrl *ctrl, gint sock, gdouble *freq)
 {
-    gchar *buff;
-    gchar buffback[128];
-    gboolean retcode;
+    hamlib_req_t req;
 
-    if (ctrl->conf->vfo_opt)
-        buff = g_strdup_printf("F currVFO %10.0f\x0a", freq);
-    else
-        buff = g_strdup_printf("F %10.0f\x0a", freq);
-    retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
-    g_free(buff);
+    prepare_set_freq(ctrl, &req, sock, *freq);
+    run_rigctld_requests(ctrl, &req, 1);
 
-    return (check_set_response(buffback, retcode, __func__));
+    return finish_set_freq(ctrl, &req, freq);
+}
+
+/*
+ * Read the frequency of both radios in dual-rig mode.
+ *
+ * The radios are read concurrently. Only radios that have been set before
+ * are read; if reading fails the last frequency sent to the radio is
+ * returned and the error counter is incremented.
+ */
+static void get_freq_dual(GtkRigCtrl *ctrl, gdouble *rxfreq, gdouble *txfreq)
+{
+    hamlib_req_t req[2];
+    gdouble *freq[2];
+    const gchar *cmd;
+    guint i, n = 0;
+
+    *rxfreq = ctrl->lastrxf;
+    *txfreq = ctrl->lasttxf;
+
+    cmd = ctrl->conf->vfo_opt ? "f currVFO\x0a" : "f\x0a";
+
+    if (ctrl->lastrxf > 0.0)
+    {
+        hamlib_req_init(&req[n], ctrl->sock, rigctld_timeout(ctrl));
+        hamlib_req_add(&req[n], cmd, 1);
+        freq[n++] = rxfreq;
+    }
+    if (ctrl->lasttxf > 0.0)
+    {
+        hamlib_req_init(&req[n], ctrl->sock2, rigctld_timeout(ctrl));
+        hamlib_req_add(&req[n], cmd, 1);
+        freq[n++] = txfreq;
+    }
+
+    if (n == 0)
+        return;
+
+    run_rigctld_requests(ctrl, req, n);
+
+    for (i = 0; i < n; i++)
+    {
+        if (req[i].status == HAMLIB_REQ_DONE &&
+            check_get_response(req[i].resp[0], TRUE, __func__))
+            *freq[i] = g_ascii_strtod(req[i].resp[0], NULL);
+        else
+            ctrl->errcnt++;
+    }
+}
+
+/*
+ * Send the downlink and/or uplink frequency to the radios in dual-rig mode.
+ *
+ * The frequencies are taken from ctrl->rigdown and ctrl->rigup and only sent
+ * if necessary. Both radios are set concurrently.
+ */
+static void set_freq_dual(GtkRigCtrl *ctrl, gboolean rx, gboolean tx)
+{
+    hamlib_req_t req[2];
+    gdouble freq[2];
+    gdouble *last[2];
+    gdouble tmpfreq;
+    guint i, n = 0;
+
+    if (rx)
+    {
+        tmpfreq = ctrl->rigdown;
+        tmpfreq = round_to_step(ctrl->conf, tmpfreq);
+        if (freq_needs_update(ctrl, ctrl->conf, tmpfreq, FALSE))
+        {
+            prepare_set_freq(ctrl, &req[n], ctrl->sock, tmpfreq);
+            freq[n] = tmpfreq;
+            last[n++] = &ctrl->lastrxf;
+        }
+    }
+    if (tx)
+    {
+        tmpfreq = ctrl->rigup;
+        tmpfreq = round_to_step(ctrl->conf2, tmpfreq);
+        if (freq_needs_update(ctrl, ctrl->conf2, tmpfreq, TRUE))
+        {
+            prepare_set_freq(ctrl, &req[n], ctrl->sock2, tmpfreq);
+            freq[n] = tmpfreq;
+            last[n++] = &ctrl->lasttxf;
+        }
+    }
+
+    if (n == 0)
+        return;
+
+    run_rigctld_requests(ctrl, req, n);
+
+    for (i = 0; i < n; i++)
+    {
+        if (finish_set_freq(ctrl, &req[i], &freq[i]))
+        {
+            /* reset error counter */
+            ctrl->errcnt = 0;
+
+            /* The actual frequency might be different from what we have set */
+            *last[i] = freq[i];
+        }
+        else
+        {
+            ctrl->errcnt++;
+        }
+    }
 }
 
 /*
@@ -2521,6 +3149,7 @@ static gboolean set_freq_toggle(GtkRigCtrl *ctrl, gint sock, gdouble freq)
     gchar *buff;
     gchar buffback[128];
     gboolean retcode;
+    gint64 start;
 
     /* send command */
     printf("set_freq_toggle %d\n", ctrl->conf->vfo_opt);
@@ -2529,10 +3158,17 @@ static gboolean set_freq_toggle(GtkRigCtrl *ctrl, gint sock, gdouble freq)
     else
         buff = g_strdup_printf("I %10.0f\x0a", freq);
 
+    start = g_get_monotonic_time();
     retcode = send_rigctld_command(ctrl, sock, buff, buffback, 128);
     g_free(buff);
 
-    return (check_set_response(buffback, retcode, __func__));
+    if (retcode)
+        update_latency(ctrl, sock, (g_get_monotonic_time() - start) / 1.0e6);
+
+    retcode = check_set_response(buffback, retcode, __func__);
+    account_set_freq(ctrl, sock, retcode);
+
+    return retcode;
 }
 
 /*
@@ -2701,8 +3337,8 @@ static gboolean get_freq_toggle(GtkRigCtrl *ctrl, gint sock, gdouble *freq)
  * the spacebar. It is only useful for RIG_TYPE_TOGGLE_MAN and possibly for
  * RIG_TYPE_TOGGLE_AUTO.
  *
- * First, the function will try to lock the controller. If the lock is
- * acquired the function checks the current PTT status.
+ * The function is executed by the rig thread between two cycles and checks
+ * the current PTT status.
  * If PTT status is FALSE (off), it will set the TX frequency and set PTT to
  * TRUE (on). If PTT status is TRUE (on) it will simply set the PTT to FALSE
  * (off).
@@ -2712,70 +3348,54 @@ static gboolean get_freq_toggle(GtkRigCtrl *ctrl, gint sock, gdouble *freq)
  */
 static void manage_ptt_event(GtkRigCtrl *ctrl)
 {
-    guint timeout = 1;
     gboolean ptt = FALSE;
 
-    /* wait for controller to be idle or until the timeout triggers */
-    while (timeout < 5)
-    {
-        if (g_mutex_trylock(&(ctrl->busy)) == TRUE)
-        {
-            timeout = 17; /* use an arbitrary value that is large enough */
-        }
-        else
-        {
-            /* wait for 100 msec */
-            g_usleep(100000);
-            timeout++;
-        }
-    }
-
-    if (timeout == 17)
+    if (ctrl->sock < 0 || ctrl->failed)
     {
-        /* timeout did not expire, we've got the controller lock */
-        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Acquired controller lock"),
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Radio is not connected; PTT event not handled"),
                     __func__);
+        return;
+    }
 
-        if (ctrl->engaged == FALSE)
-        {
-            sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s: Controller not engaged; PTT event ignored "
-                          "(Hint: Enable the Engage button)"),
-                        __func__);
-        }
-        else
-        {
-            ptt = get_ptt(ctrl, ctrl->sock);
-
-            if (ptt == FALSE)
-            {
-                /* PTT is OFF => set TX freq then set PTT to ON */
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: PTT is OFF => Set TX freq and PTT=ON"),
-                            __func__);
+    ptt = get_ptt(ctrl, ctrl->sock);
 
-                exec_toggle_tx_cycle(ctrl);
-                set_ptt(ctrl, ctrl->sock, TRUE);
-            }
-            else
-            {
-                /* PTT is ON => set to OFF */
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s: PTT is ON = Set PTT=OFF"), __func__);
-
-                set_ptt(ctrl, ctrl->sock, FALSE);
-            }
-        }
+    if (ptt == FALSE)
+    {
+        /* PTT is OFF => set TX freq then set PTT to ON */
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: PTT is OFF => Set TX freq and PTT=ON"), __func__);
 
-        g_mutex_unlock(&(ctrl->busy));
+        exec_toggle_tx_cycle(ctrl);
+        set_ptt(ctrl, ctrl->sock, TRUE);
     }
     else
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Failed to acquire controller lock; PTT event "
-                      "not handled"),
+        /* PTT is ON => set to OFF */
+        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: PTT is ON = Set PTT=OFF"),
                     __func__);
+
+        set_ptt(ctrl, ctrl->sock, FALSE);
+    }
+}
+
+/* Ask the rig thread to toggle PTT; see manage_ptt_event() */
+static void request_ptt_event(GtkRigCtrl *ctrl)
+{
+    if (ctrl->engaged == FALSE)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Controller not engaged; PTT event ignored "
+                      "(Hint: Enable the Engage button)"),
+                    __func__);
+        return;
     }
+
+    ctrl->pttreq++;
+    publish_rig_cmd(ctrl);
+
+    /* wake up the rig thread */
+    setconfig(ctrl);
 }
 
 /*
@@ -2803,7 +3423,7 @@ static gboolean key_press_cb(GtkWidget *widget, GdkEventKey *pKey,
             /* manage PTT event but only if rig is of type TOGGLE_MAN */
             if (ctrl->conf->type == RIG_TYPE_TOGGLE_MAN)
             {
-                manage_ptt_event(ctrl);
+                request_ptt_event(ctrl);
                 event_managed = TRUE;
             }
             break;
@@ -2822,84 +3442,36 @@ static gboolean key_press_cb(GtkWidget *widget, GdkEventKey *pKey,
 
 static gboolean open_rigctld_socket(radio_conf_t *conf, gint *sock)
 {
-    struct sockaddr_in ServAddr;
-    struct hostent *h;
-    gint status;
-
-    *sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    *sock = hamlib_open(conf->host, conf->port, CONNECT_TIMEOUT);
     if (*sock < 0)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to create socket"),
-                    __func__);
-        *sock = 0;
-        return FALSE;
-    }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                    _("%s: Network socket created successfully"), __func__);
-    }
-
-    memset(&ServAddr, 0, sizeof(ServAddr)); /* Zero out structure */
-    ServAddr.sin_family = AF_INET;          /* Internet address family */
-    h = gethostbyname(conf->host);
-    memcpy((char *)&ServAddr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
-    ServAddr.sin_port = htons(conf->port); /* Server port */
-
-    /* establish connection */
-    status = connect(*sock, (struct sockaddr *)&ServAddr, sizeof(ServAddr));
-    if (status < 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to connect to %s:%d"),
-                    __func__, conf->host, conf->port);
-        *sock = 0;
+        *sock = -1;
         return FALSE;
     }
-    else
-    {
-        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Connection opened to %s:%d"),
-                    __func__, conf->host, conf->port);
-    }
 
     return TRUE;
 }
 
 static gboolean close_rigctld_socket(gint *sock)
 {
-    gint written;
-
-    written = send(*sock, "q\x0a", 2, 0);
-    if (written != 2)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%s: Sent 2 bytes but sent %d."),
-                    __FILE__, __func__, written);
-    }
-#ifndef WIN32
-    shutdown(*sock, SHUT_RDWR);
-    close(*sock);
-#else
-    shutdown(*sock, SD_BOTH);
-    closesocket(*sock);
-#endif
-
-    *sock = 0;
+    if (*sock >= 0)
+        hamlib_close(*sock);
+    *sock = -1;
 
     return TRUE;
 }
 
 static void rigctrl_close(GtkRigCtrl *data)
 {
-    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+    GtkRigCtrl *ctrl = data;
 
     ctrl->lastrxptt = FALSE;
     ctrl->lasttxptt = TRUE;
     ctrl->lasttxf = 0.0;
     ctrl->lastrxf = 0.0;
 
-    remove_timer(ctrl);
-
-    if ((ctrl->conf->type == RIG_TYPE_TOGGLE_AUTO) ||
-        (ctrl->conf->type == RIG_TYPE_TOGGLE_MAN))
+    if (ctrl->sock >= 0 && ((ctrl->conf->type == RIG_TYPE_TOGGLE_AUTO) ||
+                            (ctrl->conf->type == RIG_TYPE_TOGGLE_MAN)))
     {
         unset_toggle(ctrl, ctrl->sock);
     }
@@ -2911,200 +3483,353 @@ static void rigctrl_close(GtkRigCtrl *data)
     close_rigctld_socket(&(ctrl->sock));
 }
 
-static void rigctrl_open(GtkRigCtrl *data)
+/*
+ * Connect to the radio(s) and prepare them for the control cycles.
+ *
+ * @return FALSE if a radio could not be reached; no socket is left open.
+ */
+static gboolean rigctrl_open(GtkRigCtrl *data)
 {
-    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+    GtkRigCtrl *ctrl = data;
 
     ctrl->wrops = 0;
+    ctrl->resync = FALSE;
 
-    start_timer(ctrl);
-
-    open_rigctld_socket(ctrl->conf, &(ctrl->sock));
+    if (!open_rigctld_socket(ctrl->conf, &(ctrl->sock)))
+        return FALSE;
 
     // check to see if vfo option is enabled
     ctrl->conf->vfo_opt = get_vfo_opt(ctrl, ctrl->sock);
     sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s:%s: VFO opt=%d"), __FILE__, __func__,
                 ctrl->conf->vfo_opt);
 
-    /* set initial frequency */
     if (ctrl->conf2 != NULL)
     {
-        open_rigctld_socket(ctrl->conf2, &(ctrl->sock2));
+        if (!open_rigctld_socket(ctrl->conf2, &(ctrl->sock2)))
+        {
+            close_rigctld_socket(&(ctrl->sock));
+            return FALSE;
+        }
         /* set initial dual mode */
         ctrl->conf2->vfo_opt = get_vfo_opt(ctrl, ctrl->sock2);
         sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s:%s: VFO opt2=%d"), __FILE__,
                     __func__, ctrl->conf2->vfo_opt);
-
-        exec_dual_rig_cycle(ctrl);
     }
     else
     {
         switch (ctrl->conf->type)
         {
 
-        case RIG_TYPE_RX:
-            exec_rx_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_TX:
-            exec_tx_cycle(ctrl);
-            break;
-
-        case RIG_TYPE_TRX:
-            exec_trx_cycle(ctrl);
-            break;
-
         case RIG_TYPE_DUPLEX:
             /* set rig into SAT mode (hamlib needs it even if rig already in
              * SAT) */
             setup_split(ctrl);
-            exec_duplex_cycle(ctrl);
             break;
 
         case RIG_TYPE_TOGGLE_AUTO:
         case RIG_TYPE_TOGGLE_MAN:
             set_toggle(ctrl, ctrl->sock);
             ctrl->last_toggle_tx = -1;
-            exec_toggle_cycle(ctrl);
             break;
 
         default:
-            /* this is an error! */
-            ctrl->conf->type = RIG_TYPE_RX;
-            exec_rx_cycle(ctrl);
             break;
         }
     }
+
+    return TRUE;
 }
 
-/* Communication thread for hamlib rigctld */
-gpointer rigctl_run(gpointer data)
+/*
+ * Reopen the connections after a request timed out or failed.
+ *
+ * A late reply would otherwise be read as the reply to the next command. The
+ * radio state is unknown, so the frequencies and PTT are sent again.
+ */
+static void rigctrl_resync(GtkRigCtrl *ctrl)
 {
-    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
-    GtkRigCtrl *t_ctrl = GTK_RIG_CTRL(data);
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Reconnecting to rigctld"),
+                __func__);
+
+    ctrl->lastrxptt = FALSE;
+    ctrl->lasttxptt = TRUE;
+    ctrl->lasttxf = 0.0;
+    ctrl->lastrxf = 0.0;
+
+    close_rigctld_socket(&(ctrl->sock2));
+    close_rigctld_socket(&(ctrl->sock));
+    rigctrl_open(ctrl);
+}
 
-    while (1)
+/* Execute controller cycle depending on the radio type(s) */
+static void exec_rig_cycle(GtkRigCtrl *ctrl)
+{
+    if (ctrl->conf2 != NULL)
     {
-        t_ctrl = GTK_RIG_CTRL(g_async_queue_pop(ctrl->rigctlq));
-        ctrl = t_ctrl;
-        while (g_main_context_iteration(NULL, FALSE))
-            ;
+        exec_dual_rig_cycle(ctrl);
+        return;
+    }
 
-        if (t_ctrl == NULL)
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%s: ERROR: NO VALID ctrl-struct"), __FILE__,
-                        __func__);
-            continue;
-        }
+    switch (ctrl->conf->type)
+    {
 
-        if (t_ctrl->engaged)
-        {
-            if (!t_ctrl->sock)
-                rigctrl_open(t_ctrl);
+    case RIG_TYPE_RX:
+        exec_rx_cycle(ctrl);
+        break;
 
-            if (!t_ctrl->timerid)
-                start_timer(t_ctrl);
-        }
-        else
-        {
-            g_mutex_lock(&t_ctrl->widgetsync);
+    case RIG_TYPE_TX:
+        exec_tx_cycle(ctrl);
+        break;
 
-            if (t_ctrl->sock > 0)
-                rigctrl_close(t_ctrl);
+    case RIG_TYPE_TRX:
+        exec_trx_cycle(ctrl);
+        break;
 
-            if (t_ctrl->timerid)
-                remove_timer(t_ctrl);
+    case RIG_TYPE_DUPLEX:
+        exec_duplex_cycle(ctrl);
+        break;
 
-            g_cond_signal(&t_ctrl->widgetready);
-            g_mutex_unlock(&t_ctrl->widgetsync);
-            break;
-        }
+    case RIG_TYPE_TOGGLE_AUTO:
+    case RIG_TYPE_TOGGLE_MAN:
+        exec_toggle_cycle(ctrl);
+        break;
 
-        check_aos_los(t_ctrl);
+    default:
+        /* invalid mode */
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s:%s: Invalid radio type %d. Setting type to "
+                      "RIG_TYPE_RX"),
+                    __FILE__, __func__, ctrl->conf->type);
+        ctrl->conf->type = RIG_TYPE_RX;
+        exec_rx_cycle(ctrl);
+        break;
+    }
+}
 
-        if (t_ctrl->conf2 != NULL)
-        {
-            exec_dual_rig_cycle(t_ctrl);
-        }
-        else
-        {
-            /* Execute controller cycle depending on primary radio type */
-            switch (t_ctrl->conf->type)
-            {
+/*
+ * Pick up the latest settings published by the UI, if any.
+ *
+ * The satellite frequencies are only taken over when the user has changed
+ * them; otherwise the rig thread keeps its own, which follow the radio dial.
+ * When init is TRUE everything is taken over.
+ *
+ * Returns TRUE if the user has requested a PTT toggle.
+ */
+static gboolean take_rig_cmd(GtkRigCtrl *ctrl, gboolean init)
+{
+    rig_cmd_t *cmd;
+    gboolean ptt = FALSE;
 
-            case RIG_TYPE_RX:
-                exec_rx_cycle(t_ctrl);
-                break;
+    cmd = snapshot_take(&ctrl->cmdslot);
+    if (cmd == NULL)
+        return FALSE;
 
-            case RIG_TYPE_TX:
-                exec_tx_cycle(t_ctrl);
-                break;
+    if (init || cmd->satseq != ctrl->cmd.satseq)
+    {
+        ctrl->satdown = cmd->satdown;
+        ctrl->satup = cmd->satup;
+    }
 
-            case RIG_TYPE_TRX:
-                exec_trx_cycle(t_ctrl);
-                break;
+    /* no AOS/LOS signal just because the target has changed */
+    if (init || cmd->catnum != ctrl->cmd.catnum)
+        ctrl->prev_ele = cmd->el;
 
-            case RIG_TYPE_DUPLEX:
-                exec_duplex_cycle(t_ctrl);
-                break;
+    if (!init)
+    {
+        /* invalidate RIG<->GPREDICT sync */
+        if (cmd->rxsync != ctrl->cmd.rxsync)
+            ctrl->lastrxf = 0.0;
+        if (cmd->txsync != ctrl->cmd.txsync)
+            ctrl->lasttxf = 0.0;
 
-            case RIG_TYPE_TOGGLE_AUTO:
-            case RIG_TYPE_TOGGLE_MAN:
-                exec_toggle_cycle(t_ctrl);
-                break;
+        ptt = (cmd->pttreq != ctrl->cmd.pttreq);
+    }
 
-            default:
-                /* invalid mode */
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%s: Invalid radio type %d. Setting type to "
-                              "RIG_TYPE_RX"),
-                            __FILE__, __func__, t_ctrl->conf->type);
-                t_ctrl->conf->type = RIG_TYPE_RX;
-            }
+    /* the reference to the Doppler schedule moves to ctrl->cmd */
+    doppler_sched_unref(ctrl->cmd.sched);
+    ctrl->cmd = *cmd;
+    g_free(cmd);
+
+    return ptt;
+}
+
+/*
+ * Account for the frequency errors of the cycle, i.e. how far the radio is
+ * from where Doppler tracking wants it. Directions that are not synced with
+ * the radio have no frequency to compare.
+ */
+static void account_freq_error(GtkRigCtrl *ctrl)
+{
+    if (!ctrl->cmd.tracking)
+        return;
+
+    if (ctrl->lastrxf > 0.0)
+        track_stats_add(&ctrl->freqerr[0], ctrl->lastrxf - ctrl->rigdown);
+    if (ctrl->lasttxf > 0.0)
+        track_stats_add(&ctrl->freqerr[1], ctrl->lasttxf - ctrl->rigup);
+}
+
+/* Publish the state of the radio(s) for the UI */
+static void publish_rig_state(GtkRigCtrl *ctrl)
+{
+    rig_state_t *state = g_new(rig_state_t, 1);
+
+    state->satdown = ctrl->satdown;
+    state->satup = ctrl->satup;
+    state->satseq = ctrl->cmd.satseq;
+    state->rigdown = ctrl->rigdown;
+    state->rigup = ctrl->rigup;
+    state->failed = ctrl->failed;
+    state->io[0] = ctrl->io[0];
+    state->io[1] = ctrl->io[1];
+    state->cycles = ctrl->cycles;
+    state->missed = ctrl->missed;
+    state->freqerr[0] = ctrl->freqerr[0];
+    state->freqerr[1] = ctrl->freqerr[1];
+
+    snapshot_put(&ctrl->stateslot, state, g_free);
+}
+
+/*
+ * Communication thread for hamlib rigctld.
+ *
+ * The thread runs the control cycles with the period selected by the user and
+ * does not touch any widgets. The settings are taken from the latest rig_cmd_t
+ * published by the UI and the outcome of each cycle is published as a
+ * rig_state_t, which the UI picks up at its own pace. Messages in the queue
+ * wake the thread up early, i.e. when the radio is disengaged or a PTT event
+ * is pending.
+ */
+gpointer rigctl_run(gpointer data)
+{
+    GtkRigCtrl *ctrl = data;
+    gint64 now, next, period, start;
+
+    ctrl->failed = FALSE;
+    ctrl->resync = FALSE;
+    ctrl->errcnt = 0;
+    io_stats_reset(&ctrl->io[0]);
+    io_stats_reset(&ctrl->io[1]);
+    io_stats_reset(&ctrl->cycles);
+    ctrl->missed = 0;
+    memset(ctrl->setfailed, 0, sizeof(ctrl->setfailed));
+    memset(ctrl->freqerr, 0, sizeof(ctrl->freqerr));
+    take_rig_cmd(ctrl, TRUE);
+    next = g_get_monotonic_time();
+
+    while (g_atomic_int_get(&ctrl->engaged))
+    {
+        now = g_get_monotonic_time();
+        if (ctrl->failed)
+            g_async_queue_pop(ctrl->rigctlq);
+        else if (now < next)
+            g_async_queue_timeout_pop(ctrl->rigctlq, next - now);
+
+        /* the messages carry no data; drop any that are queued up */
+        while (g_async_queue_try_pop(ctrl->rigctlq) != NULL)
+            ;
+
+        if (!g_atomic_int_get(&ctrl->engaged))
+            break;
+
+        if (ctrl->resync)
+            rigctrl_resync(ctrl);
+
+        if (take_rig_cmd(ctrl, FALSE))
+            manage_ptt_event(ctrl);
+
+        /* woken up before the next cycle is due */
+        now = g_get_monotonic_time();
+        if (ctrl->failed || now < next)
+            continue;
+
+        start = now;
+        ctrl->iotime = 0;
+
+        /* a radio that cannot be reached counts as an error */
+        if (ctrl->sock >= 0 || rigctrl_open(ctrl))
+        {
+            predict_doppler(ctrl);
+            check_aos_los(ctrl);
+            exec_rig_cycle(ctrl);
+            account_freq_error(ctrl);
+        }
+        else
+        {
+            ctrl->errcnt++;
         }
 
+        io_stats_request(&ctrl->cycles, 1);
+        io_stats_response(&ctrl->cycles, g_get_monotonic_time() - start,
+                          TRUE);
+
         /* perform error count checking */
-        if (t_ctrl->errcnt >= MAX_ERROR_COUNT)
+        if (ctrl->errcnt >= MAX_ERROR_COUNT)
         {
-            /* disengage device */
-            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(t_ctrl->LockBut),
-                                         FALSE);
-            t_ctrl->engaged = FALSE;
-            t_ctrl->errcnt = 0;
+            /* disconnect and let the UI disengage the device */
+            ctrl->failed = TRUE;
+            ctrl->errcnt = 0;
+            rigctrl_close(ctrl);
             sat_log_log(
                 SAT_LOG_LEVEL_ERROR,
                 _("%s:%s: MAX_ERROR_COUNT (%d) reached. Disengaging device!"),
                 __FILE__, __func__, MAX_ERROR_COUNT);
-
-            // g_print ("ERROR. WROPS = %d\n", ctrl->wrops);
         }
 
-        // g_print ("       WROPS = %d\n", ctrl->wrops);
+        publish_rig_state(ctrl);
+
+        /* schedule next cycle; skip the ones we have missed */
+        period = (gint64)MAX(ctrl->cmd.delay, 1) * 1000;
+        next += period;
+        now = g_get_monotonic_time();
+        if (next <= now)
+        {
+            /* tell our own delays from those of the radio */
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s missed the deadline (cycle took %d ms, %d ms "
+                          "of it waiting for rigctld)"),
+                        __func__, (gint)((now - start) / 1000),
+                        (gint)(ctrl->iotime / 1000));
+            ctrl->missed++;
+            next += ((now - next) / period + 1) * period;
+        }
     }
 
-    if (t_ctrl->sock > 0)
-        rigctrl_close(t_ctrl);
+    if (ctrl->sock >= 0)
+        rigctrl_close(ctrl);
 
-    if (t_ctrl->timerid)
-        remove_timer(t_ctrl);
+    io_stats_log(ctrl->conf->name, &ctrl->io[0]);
+    if (ctrl->conf2 != NULL)
+        io_stats_log(ctrl->conf2->name, &ctrl->io[1]);
+    track_stats_log(_("Downlink frequency error (Hz)"), &ctrl->freqerr[0]);
+    track_stats_log(_("Uplink frequency error (Hz)"), &ctrl->freqerr[1]);
 
     return NULL;
 }
 
-void start_timer(GtkRigCtrl *data)
+/* Refresh the radio frequencies and other engine state in the UI */
+static gboolean rig_ctrl_timeout_cb(gpointer data)
+{
+    GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
+
+    apply_rig_state(ctrl);
+
+    return TRUE;
+}
+
+/* (Re)start the UI refresh timer ("Cycle") */
+static void start_timer(GtkRigCtrl *data)
 {
     GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
 
-    /*  start timeout timer here ("Cycle")! */
     if (ctrl->timerid > 0)
         g_source_remove(ctrl->timerid);
 
-    ctrl->timerid =
-        gdk_threads_add_timeout(ctrl->delay, rig_ctrl_timeout_cb, ctrl);
+    ctrl->timerid = g_timeout_add(MAX(ctrl->delay, MIN_REFRESH),
+                                  rig_ctrl_timeout_cb, ctrl);
 }
 
-void remove_timer(GtkRigCtrl *data)
+static void remove_timer(GtkRigCtrl *data)
 {
     GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
 
@@ -3114,7 +3839,7 @@ void remove_timer(GtkRigCtrl *data)
     ctrl->timerid = 0;
 }
 
-void setconfig(gpointer data)
+static void setconfig(gpointer data)
 {
     /* something has changed... */
     GtkRigCtrl *ctrl = GTK_RIG_CTRL(data);
@@ -3125,6 +3850,46 @@ void setconfig(gpointer data)
     }
 }
 
+/* Start the rig thread */
+static void start_engine(GtkRigCtrl *ctrl)
+{
+    ctrl->engaged = TRUE;
+    publish_rig_cmd(ctrl);
+
+    ctrl->rigctlq = g_async_queue_new();
+    ctrl->rigctl_thread = g_thread_new("rigctl_run", rigctl_run, ctrl);
+
+    start_timer(ctrl);
+}
+
+/* Stop the rig thread and wait until it has closed the sockets */
+static void stop_engine(GtkRigCtrl *ctrl)
+{
+    rig_cmd_t *cmd;
+
+    g_atomic_int_set(&ctrl->engaged, FALSE);
+
+    if (ctrl->rigctl_thread == NULL)
+        return;
+
+    setconfig(ctrl);
+    g_thread_join(ctrl->rigctl_thread);
+    ctrl->rigctl_thread = NULL;
+    g_async_queue_unref(ctrl->rigctlq);
+    ctrl->rigctlq = NULL;
+
+    remove_timer(ctrl);
+
+    /* drop snapshots nobody is going to claim */
+    cmd = snapshot_take(&ctrl->cmdslot);
+    if (cmd != NULL)
+        rig_cmd_free(cmd);
+    g_free(snapshot_take(&ctrl->stateslot));
+
+    doppler_sched_unref(ctrl->cmd.sched);
+    ctrl->cmd.sched = NULL;
+}
+
 GtkWidget *gtk_rig_ctrl_new(GtkSatModule *module)
 {
     GtkRigCtrl *rigctrl;
@@ -3149,6 +3914,7 @@ GtkWidget *gtk_rig_ctrl_new(GtkSatModule *module)
         /* get next pass for target satellite */
         GTK_RIG_CTRL(widget)->pass =
             get_next_pass(rigctrl->target, rigctrl->qth, 3.0);
+        update_doppler_sched(rigctrl);
     }
 
     /* create contents */
@@ -5,7 +5,9 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#include "doppler-sched.h"
 #include "gtk-sat-module.h"
+#include "io-stats.h"
 #include "predict-tools.h"
 #include "radio-conf.h"
 #include "sgpsdp/sgp4sdp4.h"
@@ -24,6 +26,52 @@
 typedef struct _gtk_rig_ctrl GtkRigCtrl;
 typedef struct _GtkRigCtrlClass GtkRigCtrlClass;
 
+/*
+ * Settings handed from the UI to the rig thread.
+ *
+ * A new snapshot is published whenever something changes in the UI and the
+ * rig thread picks up the most recent one at the start of each cycle. The
+ * counters let the rig thread detect events that happened since the previous
+ * snapshot it has seen.
+ */
+typedef struct {
+    gdouble satdown;   /* Satellite downlink frequency (Hz) */
+    gdouble satup;     /* Satellite uplink frequency (Hz) */
+    guint satseq;      /* Incremented when the user changes satdown/satup */
+    guint rxsync;      /* Incremented to invalidate the downlink sync */
+    guint txsync;      /* Incremented to invalidate the uplink sync */
+    guint pttreq;      /* Incremented to request a PTT toggle */
+    gboolean tracking; /* Apply Doppler correction */
+    gboolean trsplock; /* Uplink and downlink are locked */
+    gboolean havetrsp; /* trsp holds the passbands of a transponder */
+    trsp_t trsp;       /* Transponder passbands; name and mode are NULL */
+    guint delay;       /* Cycle period (msec) */
+
+    gint catnum;    /* Catalogue number of the target; 0 if none */
+    gdouble el;     /* Elevation of the target (deg) */
+    gdouble rr;     /* Range rate at last update (km/s) */
+    gdouble rrdot;  /* Range rate derivative at last update (km/s/s) */
+    gdouble trate;  /* Module time seconds per real time second */
+    gint64 rrtime;  /* Monotonic time of last update (usec); 0 if none */
+    gdouble tmod;   /* Module time of last update (Julian date) */
+    doppler_sched_t *sched; /* Doppler schedule of the pass; may be NULL */
+} rig_cmd_t;
+
+/* Rig state handed from the rig thread to the UI after each cycle */
+typedef struct {
+    gdouble satdown;   /* Satellite downlink frequency (Hz) */
+    gdouble satup;     /* Satellite uplink frequency (Hz) */
+    guint satseq;      /* satseq of the settings satdown/satup are based on */
+    gdouble rigdown;   /* Radio downlink frequency (Hz) */
+    gdouble rigup;     /* Radio uplink frequency (Hz) */
+    gboolean failed;   /* Too many errors; the radio should be disengaged */
+    io_stats_t io[2];  /* I/O statistics of radio 1 and 2 */
+    gboolean setfailed[2]; /* Last set-frequency command of radio 1/2 failed */
+    io_stats_t cycles; /* Duration of the control cycles */
+    guint missed;      /* Number of cycles that missed their deadline */
+    track_stats_t freqerr[2]; /* Downlink and uplink frequency errors (Hz) */
+} rig_state_t;
+
 struct _gtk_rig_ctrl {
     GtkBox box;
 
@@ -44,10 +92,12 @@ struct _gtk_rig_ctrl {
     GtkWidget *SatSel;       /* Satellite selector */
     GtkWidget *SatSelFilter; /* Satellite selector filter */
     GtkWidget *TrspSel;      /* Transponder selector */
+    GtkWidget *DopExport;    /* Doppler schedule export button */
     GtkWidget *DevSel;       /* Device selector */
     GtkWidget *DevSel2;      /* Second device selector */
     GtkWidget *LockBut;
     GtkWidget *cycle_spin; /* Update timer cycle */
+    GtkWidget *IoStats;    /* Summary of the I/O statistics */
 
     radio_conf_t *conf;  /* Radio configuration */
     radio_conf_t *conf2; /* Secondary radio configuration */
@@ -59,31 +109,68 @@ struct _gtk_rig_ctrl {
     GSList *sats;  /* List of sats in parent module */
     sat_t *target; /* Target satellite */
     pass_t *pass;  /* Next pass of target satellite */
+    doppler_sched_t *sched; /* Doppler schedule for pass */
     qth_t *qth;    /* The QTH for this module */
 
     double prev_ele; /* Previous elevation (used for AOS/LOS signalling) */
 
     guint delay;   /* Timeout delay. */
-    guint timerid; /* Timer ID */
+    guint timerid; /* Timer ID of the UI refresh */
+    rig_state_t laststate; /* Last state shown in the UI */
 
     gboolean tracking; /* Flag set when we are tracking a target. */
-    GMutex busy;       /* Flag set when control algorithm is busy. */
     gboolean engaged;  /* Flag indicating that rig device is engaged. */
     gint errcnt;       /* Error counter. */
 
+    /* events for the rig thread; see rig_cmd_t */
+    guint satseq;
+    guint rxsync;
+    guint txsync;
+    guint pttreq;
+
+    /* snapshot mailboxes; each holds the latest unclaimed snapshot or NULL */
+    gpointer cmdslot;   /* rig_cmd_t from the UI to the rig thread */
+    gpointer stateslot; /* rig_state_t from the rig thread to the UI */
+
+    /* rig engine state; only used by the rig thread while engaged */
+    rig_cmd_t cmd;   /* Settings used in the current cycle */
+    gdouble satdown; /* Satellite downlink frequency (Hz) */
+    gdouble satup;   /* Satellite uplink frequency (Hz) */
+    gdouble rigdown; /* Radio downlink frequency (Hz) */
+    gdouble rigup;   /* Radio uplink frequency (Hz) */
+    gboolean failed; /* MAX_ERROR_COUNT reached; waiting to be disengaged */
+    gboolean resync; /* A request timed out; reconnect before the next one */
+    io_stats_t io[2];  /* I/O statistics of radio 1 and 2 */
+    gboolean setfailed[2]; /* Last set-frequency command of radio 1/2 failed */
+    io_stats_t cycles; /* Duration of the control cycles */
+    guint missed;      /* Number of cycles that missed their deadline */
+    track_stats_t freqerr[2]; /* Downlink and uplink frequency errors (Hz) */
+    gint64 iotime;     /* Time spent waiting for rigctld this cycle (usec) */
+
     gboolean lastrxptt; /* PTT state of last rx cycle. */
     gboolean lasttxptt; /* PTT state of last tx cycle. */
 
     gdouble lastrxf; /* Last frequency sent to receiver. */
     gdouble lasttxf; /* Last frequency sent to tranmitter. */
     gdouble du,
-        dd; /* Last computed up/down Doppler shift; computed in update() */
+        dd; /* Last computed up/down Doppler shift; see predict_doppler() */
+
+    /* Doppler prediction; see update_range_rate() and predict_doppler() */
+    gdouble rr;        /* Range rate at last update (km/s) */
+    gdouble rrdot;     /* Range rate derivative at last update (km/s/s) */
+    gdouble trate;     /* Module time seconds per real time second */
+    gint64 rrtime;     /* Monotonic time of last update (usec) */
+    gdouble tprev;     /* Module time of last update (Julian date) */
+    gdouble ddrate;    /* Rate of change of downlink Doppler shift (Hz/s) */
+    gdouble durate;    /* Rate of change of uplink Doppler shift (Hz/s) */
+    gdouble latency;   /* Average set-frequency latency of rig 1 (sec) */
+    gdouble latency2;  /* Average set-frequency latency of rig 2 (sec) */
 
     gint64 last_toggle_tx; /* Last time when exec_toggle_tx_cycle() was executed
                               (seconds) -1 indicates that an update should be
                               performed ASAP */
 
-    gint sock, sock2; /* Sockets for controlling the radio(s). */
+    gint sock, sock2; /* Sockets for controlling the radio(s), -1 if closed. */
 
     /* debug related */
     guint wrops;
@@ -94,8 +181,6 @@ struct _gtk_rig_ctrl {
     /* add mutexes etc, to make threads reentrant! */
     GMutex writelock;           /* Mutex for blocking write operation */
     GMutex rig_ctrl_updatelock; /* Mutex while updating widgets etc */
-    GMutex widgetsync;          /* Mutex used while leaving (sync stuff) */
-    GCond widgetready;          /* Condition when work is done (sync stuff) */
     GAsyncQueue *rigctlq; /* Message queue to indicate something has changed */
     GThread *rigctl_thread; /* Pointer to current rigctl-thread */
 };
@@ -108,5 +193,6 @@ GType gtk_rig_ctrl_get_type(void);
 GtkWidget *gtk_rig_ctrl_new(GtkSatModule *module);
 void gtk_rig_ctrl_update(GtkRigCtrl *ctrl, gdouble t);
 void gtk_rig_ctrl_select_sat(GtkRigCtrl *ctrl, gint catnum);
+doppler_sched_t *gtk_rig_ctrl_get_doppler_sched(GtkRigCtrl *ctrl);
 
 #endif /* __GTK_RIG_CTRL_H__ */
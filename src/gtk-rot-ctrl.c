@@ -34,168 +34,32 @@
 
 #define _GNU_SOURCE /* needed for strcasestr */
 
-/* NETWORK */
-#ifndef WIN32
-#include <arpa/inet.h>  /* htons() */
-#include <netdb.h>      /* gethostbyname() */
-#include <netinet/in.h> /* struct sockaddr_in */
-#include <sys/socket.h> /* socket(), connect(), send() */
-#else
-#include <winsock2.h>
-#endif
-
-#include <errno.h>
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <math.h>
 
-#include <string.h> /* strerror, strcasestr */
+#include <string.h> /* strcasestr */
 
 #include "compat.h"
 #include "gpredict-utils.h"
 #include "gtk-polar-plot.h"
 #include "gtk-rot-ctrl.h"
 #include "gtk-rot-knob.h"
+#include "hamlib-client.h"
 #include "predict-tools.h"
 #include "sat-log.h"
 
 #define FMTSTR "%7.2f\302\260"
 #define MAX_ERROR_COUNT 5
+#define CONNECT_TIMEOUT 2000 /* msec to wait for connection to rotctld */
+#define MIN_TIMEOUT 1000     /* min msec to wait for rotctld to respond */
+#define POLL_FAST 50         /* min msec between polls while moving */
+#define POLL_SLOW 1000       /* min msec between polls while idle */
+#define MOVE_EPS 0.05        /* smaller position changes (deg) mean idle */
 
 static GtkVBoxClass *parent_class = NULL;
 
-/* Open the rotcld socket. Returns file descriptor or -1 if an error occurs */
-static gint rotctld_socket_open(const gchar *host, gint port)
-{
-    struct sockaddr_in ServAddr;
-    struct hostent *h;
-    gint sock;
-    gint status;
-
-    sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (sock == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Failed to create rotctl socket: %s"), strerror(errno));
-        return sock;
-    }
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                _("%s: Network socket created successfully"), __func__);
-
-    memset(&ServAddr, 0, sizeof(ServAddr));
-    ServAddr.sin_family = AF_INET; /* Internet address family */
-    h = gethostbyname(host);
-    if (h == NULL)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Name resolution of rotctld server %s failed."), host);
-#ifdef WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
-        return -1;
-    }
-
-    memcpy((char *)&ServAddr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
-    ServAddr.sin_port = htons(port); /* Server port */
-
-    /* establish connection */
-    status = connect(sock, (struct sockaddr *)&ServAddr, sizeof(ServAddr));
-    if (status == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("Connection to rotctld server at %s:%d failed: %s"), host,
-                    port, strerror(errno));
-
-#ifdef WIN32
-        closesocket(sock);
-#else
-        close(sock);
-#endif
-        return -1;
-    }
-
-    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Connection opened to %s:%d"),
-                __func__, host, port);
-
-    return sock;
-}
-
-/* Close a rotcld socket. First send a q command to cleanly shut down rotctld */
-static void rotctld_socket_close(gint *sock)
-{
-    gint written;
-
-    /*shutdown the rotctld connect */
-    written = send(*sock, "q\x0a", 2, 0);
-    if (written != 2)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%s: Sent 2 bytes but sent %d."),
-                    __FILE__, __func__, written);
-    }
-
-#ifndef WIN32
-    shutdown(*sock, SHUT_RDWR);
-    close(*sock);
-#else
-    shutdown(*sock, SD_BOTH);
-    closesocket(*sock);
-#endif
-
-    *sock = -1;
-}
-
-/*
- * Send a command to rotctld and read the response.
- *
- * Inputs are the socket, a string command, and a buffer and length for
- * returning the output from rotctld.
- */
-static gboolean rotctld_socket_rw(gint sock, gchar *buff, gchar *buffout,
-                                  gint sizeout)
-{
-    gint written;
-    gint size;
-
-    size = strlen(buff);
-
-    /* send command */
-    written = send(sock, buff, size, 0);
-    if (written != size)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: SIZE ERROR %d / %d"), __func__,
-                    written, size);
-    }
-    if (written == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rotctld Socket Down"),
-                    __func__);
-        return FALSE;
-    }
-
-    /* try to read answer */
-    size = recv(sock, buffout, sizeout, 0);
-
-    if (size == -1)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rotctld Socket Down"),
-                    __func__);
-        return FALSE;
-    }
-
-    buffout[size] = '\0';
-    if (size == 0)
-    {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%s: Got 0 bytes from rotctld"),
-                    __FILE__, __func__);
-    }
-
-    return TRUE;
-}
-
 static gint sat_name_compare(sat_t *a, sat_t *b)
 {
     return (gpredict_strcmp(a->nickname, b->nickname));
@@ -284,180 +148,332 @@ static inline void set_flipped_pass(GtkRotCtrl *ctrl)
                                         ctrl->conf->azstoppos);
 }
 
-/**
- * Read rotator position from device.
+/* Get the current or the next pass of the target from the module */
+static pass_t *get_target_pass(GtkRotCtrl *ctrl, gdouble t, gboolean current)
+{
+    return pass_cache_get_pass(ctrl->passcache, ctrl->target, ctrl->qth, t,
+                               current);
+}
+
+/*
+ * Plan the rotator commands for the current pass.
  *
- * \param ctrl Pointer to the GtkRotCtrl widget.
- * \param az The current Az as read from the device
- * \param el The current El as read from the device
- * \return TRUE if the position was successfully retrieved, FALSE if an
- *         error occurred.
+ * This is done whenever the pass, the rotator or the threshold changes. The
+ * plan decides whether the pass is flipped; without one the controller falls
+ * back to following the target.
  */
-static gboolean get_pos(GtkRotCtrl *ctrl, gdouble *az, gdouble *el)
+static void update_plan(GtkRotCtrl *ctrl)
 {
-    gchar *buff, **vbuff;
-    gchar buffback[128];
-    gboolean retcode;
+    rot_track_t *track;
+    gboolean havepos = FALSE;
+    gdouble az = 0.0;
+
+    rot_plan_free(ctrl->plan);
+    ctrl->plan = NULL;
+    ctrl->plancmd = NULL;
+
+    set_flipped_pass(ctrl);
+
+    if (ctrl->conf == NULL || ctrl->pass == NULL || ctrl->target == NULL)
+        return;
 
-    if ((az == NULL) || (el == NULL))
+    /* start the pass on the side of the stops where the rotator is */
+    if (ctrl->engaged)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s:%d: NULL storage."), __FILE__,
-                    __LINE__);
-        return FALSE;
+        g_mutex_lock(&ctrl->client.mutex);
+        havepos = !ctrl->client.io_error;
+        az = ctrl->client.azi_in;
+        g_mutex_unlock(&ctrl->client.mutex);
     }
 
-    /* send command */
-    buff = g_strdup_printf("p\x0a");
-    retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
+    /* the track is shared with other rotators following the target */
+    track = pass_cache_get_track(ctrl->passcache, ctrl->target, ctrl->qth,
+                                 ctrl->pass);
+    if (track == NULL)
+        return;
 
-    /* try to parse answer */
-    if (retcode)
-    {
-        if (strncmp(buffback, "RPRT", 4) == 0)
-        {
-            g_strstrip(buffback);
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s:%d: rotctld returned error (%s)"), __FILE__,
-                        __LINE__, buffback);
-            retcode = FALSE;
-        }
-        else
-        {
-            vbuff = g_strsplit(buffback, "\n", 3);
-            if ((vbuff[0] != NULL) && (vbuff[1] != NULL))
-            {
-                *az = g_strtod(vbuff[0], NULL);
-                *el = g_strtod(vbuff[1], NULL);
-            }
-            else
-            {
-                g_strstrip(buffback);
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%d: rotctld returned bad response (%s)"),
-                            __FILE__, __LINE__, buffback);
-                retcode = FALSE;
-            }
+    ctrl->plan = rot_plan_new(track, ctrl->conf, ctrl->threshold,
+                              ctrl->delay / 1000.0, havepos, az);
+    rot_track_unref(track);
+    if (ctrl->plan != NULL)
+        ctrl->flipped = ctrl->plan->flipped;
+}
 
-            g_strfreev(vbuff);
-        }
-    }
+/* Parse a RPRT response; returns the error code or 1 if it is not one */
+static gint parse_rprt(const gchar *resp)
+{
+    if (strncmp(resp, "RPRT", 4) != 0)
+        return 1;
 
-    g_free(buff);
+    return (gint)g_ascii_strtoll(resp + 4, NULL, 10);
+}
+
+/* Parse the response to a p command */
+static gboolean parse_pos(const gchar *resp, gdouble *az, gdouble *el)
+{
+    gchar *end;
+
+    if (parse_rprt(resp) != 1)
+        return FALSE;
+
+    *az = g_ascii_strtod(resp, &end);
+    if (end == resp || *end != '\n')
+        return FALSE;
 
-    return retcode;
+    resp = end + 1;
+    *el = g_ascii_strtod(resp, &end);
+
+    return (end != resp);
 }
 
-/**
- * Send new position to rotator device
- *
- * \param ctrl Pointer to the GtkRotCtrl widget
- * \param az The new Azimuth
- * \param el The new Elevation
- * \return TRUE if the new position has been sent successfully
- *         FALSE if an error occurred
+/*
+ * Execute one request to rotctld: an optional P command followed by a p
+ * command, pipelined.
  *
- * \note The function does not perform any range check since the GtkRotKnob
- * should always keep its value within range.
+ * Returns TRUE if the position was read and the target, if any, accepted.
+ * The connection is reopened if the request times out or fails; sock is -1
+ * if that does not succeed.
  */
-static gboolean set_pos(GtkRotCtrl *ctrl, gdouble az, gdouble el)
+static gboolean rotctld_set_get_pos(GtkRotCtrl *ctrl, gint *sock, guint cycle,
+                                    gboolean settrg, gdouble tazi,
+                                    gdouble tele, gdouble *azi, gdouble *ele)
 {
-    gchar *buff;
-    gchar buffback[128];
-    gboolean retcode;
-    gint retval;
+    hamlib_req_t req;
+    gchar cmd[64];
+    gchar azbuf[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar elbuf[G_ASCII_DTOSTR_BUF_SIZE];
+    gdouble az, el;
+    gboolean setok = TRUE, getok;
+    gint64 t0;
+    guint i = 0;
+
+    hamlib_req_init(&req, *sock, MAX((gint)cycle, MIN_TIMEOUT));
+    if (settrg)
+    {
+        /* rotctld always expects a decimal point */
+        g_snprintf(cmd, sizeof(cmd), "P %s %s\x0a",
+                   g_ascii_formatd(azbuf, sizeof(azbuf), "%.2f", tazi),
+                   g_ascii_formatd(elbuf, sizeof(elbuf), "%.2f", tele));
+        hamlib_req_add(&req, cmd, 1);
+    }
+    hamlib_req_add(&req, "p\x0a", 2);
 
-    /* send command */
-    buff = g_strdup_printf("P %.2f %.2f\x0a", az, el);
-    retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
-    g_free(buff);
+    g_mutex_lock(&ctrl->client.mutex);
+    if (settrg)
+        io_stats_request(&ctrl->client.setstats, req.ncmd);
+    io_stats_request(&ctrl->client.getstats, req.ncmd);
+    g_mutex_unlock(&ctrl->client.mutex);
 
-    if (retcode == TRUE)
+    hamlib_req_run(&req, 1);
+
+    g_mutex_lock(&ctrl->client.mutex);
+    if (settrg)
     {
-        /* treat errors as soft errors */
-        retval = (gint)g_strtod(buffback + 4, NULL);
-        if (retval != 0)
+        setok = (req.nresp > 0 && parse_rprt(req.resp[0]) == 0);
+        if (req.nresp > 0)
+            io_stats_response(&ctrl->client.setstats,
+                              req.rtime[0] - req.start, setok);
+        else
+            io_stats_timeout(&ctrl->client.setstats, 1);
+        if (req.nresp > 0 && !setok)
         {
-            g_strstrip(buffback);
-            sat_log_log(
-                SAT_LOG_LEVEL_ERROR,
-                _("%s:%d: rotctld returned error %d with az %f el %f(%s)"),
-                __FILE__, __LINE__, retval, az, el, buffback);
-            retcode = FALSE;
+            g_strstrip(req.resp[0]);
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: rotctld returned error with az %f el %f (%s)"),
+                        __func__, tazi, tele, req.resp[0]);
         }
+        i = 1;
     }
 
-    return (retcode);
+    /* the p command is served after the P command */
+    t0 = (i > 0 && req.nresp > 0) ? req.rtime[0] : req.start;
+    getok = (req.nresp > i && parse_pos(req.resp[i], &az, &el));
+    if (getok)
+    {
+        *azi = az;
+        *ele = el;
+    }
+    if (req.nresp > i)
+        io_stats_response(&ctrl->client.getstats, req.rtime[i] - t0, getok);
+    else
+        io_stats_timeout(&ctrl->client.getstats, 1);
+    if (req.nresp > i && !getok)
+    {
+        g_strstrip(req.resp[i]);
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: rotctld returned bad response (%s)"), __func__,
+                    req.resp[i]);
+    }
+    g_mutex_unlock(&ctrl->client.mutex);
+
+    if (req.status == HAMLIB_REQ_TIMEOUT)
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: rotctld did not respond within %d msec"), __func__,
+                    MAX((gint)cycle, MIN_TIMEOUT));
+    else if (req.status == HAMLIB_REQ_FAILED && *sock >= 0)
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: rotctld port closed"),
+                    __func__);
+
+    /* a late reply would be read as the reply to the next request */
+    if (req.status == HAMLIB_REQ_TIMEOUT || req.status == HAMLIB_REQ_FAILED)
+    {
+        if (*sock >= 0)
+            hamlib_close(*sock);
+        *sock = hamlib_open(ctrl->conf->host, ctrl->conf->port,
+                            CONNECT_TIMEOUT);
+    }
+
+    return (setok && getok);
+}
+
+/* Stop the rotator */
+static void rotctld_stop(gint sock)
+{
+    hamlib_req_t req;
+
+    hamlib_req_init(&req, sock, MIN_TIMEOUT);
+    hamlib_req_add(&req, "S\x0a", 1);
+    if (!hamlib_req_run(&req, 1) || parse_rprt(req.resp[0]) != 0)
+    {
+        g_strstrip(req.resp[0]);
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: rotctld returned error with stop-cmd (%s)"),
+                    __func__, req.resp[0]);
+    }
 }
 
-/* Rotctl client thread */
+/*
+ * Rotctl client thread
+ *
+ * The thread sleeps until the controller passes it a new target or the
+ * position is due to be read. Targets that arrive while a request is in
+ * progress are coalesced; only the latest one is sent. The position is read
+ * with every command and polled often while the rotator moves and rarely
+ * while it is idle. Either way rotctld is kept busy at most half the time.
+ */
 static gpointer rotctld_client_thread(gpointer data)
 {
-    gdouble elapsed_time;
-    gdouble azi = 0.0;
-    gdouble ele = 0.0;
-    gboolean new_trg = FALSE;
-    gboolean io_error = FALSE;
     GtkRotCtrl *ctrl = GTK_ROT_CTRL(data);
+    gdouble azi = 0.0, ele = 0.0;
+    gdouble lastazi = 0.0, lastele = 0.0;
+    gdouble tazi, tele;
+    gboolean settrg, pending, moving, ok;
+    gint64 start, now, next_set = 0, next_poll = 0, deadline, interval;
+    guint cycle;
+    gint sock;
 
-    g_print("Starting rotctld client thread\n");
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Starting rotctld client thread"),
+                __func__);
 
-    ctrl->client.socket =
-        rotctld_socket_open(ctrl->conf->host, ctrl->conf->port);
-    if (ctrl->client.socket == -1)
+    sock = hamlib_open(ctrl->conf->host, ctrl->conf->port, CONNECT_TIMEOUT);
+    if (sock == -1)
+    {
+        g_mutex_lock(&ctrl->client.mutex);
+        ctrl->client.io_error = TRUE;
+        g_mutex_unlock(&ctrl->client.mutex);
         return GINT_TO_POINTER(-1);
+    }
 
-    ctrl->client.timer = g_timer_new();
-
-    ctrl->client.new_trg = FALSE;
-    ctrl->client.running = TRUE;
-
+    g_mutex_lock(&ctrl->client.mutex);
     while (ctrl->client.running)
     {
-        g_timer_start(ctrl->client.timer);
-        io_error = FALSE;
-
-        g_mutex_lock(&ctrl->client.mutex);
-        if (ctrl->client.new_trg)
+        now = g_get_monotonic_time();
+        pending = ctrl->client.new_trg && !ctrl->monitor;
+        settrg = pending && now >= next_set;
+        if (!settrg && now < next_poll)
         {
-            azi = ctrl->client.azi_out;
-            ele = ctrl->client.ele_out;
-            new_trg = ctrl->client.new_trg;
+            deadline = pending ? MIN(next_poll, next_set) : next_poll;
+            g_cond_wait_until(&ctrl->client.cond, &ctrl->client.mutex,
+                              deadline);
+            continue;
         }
-        g_mutex_unlock(&ctrl->client.mutex);
 
-        if (new_trg && !ctrl->monitor)
-        {
-            if (set_pos(ctrl, azi, ele))
-                new_trg = FALSE;
-            else
-                io_error = TRUE;
-        }
+        tazi = ctrl->client.azi_out;
+        tele = ctrl->client.ele_out;
+        if (settrg)
+            ctrl->client.new_trg = FALSE;
+        cycle = ctrl->client.cycle;
+        g_mutex_unlock(&ctrl->client.mutex);
 
-        /* wait 100 ms before sending new command */
-        g_usleep(100000);
-        if (!get_pos(ctrl, &azi, &ele))
-            io_error = TRUE;
+        start = g_get_monotonic_time();
+        ok = rotctld_set_get_pos(ctrl, &sock, cycle, settrg, tazi, tele, &azi,
+                                 &ele);
+        now = g_get_monotonic_time();
+
+        moving = settrg || fabs(azi - lastazi) > MOVE_EPS ||
+                 fabs(ele - lastele) > MOVE_EPS;
+        lastazi = azi;
+        lastele = ele;
+
+        /* poll fast while moving; keep the duty cycle of rotctld below 50% */
+        if (!ok)
+            interval = POLL_SLOW;
+        else if (moving)
+            interval = MAX(cycle / 2, POLL_FAST);
+        else
+            interval = MAX(cycle, POLL_SLOW);
+        next_set = now + (now - start);
+        next_poll = now + MAX(now - start, interval * 1000);
 
         g_mutex_lock(&ctrl->client.mutex);
         ctrl->client.azi_in = azi;
         ctrl->client.ele_in = ele;
-        ctrl->client.new_trg = new_trg;
-        ctrl->client.io_error = io_error;
-        g_mutex_unlock(&ctrl->client.mutex);
+        ctrl->client.io_error = !ok;
+
+        /* retry a rejected target unless there is a newer one */
+        if (settrg && !ok && !ctrl->client.new_trg)
+        {
+            ctrl->client.new_trg = TRUE;
+            io_stats_retry(&ctrl->client.setstats);
+        }
+    }
+    g_mutex_unlock(&ctrl->client.mutex);
 
-        /* ensure rotctl duty cycle stays below 50%, but wait at least 700 ms
-         * (TBC) */
-        elapsed_time = MAX(g_timer_elapsed(ctrl->client.timer, NULL), 0.7);
-        g_usleep(elapsed_time * 1e6);
+    if (sock >= 0)
+    {
+        rotctld_stop(sock);
+        hamlib_close(sock);
     }
 
-    g_print("Stopping rotctld client thread\n");
-    g_timer_destroy(ctrl->client.timer);
-    rotctld_socket_close(&ctrl->client.socket);
+    io_stats_log("rotctld P", &ctrl->client.setstats);
+    io_stats_log("rotctld p", &ctrl->client.getstats);
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Stopping rotctld client thread"),
+                __func__);
 
     return GINT_TO_POINTER(0);
 }
 
+/* Start the rotctld client thread */
+static void start_client(GtkRotCtrl *ctrl)
+{
+    g_mutex_lock(&ctrl->client.mutex);
+    ctrl->client.running = TRUE;
+    ctrl->client.new_trg = FALSE;
+    ctrl->client.io_error = FALSE;
+    ctrl->client.cycle = ctrl->delay;
+    io_stats_reset(&ctrl->client.setstats);
+    io_stats_reset(&ctrl->client.getstats);
+    g_mutex_unlock(&ctrl->client.mutex);
+
+    ctrl->client.thread =
+        g_thread_new("gpredict_rotctl", rotctld_client_thread, ctrl);
+}
+
+/* Stop the rotctld client thread; it stops the rotator before it exits */
+static void stop_client(GtkRotCtrl *ctrl)
+{
+    if (ctrl->client.thread == NULL)
+        return;
+
+    g_mutex_lock(&ctrl->client.mutex);
+    ctrl->client.running = FALSE;
+    g_cond_signal(&ctrl->client.cond);
+    g_mutex_unlock(&ctrl->client.mutex);
+
+    g_thread_join(ctrl->client.thread);
+    ctrl->client.thread = NULL;
+}
+
 /**
  * Update count down label.
  *
@@ -534,10 +550,10 @@ void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t)
             {
                 free_pass(ctrl->pass);
                 ctrl->pass = NULL;
-                ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
+                ctrl->pass = get_target_pass(ctrl, t, FALSE);
                 if (ctrl->pass)
                 {
-                    set_flipped_pass(ctrl);
+                    update_plan(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -557,8 +573,8 @@ void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t)
                     /* inside an unexpected/unpredicted pass */
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
-                    ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
-                    set_flipped_pass(ctrl);
+                    ctrl->pass = get_target_pass(ctrl, t, TRUE);
+                    update_plan(ctrl);
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
                 }
@@ -574,8 +590,8 @@ void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t)
                     /* if the next pass is not the one for the target */
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
-                    ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
+                    ctrl->pass = get_target_pass(ctrl, t, FALSE);
+                    update_plan(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -589,8 +605,8 @@ void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t)
                 {
                     free_pass(ctrl->pass);
                     ctrl->pass = NULL;
-                    ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
-                    set_flipped_pass(ctrl);
+                    ctrl->pass = get_target_pass(ctrl, t, FALSE);
+                    update_plan(ctrl);
                     /* update polar plot */
                     gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot),
                                             ctrl->pass);
@@ -601,11 +617,11 @@ void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t)
         {
             /* we don't have any current pass; store the current one */
             if (ctrl->target->el > 0.0)
-                ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, t);
+                ctrl->pass = get_target_pass(ctrl, t, TRUE);
             else
-                ctrl->pass = get_pass(ctrl->target, ctrl->qth, t, 3.0);
+                ctrl->pass = get_target_pass(ctrl, t, FALSE);
 
-            set_flipped_pass(ctrl);
+            update_plan(ctrl);
             /* update polar plot */
             gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot), ctrl->pass);
         }
@@ -632,6 +648,23 @@ void gtk_rot_ctrl_select_sat(GtkRotCtrl *ctrl, gint catnum)
     }
 }
 
+/*
+ * Forget the pass of a satellite whose data has changed.
+ *
+ * The pass and the plan of the target are predicted again on the next
+ * update; other satellites are ignored.
+ */
+void gtk_rot_ctrl_reload_sat(GtkRotCtrl *ctrl, sat_t *sat)
+{
+    if (ctrl->target == NULL || ctrl->target->tle.catnr != sat->tle.catnr)
+        return;
+
+    free_pass(ctrl->pass);
+    ctrl->pass = NULL;
+    update_plan(ctrl);
+    gtk_polar_plot_set_pass(GTK_POLAR_PLOT(ctrl->plot), NULL);
+}
+
 /*
  * Create azimuth control widgets.
  *
@@ -763,6 +796,52 @@ static void track_toggle_cb(GtkToggleButton *button, gpointer data)
                              !(ctrl->tracking || locked));
     gtk_widget_set_sensitive(ctrl->AzSet, !ctrl->tracking);
     gtk_widget_set_sensitive(ctrl->ElSet, !ctrl->tracking);
+
+    /* the knobs may have been moved by hand; resend the current command */
+    ctrl->plancmd = NULL;
+}
+
+/*
+ * Pass a new target position to the rotctld client thread.
+ *
+ * Returns FALSE if the client was busy; the caller should try again in the
+ * next cycle.
+ */
+static gboolean send_target_pos(GtkRotCtrl *ctrl, gdouble az, gdouble el)
+{
+    gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->AzSet), az);
+    gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->ElSet), el);
+
+    if (!g_mutex_trylock(&ctrl->client.mutex))
+        return FALSE;
+
+    ctrl->client.azi_out = az;
+    ctrl->client.ele_out = el;
+    ctrl->client.new_trg = TRUE;
+    g_cond_signal(&ctrl->client.cond);
+    g_mutex_unlock(&ctrl->client.mutex);
+
+    return TRUE;
+}
+
+/*
+ * Angle between the direction to the satellite and where the rotator points
+ * (deg). Working on the directions rather than on az and el handles flipped
+ * passes and azimuths beyond 360 deg without special cases.
+ */
+static gdouble pointing_error(gdouble sataz, gdouble satel, gdouble rotaz,
+                              gdouble rotel)
+{
+    gdouble dot;
+
+    sataz *= de2ra;
+    satel *= de2ra;
+    rotaz *= de2ra;
+    rotel *= de2ra;
+    dot = cos(satel) * cos(rotel) * cos(sataz - rotaz) +
+          sin(satel) * sin(rotel);
+
+    return acos(CLAMP(dot, -1.0, 1.0)) / de2ra;
 }
 
 /**
@@ -779,6 +858,7 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
     gchar *text;
     gboolean error = FALSE;
     sat_t sat_working, *sat;
+    const rot_plan_cmd_t *cmd = NULL;
 
     /* parameters for path predictions */
     gdouble time_delta;
@@ -795,45 +875,57 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
      */
     if (ctrl->tracking && ctrl->target)
     {
-        if (ctrl->target->el < 0.0)
+        if (ctrl->plan != NULL)
+            cmd = rot_plan_lookup(ctrl->plan, ctrl->t);
+
+        if (cmd != NULL)
+        {
+            /* the plan is already mapped onto the rotator travel */
+            setaz = cmd->az;
+            setel = cmd->el;
+        }
+        else
         {
-            if (ctrl->pass != NULL)
+            if (ctrl->target->el < 0.0)
             {
-                if (ctrl->t < ctrl->pass->aos)
+                if (ctrl->pass != NULL)
                 {
-                    setaz = SAFE_AZI(ctrl->pass->aos_az);
-                    setel = SAFE_ELE(0.0);
-                }
-                else if (ctrl->t > ctrl->pass->los)
-                {
-                    setaz = SAFE_AZI(ctrl->pass->los_az);
-                    setel = SAFE_ELE(0.0);
+                    if (ctrl->t < ctrl->pass->aos)
+                    {
+                        setaz = SAFE_AZI(ctrl->pass->aos_az);
+                        setel = SAFE_ELE(0.0);
+                    }
+                    else if (ctrl->t > ctrl->pass->los)
+                    {
+                        setaz = SAFE_AZI(ctrl->pass->los_az);
+                        setel = SAFE_ELE(0.0);
+                    }
                 }
             }
-        }
-        else
-        {
-            setaz = SAFE_AZI(ctrl->target->az);
-            setel = SAFE_ELE(ctrl->target->el);
-        }
-        /* if this is a flipped pass and the rotor supports it */
-        if ((ctrl->flipped) && (ctrl->conf->maxel >= 180.0))
-        {
-            setel = 180 - setel;
-            if (setaz > 180)
-                setaz -= 180;
             else
-                setaz += 180;
+            {
+                setaz = SAFE_AZI(ctrl->target->az);
+                setel = SAFE_ELE(ctrl->target->el);
+            }
+            /* if this is a flipped pass and the rotor supports it */
+            if ((ctrl->flipped) && (ctrl->conf->maxel >= 180.0))
+            {
+                setel = 180 - setel;
+                if (setaz > 180)
+                    setaz -= 180;
+                else
+                    setaz += 180;
 
-            while (setaz > ctrl->conf->maxaz)
-                setaz -= 360;
+                while (setaz > ctrl->conf->maxaz)
+                    setaz -= 360;
 
-            while (setaz < ctrl->conf->minaz)
-                setaz += 360;
-        }
+                while (setaz < ctrl->conf->minaz)
+                    setaz += 360;
+            }
 
-        if ((ctrl->conf->aztype == ROT_AZ_TYPE_180) && (setaz > 180.0))
-            setaz = setaz - 360.0;
+            if ((ctrl->conf->aztype == ROT_AZ_TYPE_180) && (setaz > 180.0))
+                setaz = setaz - 360.0;
+        }
 
         if (!(ctrl->engaged))
         {
@@ -856,8 +948,12 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
             error = ctrl->client.io_error;
             rotaz = ctrl->client.azi_in;
             rotel = ctrl->client.ele_in;
+            text = io_stats_summary(&ctrl->client.getstats);
             g_mutex_unlock(&ctrl->client.mutex);
 
+            gtk_label_set_text(GTK_LABEL(ctrl->IoStats), text);
+            g_free(text);
+
             /* ensure Azimuth angle is 0-360 degrees */
             while (rotaz < 0.0)
                 rotaz += 360.0;
@@ -891,13 +987,25 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
                     gtk_polar_plot_set_rotor_pos(GTK_POLAR_PLOT(ctrl->plot),
                                                  rotaz, rotel);
                 }
+
+                if (ctrl->tracking && ctrl->target && ctrl->target->el >= 0.0)
+                    track_stats_add(&ctrl->pointerr,
+                                    pointing_error(ctrl->target->az,
+                                                   ctrl->target->el, rotaz,
+                                                   rotel));
             }
         }
 
-        /* if tolerance exceeded */
-        if ((fabs(setaz - rotaz) > ctrl->threshold) ||
-            (fabs(setel - rotel) > ctrl->threshold))
+        if (cmd != NULL)
         {
+            /* follow the plan; a command is only sent once it is due */
+            if (cmd != ctrl->plancmd && send_target_pos(ctrl, setaz, setel))
+                ctrl->plancmd = cmd;
+        }
+        else if ((fabs(setaz - rotaz) > ctrl->threshold) ||
+                 (fabs(setel - rotel) > ctrl->threshold))
+        {
+            /* tolerance exceeded */
             if (ctrl->tracking)
             {
                 /* if we are in a pass try to lead the satellite
@@ -978,15 +1086,7 @@ static gboolean rot_ctrl_timeout_cb(gpointer data)
             /* send controller values to rotator device */
             /* this is the newly computed value which should be ahead of the
              * current position */
-            gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->AzSet), setaz);
-            gtk_rot_knob_set_value(GTK_ROT_KNOB(ctrl->ElSet), setel);
-            if (g_mutex_trylock(&ctrl->client.mutex))
-            {
-                ctrl->client.azi_out = setaz;
-                ctrl->client.ele_out = setel;
-                ctrl->client.new_trg = TRUE;
-                g_mutex_unlock(&ctrl->client.mutex);
-            }
+            send_target_pos(ctrl, setaz, setel);
         }
 
         /* check error status */
@@ -1071,10 +1171,32 @@ static void delay_changed_cb(GtkSpinButton *spin, gpointer data)
     if (ctrl->conf)
         ctrl->conf->cycle = ctrl->delay;
 
+    g_mutex_lock(&ctrl->client.mutex);
+    ctrl->client.cycle = ctrl->delay;
+    g_mutex_unlock(&ctrl->client.mutex);
+
     if (ctrl->timerid > 0)
         g_source_remove(ctrl->timerid);
 
     ctrl->timerid = g_timeout_add(ctrl->delay, rot_ctrl_timeout_cb, ctrl);
+
+    /* commands can not be sent more often than once per cycle */
+    update_plan(ctrl);
+}
+
+/* Show the I/O statistics of the rotator */
+static void io_stats_cb(GtkButton *button, gpointer data)
+{
+    GtkRotCtrl *ctrl = GTK_ROT_CTRL(data);
+    io_report_t report = {0};
+
+    g_mutex_lock(&ctrl->client.mutex);
+    io_report_add_io(&report, _("Set position (P)"), &ctrl->client.setstats);
+    io_report_add_io(&report, _("Get position (p)"), &ctrl->client.getstats);
+    g_mutex_unlock(&ctrl->client.mutex);
+    io_report_add_error(&report, _("Pointing error (deg)"), &ctrl->pointerr);
+
+    io_report_dialog(GTK_WIDGET(button), _("Rotator I/O Statistics"), &report);
 }
 
 /**
@@ -1093,6 +1215,8 @@ static void threshold_changed_cb(GtkSpinButton *spin, gpointer data)
     ctrl->threshold = gtk_spin_button_get_value(spin);
     if (ctrl->conf)
         ctrl->conf->threshold = ctrl->threshold;
+
+    update_plan(ctrl);
 }
 
 /**
@@ -1144,8 +1268,8 @@ static void rot_selected_cb(GtkComboBox *box, gpointer data)
         gtk_rot_knob_set_range(GTK_ROT_KNOB(ctrl->ElSet), ctrl->conf->minel,
                                ctrl->conf->maxel);
 
-        /* Update flipped when changing rotor if there is a plot */
-        set_flipped_pass(ctrl);
+        /* Update the plan when changing rotor if there is a pass */
+        update_plan(ctrl);
     }
     else
     {
@@ -1187,10 +1311,6 @@ static void rot_monitor_cb(GtkCheckButton *button, gpointer data)
 static void rot_locked_cb(GtkToggleButton *button, gpointer data)
 {
     GtkRotCtrl *ctrl = GTK_ROT_CTRL(data);
-    gchar *buff;
-    gchar buffback[128];
-    gboolean retcode;
-    gint retval;
 
     if (!gtk_toggle_button_get_active(button))
     {
@@ -1199,31 +1319,8 @@ static void rot_locked_cb(GtkToggleButton *button, gpointer data)
         gtk_label_set_text(GTK_LABEL(ctrl->AzRead), "---");
         gtk_label_set_text(GTK_LABEL(ctrl->ElRead), "---");
 
-        if (!ctrl->client.running)
-            /* client thread is not running; nothing to do */
-            return;
-
-        /* stop moving rotor */
-        /** FIXME: should use high level func */
-        buff = g_strdup_printf("S\x0a");
-        retcode = rotctld_socket_rw(ctrl->client.socket, buff, buffback, 128);
-        g_free(buff);
-        if (retcode == TRUE)
-        {
-            /* treat errors as soft errors */
-            retval = (gint)g_strtod(buffback + 4, NULL);
-            if (retval != 0)
-            {
-                g_strstrip(buffback);
-                sat_log_log(
-                    SAT_LOG_LEVEL_ERROR,
-                    _("%s:%d: rotctld returned error %d with stop-cmd (%s)"),
-                    __FILE__, __LINE__, retval, buffback);
-            }
-        }
-
-        ctrl->client.running = FALSE;
-        g_thread_join(ctrl->client.thread);
+        stop_client(ctrl);
+        track_stats_log(_("Pointing error (deg)"), &ctrl->pointerr);
     }
     else
     {
@@ -1236,11 +1333,12 @@ static void rot_locked_cb(GtkToggleButton *button, gpointer data)
             return;
         }
 
-        ctrl->client.thread =
-            g_thread_new("gpredict_rotctl", rotctld_client_thread, ctrl);
+        start_client(ctrl);
+        memset(&ctrl->pointerr, 0, sizeof(ctrl->pointerr));
 
         gtk_widget_set_sensitive(ctrl->DevSel, FALSE);
         ctrl->engaged = TRUE;
+        ctrl->plancmd = NULL;
     }
 }
 
@@ -1277,11 +1375,11 @@ static void sat_selected_cb(GtkComboBox *satsel, gpointer data)
             free_pass(ctrl->pass);
 
         if (ctrl->target->el > 0.0)
-            ctrl->pass = get_current_pass(ctrl->target, ctrl->qth, ctrl->t);
+            ctrl->pass = get_target_pass(ctrl, ctrl->t, TRUE);
         else
-            ctrl->pass = get_pass(ctrl->target, ctrl->qth, ctrl->t, 3.0);
+            ctrl->pass = get_target_pass(ctrl, ctrl->t, FALSE);
 
-        set_flipped_pass(ctrl);
+        update_plan(ctrl);
     }
     else
     {
@@ -1291,6 +1389,7 @@ static void sat_selected_cb(GtkComboBox *satsel, gpointer data)
             free_pass(ctrl->pass);
             ctrl->pass = NULL;
         }
+        update_plan(ctrl);
     }
 
     /* in either case, we set the new pass (even if NULL) on the polar plot */
@@ -1383,7 +1482,7 @@ static GtkWidget *create_target_widgets(GtkRotCtrl *ctrl)
 
 static GtkWidget *create_conf_widgets(GtkRotCtrl *ctrl)
 {
-    GtkWidget *frame, *table, *label;
+    GtkWidget *frame, *table, *label, *button;
     GDir *dir = NULL;     /* directory handle */
     GError *error = NULL; /* error flag and info */
     gchar *dirname;       /* directory name */
@@ -1509,6 +1608,25 @@ static GtkWidget *create_conf_widgets(GtkRotCtrl *ctrl)
     g_object_set(label, "xalign", 0.0f, "yalign", 0.5f, NULL);
     gtk_grid_attach(GTK_GRID(table), label, 2, 3, 1, 1);
 
+    /* I/O statistics */
+    label = gtk_label_new(_("I/O:"));
+    g_object_set(label, "xalign", 1.0f, "yalign", 0.5f, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 4, 1, 1);
+
+    ctrl->IoStats = gtk_label_new(_("No commands"));
+    g_object_set(ctrl->IoStats, "xalign", 0.0f, "yalign", 0.5f, NULL);
+    gtk_widget_set_tooltip_text(ctrl->IoStats,
+                                _("Mean round-trip time, rate and number of "
+                                  "failed position readings since the "
+                                  "rotator was engaged"));
+    gtk_grid_attach(GTK_GRID(table), ctrl->IoStats, 1, 4, 1, 1);
+
+    button = gtk_button_new_with_label(_("Stats"));
+    gtk_widget_set_tooltip_text(button,
+                                _("Show the I/O statistics of the rotator"));
+    g_signal_connect(button, "clicked", G_CALLBACK(io_stats_cb), ctrl);
+    gtk_grid_attach(GTK_GRID(table), button, 2, 4, 1, 1);
+
     /* load initial rotator configuration */
     rot_selected_cb(GTK_COMBO_BOX(ctrl->DevSel), ctrl);
 
@@ -1590,6 +1708,8 @@ static void gtk_rot_ctrl_init(GtkRotCtrl *ctrl, gpointer g_class)
     ctrl->sats = NULL;
     ctrl->target = NULL;
     ctrl->pass = NULL;
+    ctrl->plan = NULL;
+    ctrl->plancmd = NULL;
     ctrl->qth = NULL;
     ctrl->plot = NULL;
 
@@ -1601,8 +1721,8 @@ static void gtk_rot_ctrl_init(GtkRotCtrl *ctrl, gpointer g_class)
     ctrl->errcnt = 0;
 
     g_mutex_init(&ctrl->client.mutex);
+    g_cond_init(&ctrl->client.cond);
     ctrl->client.thread = NULL;
-    ctrl->client.socket = -1;
     ctrl->client.running = FALSE;
 }
 
@@ -1628,13 +1748,13 @@ static void gtk_rot_ctrl_destroy(GtkWidget *widget)
     }
 
     /* stop client thread */
-    if (ctrl->client.running)
-    {
-        ctrl->client.running = FALSE;
-        g_thread_join(ctrl->client.thread);
-    }
+    stop_client(ctrl);
 
     g_mutex_clear(&ctrl->client.mutex);
+    g_cond_clear(&ctrl->client.cond);
+
+    rot_plan_free(ctrl->plan);
+    ctrl->plan = NULL;
 
     (*GTK_WIDGET_CLASS(parent_class)->destroy)(widget);
 }
@@ -1693,21 +1813,20 @@ GtkWidget *gtk_rot_ctrl_new(GtkSatModule *module)
     /* store current time (don't know if real or simulated) */
     rot_ctrl->t = module->tmgCdnum;
 
-    /* store QTH */
+    /* store QTH and the passes shared with other controllers */
     rot_ctrl->qth = module->qth;
+    rot_ctrl->passcache = module->passcache;
 
     /* get next pass for target satellite */
     if (rot_ctrl->target)
     {
         if (rot_ctrl->target->el > 0.0)
         {
-            rot_ctrl->pass =
-                get_current_pass(rot_ctrl->target, rot_ctrl->qth, 0.0);
+            rot_ctrl->pass = get_target_pass(rot_ctrl, rot_ctrl->t, TRUE);
         }
         else
         {
-            rot_ctrl->pass =
-                get_next_pass(rot_ctrl->target, rot_ctrl->qth, 3.0);
+            rot_ctrl->pass = get_target_pass(rot_ctrl, rot_ctrl->t, FALSE);
         }
     }
 
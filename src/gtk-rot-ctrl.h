@@ -6,7 +6,10 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-module.h"
+#include "io-stats.h"
+#include "pass-cache.h"
 #include "predict-tools.h"
+#include "rot-planner.h"
 #include "rotor-conf.h"
 #include "sgpsdp/sgp4sdp4.h"
 
@@ -47,6 +50,7 @@ struct _gtk_rot_ctrl {
     GtkWidget *track;
     GtkWidget *cycle_spin; /* Update timer cycle */
     GtkWidget *thld_spin;  /* Threshold spin */
+    GtkWidget *IoStats;    /* Summary of the I/O statistics */
 
     rotor_conf_t *conf;
     gdouble t; /* Time when sat data last has been updated. */
@@ -56,8 +60,11 @@ struct _gtk_rot_ctrl {
     sat_t *target; /* Target satellite */
     pass_t *pass;  /* Next pass of target satellite */
     qth_t *qth;    /* The QTH for this module */
+    pass_cache_t *passcache; /* Passes shared with the module */
     gboolean
         flipped; /* Whether the current pass loaded is a flip pass or not */
+    rot_plan_t *plan;               /* Rotator commands for the pass */
+    const rot_plan_cmd_t *plancmd;  /* Last command sent from the plan */
 
     guint delay;       /* Timeout delay. */
     guint timerid;     /* Timer ID */
@@ -68,20 +75,23 @@ struct _gtk_rot_ctrl {
     gboolean engaged;  /* Flag indicating that rotor device is engaged. */
 
     gint errcnt; /* Error counter. */
+    track_stats_t pointerr; /* Pointing error while tracking (deg) */
 
     /* TCP client to rotctld */
     struct {
         GThread *thread;
-        GTimer *timer;
         GMutex mutex;
-        gint socket;      /* network socket to rotctld */
+        GCond cond;       /* signalled when there is work for the thread */
         gfloat azi_in;    /* last AZI angle read from rotctld */
         gfloat ele_in;    /* last ELE angle read from rotctld */
         gfloat azi_out;   /* AZI target */
         gfloat ele_out;   /* ELE target */
+        guint cycle;      /* controller cycle in msec */
         gboolean new_trg; /* new target position set */
         gboolean running;
         gboolean io_error;
+        io_stats_t setstats; /* P commands */
+        io_stats_t getstats; /* p commands */
     } client;
 };
 
@@ -93,6 +103,7 @@ GType gtk_rot_ctrl_get_type(void);
 GtkWidget *gtk_rot_ctrl_new(GtkSatModule *module);
 void gtk_rot_ctrl_update(GtkRotCtrl *ctrl, gdouble t);
 void gtk_rot_ctrl_select_sat(GtkRotCtrl *ctrl, gint catnum);
+void gtk_rot_ctrl_reload_sat(GtkRotCtrl *ctrl, sat_t *sat);
 
 #ifdef __cplusplus
 }
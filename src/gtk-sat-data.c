@@ -37,8 +37,85 @@
 #include "orbit-tools.h"
 #include "time-tools.h"
 #include "compat.h"
+#include "sat-catalogue.h"
 
 
+/* Prepare a satellite whose elements have just been read */
+static void setup_sat(sat_t * sat)
+{
+    /* VERY, VERY important! If not done, some sats
+       will not get initialised, the first time SGP4/SDP4
+       is called. Consequently, the resulting data will
+       be NAN, INF or similar nonsense.
+       For some reason, not even using g_new0 seems to
+       be enough.
+     */
+    sat->flags = 0;
+
+    select_ephemeris(sat);
+
+    /* initialise variable fields */
+    sat->jul_utc = 0.0;
+    sat->tsince = 0.0;
+    sat->az = 0.0;
+    sat->el = 0.0;
+    sat->range = 0.0;
+    sat->range_rate = 0.0;
+    sat->ra = 0.0;
+    sat->dec = 0.0;
+    sat->ssplat = 0.0;
+    sat->ssplon = 0.0;
+    sat->alt = 0.0;
+    sat->velo = 0.0;
+    sat->ma = 0.0;
+    sat->footprint = 0.0;
+    sat->phase = 0.0;
+    sat->aos = 0.0;
+    sat->los = 0.0;
+
+    /* calculate satellite data at epoch */
+    gtk_sat_data_init_sat(sat, NULL);
+}
+
+/**
+ * Read a satellite from the satellite catalogue.
+ *
+ * @return TRUE if the satellite is in the catalogue, FALSE if there is no
+ *         catalogue, the satellite is not in it or its elements can not be
+ *         read.
+ */
+static gboolean read_sat_from_catalogue(gint catnum, sat_t * sat)
+{
+    sat_catalogue_t *cat;
+    const sat_cat_entry_t *entry;
+
+    cat = sat_catalogue_get_default();
+    if (cat == NULL)
+        return FALSE;
+
+    entry = sat_catalogue_lookup(cat, catnum);
+    if (entry == NULL)
+    {
+        sat_catalogue_unref(cat);
+        return FALSE;
+    }
+
+    /* entries are validated when the catalogue is written */
+    if (!sat_catalogue_get_tle(cat, entry, &sat->tle))
+    {
+        sat_catalogue_unref(cat);
+        return FALSE;
+    }
+    sat->name = g_strdup(sat_catalogue_str(cat, entry->name));
+    sat->nickname = g_strdup(sat_catalogue_str(cat, entry->nickname));
+    sat->website = g_strdup(sat_catalogue_str(cat, entry->website));
+    sat_catalogue_unref(cat);
+
+    setup_sat(sat);
+
+    return TRUE;
+}
+
 /**
  * Read TLE data for a given satellite into memory.
  *
@@ -47,6 +124,8 @@
  * @return 0 if successful, 1 if an I/O error occurred,
  *         2 if the TLE data appears to be bad.
  *
+ * The satellite is read from the satellite catalogue if it is there, and
+ * from its .sat file otherwise.
  */
 gint gtk_sat_data_read_sat(gint catnum, sat_t * sat)
 {
@@ -60,6 +139,9 @@ gint gtk_sat_data_read_sat(gint catnum, sat_t * sat)
     /* ensure that sat != NULL */
     g_return_val_if_fail(sat != NULL, 1);
 
+    if (read_sat_from_catalogue(catnum, sat))
+        return 0;
+
     /* .sat file names */
     filename = g_strdup_printf("%d.sat", catnum);
     path = sat_file_name_from_catnum(catnum);
@@ -142,38 +224,7 @@ gint gtk_sat_data_read_sat(gint catnum, sat_t * sat)
         g_free(tlestr2);
         g_free(rawtle);
 
-        /* VERY, VERY important! If not done, some sats
-           will not get initialised, the first time SGP4/SDP4
-           is called. Consequently, the resulting data will
-           be NAN, INF or similar nonsense.
-           For some reason, not even using g_new0 seems to
-           be enough.
-         */
-        sat->flags = 0;
-
-        select_ephemeris(sat);
-
-        /* initialise variable fields */
-        sat->jul_utc = 0.0;
-        sat->tsince = 0.0;
-        sat->az = 0.0;
-        sat->el = 0.0;
-        sat->range = 0.0;
-        sat->range_rate = 0.0;
-        sat->ra = 0.0;
-        sat->dec = 0.0;
-        sat->ssplat = 0.0;
-        sat->ssplon = 0.0;
-        sat->alt = 0.0;
-        sat->velo = 0.0;
-        sat->ma = 0.0;
-        sat->footprint = 0.0;
-        sat->phase = 0.0;
-        sat->aos = 0.0;
-        sat->los = 0.0;
-
-        /* calculate satellite data at epoch */
-        gtk_sat_data_init_sat(sat, NULL);
+        setup_sat(sat);
     }
 
     g_free(filename);
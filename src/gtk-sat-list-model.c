@@ -0,0 +1,1047 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+  Comments, questions and bugreports should be submitted via
+  http://sourceforge.net/projects/gpredict/
+  More details can be found at the project home page:
+
+  http://gpredict.oz9aec.net/
+ 
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+#include "gtk-sat-list.h"
+#include "gtk-sat-list-model.h"
+#include "locator.h"
+#include "orbit-tools.h"
+#include "sat-cfg.h"
+#include "sat-log.h"
+#include "sat-vis.h"
+#include "time-tools.h"
+
+/** Text columns, whose formatted text is kept in the row. */
+enum {
+    ROW_TEXT_DIR,
+    ROW_TEXT_NEXT_EVENT,
+    ROW_TEXT_SSP,
+    ROW_TEXT_VISIBILITY,
+    ROW_TEXT_NUMBER
+};
+
+/** Formatted text of a column, valid while gen matches the model. */
+typedef struct {
+    guint           gen;
+    gchar           str[TIME_FORMAT_MAX_LENGTH];
+} row_text_t;
+
+/**
+ * Per-satellite row data. Numbers are read from sat on demand; text is
+ * formatted on demand too but kept until the row changes, since the view
+ * asks for it on every redraw.
+ */
+typedef struct {
+    gint            catnum;     /*!< catalogue number, key in the index */
+    sat_t          *sat;        /*!< the satellite */
+    gchar          *collate;    /*!< collation key for the name */
+    gint            pos;        /*!< position in the view, -1 if hidden */
+    gdouble         rate;       /*!< range rate at the last refresh */
+    gdouble         oldrate;    /*!< range rate at the refresh before */
+    gdouble         key;        /*!< numeric sort key */
+    row_text_t      text[ROW_TEXT_NUMBER];      /*!< formatted text */
+} sat_list_row_t;
+
+#define ROW(iter) ((sat_list_row_t *)(iter)->user_data)
+
+static const GType SAT_LIST_COL_TYPE[SAT_LIST_COL_NUMBER] = {
+    G_TYPE_STRING,              // name
+    G_TYPE_INT,                 // catnum
+    G_TYPE_DOUBLE,              // az
+    G_TYPE_DOUBLE,              // el
+    G_TYPE_STRING,              // direction
+    G_TYPE_DOUBLE,              // RA
+    G_TYPE_DOUBLE,              // Dec
+    G_TYPE_DOUBLE,              // range
+    G_TYPE_DOUBLE,              // range rate
+    G_TYPE_STRING,              // next event
+    G_TYPE_DOUBLE,              // next AOS
+    G_TYPE_DOUBLE,              // next LOS
+    G_TYPE_DOUBLE,              // ssp lat
+    G_TYPE_DOUBLE,              // ssp lon
+    G_TYPE_STRING,              // ssp qra
+    G_TYPE_DOUBLE,              // footprint
+    G_TYPE_DOUBLE,              // alt
+    G_TYPE_DOUBLE,              // vel
+    G_TYPE_DOUBLE,              // doppler
+    G_TYPE_DOUBLE,              // path loss
+    G_TYPE_DOUBLE,              // delay
+    G_TYPE_DOUBLE,              // mean anomaly
+    G_TYPE_DOUBLE,              // phase
+    G_TYPE_LONG,                // orbit
+    G_TYPE_STRING,              // visibility
+    G_TYPE_BOOLEAN,             // decay
+    G_TYPE_INT,                 // Operational Status
+    G_TYPE_INT                  // weight/bold
+};
+
+static void     gtk_sat_list_model_class_init(GtkSatListModelClass * class,
+                                              gpointer class_data);
+static void     gtk_sat_list_model_init(GtkSatListModel * model,
+                                        gpointer g_class);
+static void     gtk_sat_list_model_tree_model_init(GtkTreeModelIface * iface,
+                                                   gpointer iface_data);
+static void     gtk_sat_list_model_sortable_init(GtkTreeSortableIface * iface,
+                                                 gpointer iface_data);
+static void     gtk_sat_list_model_finalize(GObject * object);
+static void     Calculate_RADec(sat_t * sat, qth_t * qth,
+                                obs_astro_t * obs_set);
+
+static GObjectClass *parent_class = NULL;
+
+
+GType gtk_sat_list_model_get_type()
+{
+    static GType    gtk_sat_list_model_type = 0;
+
+    if (!gtk_sat_list_model_type)
+    {
+        static const GTypeInfo gtk_sat_list_model_info = {
+            sizeof(GtkSatListModelClass),
+            NULL,               /* base_init */
+            NULL,               /* base_finalize */
+            (GClassInitFunc) gtk_sat_list_model_class_init,
+            NULL,               /* class_finalize */
+            NULL,               /* class_data */
+            sizeof(GtkSatListModel),
+            5,                  /* n_preallocs */
+            (GInstanceInitFunc) gtk_sat_list_model_init,
+            NULL
+        };
+        static const GInterfaceInfo tree_model_info = {
+            (GInterfaceInitFunc) gtk_sat_list_model_tree_model_init,
+            NULL,
+            NULL
+        };
+        static const GInterfaceInfo sortable_info = {
+            (GInterfaceInitFunc) gtk_sat_list_model_sortable_init,
+            NULL,
+            NULL
+        };
+
+        gtk_sat_list_model_type = g_type_register_static(G_TYPE_OBJECT,
+                                                         "GtkSatListModel",
+                                                         &gtk_sat_list_model_info,
+                                                         0);
+        g_type_add_interface_static(gtk_sat_list_model_type,
+                                    GTK_TYPE_TREE_MODEL, &tree_model_info);
+        g_type_add_interface_static(gtk_sat_list_model_type,
+                                    GTK_TYPE_TREE_SORTABLE, &sortable_info);
+    }
+
+    return gtk_sat_list_model_type;
+}
+
+static void gtk_sat_list_model_class_init(GtkSatListModelClass * class,
+                                          gpointer class_data)
+{
+    GObjectClass   *object_class = (GObjectClass *) class;
+
+    (void)class_data;
+
+    object_class->finalize = gtk_sat_list_model_finalize;
+
+    parent_class = g_type_class_peek_parent(class);
+}
+
+static void row_free(gpointer data)
+{
+    sat_list_row_t *row = data;
+
+    g_free(row->collate);
+    g_free(row);
+}
+
+static void gtk_sat_list_model_init(GtkSatListModel * model, gpointer g_class)
+{
+    (void)g_class;
+
+    model->stamp = g_random_int();
+    model->rows = g_ptr_array_new_with_free_func(row_free);
+    model->index = g_hash_table_new(g_int_hash, g_int_equal);
+    model->order = g_ptr_array_new();
+    model->sort_column = SAT_LIST_COL_NAME;
+    model->sort_order = GTK_SORT_ASCENDING;
+    model->textgen = 1;
+}
+
+static void gtk_sat_list_model_finalize(GObject * object)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(object);
+
+    g_ptr_array_free(model->order, TRUE);
+    g_hash_table_destroy(model->index);
+    g_ptr_array_free(model->rows, TRUE);
+
+    (*parent_class->finalize) (object);
+}
+
+static void fill_iter(GtkSatListModel * model, sat_list_row_t * row,
+                      GtkTreeIter * iter)
+{
+    iter->stamp = model->stamp;
+    iter->user_data = row;
+    iter->user_data2 = NULL;
+    iter->user_data3 = NULL;
+}
+
+/** Time of the next AOS or LOS, whichever comes first. */
+static gdouble next_event_time(sat_t * sat)
+{
+    return (sat->aos > sat->los) ? sat->los : sat->aos;
+}
+
+/** Numeric value of a column. */
+static gdouble row_get_number(GtkSatListModel * model, sat_list_row_t * row,
+                              gint column)
+{
+    sat_t          *sat = row->sat;
+    obs_astro_t     astro;
+
+    switch (column)
+    {
+    case SAT_LIST_COL_CATNUM:
+        return row->catnum;
+    case SAT_LIST_COL_AZ:
+        return sat->az;
+    case SAT_LIST_COL_EL:
+        return sat->el;
+    case SAT_LIST_COL_RA:
+    case SAT_LIST_COL_DEC:
+        Calculate_RADec(sat, model->qth, &astro);
+        sat->ra = Degrees(astro.ra);
+        sat->dec = Degrees(astro.dec);
+        return (column == SAT_LIST_COL_RA) ? sat->ra : sat->dec;
+    case SAT_LIST_COL_RANGE:
+        return sat->range;
+    case SAT_LIST_COL_RANGE_RATE:
+        return sat->range_rate;
+    case SAT_LIST_COL_NEXT_EVENT:
+        return next_event_time(sat);
+    case SAT_LIST_COL_AOS:
+        return sat->aos;
+    case SAT_LIST_COL_LOS:
+        return sat->los;
+    case SAT_LIST_COL_LAT:
+        return sat->ssplat;
+    case SAT_LIST_COL_LON:
+        return sat->ssplon;
+    case SAT_LIST_COL_FOOTPRINT:
+        return sat->footprint;
+    case SAT_LIST_COL_ALT:
+        return sat->alt;
+    case SAT_LIST_COL_VEL:
+        return sat->velo;
+    case SAT_LIST_COL_DOPPLER:
+        return -100.0e06 * (sat->range_rate / 299792.4580);    // Hz
+    case SAT_LIST_COL_LOSS:
+        return 72.4 + 20.0 * log10(sat->range);        // dB
+    case SAT_LIST_COL_DELAY:
+        return sat->range / 299.7924580;        // msec
+    case SAT_LIST_COL_MA:
+        return sat->ma;
+    case SAT_LIST_COL_PHASE:
+        return sat->phase;
+    case SAT_LIST_COL_ORBIT:
+        return sat->orbit;
+    case SAT_LIST_COL_DECAY:
+        return !decayed(sat);
+    case SAT_LIST_COL_STAT_OPERATIONAL:
+        return sat->tle.status;
+    case SAT_LIST_COL_BOLD:
+        return (sat->el > 0.0) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL;
+    default:
+        return 0.0;
+    }
+}
+
+/** Format the text of a column. */
+static void row_format_string(GtkSatListModel * model, sat_list_row_t * row,
+                              gint column, gchar * buff, gsize len)
+{
+    sat_t          *sat = row->sat;
+    gchar          *fmtstr;
+    gchar          *tfstr;
+    gdouble         number;
+
+    switch (column)
+    {
+    case SAT_LIST_COL_DIR:
+        if (sat->otype == ORBIT_TYPE_GEO)
+            g_strlcpy(buff, "G", len);
+        else if (decayed(sat))
+            g_strlcpy(buff, "D", len);
+        else if (row->rate > 0.001)
+            /* going down */
+            g_strlcpy(buff, "\342\206\223", len);
+        else if (row->rate >= -0.001)
+            /* turning around; compare with the previous refresh */
+            g_strlcpy(buff, (row->rate < row->oldrate) ?
+                      "\342\206\272" : "\342\206\267", len);
+        else
+            /* coming up */
+            g_strlcpy(buff, "\342\206\221", len);
+        break;
+
+    case SAT_LIST_COL_SSP:
+        if (len < 7 || longlat2locator(sat->ssplon, sat->ssplat, buff, 3) != RIG_OK)
+            buff[0] = '\0';
+        else
+            buff[6] = '\0';
+        break;
+
+    case SAT_LIST_COL_VISIBILITY:
+        g_snprintf(buff, len, "%c",
+                   vis_to_chr(get_sat_vis(sat, model->qth, sat->jul_utc)));
+        break;
+
+    case SAT_LIST_COL_NEXT_EVENT:
+        number = next_event_time(sat);
+        if (number == 0.0)
+        {
+            g_strlcpy(buff, "--- N/A ---", len);
+        }
+        else
+        {
+            tfstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
+            fmtstr = g_strconcat(tfstr, (sat->aos > sat->los) ?
+                                 " (LOS)" : " (AOS)", NULL);
+            daynum_to_str(buff, len, fmtstr, number);
+            g_free(tfstr);
+            g_free(fmtstr);
+        }
+        break;
+
+    default:
+        buff[0] = '\0';
+        break;
+    }
+}
+
+/** Slot of a text column in the row, or -1 if it is not one. */
+static gint row_text_slot(gint column)
+{
+    switch (column)
+    {
+    case SAT_LIST_COL_DIR:
+        return ROW_TEXT_DIR;
+    case SAT_LIST_COL_NEXT_EVENT:
+        return ROW_TEXT_NEXT_EVENT;
+    case SAT_LIST_COL_SSP:
+        return ROW_TEXT_SSP;
+    case SAT_LIST_COL_VISIBILITY:
+        return ROW_TEXT_VISIBILITY;
+    default:
+        return -1;
+    }
+}
+
+/** Text value of a column, formatted again only if the row has changed. */
+static const gchar *row_get_string(GtkSatListModel * model,
+                                   sat_list_row_t * row, gint column)
+{
+    row_text_t     *text = &row->text[row_text_slot(column)];
+
+    if (text->gen != model->textgen)
+    {
+        row_format_string(model, row, column, text->str, sizeof(text->str));
+        text->gen = model->textgen;
+    }
+
+    return text->str;
+}
+
+/** Forget the formatted text of all rows, e.g. after they were updated. */
+static void invalidate_text(GtkSatListModel * model)
+{
+    /* 0 is what new rows start with */
+    if (++model->textgen == 0)
+        model->textgen = 1;
+}
+
+/** Refresh the sort key of a row for the current sort column. */
+static void row_update_key(GtkSatListModel * model, sat_list_row_t * row)
+{
+    switch (model->sort_column)
+    {
+    case SAT_LIST_COL_NAME:
+        break;
+    case SAT_LIST_COL_DIR:
+    case SAT_LIST_COL_SSP:
+    case SAT_LIST_COL_VISIBILITY:
+        row_get_string(model, row, model->sort_column);
+        break;
+    default:
+        row->key = row_get_number(model, row, model->sort_column);
+        break;
+    }
+}
+
+static gint row_compare(GtkSatListModel * model, const sat_list_row_t * a,
+                        const sat_list_row_t * b)
+{
+    gint            result;
+    gint            i;
+
+    switch (model->sort_column)
+    {
+    case SAT_LIST_COL_NAME:
+        result = strcmp(a->collate, b->collate);
+        break;
+    case SAT_LIST_COL_DIR:
+    case SAT_LIST_COL_SSP:
+    case SAT_LIST_COL_VISIBILITY:
+        i = row_text_slot(model->sort_column);
+        result = strcmp(a->text[i].str, b->text[i].str);
+        break;
+    default:
+        result = (a->key > b->key) - (a->key < b->key);
+        break;
+    }
+
+    /* keep the order of equal rows deterministic */
+    if (result == 0)
+        result = (a->catnum > b->catnum) - (a->catnum < b->catnum);
+
+    return (model->sort_order == GTK_SORT_DESCENDING) ? -result : result;
+}
+
+static gint row_compare_ptr(gconstpointer a, gconstpointer b, gpointer data)
+{
+    return row_compare(GTK_SAT_LIST_MODEL(data),
+                       *(const sat_list_row_t * const *)a,
+                       *(const sat_list_row_t * const *)b);
+}
+
+/**
+ * Sort the visible rows and tell the view how they moved.
+ *
+ * Between two refreshes the satellites barely move relative to each other,
+ * so the previous order is almost sorted. Insertion sort is linear in that
+ * case and we avoid emitting rows-reordered when nothing changed. A full
+ * sort is used when the sort column changes.
+ */
+static void sort_rows(GtkSatListModel * model, gboolean full)
+{
+    sat_list_row_t **rows = (sat_list_row_t **) model->order->pdata;
+    sat_list_row_t *tmp;
+    GtkTreePath    *path;
+    gint           *new_order;
+    gint            n = model->order->len;
+    gint            i, j;
+    gboolean        moved = FALSE;
+
+    if (n < 2)
+        return;
+
+    for (i = 0; i < n; i++)
+        row_update_key(model, rows[i]);
+
+    if (full)
+    {
+        g_ptr_array_sort_with_data(model->order, row_compare_ptr, model);
+        for (i = 0; i < n && !moved; i++)
+            moved = (rows[i]->pos != i);
+    }
+    else
+    {
+        for (i = 1; i < n; i++)
+        {
+            tmp = rows[i];
+            for (j = i; j > 0 && row_compare(model, rows[j - 1], tmp) > 0; j--)
+                rows[j] = rows[j - 1];
+
+            if (j != i)
+            {
+                rows[j] = tmp;
+                moved = TRUE;
+            }
+        }
+    }
+
+    if (!moved)
+        return;
+
+    new_order = g_new(gint, n);
+    for (i = 0; i < n; i++)
+    {
+        new_order[i] = rows[i]->pos;
+        rows[i]->pos = i;
+    }
+
+    path = gtk_tree_path_new();
+    gtk_tree_model_rows_reordered(GTK_TREE_MODEL(model), path, NULL,
+                                  new_order);
+    gtk_tree_path_free(path);
+    g_free(new_order);
+}
+
+/** Add a row to the end of the view. */
+static void show_row(GtkSatListModel * model, sat_list_row_t * row)
+{
+    GtkTreePath    *path;
+    GtkTreeIter     iter;
+
+    row->pos = model->order->len;
+    row->rate = row->oldrate = row->sat->range_rate;
+    g_ptr_array_add(model->order, row);
+
+    path = gtk_tree_path_new_from_indices(row->pos, -1);
+    fill_iter(model, row, &iter);
+    gtk_tree_model_row_inserted(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+/** Remove a row from the view. The row itself is kept. */
+static void hide_row(GtkSatListModel * model, sat_list_row_t * row)
+{
+    GtkTreePath    *path;
+    guint           i;
+
+    if (row->pos < 0)
+        return;
+
+    g_ptr_array_remove_index(model->order, row->pos);
+    for (i = row->pos; i < model->order->len; i++)
+        ((sat_list_row_t *) g_ptr_array_index(model->order, i))->pos = i;
+
+    path = gtk_tree_path_new_from_indices(row->pos, -1);
+    row->pos = -1;
+    gtk_tree_model_row_deleted(GTK_TREE_MODEL(model), path);
+    gtk_tree_path_free(path);
+}
+
+static void add_sat(gpointer key, gpointer value, gpointer data)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(data);
+    sat_t          *sat = SAT(value);
+    sat_list_row_t *row;
+
+    (void)key;
+
+    if (g_hash_table_lookup(model->index, &sat->tle.catnr) != NULL)
+        return;
+
+    row = g_new0(sat_list_row_t, 1);
+    row->catnum = sat->tle.catnr;
+    row->sat = sat;
+    row->collate = g_utf8_collate_key(sat->nickname, -1);
+    row->pos = -1;
+
+    g_ptr_array_add(model->rows, row);
+    g_hash_table_insert(model->index, &row->catnum, row);
+
+    if (!decayed(sat))
+        show_row(model, row);
+}
+
+GtkSatListModel *gtk_sat_list_model_new(GHashTable * sats, qth_t * qth)
+{
+    GtkSatListModel *model;
+
+    model = GTK_SAT_LIST_MODEL(g_object_new(GTK_TYPE_SAT_LIST_MODEL, NULL));
+    model->qth = qth;
+    gtk_sat_list_model_set_sats(model, sats);
+
+    return model;
+}
+
+/**
+ * Synchronise the rows with a (re)loaded satellite hash table.
+ *
+ * Existing rows are re-pointed to the new sat_t objects, rows of
+ * satellites no longer in the table are removed and new satellites are
+ * appended. Must be called whenever the sat_t objects are replaced.
+ */
+void gtk_sat_list_model_set_sats(GtkSatListModel * model, GHashTable * sats)
+{
+    sat_list_row_t *row;
+    sat_t          *sat;
+    gint            i;
+
+    g_return_if_fail(IS_GTK_SAT_LIST_MODEL(model));
+
+    model->satellites = sats;
+    invalidate_text(model);
+
+    for (i = (gint) model->rows->len - 1; i >= 0; i--)
+    {
+        row = g_ptr_array_index(model->rows, i);
+        sat = SAT(g_hash_table_lookup(sats, &row->catnum));
+
+        if (sat == NULL)
+        {
+            hide_row(model, row);
+            g_hash_table_remove(model->index, &row->catnum);
+            g_ptr_array_remove_index_fast(model->rows, i);
+            continue;
+        }
+
+        row->sat = sat;
+        g_free(row->collate);
+        row->collate = g_utf8_collate_key(sat->nickname, -1);
+    }
+
+    g_hash_table_foreach(sats, add_sat, model);
+
+    sort_rows(model, TRUE);
+}
+
+/**
+ * Update the row of a satellite whose elements or name have changed.
+ *
+ * A new name is sorted in right away and the row is redrawn.
+ */
+void gtk_sat_list_model_reload_sat(GtkSatListModel * model, sat_t * sat)
+{
+    sat_list_row_t *row;
+    GtkTreePath    *path;
+    GtkTreeIter     iter;
+
+    g_return_if_fail(IS_GTK_SAT_LIST_MODEL(model));
+
+    row = g_hash_table_lookup(model->index, &sat->tle.catnr);
+    if (row == NULL)
+        return;
+
+    g_free(row->collate);
+    row->collate = g_utf8_collate_key(sat->nickname, -1);
+    memset(row->text, 0, sizeof(row->text));
+
+    if (row->pos < 0)
+        return;
+
+    /* only this row is out of place, which insertion sort handles well */
+    sort_rows(model, FALSE);
+
+    path = gtk_tree_path_new_from_indices(row->pos, -1);
+    fill_iter(model, row, &iter);
+    gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+    gtk_tree_path_free(path);
+}
+
+/**
+ * Refresh the model after the satellites have been updated.
+ *
+ * @param model The model.
+ * @param first Index of the first row visible in the view.
+ * @param last Index of the last row visible in the view.
+ *
+ * Rows whose decay status changed are shown or hidden, the order is
+ * updated incrementally and row-changed is emitted only for the rows
+ * between first and last. Rows scrolled into view later will read fresh
+ * values anyway since nothing is cached.
+ */
+void gtk_sat_list_model_refresh(GtkSatListModel * model, gint first, gint last)
+{
+    sat_list_row_t *row;
+    GtkTreePath    *path;
+    GtkTreeIter     iter;
+    guint           i;
+    gint            n;
+
+    g_return_if_fail(IS_GTK_SAT_LIST_MODEL(model));
+
+    /* the satellites have moved since the text was formatted */
+    invalidate_text(model);
+
+    for (i = 0; i < model->rows->len; i++)
+    {
+        row = g_ptr_array_index(model->rows, i);
+
+        if (decayed(row->sat))
+            hide_row(model, row);
+        else if (row->pos < 0)
+            show_row(model, row);
+    }
+
+    for (i = 0; i < model->order->len; i++)
+    {
+        row = g_ptr_array_index(model->order, i);
+        row->oldrate = row->rate;
+        row->rate = row->sat->range_rate;
+    }
+
+    sort_rows(model, FALSE);
+
+    n = model->order->len;
+    first = MAX(first, 0);
+    last = MIN(last, n - 1);
+
+    for (; first <= last; first++)
+    {
+        row = g_ptr_array_index(model->order, first);
+        path = gtk_tree_path_new_from_indices(first, -1);
+        fill_iter(model, row, &iter);
+        gtk_tree_model_row_changed(GTK_TREE_MODEL(model), path, &iter);
+        gtk_tree_path_free(path);
+    }
+}
+
+/** Get the satellite shown in the row pointed to by iter. */
+sat_t          *gtk_sat_list_model_get_sat(GtkSatListModel * model,
+                                           GtkTreeIter * iter)
+{
+    g_return_val_if_fail(IS_GTK_SAT_LIST_MODEL(model), NULL);
+    g_return_val_if_fail(iter->stamp == model->stamp, NULL);
+
+    return ROW(iter)->sat;
+}
+
+/** Get an iterator pointing to the row of a satellite. */
+gboolean gtk_sat_list_model_get_iter(GtkSatListModel * model, gint catnum,
+                                     GtkTreeIter * iter)
+{
+    sat_list_row_t *row;
+
+    g_return_val_if_fail(IS_GTK_SAT_LIST_MODEL(model), FALSE);
+
+    row = g_hash_table_lookup(model->index, &catnum);
+    if (row == NULL || row->pos < 0)
+        return FALSE;
+
+    fill_iter(model, row, iter);
+
+    return TRUE;
+}
+
+/* GtkTreeModel interface */
+
+static GtkTreeModelFlags get_flags(GtkTreeModel * tree_model)
+{
+    (void)tree_model;
+
+    return GTK_TREE_MODEL_ITERS_PERSIST | GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint get_n_columns(GtkTreeModel * tree_model)
+{
+    (void)tree_model;
+
+    return SAT_LIST_COL_NUMBER;
+}
+
+static GType get_column_type(GtkTreeModel * tree_model, gint index)
+{
+    (void)tree_model;
+
+    g_return_val_if_fail(index >= 0 && index < SAT_LIST_COL_NUMBER,
+                         G_TYPE_INVALID);
+
+    return SAT_LIST_COL_TYPE[index];
+}
+
+static gboolean get_iter(GtkTreeModel * tree_model, GtkTreeIter * iter,
+                         GtkTreePath * path)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(tree_model);
+    gint            i;
+
+    if (gtk_tree_path_get_depth(path) != 1)
+        return FALSE;
+
+    i = gtk_tree_path_get_indices(path)[0];
+    if (i < 0 || i >= (gint) model->order->len)
+        return FALSE;
+
+    fill_iter(model, g_ptr_array_index(model->order, i), iter);
+
+    return TRUE;
+}
+
+static GtkTreePath *get_path(GtkTreeModel * tree_model, GtkTreeIter * iter)
+{
+    g_return_val_if_fail(iter->stamp == GTK_SAT_LIST_MODEL(tree_model)->stamp,
+                         NULL);
+
+    return gtk_tree_path_new_from_indices(ROW(iter)->pos, -1);
+}
+
+static void get_value(GtkTreeModel * tree_model, GtkTreeIter * iter,
+                      gint column, GValue * value)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(tree_model);
+    sat_list_row_t *row = ROW(iter);
+
+    g_return_if_fail(iter->stamp == model->stamp);
+    g_return_if_fail(column >= 0 && column < SAT_LIST_COL_NUMBER);
+
+    g_value_init(value, SAT_LIST_COL_TYPE[column]);
+
+    switch (column)
+    {
+    case SAT_LIST_COL_NAME:
+        g_value_set_string(value, row->sat->nickname);
+        break;
+    case SAT_LIST_COL_CATNUM:
+        g_value_set_int(value, row->catnum);
+        break;
+    case SAT_LIST_COL_DIR:
+    case SAT_LIST_COL_NEXT_EVENT:
+    case SAT_LIST_COL_SSP:
+    case SAT_LIST_COL_VISIBILITY:
+        /* kept in the row, so it need not be copied here */
+        g_value_set_static_string(value, row_get_string(model, row, column));
+        break;
+    case SAT_LIST_COL_ORBIT:
+        g_value_set_long(value, row->sat->orbit);
+        break;
+    case SAT_LIST_COL_DECAY:
+        g_value_set_boolean(value, !decayed(row->sat));
+        break;
+    case SAT_LIST_COL_STAT_OPERATIONAL:
+    case SAT_LIST_COL_BOLD:
+        g_value_set_int(value, (gint) row_get_number(model, row, column));
+        break;
+    default:
+        g_value_set_double(value, row_get_number(model, row, column));
+        break;
+    }
+}
+
+static gboolean iter_next(GtkTreeModel * tree_model, GtkTreeIter * iter)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(tree_model);
+    gint            i = ROW(iter)->pos + 1;
+
+    if (i <= 0 || i >= (gint) model->order->len)
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = g_ptr_array_index(model->order, i);
+
+    return TRUE;
+}
+
+static gboolean iter_previous(GtkTreeModel * tree_model, GtkTreeIter * iter)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(tree_model);
+    gint            i = ROW(iter)->pos - 1;
+
+    if (i < 0)
+    {
+        iter->stamp = 0;
+        return FALSE;
+    }
+
+    iter->user_data = g_ptr_array_index(model->order, i);
+
+    return TRUE;
+}
+
+static gboolean iter_nth_child(GtkTreeModel * tree_model, GtkTreeIter * iter,
+                               GtkTreeIter * parent, gint n)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(tree_model);
+
+    if (parent != NULL || n < 0 || n >= (gint) model->order->len)
+        return FALSE;
+
+    fill_iter(model, g_ptr_array_index(model->order, n), iter);
+
+    return TRUE;
+}
+
+static gboolean iter_children(GtkTreeModel * tree_model, GtkTreeIter * iter,
+                              GtkTreeIter * parent)
+{
+    return iter_nth_child(tree_model, iter, parent, 0);
+}
+
+static gboolean iter_has_child(GtkTreeModel * tree_model, GtkTreeIter * iter)
+{
+    (void)tree_model;
+    (void)iter;
+
+    return FALSE;
+}
+
+static gint iter_n_children(GtkTreeModel * tree_model, GtkTreeIter * iter)
+{
+    if (iter != NULL)
+        return 0;
+
+    return GTK_SAT_LIST_MODEL(tree_model)->order->len;
+}
+
+static gboolean iter_parent(GtkTreeModel * tree_model, GtkTreeIter * iter,
+                            GtkTreeIter * child)
+{
+    (void)tree_model;
+    (void)iter;
+    (void)child;
+
+    return FALSE;
+}
+
+static void gtk_sat_list_model_tree_model_init(GtkTreeModelIface * iface,
+                                               gpointer iface_data)
+{
+    (void)iface_data;
+
+    iface->get_flags = get_flags;
+    iface->get_n_columns = get_n_columns;
+    iface->get_column_type = get_column_type;
+    iface->get_iter = get_iter;
+    iface->get_path = get_path;
+    iface->get_value = get_value;
+    iface->iter_next = iter_next;
+    iface->iter_previous = iter_previous;
+    iface->iter_children = iter_children;
+    iface->iter_has_child = iter_has_child;
+    iface->iter_n_children = iter_n_children;
+    iface->iter_nth_child = iter_nth_child;
+    iface->iter_parent = iter_parent;
+}
+
+/* GtkTreeSortable interface */
+
+static gboolean get_sort_column_id(GtkTreeSortable * sortable,
+                                   gint * sort_column_id, GtkSortType * order)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(sortable);
+
+    if (sort_column_id)
+        *sort_column_id = model->sort_column;
+    if (order)
+        *order = model->sort_order;
+
+    return TRUE;
+}
+
+static void set_sort_column_id(GtkTreeSortable * sortable,
+                               gint sort_column_id, GtkSortType order)
+{
+    GtkSatListModel *model = GTK_SAT_LIST_MODEL(sortable);
+
+    /* there is no unsorted state; the default is sorting by name */
+    if (sort_column_id < 0 || sort_column_id >= SAT_LIST_COL_NUMBER)
+        sort_column_id = SAT_LIST_COL_NAME;
+
+    if (model->sort_column == sort_column_id && model->sort_order == order)
+        return;
+
+    model->sort_column = sort_column_id;
+    model->sort_order = order;
+    gtk_tree_sortable_sort_column_changed(sortable);
+    sort_rows(model, TRUE);
+}
+
+static void set_sort_func(GtkTreeSortable * sortable, gint sort_column_id,
+                          GtkTreeIterCompareFunc sort_func, gpointer data,
+                          GDestroyNotify destroy)
+{
+    (void)sortable;
+    (void)sort_column_id;
+    (void)sort_func;
+    (void)data;
+    (void)destroy;
+
+    sat_log_log(SAT_LOG_LEVEL_ERROR,
+                _("%s: Custom sort functions are not supported"), __func__);
+}
+
+static void set_default_sort_func(GtkTreeSortable * sortable,
+                                  GtkTreeIterCompareFunc sort_func,
+                                  gpointer data, GDestroyNotify destroy)
+{
+    set_sort_func(sortable, 0, sort_func, data, destroy);
+}
+
+static gboolean has_default_sort_func(GtkTreeSortable * sortable)
+{
+    (void)sortable;
+
+    return FALSE;
+}
+
+static void gtk_sat_list_model_sortable_init(GtkTreeSortableIface * iface,
+                                             gpointer iface_data)
+{
+    (void)iface_data;
+
+    iface->get_sort_column_id = get_sort_column_id;
+    iface->set_sort_column_id = set_sort_column_id;
+    iface->set_sort_func = set_sort_func;
+    iface->set_default_sort_func = set_default_sort_func;
+    iface->has_default_sort_func = has_default_sort_func;
+}
+
+/*** FIXME: formalise with other copies, only need az,el and jul_utc */
+static void Calculate_RADec(sat_t * sat, qth_t * qth, obs_astro_t * obs_set)
+{
+    /* Reference:  Methods of Orbit Determination by  */
+    /*                Pedro Ramon Escobal, pp. 401-402 */
+
+    double          phi, theta, sin_theta, cos_theta, sin_phi, cos_phi,
+        az, el, Lxh, Lyh, Lzh, Sx, Ex, Zx, Sy, Ey, Zy, Sz, Ez, Zz,
+        Lx, Ly, Lz, cos_delta, sin_alpha, cos_alpha;
+    geodetic_t      geodetic;
+
+    geodetic.lon = qth->lon * de2ra;
+    geodetic.lat = qth->lat * de2ra;
+    geodetic.alt = qth->alt / 1000.0;
+    geodetic.theta = 0;
+
+    az = sat->az * de2ra;
+    el = sat->el * de2ra;
+    phi = geodetic.lat;
+    theta = FMod2p(ThetaG_JD(sat->jul_utc) + geodetic.lon);
+    sin_theta = sin(theta);
+    cos_theta = cos(theta);
+    sin_phi = sin(phi);
+    cos_phi = cos(phi);
+    Lxh = -cos(az) * cos(el);
+    Lyh = sin(az) * cos(el);
+    Lzh = sin(el);
+    Sx = sin_phi * cos_theta;
+    Ex = -sin_theta;
+    Zx = cos_theta * cos_phi;
+    Sy = sin_phi * sin_theta;
+    Ey = cos_theta;
+    Zy = sin_theta * cos_phi;
+    Sz = -cos_phi;
+    Ez = 0;
+    Zz = sin_phi;
+    Lx = Sx * Lxh + Ex * Lyh + Zx * Lzh;
+    Ly = Sy * Lxh + Ey * Lyh + Zy * Lzh;
+    Lz = Sz * Lxh + Ez * Lyh + Zz * Lzh;
+    obs_set->dec = ArcSin(Lz);  /* Declination (radians) */
+    cos_delta = sqrt(1 - Sqr(Lz));
+    sin_alpha = Ly / cos_delta;
+    cos_alpha = Lx / cos_delta;
+    obs_set->ra = AcTan(sin_alpha, cos_alpha);  /* Right Ascension (radians) */
+    obs_set->ra = FMod2p(obs_set->ra);
+}
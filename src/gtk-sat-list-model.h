@@ -0,0 +1,96 @@
+/*
+    Gpredict: Real-time satellite tracking and orbit prediction program
+
+    Copyright (C)  2001-2017  Alexandru Csete, OZ9AEC.
+
+    Comments, questions and bugreports should be submitted via
+    http://sourceforge.net/projects/gpredict/
+    More details can be found at the project home page:
+
+            http://gpredict.oz9aec.net/
+ 
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+  
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+  
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef GTK_SAT_LIST_MODEL_H
+#define GTK_SAT_LIST_MODEL_H 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "gtk-sat-data.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+extern "C" {
+#endif
+/* *INDENT-ON* */
+
+#define GTK_TYPE_SAT_LIST_MODEL (gtk_sat_list_model_get_type ())
+#define GTK_SAT_LIST_MODEL(obj) G_TYPE_CHECK_INSTANCE_CAST (obj,\
+                                    gtk_sat_list_model_get_type (),\
+                                    GtkSatListModel)
+#define IS_GTK_SAT_LIST_MODEL(obj) G_TYPE_CHECK_INSTANCE_TYPE (obj, gtk_sat_list_model_get_type ())
+
+typedef struct _gtk_sat_list_model GtkSatListModel;
+typedef struct _GtkSatListModelClass GtkSatListModelClass;
+
+/**
+ * Tree model exposing the satellites of a module to the GtkSatList.
+ *
+ * The model does not store any column data. Values are read from the
+ * sat_t structures when the view asks for them, so only the rows that
+ * are actually rendered cost anything; text is kept until the next
+ * refresh. Decayed satellites are hidden.
+ */
+struct _gtk_sat_list_model {
+    GObject         parent;
+
+    gint            stamp;      /*!< iterator stamp */
+    GHashTable     *satellites; /*!< satellites (not owned) */
+    qth_t          *qth;        /*!< ground station (not owned) */
+
+    GPtrArray      *rows;       /*!< all rows, owns the row data */
+    GHashTable     *index;      /*!< catnum -> row */
+    GPtrArray      *order;      /*!< rows shown in the view, in sort order */
+
+    gint            sort_column;
+    GtkSortType     sort_order;
+    guint           textgen;    /*!< generation of the formatted text */
+};
+
+struct _GtkSatListModelClass {
+    GObjectClass    parent_class;
+};
+
+GType           gtk_sat_list_model_get_type(void);
+GtkSatListModel *gtk_sat_list_model_new(GHashTable * sats, qth_t * qth);
+void            gtk_sat_list_model_set_sats(GtkSatListModel * model,
+                                            GHashTable * sats);
+void            gtk_sat_list_model_reload_sat(GtkSatListModel * model,
+                                              sat_t * sat);
+void            gtk_sat_list_model_refresh(GtkSatListModel * model,
+                                           gint first, gint last);
+sat_t          *gtk_sat_list_model_get_sat(GtkSatListModel * model,
+                                           GtkTreeIter * iter);
+gboolean        gtk_sat_list_model_get_iter(GtkSatListModel * model,
+                                            gint catnum, GtkTreeIter * iter);
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+}
+#endif
+/* *INDENT-ON* */
+
+#endif
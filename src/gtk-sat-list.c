@@ -35,13 +35,10 @@
 #include "gtk-sat-data.h"
 #include "gtk-sat-list.h"
 #include "gtk-sat-list-popup.h"
-#include "locator.h"
 #include "mod-cfg-get-param.h"
-#include "orbit-tools.h"
 #include "sat-cfg.h"
 #include "sat-info.h"
 #include "sat-log.h"
-#include "sat-vis.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
 
@@ -144,11 +141,6 @@ static void     gtk_sat_list_class_init(GtkSatListClass * class,
 static void     gtk_sat_list_init(GtkSatList * list,
 				  gpointer g_class);
 static void     gtk_sat_list_destroy(GtkWidget * widget);
-static GtkTreeModel *create_and_fill_model(GHashTable * sats);
-static void     sat_list_add_satellites(gpointer key, gpointer value,
-                                        gpointer user_data);
-static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
-                                     GtkTreeIter * iter, gpointer data);
 
 /* cell rendering related functions */
 static void     check_and_set_cell_renderer(GtkTreeViewColumn * column,
@@ -203,10 +195,6 @@ static void     event_cell_data_function(GtkTreeViewColumn * col,
                                          GtkTreeIter * iter, gpointer column);
 
 
-static gint     event_cell_compare_function(GtkTreeModel * model,
-                                            GtkTreeIter * a, GtkTreeIter * b,
-                                            gpointer user_data);
-
 static gboolean popup_menu_cb(GtkWidget * treeview, gpointer list);
 static gboolean button_press_cb(GtkWidget * treeview, GdkEventButton * event,
                                 gpointer list);
@@ -215,9 +203,6 @@ static void     row_activated_cb(GtkTreeView * tree_view, GtkTreePath * path,
 
 static void     view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
                                 gpointer list);
-static void     Calculate_RADec(sat_t * sat, qth_t * qth,
-                                obs_astro_t * obs_set);
-
 static GtkVBoxClass *parent_class = NULL;
 
 
@@ -271,6 +256,15 @@ static void gtk_sat_list_destroy(GtkWidget * widget)
 {
     GtkSatList     *list = GTK_SAT_LIST(widget);
 
+    if (list->model != NULL)
+    {
+        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(list->model),
+                                             &list->sort_column,
+                                             &list->sort_order);
+        g_object_unref(list->model);
+        list->model = NULL;
+    }
+
     g_key_file_set_integer(list->cfgdata, MOD_CFG_LIST_SECTION,
                            MOD_CFG_LIST_SORT_COLUMN, list->sort_column);
 
@@ -285,7 +279,6 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
 {
 //    GtkWidget      *widget;
     GtkSatList     *satlist;
-    GtkTreeModel   *model, *filter, *sortable;
     guint           i;
 
     GtkCellRenderer *renderer;
@@ -384,33 +377,14 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
             gtk_tree_view_column_set_visible(column, FALSE);
     }
 
-    /* create model and finalise treeview */
-    model = create_and_fill_model(satlist->satellites);
-    filter = gtk_tree_model_filter_new(model, NULL);
-    sortable = gtk_tree_model_sort_new_with_model(filter);
-    satlist->sortable = sortable;
-    gtk_tree_model_filter_set_visible_column(GTK_TREE_MODEL_FILTER(filter),
-                                             SAT_LIST_COL_DECAY);
-    gtk_tree_view_set_model(GTK_TREE_VIEW(satlist->treeview), sortable);
-
-    /* We need a special sort function for AOS/LOS events that works
-       with all date and time formats (see bug #1861323)
-     */
-    gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(model), SAT_LIST_COL_AOS,
-                                    event_cell_compare_function,
-                                    GTK_WIDGET(satlist), NULL);
-    gtk_tree_sortable_set_sort_func(GTK_TREE_SORTABLE(model), SAT_LIST_COL_LOS,
-                                    event_cell_compare_function,
-                                    GTK_WIDGET(satlist), NULL);
-
-    /* satellite name should be initial sorting criteria */
-    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(sortable),
+    /* create model and finalise treeview; the model keeps the rows
+       sorted itself and hides decayed satellites */
+    satlist->model = gtk_sat_list_model_new(satlist->satellites, satlist->qth);
+    gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(satlist->model),
                                          satlist->sort_column,
                                          satlist->sort_order);
-
-    g_object_unref(model);
-    g_object_unref(filter);
-    g_object_unref(sortable);
+    gtk_tree_view_set_model(GTK_TREE_VIEW(satlist->treeview),
+                            GTK_TREE_MODEL(satlist->model));
 
     g_signal_connect(satlist->treeview, "button-press-event",
                      G_CALLBACK(button_press_cb), satlist);
@@ -430,92 +404,18 @@ GtkWidget      *gtk_sat_list_new(GKeyFile * cfgdata, GHashTable * sats,
     return GTK_WIDGET(satlist);
 }
 
-static GtkTreeModel *create_and_fill_model(GHashTable * sats)
-{
-    GtkListStore   *liststore;
-
-    liststore = gtk_list_store_new(SAT_LIST_COL_NUMBER, G_TYPE_STRING,  // name
-                                   G_TYPE_INT,  // catnum
-                                   G_TYPE_DOUBLE,       // az
-                                   G_TYPE_DOUBLE,       // el
-                                   G_TYPE_STRING,       // direction
-                                   G_TYPE_DOUBLE,       // RA
-                                   G_TYPE_DOUBLE,       // Dec
-                                   G_TYPE_DOUBLE,       // range
-                                   G_TYPE_DOUBLE,       // range rate
-                                   G_TYPE_STRING,       // next event
-                                   G_TYPE_DOUBLE,       // next AOS
-                                   G_TYPE_DOUBLE,       // next LOS
-                                   G_TYPE_DOUBLE,       // ssp lat
-                                   G_TYPE_DOUBLE,       // ssp lon
-                                   G_TYPE_STRING,       // ssp qra
-                                   G_TYPE_DOUBLE,       // footprint
-                                   G_TYPE_DOUBLE,       // alt
-                                   G_TYPE_DOUBLE,       // vel
-                                   G_TYPE_DOUBLE,       // doppler
-                                   G_TYPE_DOUBLE,       // path loss
-                                   G_TYPE_DOUBLE,       // delay
-                                   G_TYPE_DOUBLE,       // mean anomaly
-                                   G_TYPE_DOUBLE,       // phase
-                                   G_TYPE_LONG, // orbit
-                                   G_TYPE_STRING,       // visibility
-                                   G_TYPE_BOOLEAN,      // decay
-                                   G_TYPE_INT,       // Operational Status
-                                   G_TYPE_INT   // weight/bold
-        );
-
-
-    g_hash_table_foreach(sats, sat_list_add_satellites, liststore);
-
-    return GTK_TREE_MODEL(liststore);
-}
-
-
-static void sat_list_add_satellites(gpointer key, gpointer value,
-                                    gpointer user_data)
-{
-    GtkListStore   *store = GTK_LIST_STORE(user_data);
-    GtkTreeIter     item;
-    sat_t          *sat = SAT(value);
-
-    (void)key;
-
-    gtk_list_store_append(store, &item);
-    gtk_list_store_set(store, &item,
-                       SAT_LIST_COL_NAME, sat->nickname,
-                       SAT_LIST_COL_CATNUM, sat->tle.catnr,
-                       SAT_LIST_COL_AZ, sat->az,
-                       SAT_LIST_COL_EL, sat->el,
-                       SAT_LIST_COL_VISIBILITY, "-",
-                       SAT_LIST_COL_RA, sat->ra,
-                       SAT_LIST_COL_DEC, sat->dec,
-                       SAT_LIST_COL_RANGE, sat->range,
-                       SAT_LIST_COL_RANGE_RATE, sat->range_rate,
-                       SAT_LIST_COL_DIR, "-",
-                       SAT_LIST_COL_NEXT_EVENT, "--- N/A ---",
-                       SAT_LIST_COL_AOS, sat->aos,
-                       SAT_LIST_COL_LOS, sat->los,
-                       SAT_LIST_COL_LAT, sat->ssplat,
-                       SAT_LIST_COL_LON, sat->ssplon,
-                       SAT_LIST_COL_SSP, "",
-                       SAT_LIST_COL_FOOTPRINT, sat->footprint,
-                       SAT_LIST_COL_ALT, sat->alt,
-                       SAT_LIST_COL_VEL, sat->velo,
-                       SAT_LIST_COL_DOPPLER, 0.0,
-                       SAT_LIST_COL_LOSS, 0.0,
-                       SAT_LIST_COL_DELAY, 0.0,
-                       SAT_LIST_COL_MA, sat->ma,
-                       SAT_LIST_COL_PHASE, sat->phase,
-                       SAT_LIST_COL_ORBIT, sat->orbit, 
-                       SAT_LIST_COL_STAT_OPERATIONAL, (char *) sat->tle.status,
-                       SAT_LIST_COL_DECAY, !decayed(sat), -1);
-}
-
-/** Update satellites */
+/**
+ * Update satellites.
+ *
+ * The model reads the satellite data directly, so all we need to do is to
+ * let it re-sort and tell the view which of the visible rows to redraw.
+ */
 void gtk_sat_list_update(GtkWidget * widget)
 {
-    GtkTreeModel   *model;
     GtkSatList     *satlist = GTK_SAT_LIST(widget);
+    GtkTreePath    *start, *end;
+    gint            first = 0;
+    gint            last = -1;
 
     /* first, do some sanity checks */
     if ((satlist == NULL) || !IS_GTK_SAT_LIST(satlist))
@@ -534,278 +434,18 @@ void gtk_sat_list_update(GtkWidget * widget)
     {
         satlist->counter = 1;
 
-        /* get and tranverse the model */
-        model =
-            gtk_tree_model_filter_get_model(GTK_TREE_MODEL_FILTER
-                                            (gtk_tree_model_sort_get_model
-                                             (GTK_TREE_MODEL_SORT
-                                              (gtk_tree_view_get_model
-                                               (GTK_TREE_VIEW
-                                                (satlist->treeview))))));
-
-        /*save the sort information */
-        gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE
-                                             (satlist->sortable),
-                                             &(satlist->sort_column),
-                                             &(satlist->sort_order));
-
-        /* optimisation: detach model from view while updating */
-        /* No, we do not do it, because it makes selections and scrolling
-           impossible
-         */
-        /*         g_object_ref (model); */
-        /*         gtk_tree_view_set_model (GTK_TREE_VIEW (satlist->treeview), NULL); */
-
-        /* update */
-        gtk_tree_model_foreach(model, sat_list_update_sats, satlist);
-
-        /* re-attach model to view */
-        /*         gtk_tree_view_set_model (GTK_TREE_VIEW (satlist->treeview), model); */
-
-        /*         g_object_unref (model); */
-    }
-}
-
-/** Update data in each column in a given row */
-static gboolean sat_list_update_sats(GtkTreeModel * model, GtkTreePath * path,
-                                     GtkTreeIter * iter, gpointer data)
-{
-    GtkSatList     *satlist = GTK_SAT_LIST(data);
-    guint          *catnum;
-    sat_t          *sat;
-    gchar          *buff;
-    gdouble         doppler;
-    gdouble         delay;
-    gdouble         loss;
-    gdouble         oldrate;
-    gint            retcode;
-
-    (void)path;
-
-    /* get the catalogue number for this row
-       then look it up in the hash table
-     */
-    catnum = g_new0(guint, 1);
-    gtk_tree_model_get(model, iter, SAT_LIST_COL_CATNUM, catnum, -1);
-    sat = SAT(g_hash_table_lookup(satlist->satellites, catnum));
-
-    if (sat == NULL)
-    {
-        /* satellite not tracked anymore => remove */
-        sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s: Failed to get data for #%d."), __func__, *catnum);
-
-        gtk_list_store_remove(GTK_LIST_STORE(model), iter);
-
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s: Satellite #%d removed from list."), __func__,
-                    *catnum);
-    }
-    else
-    {
-        /* store new data */
-        gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                           SAT_LIST_COL_AZ, sat->az,
-                           SAT_LIST_COL_EL, sat->el,
-                           SAT_LIST_COL_RANGE, sat->range,
-                           SAT_LIST_COL_RANGE_RATE, sat->range_rate,
-                           SAT_LIST_COL_LAT, sat->ssplat,
-                           SAT_LIST_COL_LON, sat->ssplon,
-                           SAT_LIST_COL_FOOTPRINT, sat->footprint,
-                           SAT_LIST_COL_ALT, sat->alt,
-                           SAT_LIST_COL_VEL, sat->velo,
-                           SAT_LIST_COL_MA, sat->ma,
-                           SAT_LIST_COL_PHASE, sat->phase,
-                           SAT_LIST_COL_ORBIT, sat->orbit,
-                           SAT_LIST_COL_DECAY, !decayed(sat),
-                           SAT_LIST_COL_BOLD,
-                           (sat->el >
-                            0.0) ? PANGO_WEIGHT_BOLD : PANGO_WEIGHT_NORMAL,
-                           -1);
-
-        /* doppler shift @ 100 MHz */
-        if (satlist->flags & SAT_LIST_FLAG_DOPPLER)
-        {
-            doppler = -100.0e06 * (sat->range_rate / 299792.4580);      // Hz
-            gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                               SAT_LIST_COL_DOPPLER, doppler, -1);
-        }
-
-        /* delay */
-        if (satlist->flags & SAT_LIST_FLAG_DELAY)
-        {
-            delay = sat->range / 299.7924580;   // msec 
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DELAY,
-                               delay, -1);
-        }
-
-        /* path loss */
-        if (satlist->flags & SAT_LIST_FLAG_LOSS)
-        {
-            loss = 72.4 + 20.0 * log10(sat->range);     // dB
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_LOSS,
-                               loss, -1);
-        }
-
-        /* calculate direction */
-        if (satlist->flags & SAT_LIST_FLAG_DIR)
-        {
-            if (sat->otype == ORBIT_TYPE_GEO)
-            {
-                buff = g_strdup("G");
-            }
-            else if (decayed(sat))
-            {
-                buff = g_strdup("D");
-            }
-            else if (sat->range_rate > 0.001)
-            {
-                /* going down */
-                buff = g_strdup("\342\206\223");
-            }
-            else if ((sat->range_rate <= 0.001) && (sat->range_rate >= -0.001))
-            {
-                gtk_tree_model_get(model, iter, SAT_LIST_COL_RANGE_RATE,
-                                   &oldrate, -1);
-                /* turning around; don't know which way ? */
-                if (sat->range_rate < oldrate)
-                {
-                    /* starting to approach */
-                    buff = g_strdup("\342\206\272");
-                }
-                else
-                {
-                    /* to receed */
-                    buff = g_strdup("\342\206\267");
-                }
-            }
-            else if (sat->range_rate < -0.001)
-            {
-                /* coming up */
-                buff = g_strdup("\342\206\221");
-            }
-            else
-            {
-                buff = g_strdup("-");
-            }
-
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_DIR,
-                               buff, -1);
-
-            /* free memory */
-            g_free(buff);
-
-        }
-
-        /* SSP locator */
-        if (satlist->flags & SAT_LIST_FLAG_SSP)
-        {
-
-            buff = g_try_malloc(7);
-
-            retcode = longlat2locator(sat->ssplon, sat->ssplat, buff, 3);
-            if (retcode == RIG_OK)
-            {
-                buff[6] = '\0';
-                gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                                   SAT_LIST_COL_SSP, buff, -1);
-            }
-            g_free(buff);
-        }
-
-        /* Ra and Dec */
-        if (satlist->flags & (SAT_LIST_FLAG_RA | SAT_LIST_FLAG_DEC))
-        {
-            obs_astro_t     astro;
-
-            Calculate_RADec(sat, satlist->qth, &astro);
-
-            sat->ra = Degrees(astro.ra);
-            sat->dec = Degrees(astro.dec);
-
-            gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                               SAT_LIST_COL_RA, sat->ra, SAT_LIST_COL_DEC,
-                               sat->dec, -1);
-        }
-
-        /* upcoming events */
-        /*** FIXME: not necessary to update every time */
-        if (satlist->flags & SAT_LIST_FLAG_AOS)
+        /* only the rows inside the viewport need to be redrawn */
+        if (gtk_tree_view_get_visible_range(GTK_TREE_VIEW(satlist->treeview),
+                                            &start, &end))
         {
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_AOS,
-                               sat->aos, -1);
-        }
-        if (satlist->flags & SAT_LIST_FLAG_LOS)
-        {
-            gtk_list_store_set(GTK_LIST_STORE(model), iter, SAT_LIST_COL_LOS,
-                               sat->los, -1);
-
+            first = gtk_tree_path_get_indices(start)[0];
+            last = gtk_tree_path_get_indices(end)[0];
+            gtk_tree_path_free(start);
+            gtk_tree_path_free(end);
         }
-        if (satlist->flags & SAT_LIST_FLAG_NEXT_EVENT)
-        {
-            gdouble         number;
-            gchar           buff[TIME_FORMAT_MAX_LENGTH];
-            gchar          *tfstr;
-            gchar          *fmtstr;
-            gchar          *alstr;
-
-
-            if (sat->aos > sat->los)
-            {
-                /* next event is LOS */
-                number = sat->los;
-                alstr = g_strdup(" (LOS)");
-            }
-            else
-            {
-                /* next event is AOS */
-                number = sat->aos;
-                alstr = g_strdup(" (AOS)");
-            }
 
-            if (number == 0.0)
-            {
-                gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                                   SAT_LIST_COL_NEXT_EVENT, "--- N/A ---", -1);
-            }
-            else
-            {
-
-                /* format the number */
-                tfstr = sat_cfg_get_str(SAT_CFG_STR_TIME_FORMAT);
-                fmtstr = g_strconcat(tfstr, alstr, NULL);
-                g_free(tfstr);
-
-                daynum_to_str(buff, TIME_FORMAT_MAX_LENGTH, fmtstr, number);
-
-                gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                                   SAT_LIST_COL_NEXT_EVENT, buff, -1);
-
-
-                g_free(fmtstr);
-            }
-
-            g_free(alstr);
-        }
-
-        if (satlist->flags & SAT_LIST_FLAG_VISIBILITY)
-        {
-            sat_vis_t       vis;
-
-            vis = get_sat_vis(sat, satlist->qth, sat->jul_utc);
-            buff = g_strdup_printf("%c", vis_to_chr(vis));
-            gtk_list_store_set(GTK_LIST_STORE(model), iter,
-                               SAT_LIST_COL_VISIBILITY, buff, -1);
-            g_free(buff);
-        }
+        gtk_sat_list_model_refresh(satlist->model, first, last);
     }
-
-    g_free(catnum);
-
-    /* Return value not documented what to return, but it seems that
-       FALSE continues to next row while TRUE breaks
-     */
-    return FALSE;
 }
 
 /** Set cell renderer function. */
@@ -1157,57 +797,6 @@ static void event_cell_data_function(GtkTreeViewColumn * col,
 
 }
 
-/**
- * Function to compare to Event cells.
- *
- * @param model Pointer to the GtkTreeModel.
- * @param a Pointer to the first element.
- * @param b Pointer to the second element.
- * @param user_data Always NULL (TBC).
- * 2return See detailed description.
- *
- * This function is used by the SatList sort function to determine whether
- * AOS/LOS cell a is greater than b or not. The cells a and b contain the
- * time of the event in Julian days, thus the result can be computed by a
- * simple comparison between the two numbers contained in the cells.
- *
- * The function returns -1 if a < b; +1 if a > b; 0 otherwise.
- */
-static gint event_cell_compare_function(GtkTreeModel * model,
-                                        GtkTreeIter * a,
-                                        GtkTreeIter * b, gpointer user_data)
-{
-    gint            result;
-    gdouble         ta, tb;
-    gint            sort_col;
-    GtkSortType     sort_type;
-    GtkSatList     *satlist = GTK_SAT_LIST(user_data);
-
-    /* Since this function is used for both AOS and LOS columns,
-       we need to get the sort column */
-    gtk_tree_sortable_get_sort_column_id(GTK_TREE_SORTABLE(satlist->sortable),
-                                         &sort_col, &sort_type);
-
-    /* get a and b */
-    gtk_tree_model_get(model, a, sort_col, &ta, -1);
-    gtk_tree_model_get(model, b, sort_col, &tb, -1);
-
-    if (ta < tb)
-    {
-        result = -1;
-    }
-    else if (ta > tb)
-    {
-        result = 1;
-    }
-    else
-    {
-        result = 0;
-    }
-
-    return result;
-}
-
 /** Reload configuration */
 void gtk_sat_list_reconf(GtkWidget * widget, GKeyFile * cfgdat)
 {
@@ -1290,59 +879,47 @@ static void row_activated_cb(GtkTreeView * tree_view,
                              GtkTreePath * path,
                              GtkTreeViewColumn * column, gpointer list)
 {
-    GtkTreeModel   *model;
     GtkTreeIter     iter;
-    guint          *catnum;
     sat_t          *sat;
 
     (void)column;
 
-    catnum = g_new0(guint, 1);
-
-    model = gtk_tree_view_get_model(tree_view);
-    gtk_tree_model_get_iter(model, &iter, path);
-    gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
+    if (!gtk_tree_model_get_iter(gtk_tree_view_get_model(tree_view),
+                                 &iter, path))
+        return;
 
-    sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+    sat = gtk_sat_list_model_get_sat(GTK_SAT_LIST(list)->model, &iter);
 
     if (sat == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO,
-                    _("%s:%d Failed to get data for %d."), __FILE__, __LINE__,
-                    *catnum);
+                    _("%s:%d Failed to get satellite data."), __FILE__,
+                    __LINE__);
     }
     else
     {
         show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(list)));
     }
-
-    g_free(catnum);
 }
 
 static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
                             gpointer list)
 {
     GtkTreeSelection *selection;
-    GtkTreeModel   *model;
     GtkTreeIter     iter;
-    guint          *catnum;
     sat_t          *sat;
 
-    catnum = g_new0(guint, 1);
-
     /* get selected satellite */
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(treeview));
-    if (gtk_tree_selection_get_selected(selection, &model, &iter))
+    if (gtk_tree_selection_get_selected(selection, NULL, &iter))
     {
-        gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, catnum, -1);
-
-        sat = SAT(g_hash_table_lookup(GTK_SAT_LIST(list)->satellites, catnum));
+        sat = gtk_sat_list_model_get_sat(GTK_SAT_LIST(list)->model, &iter);
 
         if (sat == NULL)
         {
             sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s:%d Failed to get data for %d."), __FILE__,
-                        __LINE__, *catnum);
+                        _("%s:%d Failed to get satellite data."), __FILE__,
+                        __LINE__);
 
         }
         else
@@ -1357,97 +934,31 @@ static void view_popup_menu(GtkWidget * treeview, GdkEventButton * event,
                     _("%s:%d: There is no selection; skip popup."), __FILE__,
                     __LINE__);
     }
-
-    g_free(catnum);
-}
-
-/*** FIXME: formalise with other copies, only need az,el and jul_utc */
-static void Calculate_RADec(sat_t * sat, qth_t * qth, obs_astro_t * obs_set)
-{
-    /* Reference:  Methods of Orbit Determination by  */
-    /*                Pedro Ramon Escobal, pp. 401-402 */
-
-    double          phi, theta, sin_theta, cos_theta, sin_phi, cos_phi,
-        az, el, Lxh, Lyh, Lzh, Sx, Ex, Zx, Sy, Ey, Zy, Sz, Ez, Zz,
-        Lx, Ly, Lz, cos_delta, sin_alpha, cos_alpha;
-    geodetic_t      geodetic;
-
-    geodetic.lon = qth->lon * de2ra;
-    geodetic.lat = qth->lat * de2ra;
-    geodetic.alt = qth->alt / 1000.0;
-    geodetic.theta = 0;
-
-    az = sat->az * de2ra;
-    el = sat->el * de2ra;
-    phi = geodetic.lat;
-    theta = FMod2p(ThetaG_JD(sat->jul_utc) + geodetic.lon);
-    sin_theta = sin(theta);
-    cos_theta = cos(theta);
-    sin_phi = sin(phi);
-    cos_phi = cos(phi);
-    Lxh = -cos(az) * cos(el);
-    Lyh = sin(az) * cos(el);
-    Lzh = sin(el);
-    Sx = sin_phi * cos_theta;
-    Ex = -sin_theta;
-    Zx = cos_theta * cos_phi;
-    Sy = sin_phi * sin_theta;
-    Ey = cos_theta;
-    Zy = sin_theta * cos_phi;
-    Sz = -cos_phi;
-    Ez = 0;
-    Zz = sin_phi;
-    Lx = Sx * Lxh + Ex * Lyh + Zx * Lzh;
-    Ly = Sy * Lxh + Ey * Lyh + Zy * Lzh;
-    Lz = Sz * Lxh + Ez * Lyh + Zz * Lzh;
-    obs_set->dec = ArcSin(Lz);  /* Declination (radians) */
-    cos_delta = sqrt(1 - Sqr(Lz));
-    sin_alpha = Ly / cos_delta;
-    cos_alpha = Lx / cos_delta;
-    obs_set->ra = AcTan(sin_alpha, cos_alpha);  /* Right Ascension (radians) */
-    obs_set->ra = FMod2p(obs_set->ra);
 }
 
 /** Reload reference to satellites (e.g. after TLE update). */
 void gtk_sat_list_reload_sats(GtkWidget * satlist, GHashTable * sats)
 {
     GTK_SAT_LIST(satlist)->satellites = sats;
+    gtk_sat_list_model_set_sats(GTK_SAT_LIST(satlist)->model, sats);
+}
+
+/** Reload a satellite whose elements have changed */
+void gtk_sat_list_reload_sat(GtkWidget * satlist, sat_t * sat)
+{
+    gtk_sat_list_model_reload_sat(GTK_SAT_LIST(satlist)->model, sat);
 }
 
 /** Select a satellite */
 void gtk_sat_list_select_sat(GtkWidget * satlist, gint catnum)
 {
     GtkSatList     *slist;
-    GtkTreeModel   *model;
     GtkTreeSelection *selection;
     GtkTreeIter     iter;
-    gint            i, n;
-    gint            sat;
-
 
     slist = GTK_SAT_LIST(satlist);
-    model = gtk_tree_view_get_model(GTK_TREE_VIEW(slist->treeview));
     selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(slist->treeview));
 
-    /* iterate over the satellite list until a amtch is found */
-    n = g_hash_table_size(slist->satellites);
-    for (i = 0; i < n; i++)
-    {
-
-        if (gtk_tree_model_iter_nth_child(model, &iter, NULL, i))
-        {
-            gtk_tree_model_get(model, &iter, SAT_LIST_COL_CATNUM, &sat, -1);
-            if (sat == catnum)
-            {
-                gtk_tree_selection_select_iter(selection, &iter);
-                i = n;
-            }
-        }
-        else
-        {
-            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                        _("%s: GtkSatList has not child with index %d"),
-                        __func__, i);
-        }
-    }
+    if (gtk_sat_list_model_get_iter(slist->model, catnum, &iter))
+        gtk_tree_selection_select_iter(selection, &iter);
 }
@@ -30,6 +30,7 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "gtk-sat-list-model.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -66,7 +67,7 @@ struct _gtk_sat_list {
     GKeyFile       *cfgdata;
     gint            sort_column;
     GtkSortType     sort_order;
-    GtkTreeModel   *sortable;   /*!< a sortable version of the tree model for filtering */
+    GtkSatListModel *model;     /*!< tree model reading directly from the satellites */
 
     void            (*update) (GtkWidget * widget);     /*!< update function */
 };
@@ -148,6 +149,7 @@ void            gtk_sat_list_reconf(GtkWidget * widget, GKeyFile * cfgdat);
 
 void            gtk_sat_list_reload_sats(GtkWidget * satlist,
                                          GHashTable * sats);
+void            gtk_sat_list_reload_sat(GtkWidget * satlist, sat_t * sat);
 void            gtk_sat_list_select_sat(GtkWidget * satlist, gint catnum);
 
 /* *INDENT-OFF* */
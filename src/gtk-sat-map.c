@@ -47,6 +47,9 @@
 
 #define MARKER_SIZE_HALF    3
 
+/* Half size of the point sprites used in LOD mode */
+#define LOD_POINT_SIZE_HALF 1
+
 /* Update terminator every 30 seconds */
 #define TERMINATOR_UPDATE_INTERVAL (15.0/86400.0)
 
@@ -103,6 +106,8 @@ static void     gtk_sat_map_store_hidecovs(GtkSatMap * satmap);
 static void     reset_ground_track(gpointer key, gpointer value,
                                    gpointer user_data);
 static sat_map_obj_t *find_sat_at_pos(GtkSatMap * satmap, gfloat mx, gfloat my);
+static void     draw_lod_sats(GtkSatMap * satmap, cairo_t * cr,
+                              PangoLayout * layout);
 
 static GtkBoxClass *parent_class = NULL;
 
@@ -120,6 +125,18 @@ static void rgba_to_cairo(guint32 rgba, gdouble * r, gdouble * g,
     *a = (rgba & 0xFF) / 255.0;
 }
 
+/**
+ * Check whether a satellite object should be rendered with full detail.
+ *
+ * In LOD mode only selected, targeted and tracked satellites get labels,
+ * footprints and tooltips; everything else is drawn as a point sprite.
+ */
+static inline gboolean obj_has_details(GtkSatMap * satmap,
+                                       sat_map_obj_t * obj)
+{
+    return !satmap->lod || obj->selected || obj->istarget || obj->showtrack;
+}
+
 GType gtk_sat_map_get_type()
 {
     static GType    gtk_sat_map_type = 0;
@@ -197,8 +214,14 @@ static void gtk_sat_map_init(GtkSatMap * satmap,
     satmap->terminator_points = NULL;
     satmap->terminator_count = 0;
     satmap->font = NULL;
+    satmap->mipmap = NULL;
     satmap->map = NULL;
     satmap->grid_lines_valid = FALSE;
+    satmap->lod_threshold = 0;
+    satmap->cluster_size = 0;
+    satmap->lod = FALSE;
+    satmap->cluster_bins = NULL;
+    satmap->cluster_nbins = 0;
 }
 
 static void gtk_sat_map_destroy(GtkWidget * widget)
@@ -217,12 +240,9 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         g_hash_table_destroy(satmap->obj);
         satmap->obj = NULL;
 
-        /* free the original map pixbuf */
-        if (satmap->origmap)
-        {
-            g_object_unref(satmap->origmap);
-            satmap->origmap = NULL;
-        }
+        /* release the map cache */
+        map_tools_mip_unref(satmap->mipmap);
+        satmap->mipmap = NULL;
 
         /* free the scaled map pixbuf */
         if (satmap->map)
@@ -255,6 +275,11 @@ static void gtk_sat_map_destroy(GtkWidget * widget)
         satmap->terminator_points = NULL;
         satmap->terminator_count = 0;
 
+        /* free cluster bins */
+        g_free(satmap->cluster_bins);
+        satmap->cluster_bins = NULL;
+        satmap->cluster_nbins = 0;
+
         /* free temporary point arrays */
         g_free(temp_points1);
         temp_points1 = NULL;
@@ -328,6 +353,18 @@ GtkWidget      *gtk_sat_map_new(GKeyFile * cfgdata, GHashTable * sats,
                                          MOD_CFG_MAP_KEEP_RATIO,
                                          SAT_CFG_BOOL_MAP_KEEP_RATIO);
 
+    satmap->lod_threshold = mod_cfg_get_int(cfgdata,
+                                            MOD_CFG_MAP_SECTION,
+                                            MOD_CFG_MAP_LOD_THRESHOLD,
+                                            SAT_CFG_INT_MAP_LOD_THRESHOLD);
+    satmap->cluster_size = mod_cfg_get_int(cfgdata,
+                                           MOD_CFG_MAP_SECTION,
+                                           MOD_CFG_MAP_CLUSTER_SIZE,
+                                           SAT_CFG_INT_MAP_CLUSTER_SIZE);
+    satmap->cluster_size = MIN(satmap->cluster_size, SAT_MAP_LOD_MAX_CLUSTER);
+    satmap->lod = (satmap->lod_threshold > 0) &&
+        (g_hash_table_size(sats) > satmap->lod_threshold);
+
     col = mod_cfg_get_int(cfgdata,
                           MOD_CFG_MAP_SECTION,
                           MOD_CFG_MAP_INFO_BGD_COL,
@@ -457,14 +494,32 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
     gchar           hmf = ' ';
     guint32         globe_shadow_col;
     GSList         *line_node;
+    gdouble         shift;
 
     (void)widget;
 
-    /* Draw background map */
+    /* Draw background map; the scaled map is centered at 0 longitude and is
+       rotated to the configured center by painting it twice with a shift */
     if (satmap->map)
     {
-        gdk_cairo_set_source_pixbuf(cr, satmap->map, satmap->x0, satmap->y0);
+        shift = round((satmap->left_side_lon + 180.0) * satmap->width / 360.0);
+        shift = fmod(shift, (gdouble) satmap->width);
+
+        cairo_save(cr);
+        cairo_rectangle(cr, satmap->x0, satmap->y0,
+                        satmap->width, satmap->height);
+        cairo_clip(cr);
+        gdk_cairo_set_source_pixbuf(cr, satmap->map,
+                                    satmap->x0 - shift, satmap->y0);
         cairo_paint(cr);
+        if (shift > 0.0)
+        {
+            gdk_cairo_set_source_pixbuf(cr, satmap->map,
+                                        satmap->x0 - shift + satmap->width,
+                                        satmap->y0);
+            cairo_paint(cr);
+        }
+        cairo_restore(cr);
     }
 
     /* Set up font */
@@ -593,6 +648,10 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
     cairo_move_to(cr, x - tw / 2, y + 2);
     pango_cairo_show_layout(cr, layout);
 
+    /* Draw the bulk of the satellites as point sprites or clusters */
+    if (satmap->obj && satmap->lod)
+        draw_lod_sats(satmap, cr, layout);
+
     /* Draw satellite objects */
     if (satmap->obj)
     {
@@ -601,6 +660,10 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
         {
             obj = SAT_MAP_OBJ(value);
 
+            /* already drawn by draw_lod_sats() */
+            if (!obj_has_details(satmap, obj))
+                continue;
+
             /* Draw ground track if enabled */
             if (obj->showtrack && obj->track_data.lines)
             {
@@ -808,6 +871,119 @@ static gboolean on_draw(GtkWidget * widget, cairo_t * cr, gpointer data)
     return FALSE;
 }
 
+/**
+ * Draw the satellites that have no details in LOD mode.
+ *
+ * All point sprites are collected into a single path and filled in one go.
+ * When clustering is enabled the map is divided into square cells and cells
+ * containing more than one satellite are drawn as a bubble showing the number
+ * of satellites in the cell.
+ */
+static void draw_lod_sats(GtkSatMap * satmap, cairo_t * cr,
+                          PangoLayout * layout)
+{
+    GHashTableIter  iter;
+    gpointer        key, value;
+    sat_map_obj_t  *obj;
+    gdouble         r, g, b, a;
+    guint           cols = 0, rows = 0, nbins = 0;
+    guint           col, row, i;
+    gint            tw, th;
+    gchar           buf[16];
+    gdouble         cx, cy, radius;
+
+    if (!satmap->satmarker)
+        return;
+
+    if (satmap->cluster_size > 0 && satmap->width > 0 && satmap->height > 0)
+    {
+        cols = satmap->width / satmap->cluster_size + 1;
+        rows = satmap->height / satmap->cluster_size + 1;
+        nbins = cols * rows;
+
+        if (nbins > satmap->cluster_nbins)
+        {
+            g_free(satmap->cluster_bins);
+            satmap->cluster_bins = g_new(guint, nbins);
+            satmap->cluster_nbins = nbins;
+        }
+        memset(satmap->cluster_bins, 0, nbins * sizeof(guint));
+
+        /* first pass: count satellites per cell */
+        g_hash_table_iter_init(&iter, satmap->obj);
+        while (g_hash_table_iter_next(&iter, &key, &value))
+        {
+            obj = SAT_MAP_OBJ(value);
+            if (obj_has_details(satmap, obj))
+                continue;
+
+            col = MIN((guint) MAX(obj->x - satmap->x0, 0) /
+                      satmap->cluster_size, cols - 1);
+            row = MIN((guint) MAX(obj->y - satmap->y0, 0) /
+                      satmap->cluster_size, rows - 1);
+            satmap->cluster_bins[row * cols + col]++;
+        }
+    }
+
+    /* point sprites for satellites that are alone in their cell */
+    rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
+    cairo_set_source_rgba(cr, r, g, b, a);
+
+    g_hash_table_iter_init(&iter, satmap->obj);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+    {
+        obj = SAT_MAP_OBJ(value);
+        if (obj_has_details(satmap, obj))
+            continue;
+
+        if (nbins > 0)
+        {
+            col = MIN((guint) MAX(obj->x - satmap->x0, 0) /
+                      satmap->cluster_size, cols - 1);
+            row = MIN((guint) MAX(obj->y - satmap->y0, 0) /
+                      satmap->cluster_size, rows - 1);
+            if (satmap->cluster_bins[row * cols + col] > 1)
+                continue;
+        }
+
+        cairo_rectangle(cr, obj->x - LOD_POINT_SIZE_HALF,
+                        obj->y - LOD_POINT_SIZE_HALF,
+                        2 * LOD_POINT_SIZE_HALF, 2 * LOD_POINT_SIZE_HALF);
+    }
+    cairo_fill(cr);
+
+    if (nbins == 0)
+        return;
+
+    /* count bubbles for the dense cells */
+    for (i = 0; i < nbins; i++)
+    {
+        if (satmap->cluster_bins[i] < 2)
+            continue;
+
+        cx = satmap->x0 + (i % cols + 0.5) * satmap->cluster_size;
+        cy = satmap->y0 + (i / cols + 0.5) * satmap->cluster_size;
+        radius = MIN(0.5 * satmap->cluster_size,
+                     MARKER_SIZE_HALF + 2.0 * log2(satmap->cluster_bins[i]));
+
+        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
+        cairo_set_source_rgba(cr, r, g, b, 0.6 * a);
+        cairo_new_sub_path(cr);
+        cairo_arc(cr, cx, cy, radius, 0.0, twopi);
+        cairo_fill(cr);
+
+        g_snprintf(buf, sizeof(buf), "%u", satmap->cluster_bins[i]);
+        pango_layout_set_text(layout, buf, -1);
+        pango_layout_get_pixel_size(layout, &tw, &th);
+
+        /* dark text with the alpha of the satellite labels */
+        rgba_to_cairo(satmap->col_sat, &r, &g, &b, &a);
+        cairo_set_source_rgba(cr, 0, 0, 0, a);
+        cairo_move_to(cr, cx - tw / 2, cy - th / 2);
+        pango_cairo_show_layout(cr, layout);
+    }
+}
+
 /** Find satellite object at given position */
 static sat_map_obj_t *find_sat_at_pos(GtkSatMap * satmap, gfloat mx, gfloat my)
 {
@@ -852,8 +1028,8 @@ static void update_map_size(GtkSatMap * satmap)
 
         if (satmap->keepratio)
         {
-            ratio = (gfloat)gdk_pixbuf_get_width(satmap->origmap) /
-                (gfloat)gdk_pixbuf_get_height(satmap->origmap);
+            ratio = (gfloat)map_tools_mip_get_width(satmap->mipmap) /
+                (gfloat)map_tools_mip_get_height(satmap->mipmap);
 
             gfloat size = MIN(allocation.width, ratio * allocation.height);
 
@@ -863,10 +1039,8 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->x0 = (allocation.width - satmap->width) / 2;
             satmap->y0 = (allocation.height - satmap->height) / 2;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_tools_mip_scale(satmap->mipmap,
+                                       satmap->width, satmap->height);
         }
         else
         {
@@ -875,10 +1049,8 @@ static void update_map_size(GtkSatMap * satmap)
             satmap->width = allocation.width;
             satmap->height = allocation.height;
 
-            pbuf = gdk_pixbuf_scale_simple(satmap->origmap,
-                                           satmap->width,
-                                           satmap->height,
-                                           GDK_INTERP_BILINEAR);
+            pbuf = map_tools_mip_scale(satmap->mipmap,
+                                       satmap->width, satmap->height);
         }
 
         if (satmap->map)
@@ -901,7 +1073,6 @@ void gtk_sat_map_update(GtkWidget * widget)
     sat_t          *sat = NULL;
     gdouble         number, now;
     gchar          *buff;
-    gint           *catnr;
     guint           h, m, s;
     gchar          *ch, *cm, *cs;
 
@@ -937,10 +1108,7 @@ void gtk_sat_map_update(GtkWidget * widget)
         {
             if (satmap->ncat > 0)
             {
-                catnr = g_try_new0(gint, 1);
-                *catnr = satmap->ncat;
-                sat = SAT(g_hash_table_lookup(satmap->sats, catnr));
-                g_free(catnr);
+                sat = SAT(g_hash_table_lookup(satmap->sats, &satmap->ncat));
 
                 /* last desperate sanity check */
                 if (sat != NULL)
@@ -1073,7 +1241,6 @@ static gboolean on_button_press(GtkWidget * widget, GdkEventButton * event,
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj;
-    gint           *catpoint = NULL;
     sat_t          *sat = NULL;
 
     (void)widget;
@@ -1088,28 +1255,21 @@ static gboolean on_button_press(GtkWidget * widget, GdkEventButton * event,
     case 1:
         if (event->type == GDK_2BUTTON_PRESS)
         {
-            catpoint = g_try_new0(gint, 1);
-            *catpoint = obj->catnum;
-
-            sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+            sat = SAT(g_hash_table_lookup(satmap->sats, &obj->catnum));
             if (sat != NULL)
             {
                 show_sat_info(sat, gtk_widget_get_toplevel(GTK_WIDGET(data)));
             }
-            g_free(catpoint);
         }
         break;
 
     case 3:
-        catpoint = g_try_new0(gint, 1);
-        *catpoint = obj->catnum;
-        sat = SAT(g_hash_table_lookup(satmap->sats, catpoint));
+        sat = SAT(g_hash_table_lookup(satmap->sats, &obj->catnum));
         if (sat != NULL)
         {
             gtk_sat_map_popup_exec(sat, satmap->qth, satmap, event,
                                    gtk_widget_get_toplevel(GTK_WIDGET(satmap)));
         }
-        g_free(catpoint);
         break;
     default:
         break;
@@ -1123,7 +1283,7 @@ static gboolean on_button_release(GtkWidget * widget, GdkEventButton * event,
 {
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
-    gint           *catpoint;
+    gint            catnum;
 
     (void)widget;
 
@@ -1137,21 +1297,18 @@ static gboolean on_button_release(GtkWidget * widget, GdkEventButton * event,
 
     obj->selected = !obj->selected;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = obj->catnum;
+    catnum = obj->catnum;
 
     if (!obj->selected)
     {
         g_free(satmap->sel_text);
         satmap->sel_text = NULL;
-        *catpoint = 0;
+        catnum = 0;
     }
 
-    g_hash_table_foreach(satmap->obj, clear_selection, catpoint);
+    g_hash_table_foreach(satmap->obj, clear_selection, &catnum);
     g_hash_table_foreach(satmap->sats, update_sat, satmap);
 
-    g_free(catpoint);
-
     gtk_widget_queue_draw(satmap->canvas);
 
     return TRUE;
@@ -1172,13 +1329,9 @@ static void clear_selection(gpointer key, gpointer val, gpointer data)
 void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
 {
     GtkSatMap      *smap = GTK_SAT_MAP(satmap);
-    gint           *catpoint = NULL;
     sat_map_obj_t  *obj = NULL;
 
-    catpoint = g_try_new0(gint, 1);
-    *catpoint = catnum;
-
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(smap->obj, catpoint));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(smap->obj, &catnum));
     if (obj == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -1188,12 +1341,10 @@ void gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum)
     else
     {
         obj->selected = TRUE;
-        g_hash_table_foreach(smap->obj, clear_selection, catpoint);
+        g_hash_table_foreach(smap->obj, clear_selection, &catnum);
         g_hash_table_foreach(smap->sats, update_sat, smap);
         gtk_widget_queue_draw(smap->canvas);
     }
-
-    g_free(catpoint);
 }
 
 void gtk_sat_map_reconf(GtkWidget * widget, GKeyFile * cfgdat)
@@ -1209,6 +1360,10 @@ static void load_map_file(GtkSatMap * satmap, float clon)
     GError         *error = NULL;
     GdkPixbuf      *tmpbuf;
 
+    /* the map itself is always kept centered at 0 longitude and is shifted
+       at draw time, see on_draw() */
+    map_tools_mip_unref(satmap->mipmap);
+
     buff = mod_cfg_get_str(satmap->cfgdata,
                            MOD_CFG_MAP_SECTION,
                            MOD_CFG_MAP_FILE, SAT_CFG_STR_MAP_FILE);
@@ -1245,29 +1400,29 @@ static void load_map_file(GtkSatMap * satmap, float clon)
                     __FILE__, __LINE__, mapfile);
     }
 
-    tmpbuf = gdk_pixbuf_new_from_file(mapfile, &error);
+    satmap->mipmap = map_tools_mip_ref_file(mapfile, &error);
 
-    if (error != NULL)
+    if (satmap->mipmap == NULL)
     {
         sat_log_log(SAT_LOG_LEVEL_ERROR,
                     _("%s:%d: Error loading map file (%s)"),
-                    __FILE__, __LINE__, error->message);
+                    __FILE__, __LINE__,
+                    error ? error->message : _("unknown error"));
         g_clear_error(&error);
 
         tmpbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, 400, 200);
         gdk_pixbuf_fill(tmpbuf, 0x0F0F0F0F);
+        satmap->mipmap = map_tools_mip_new(tmpbuf);
+        g_object_unref(tmpbuf);
     }
 
-    satmap->origmap = gdk_pixbuf_new(GDK_COLORSPACE_RGB,
-                                     FALSE,
-                                     gdk_pixbuf_get_bits_per_sample(tmpbuf),
-                                     gdk_pixbuf_get_width(tmpbuf),
-                                     gdk_pixbuf_get_height(tmpbuf));
-
-    map_tools_shift_center(tmpbuf, satmap->origmap, clon);
-    g_object_unref(tmpbuf);
     g_free(mapfile);
 
+    if (clon > 180.0)
+        clon = 180.0;
+    else if (clon < -180.0)
+        clon = -180.0;
+
     satmap->left_side_lon = -180.0;
     if (clon > 0.0)
         satmap->left_side_lon += clon;
@@ -1766,25 +1921,31 @@ static void plot_sat(gpointer key, gpointer value, gpointer data)
     obj->x = x;
     obj->y = y;
 
-    obj->nickname = g_strdup(sat->nickname);
-
-    tooltip = g_markup_printf_escaped("<b>%s</b>\n"
-                                      "Lon: %5.1f\302\260\n"
-                                      "Lat: %5.1f\302\260\n"
-                                      " Az: %5.1f\302\260\n"
-                                      " El: %5.1f\302\260",
-                                      sat->nickname,
-                                      sat->ssplon, sat->ssplat,
-                                      sat->az, sat->el);
-    obj->tooltip = tooltip;
-
+    obj->nickname = NULL;
+    obj->tooltip = NULL;
     obj->range1_points = NULL;
     obj->range1_count = 0;
     obj->range2_points = NULL;
     obj->range2_count = 0;
 
-    obj->newrcnum = calculate_footprint(satmap, sat, obj);
-    obj->oldrcnum = obj->newrcnum;
+    /* in LOD mode labels and footprints are created on demand in update_sat */
+    if (obj_has_details(satmap, obj))
+    {
+        obj->nickname = g_strdup(sat->nickname);
+
+        tooltip = g_markup_printf_escaped("<b>%s</b>\n"
+                                          "Lon: %5.1f\302\260\n"
+                                          "Lat: %5.1f\302\260\n"
+                                          " Az: %5.1f\302\260\n"
+                                          " El: %5.1f\302\260",
+                                          sat->nickname,
+                                          sat->ssplon, sat->ssplat,
+                                          sat->az, sat->el);
+        obj->tooltip = tooltip;
+
+        obj->newrcnum = calculate_footprint(satmap, sat, obj);
+        obj->oldrcnum = obj->newrcnum;
+    }
 
     g_hash_table_insert(satmap->obj, catnum, obj);
 }
@@ -1815,7 +1976,6 @@ static void free_sat_obj(gpointer key, gpointer value, gpointer data)
 
 static void update_sat(gpointer key, gpointer value, gpointer data)
 {
-    gint           *catnum;
     GtkSatMap      *satmap = GTK_SAT_MAP(data);
     sat_map_obj_t  *obj = NULL;
     sat_t          *sat = SAT(value);
@@ -1825,9 +1985,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     gchar          *tooltip;
     gchar          *aosstr;
 
-    catnum = g_new0(gint, 1);
-    *catnum = sat->tle.catnr;
-
     now = satmap->tstamp;
 
     if (sat->aos > now)
@@ -1839,13 +1996,12 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         }
     }
 
-    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, catnum));
+    obj = SAT_MAP_OBJ(g_hash_table_lookup(satmap->obj, &sat->tle.catnr));
 
     if (decayed(sat) && obj != NULL)
     {
         free_sat_obj(NULL, obj, satmap);
-        g_hash_table_remove(satmap->obj, catnum);
-        g_free(catnum);
+        g_hash_table_remove(satmap->obj, &sat->tle.catnr);
         return;
     }
 
@@ -1853,13 +2009,11 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     {
         if (decayed(sat))
         {
-            g_free(catnum);
             return;
         }
         else
         {
             plot_sat(key, value, data);
-            g_free(catnum);
             return;
         }
     }
@@ -1869,6 +2023,13 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
         update_selected(satmap, sat);
     }
 
+    /* satellites without details only need their position updated */
+    if (!obj_has_details(satmap, obj))
+    {
+        lonlat_to_xy(satmap, sat->ssplon, sat->ssplat, &obj->x, &obj->y);
+        return;
+    }
+
     g_free(obj->nickname);
     obj->nickname = g_strdup(sat->nickname);
 
@@ -1892,7 +2053,8 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
     oldy = obj->y;
 
     if ((fabs(oldx - x) >= 2 * MARKER_SIZE_HALF) ||
-        (fabs(oldy - y) >= 2 * MARKER_SIZE_HALF))
+        (fabs(oldy - y) >= 2 * MARKER_SIZE_HALF) ||
+        (obj->range1_points == NULL))
     {
         obj->x = x;
         obj->y = y;
@@ -1912,8 +2074,6 @@ static void update_sat(gpointer key, gpointer value, gpointer data)
             ground_track_update(satmap, sat, satmap->qth, obj, FALSE);
         }
     }
-
-    g_free(catnum);
 }
 
 static void update_selected(GtkSatMap * satmap, sat_t * sat)
@@ -2096,9 +2256,13 @@ void gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
 
 void gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats)
 {
-    GTK_SAT_MAP(satmap)->sats = sats;
-    GTK_SAT_MAP(satmap)->naos = 0.0;
-    GTK_SAT_MAP(satmap)->ncat = 0;
+    GtkSatMap      *smap = GTK_SAT_MAP(satmap);
+
+    smap->sats = sats;
+    smap->naos = 0.0;
+    smap->ncat = 0;
+    smap->lod = (smap->lod_threshold > 0) &&
+        (g_hash_table_size(sats) > smap->lod_threshold);
 
     g_hash_table_foreach(GTK_SAT_MAP(satmap)->obj, reset_ground_track, NULL);
 }
@@ -2113,6 +2277,26 @@ static void reset_ground_track(gpointer key, gpointer value,
     obj->track_orbit = 0;
 }
 
+/**
+ * Reload a satellite whose elements have changed.
+ *
+ * Only the ground track of the satellite is recalculated; those of the
+ * other satellites are kept.
+ */
+void gtk_sat_map_reload_sat(GtkWidget * satmap, sat_t * sat)
+{
+    GtkSatMap      *smap = GTK_SAT_MAP(satmap);
+    sat_map_obj_t  *obj;
+
+    /* next event may have changed */
+    smap->naos = 0.0;
+    smap->ncat = 0;
+
+    obj = g_hash_table_lookup(smap->obj, &sat->tle.catnr);
+    if (obj != NULL)
+        obj->track_orbit = 0;
+}
+
 static gchar   *aoslos_time_to_str(GtkSatMap * satmap, sat_t * sat)
 {
     guint           h, m, s;
@@ -7,6 +7,7 @@
 #include <gtk/gtk.h>
 
 #include "gtk-sat-data.h"
+#include "map-tools.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -15,6 +16,7 @@ extern "C" {
 /* *INDENT-ON* */
 
 #define SAT_MAP_RANGE_CIRCLE_POINTS    180      /*!< Number of points used to plot a satellite range half circle. */
+#define SAT_MAP_LOD_MAX_CLUSTER        64       /*!< Largest cluster cell size in pixels. */
 
 #define GTK_SAT_MAP(obj)          G_TYPE_CHECK_INSTANCE_CAST (obj, gtk_sat_map_get_type (), GtkSatMap)
 #define GTK_SAT_MAP_CLASS(klass)  G_TYPE_CHECK_CLASS_CAST (klass, gtk_sat_map_get_type (), GtkSatMapClass)
@@ -131,6 +133,13 @@ typedef struct {
     gboolean        keepratio;  /*!< Keep map aspect ratio. */
     gboolean        resize;     /*!< Flag indicating that the map has been resized. */
 
+    /* level-of-detail rendering for large catalogues */
+    guint           lod_threshold;      /*!< Number of satellites above which LOD is used (0 = never). */
+    guint           cluster_size;       /*!< Cluster cell size in pixels (0 = no clustering). */
+    gboolean        lod;        /*!< LOD rendering is active. */
+    guint          *cluster_bins;       /*!< Per-cell satellite count used while drawing clusters. */
+    guint           cluster_nbins;      /*!< Number of allocated cluster cells. */
+
     gchar          *infobgd;    /*!< Background color of info text. */
     guint32         col_qth;    /*!< QTH marker color. */
     guint32         col_info;   /*!< Info text color. */
@@ -142,8 +151,8 @@ typedef struct {
     guint32         col_track;  /*!< Track color. */
     guint32         col_terminator; /*!< Terminator color. */
 
-    GdkPixbuf      *origmap;    /*!< Original map kept here for high quality scaling. */
-    GdkPixbuf      *map;        /*!< Scaled map for current size. */
+    map_mip_t      *mipmap;     /*!< Multi-resolution cache of the original map. */
+    GdkPixbuf      *map;        /*!< Scaled map for current size, centered at 0 lon. */
 
     gchar          *font;       /*!< Default font name */
 
@@ -163,6 +172,7 @@ void            gtk_sat_map_lonlat_to_xy(GtkSatMap * m,
                                          gdouble * x, gdouble * y);
 
 void            gtk_sat_map_reload_sats(GtkWidget * satmap, GHashTable * sats);
+void            gtk_sat_map_reload_sat(GtkWidget * satmap, sat_t * sat);
 void            gtk_sat_map_select_sat(GtkWidget * satmap, gint catnum);
 
 /* *INDENT-OFF* */
@@ -855,7 +855,90 @@ static void destroy_rotctrl(GtkWidget * window, gpointer data)
     (void)window;
 
     module->rotctrlwin = NULL;
-    module->rotctrl = NULL;
+    module->rotctrlbook = NULL;
+}
+
+/** Forget a rotator controller when it is destroyed. */
+static void destroy_rotctrl_page(GtkWidget * rotctrl, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+
+    module->rotctrls = g_slist_remove(module->rotctrls, rotctrl);
+}
+
+/** Close one rotator; the window goes with the last one. */
+static void close_rotctrl_cb(GtkWidget * button, gpointer data)
+{
+    GtkSatModule   *module = GTK_SAT_MODULE(data);
+    GtkWidget      *rotctrl = GTK_WIDGET(g_object_get_data(G_OBJECT(button),
+                                                           "rotctrl"));
+
+    if (g_slist_length(module->rotctrls) > 1)
+        gtk_widget_destroy(rotctrl);
+    else
+        gtk_widget_destroy(module->rotctrlwin);
+}
+
+/**
+ * Add a rotator controller to the rotator control window.
+ *
+ * Each controller has its own rotator, target and plan, while the passes and
+ * tracks of the targets come from the module, so that a satellite followed
+ * by several antennas is predicted only once.
+ *
+ * @param module The module.
+ * @return TRUE if a controller was added, FALSE if there are no rotators.
+ */
+static gboolean add_rotctrl(GtkSatModule * module)
+{
+    GtkWidget      *rotctrl;
+    GtkWidget      *label;
+    GtkWidget      *button;
+    GtkWidget      *box;
+    gchar          *buff;
+    gint            page;
+
+    rotctrl = gtk_rot_ctrl_new(module);
+    if (rotctrl == NULL)
+        return FALSE;
+
+    module->rotctrls = g_slist_append(module->rotctrls, rotctrl);
+    g_signal_connect(rotctrl, "destroy", G_CALLBACK(destroy_rotctrl_page),
+                     module);
+
+    buff = g_strdup_printf(_("Antenna %d"),
+                           gtk_notebook_get_n_pages(GTK_NOTEBOOK
+                                                    (module->rotctrlbook)) +
+                           1);
+    label = gtk_label_new(buff);
+    g_free(buff);
+
+    button = gtk_button_new_from_icon_name("window-close",
+                                           GTK_ICON_SIZE_MENU);
+    gtk_button_set_relief(GTK_BUTTON(button), GTK_RELIEF_NONE);
+    gtk_widget_set_tooltip_text(button, _("Close this rotator controller"));
+    g_object_set_data(G_OBJECT(button), "rotctrl", rotctrl);
+    g_signal_connect(button, "clicked", G_CALLBACK(close_rotctrl_cb), module);
+
+    box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 3);
+    gtk_box_pack_start(GTK_BOX(box), label, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(box), button, FALSE, FALSE, 0);
+    gtk_widget_show_all(box);
+
+    page = gtk_notebook_append_page(GTK_NOTEBOOK(module->rotctrlbook),
+                                    rotctrl, box);
+    gtk_widget_show_all(rotctrl);
+    gtk_notebook_set_current_page(GTK_NOTEBOOK(module->rotctrlbook), page);
+
+    return TRUE;
+}
+
+/** Add another rotator to the rotator control window. */
+static void add_rotctrl_cb(GtkWidget * button, gpointer data)
+{
+    (void)button;
+
+    add_rotctrl(GTK_SAT_MODULE(data));
 }
 
 /**
@@ -867,6 +950,7 @@ static void destroy_rotctrl(GtkWidget * window, gpointer data)
 static void rotctrl_cb(GtkWidget * menuitem, gpointer data)
 {
     GtkSatModule   *module = GTK_SAT_MODULE(data);
+    GtkWidget      *button;
     gchar          *buff;
 
     (void)menuitem;
@@ -878,13 +962,17 @@ static void rotctrl_cb(GtkWidget * menuitem, gpointer data)
         return;
     }
 
-    module->rotctrl = gtk_rot_ctrl_new(module);
+    module->rotctrlbook = gtk_notebook_new();
+    gtk_notebook_set_scrollable(GTK_NOTEBOOK(module->rotctrlbook), TRUE);
 
-    if (module->rotctrl == NULL)
+    if (!add_rotctrl(module))
     {
         /* gtk_rot_ctrl_new returned NULL because no rotators are configured */
         GtkWidget      *dialog;
 
+        gtk_widget_destroy(module->rotctrlbook);
+        module->rotctrlbook = NULL;
+
         dialog = gtk_message_dialog_new(GTK_WINDOW(app),
                                         GTK_DIALOG_MODAL |
                                         GTK_DIALOG_DESTROY_WITH_PARENT,
@@ -900,6 +988,15 @@ static void rotctrl_cb(GtkWidget * menuitem, gpointer data)
         return;
     }
 
+    /* button for adding more rotators */
+    button = gtk_button_new_from_icon_name("list-add", GTK_ICON_SIZE_MENU);
+    gtk_button_set_relief(GTK_BUTTON(button), GTK_RELIEF_NONE);
+    gtk_widget_set_tooltip_text(button, _("Control another rotator"));
+    g_signal_connect(button, "clicked", G_CALLBACK(add_rotctrl_cb), module);
+    gtk_widget_show(button);
+    gtk_notebook_set_action_widget(GTK_NOTEBOOK(module->rotctrlbook), button,
+                                   GTK_PACK_END);
+
     /* create a window */
     module->rotctrlwin = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     buff = g_strdup_printf(_("Gpredict Rotator Control: %s"), module->name);
@@ -915,7 +1012,7 @@ static void rotctrl_cb(GtkWidget * menuitem, gpointer data)
     gtk_window_set_icon_from_file(GTK_WINDOW(module->rotctrlwin), buff, NULL);
     g_free(buff);
 
-    gtk_container_add(GTK_CONTAINER(module->rotctrlwin), module->rotctrl);
+    gtk_container_add(GTK_CONTAINER(module->rotctrlwin), module->rotctrlbook);
 
     gtk_widget_show_all(module->rotctrlwin);
 }
@@ -61,6 +61,7 @@
 #include "predict-tools.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-registry.h"
 #include "sgpsdp/sgp4sdp4.h"
 #include "time-tools.h"
 
@@ -69,7 +70,7 @@ static GtkVBoxClass *parent_class = NULL;
 
 static void gtk_sat_module_free_sat(gpointer sat)
 {
-    gtk_sat_data_free_sat(SAT(sat));
+    sat_registry_free_sat(SAT(sat));
 }
 
 static void update_autotrack(GtkSatModule * module)
@@ -193,6 +194,18 @@ static void gtk_sat_module_destroy(GtkWidget * widget)
         module->satellites = NULL;
     }
 
+    if (module->passcache)
+    {
+        pass_cache_free(module->passcache);
+        module->passcache = NULL;
+    }
+
+    if (module->feed)
+    {
+        shm_feed_free(module->feed);
+        module->feed = NULL;
+    }
+
     if (module->grid)
     {
         g_free(module->grid);
@@ -228,9 +241,12 @@ static void gtk_sat_module_init(GtkSatModule * module,
 
     module->satellites = g_hash_table_new_full(g_int_hash, g_int_equal,
                                                g_free, gtk_sat_module_free_sat);
+    module->passcache = pass_cache_new();
+    module->feed = NULL;
 
     module->rotctrlwin = NULL;
-    module->rotctrl = NULL;
+    module->rotctrlbook = NULL;
+    module->rotctrls = NULL;
     module->rigctrlwin = NULL;
     module->rigctrl = NULL;
     module->skgwin = NULL;
@@ -450,16 +466,15 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
     /* read each satellite into hash table */
     for (i = 0; i < length; i++)
     {
-        sat = g_new(sat_t, 1);
+        /* shared with the other modules */
+        sat = sat_registry_new_sat(sats[i]);
 
-        if (gtk_sat_data_read_sat(sats[i], sat))
+        if (sat == NULL)
         {
             /* the satellite could not be read */
             sat_log_log(SAT_LOG_LEVEL_ERROR,
                         _("%s: Error reading data for #%d"),
                         __func__, sats[i]);
-
-            g_free(sat);
         }
         else
         {
@@ -484,7 +499,8 @@ static void gtk_sat_module_load_sats(GtkSatModule * module)
                             __func__, sats[i]);
 
                 /* it is not needed in this case */
-                g_free(sat);
+                sat_registry_free_sat(sat);
+                g_free(key);
             }
 
         }
@@ -707,6 +723,7 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
 {
     GtkSatModule   *mod = GTK_SAT_MODULE(module);
     GtkWidget      *child;
+    GSList         *iter;
     gboolean        needupdate = FALSE;
     GdkWindowState  state;
     gdouble         delta;
@@ -798,6 +815,10 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
             g_hash_table_foreach(mod->satellites,
                                  gtk_sat_module_update_sat, module);
 
+        if (mod->feed)
+            shm_feed_publish(mod->feed, mod->satellites, mod->qth,
+                             mod->tmgCdnum, mod->rtNow);
+
         /* update target if autotracking is enabled */
         if (mod->autotrack)
             update_autotrack(mod);
@@ -805,8 +826,8 @@ static gboolean gtk_sat_module_timeout_cb(gpointer module)
         /* send notice to radio and rotator controller */
         if (mod->rigctrl)
             gtk_rig_ctrl_update(GTK_RIG_CTRL(mod->rigctrl), mod->tmgCdnum);
-        if (mod->rotctrl)
-            gtk_rot_ctrl_update(GTK_ROT_CTRL(mod->rotctrl), mod->tmgCdnum);
+        for (iter = mod->rotctrls; iter != NULL; iter = iter->next)
+            gtk_rot_ctrl_update(GTK_ROT_CTRL(iter->data), mod->tmgCdnum);
 
         /* check and update Sky at glance */
         /* FIXME: We should have some timeout counter to ensure that we don't
@@ -1055,6 +1076,11 @@ GtkWidget *gtk_sat_module_new(const gchar * cfgfile)
 
     gtk_sat_module_load_sats(module);
 
+    /* live tracking feed for other programs */
+    if (mod_cfg_get_bool(module->cfgdata, MOD_CFG_GLOBAL_SECTION,
+                         MOD_CFG_SHM_FEED, SAT_CFG_BOOL_MOD_SHM_FEED))
+        module->feed = shm_feed_new(module->name);
+
     /* menu */
     GtkWidget * image = gtk_image_new_from_icon_name("open-menu-symbolic",
                                          GTK_ICON_SIZE_BUTTON);
@@ -1401,11 +1427,41 @@ static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
     }
     else if (IS_GTK_SAT_LIST(widget))
     {
-        /* NOP */
+        gtk_sat_list_reload_sats(widget, module->satellites);
+    }
+    else if (IS_GTK_EVENT_LIST(widget))
+    {
+        gtk_event_list_reload_sats(widget, module->satellites);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s:%d: Unknown child type"), __FILE__, __LINE__);
+    }
+}
+
+/** Tell a view that the elements or the name of a satellite have changed */
+static void reload_sat_in_child(GtkWidget * widget, sat_t * sat)
+{
+    if (IS_GTK_SINGLE_SAT(G_OBJECT(widget)))
+    {
+        /* nothing is computed ahead */
+    }
+    else if (IS_GTK_POLAR_VIEW(widget))
+    {
+        gtk_polar_view_reload_sat(widget, sat);
+    }
+    else if (IS_GTK_SAT_MAP(widget))
+    {
+        gtk_sat_map_reload_sat(widget, sat);
+    }
+    else if (IS_GTK_SAT_LIST(widget))
+    {
+        gtk_sat_list_reload_sat(widget, sat);
     }
     else if (IS_GTK_EVENT_LIST(widget))
     {
-        /* NOP */
+        gtk_event_list_reload_sat(widget, sat);
     }
     else
     {
@@ -1414,6 +1470,93 @@ static void reload_sats_in_child(GtkWidget * widget, GtkSatModule * module)
     }
 }
 
+/**
+ * Take in new satellite data, e.g. after a TLE update.
+ *
+ * @param module Pointer to a GtkSatModule widget.
+ *
+ * Unlike gtk_sat_module_reload_sats() the satellites are updated in place.
+ * Only those whose elements have changed are initialised again, and the
+ * views and rotator controllers are told about each satellite whose
+ * elements or name have changed, so that what they have computed for the
+ * other satellites is kept. Satellites that could not be read before need a
+ * full reload.
+ */
+void gtk_sat_module_update_sats(GtkSatModule * module)
+{
+    GHashTableIter  iter;
+    gpointer        value;
+    GSList         *changed = NULL;
+    GSList         *node;
+    GSList         *rot;
+    GtkWidget      *child;
+    gint           *sats;
+    gsize           length = 0;
+    guint           changes;
+    guint           nelem = 0;
+    guint           i;
+
+    g_return_if_fail(IS_GTK_SAT_MODULE(module));
+
+    /* the list may name a satellite more than once */
+    sats = g_key_file_get_integer_list(module->cfgdata,
+                                       MOD_CFG_GLOBAL_SECTION,
+                                       MOD_CFG_SATS_KEY, &length, NULL);
+    for (i = 0; i < length; i++)
+        if (!g_hash_table_contains(module->satellites, &sats[i]))
+            break;
+    g_free(sats);
+    if (i < length)
+    {
+        gtk_sat_module_reload_sats(module);
+        return;
+    }
+
+    /* lock module */
+    g_mutex_lock(&module->busy);
+
+    g_hash_table_iter_init(&iter, module->satellites);
+    while (g_hash_table_iter_next(&iter, NULL, &value))
+    {
+        changes = sat_registry_update_sat(SAT(value));
+        if (changes & SAT_UPDATE_ELEMENTS)
+        {
+            gtk_sat_data_init_sat(SAT(value), module->qth);
+            nelem++;
+        }
+        if (changes != SAT_UPDATE_NONE)
+            changed = g_slist_prepend(changed, value);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %d satellites in module %s have new elements"),
+                __func__, nelem, module->name);
+
+    if (changed != NULL)
+    {
+        /* reset event counter so that next AOS/LOS gets re-calculated */
+        module->event_count = 0;
+
+        /* update children */
+        for (i = 0; i < module->nviews; i++)
+        {
+            child = GTK_WIDGET(g_slist_nth_data(module->views, i));
+            for (node = changed; node != NULL; node = node->next)
+                reload_sat_in_child(child, SAT(node->data));
+        }
+
+        /* the rotators plan their pass again */
+        for (rot = module->rotctrls; rot != NULL; rot = rot->next)
+            for (node = changed; node != NULL; node = node->next)
+                gtk_rot_ctrl_reload_sat(GTK_ROT_CTRL(rot->data),
+                                        SAT(node->data));
+        g_slist_free(changed);
+    }
+
+    /* unlock module */
+    g_mutex_unlock(&module->busy);
+}
+
 /**
  * Reload satellites.
  *
@@ -1469,6 +1612,8 @@ void gtk_sat_module_reload_sats(GtkSatModule * module)
 void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
 {
     GtkWidget      *child;
+    GtkWidget      *rotctrl;
+    gint            page;
     guint           i;
 
     module->target = catnum;
@@ -1509,8 +1654,16 @@ void gtk_sat_module_select_sat(GtkSatModule * module, gint catnum)
     if (module->rigctrl != NULL)
         gtk_rig_ctrl_select_sat(GTK_RIG_CTRL(module->rigctrl), catnum);
 
-    if (module->rotctrl != NULL)
-        gtk_rot_ctrl_select_sat(GTK_ROT_CTRL(module->rotctrl), catnum);
+    /* each rotator keeps its own target; only the one shown follows */
+    if (module->rotctrlbook != NULL)
+    {
+        page =
+            gtk_notebook_get_current_page(GTK_NOTEBOOK(module->rotctrlbook));
+        rotctrl =
+            gtk_notebook_get_nth_page(GTK_NOTEBOOK(module->rotctrlbook), page);
+        if (rotctrl != NULL)
+            gtk_rot_ctrl_select_sat(GTK_ROT_CTRL(rotctrl), catnum);
+    }
 }
 
 /**
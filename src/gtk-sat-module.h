@@ -7,6 +7,8 @@
 
 #include "qth-data.h"
 #include "gtk-sat-data.h"
+#include "pass-cache.h"
+#include "shm-feed.h"
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -55,7 +57,8 @@ struct _gtk_sat_module {
     GtkWidget      *win;        /*!< Window when module is not docked */
 
     GtkWidget      *rotctrlwin; /*!< Rotator controller window */
-    GtkWidget      *rotctrl;    /*!< Rotator controller widget */
+    GtkWidget      *rotctrlbook;        /*!< Notebook with a page per rotator */
+    GSList         *rotctrls;   /*!< Rotator controller widgets */
     GtkWidget      *rigctrlwin; /*!< Radio controller window */
     GtkWidget      *rigctrl;    /*!< Radio controller widget */
     GtkWidget      *skgwin;     /*!< Sky at glance window */
@@ -78,6 +81,8 @@ struct _gtk_sat_module {
     qth_t          *qth;        /*!< QTH information. */
     qth_small_t     qth_event;  /*!< QTH information for last AOS/LOS update. */
     GHashTable     *satellites; /*!< Satellites. */
+    pass_cache_t   *passcache;  /*!< Passes shared by the controllers. */
+    shm_feed_t     *feed;       /*!< Live tracking feed; NULL if disabled. */
 
     guint32         timeout;    /*!< Timeout value [msec] */
 
@@ -131,6 +136,7 @@ void            gtk_sat_module_close_cb(GtkWidget * button, gpointer data);
 void            gtk_sat_module_config_cb(GtkWidget * button, gpointer data);
 
 void            gtk_sat_module_reload_sats(GtkSatModule * module);
+void            gtk_sat_module_update_sats(GtkSatModule * module);
 void            gtk_sat_module_reconf(GtkSatModule * module, gboolean local);
 void            gtk_sat_module_select_sat(GtkSatModule * module, gint catnum);
 
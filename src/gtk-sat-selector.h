@@ -3,6 +3,8 @@
 
 #include <gtk/gtk.h>
 
+#include "sat-index.h"
+
 /* *INDENT-OFF* */
 #ifdef __cplusplus
 extern "C" {
@@ -53,6 +55,10 @@ struct _gtk_sat_selector {
     GtkWidget      *groups;     /*!< Combo box for selecting satellite group. */
     GtkWidget      *search;     /*!< Text entry for searching. */
     GSList         *models;     /*!< List of models with index corresponding to groups. */
+    sat_index_t    *index;      /*!< Index the models were filled from. */
+    gchar          *needle;     /*!< Search key the matches are for. */
+    GArray         *matches;    /*!< Index positions matching needle, NULL for all. */
+    GCancellable   *searching;  /*!< Search running in the background, if any. */
 };
 
 struct _GtkSatSelectorClass {
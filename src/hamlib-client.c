@@ -0,0 +1,429 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Client for the hamlib rigctld and rotctld network daemons.
+ *
+ * All sockets are non-blocking and every operation has a deadline, so a slow
+ * or wedged daemon can not stall the caller for longer than it allows.
+ * Several commands can be pipelined to the same daemon and requests to
+ * different daemons are executed concurrently using poll().
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>   /* htons() */
+#include <fcntl.h>       /* fcntl() */
+#include <netdb.h>       /* gethostbyname() */
+#include <netinet/in.h>  /* struct sockaddr_in */
+#include <netinet/tcp.h> /* TCP_NODELAY */
+#include <poll.h>        /* poll() */
+#include <sys/socket.h>  /* socket(), connect(), send() */
+#include <unistd.h>      /* close() */
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "hamlib-client.h"
+#include "sat-log.h"
+
+#ifdef WIN32
+#define poll(fds, nfds, timeout) WSAPoll(fds, nfds, timeout)
+#define SOCK_IN_PROGRESS() (WSAGetLastError() == WSAEWOULDBLOCK)
+#define SOCK_WOULD_BLOCK() (WSAGetLastError() == WSAEWOULDBLOCK)
+#define sock_close(s) closesocket(s)
+#else
+#define SOCK_IN_PROGRESS() (errno == EINPROGRESS)
+#define SOCK_WOULD_BLOCK()                                                     \
+    (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+#define sock_close(s) close(s)
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+/* Put socket into non-blocking mode */
+static gboolean set_nonblocking(gint sock)
+{
+#ifdef WIN32
+    u_long mode = 1;
+
+    return (ioctlsocket(sock, FIONBIO, &mode) == 0);
+#else
+    gint flags = fcntl(sock, F_GETFL, 0);
+
+    if (flags == -1)
+        return FALSE;
+
+    return (fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0);
+#endif
+}
+
+/* Milliseconds until deadline, rounded up and never negative */
+static gint ms_until(gint64 deadline, gint64 now)
+{
+    if (deadline <= now)
+        return 0;
+
+    return (gint)((deadline - now + 999) / 1000);
+}
+
+/*
+ * Open a connection to a rigctld or rotctld server.
+ *
+ * @param host The host name of the server.
+ * @param port The port number of the server.
+ * @param timeout Connection timeout in msec.
+ * @return The socket or -1 if the connection could not be established.
+ *
+ * The returned socket is in non-blocking mode and should only be used through
+ * the hamlib_req_* functions.
+ */
+gint hamlib_open(const gchar *host, gint port, gint timeout)
+{
+    struct sockaddr_in ServAddr;
+    struct hostent *h;
+    struct pollfd pfd;
+    gint sock;
+    gint status;
+    gint err = 0;
+    gint one = 1;
+    socklen_t errlen = sizeof(err);
+
+    sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to create socket: %s"),
+                    __func__, strerror(errno));
+        return -1;
+    }
+
+    memset(&ServAddr, 0, sizeof(ServAddr));
+    ServAddr.sin_family = AF_INET;
+    h = gethostbyname(host);
+    if (h == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Name resolution of %s failed."), __func__, host);
+        sock_close(sock);
+        return -1;
+    }
+    memcpy((char *)&ServAddr.sin_addr.s_addr, h->h_addr_list[0], h->h_length);
+    ServAddr.sin_port = htons(port);
+
+    if (!set_nonblocking(sock))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to make socket non-blocking"), __func__);
+        sock_close(sock);
+        return -1;
+    }
+
+    /* commands are short and latency matters more than throughput */
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one,
+               sizeof(one));
+
+    status = connect(sock, (struct sockaddr *)&ServAddr, sizeof(ServAddr));
+    if (status == -1 && SOCK_IN_PROGRESS())
+    {
+        pfd.fd = sock;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        status = poll(&pfd, 1, timeout);
+        if (status == 1)
+        {
+            getsockopt(sock, SOL_SOCKET, SO_ERROR, (char *)&err, &errlen);
+            status = (err == 0) ? 0 : -1;
+        }
+        else
+        {
+            err = ETIMEDOUT;
+            status = -1;
+        }
+    }
+    else if (status == -1)
+    {
+        err = errno;
+    }
+
+    if (status == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to connect to %s:%d: %s"), __func__, host,
+                    port, strerror(err));
+        sock_close(sock);
+        return -1;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Connection opened to %s:%d"),
+                __func__, host, port);
+
+    return sock;
+}
+
+/* Close a connection. The q command is sent first to cleanly end the session */
+void hamlib_close(gint sock)
+{
+    if (send(sock, "q\x0a", 2, MSG_NOSIGNAL) != 2)
+        sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Could not send q command"),
+                    __func__);
+
+#ifndef WIN32
+    shutdown(sock, SHUT_RDWR);
+#else
+    shutdown(sock, SD_BOTH);
+#endif
+    sock_close(sock);
+}
+
+/*
+ * Initialise a request.
+ *
+ * @param req The request.
+ * @param sock Socket returned by hamlib_open().
+ * @param timeout Time in msec the server has to respond to all commands.
+ *
+ * The deadline starts running when the request is initialised.
+ */
+void hamlib_req_init(hamlib_req_t *req, gint sock, gint timeout)
+{
+    memset(req, 0, sizeof(hamlib_req_t));
+    req->sock = sock;
+    req->start = g_get_monotonic_time();
+    req->deadline = req->start + (gint64)timeout * 1000;
+    req->status = HAMLIB_REQ_PENDING;
+}
+
+/*
+ * Append a command to a request.
+ *
+ * @param req The request.
+ * @param cmd The command, terminated by a newline.
+ * @param nlines The number of lines in the response, or 0 if the response is
+ *               terminated by an RPRT line (extended protocol).
+ * @return FALSE if the request is full.
+ */
+gboolean hamlib_req_add(hamlib_req_t *req, const gchar *cmd, guint nlines)
+{
+    gsize len = strlen(cmd);
+
+    if (req->ncmd == HAMLIB_REQ_MAX_CMDS ||
+        req->cmdlen + len >= HAMLIB_REQ_CMD_SIZE)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Request is full"), __func__);
+        return FALSE;
+    }
+
+    memcpy(req->cmd + req->cmdlen, cmd, len);
+    req->cmdlen += len;
+    req->nlines[req->ncmd++] = nlines;
+
+    return TRUE;
+}
+
+/* Feed received bytes to the response parser of a request */
+static void parse_input(hamlib_req_t *req, const gchar *buf, gssize len,
+                        gint64 now)
+{
+    gchar *resp;
+    gboolean done;
+    gssize i;
+
+    for (i = 0; i < len && req->nresp < req->ncmd; i++)
+    {
+        resp = req->resp[req->nresp];
+
+        /* responses that do not fit are truncated */
+        if (req->rlen < HAMLIB_REQ_RESP_SIZE - 1)
+            resp[req->rlen++] = buf[i];
+
+        if (buf[i] != '\n')
+        {
+            if (req->headlen < sizeof(req->head))
+                req->head[req->headlen++] = buf[i];
+            continue;
+        }
+
+        /* errors are reported with a lone RPRT line in either protocol */
+        req->lines++;
+        done = (req->headlen >= 4 && !strncmp(req->head, "RPRT", 4));
+        if (req->nlines[req->nresp] > 0)
+            done |= (req->lines == req->nlines[req->nresp]);
+        req->headlen = 0;
+
+        if (done)
+        {
+            resp[req->rlen] = '\0';
+            req->rtime[req->nresp++] = now;
+            req->rlen = 0;
+            req->lines = 0;
+        }
+    }
+}
+
+/*
+ * Discard any bytes left in the socket before a new request is sent.
+ *
+ * This only catches replies that have already arrived; a reply that is still
+ * on its way after a timeout would be read as the reply to the next request.
+ * The caller must therefore reopen the connection after a timeout.
+ */
+static void drain_input(hamlib_req_t *req)
+{
+    gchar buf[256];
+    gssize n;
+
+    do
+    {
+        n = recv(req->sock, buf, sizeof(buf), 0);
+        if (n > 0)
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: Discarded %d stale bytes"), __func__, (gint)n);
+    } while (n > 0);
+}
+
+/* Service one socket that poll() reported ready */
+static void service_req(hamlib_req_t *req, short revents, gint64 now)
+{
+    gchar buf[512];
+    gssize n;
+
+    if ((revents & POLLOUT) && req->sent < req->cmdlen)
+    {
+        n = send(req->sock, req->cmd + req->sent, req->cmdlen - req->sent,
+                 MSG_NOSIGNAL);
+        if (n > 0)
+            req->sent += n;
+        else if (n == -1 && !SOCK_WOULD_BLOCK())
+            req->status = HAMLIB_REQ_FAILED;
+    }
+
+    if (revents & POLLIN)
+    {
+        n = recv(req->sock, buf, sizeof(buf), 0);
+        if (n > 0)
+            parse_input(req, buf, n, now);
+        else if (n == 0 || !SOCK_WOULD_BLOCK())
+            req->status = HAMLIB_REQ_FAILED;
+    }
+    else if (revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+        req->status = HAMLIB_REQ_FAILED;
+    }
+
+    if (req->status == HAMLIB_REQ_PENDING && req->nresp == req->ncmd)
+        req->status = HAMLIB_REQ_DONE;
+}
+
+/*
+ * Execute one or more requests concurrently.
+ *
+ * @param reqs Array of requests, each to a different socket.
+ * @param n The number of requests, at most HAMLIB_MAX_REQS.
+ * @return TRUE if all requests completed, FALSE if any of them failed or
+ *         timed out. The status of each request tells which.
+ *
+ * The function returns when every request has either completed, failed or
+ * passed its deadline. The server may still answer a request that timed out,
+ * so its connection must be closed and opened again before the next request.
+ * Requests with a socket of -1 fail immediately.
+ */
+gboolean hamlib_req_run(hamlib_req_t *reqs, guint n)
+{
+    struct pollfd pfd[HAMLIB_MAX_REQS];
+    hamlib_req_t *map[HAMLIB_MAX_REQS];
+    gint64 now, deadline;
+    guint i, m;
+    gboolean ok = TRUE;
+
+    g_return_val_if_fail(n <= HAMLIB_MAX_REQS, FALSE);
+
+    for (i = 0; i < n; i++)
+    {
+        if (reqs[i].sock < 0)
+        {
+            reqs[i].status = HAMLIB_REQ_FAILED;
+            continue;
+        }
+
+        drain_input(&reqs[i]);
+        if (reqs[i].ncmd == 0)
+            reqs[i].status = HAMLIB_REQ_DONE;
+    }
+
+    while (TRUE)
+    {
+        now = g_get_monotonic_time();
+        deadline = G_MAXINT64;
+        m = 0;
+
+        for (i = 0; i < n; i++)
+        {
+            if (reqs[i].status != HAMLIB_REQ_PENDING)
+                continue;
+
+            if (reqs[i].deadline <= now)
+            {
+                reqs[i].status = HAMLIB_REQ_TIMEOUT;
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: Timeout after %u of %u responses"),
+                            __func__, reqs[i].nresp, reqs[i].ncmd);
+                continue;
+            }
+
+            pfd[m].fd = reqs[i].sock;
+            pfd[m].events = POLLIN;
+            if (reqs[i].sent < reqs[i].cmdlen)
+                pfd[m].events |= POLLOUT;
+            pfd[m].revents = 0;
+            map[m++] = &reqs[i];
+            deadline = MIN(deadline, reqs[i].deadline);
+        }
+
+        if (m == 0)
+            break;
+
+        if (poll(pfd, m, ms_until(deadline, now)) < 0 && !SOCK_WOULD_BLOCK())
+        {
+            for (i = 0; i < m; i++)
+                map[i]->status = HAMLIB_REQ_FAILED;
+            break;
+        }
+
+        now = g_get_monotonic_time();
+        for (i = 0; i < m; i++)
+        {
+            if (pfd[i].revents)
+                service_req(map[i], pfd[i].revents, now);
+        }
+    }
+
+    for (i = 0; i < n; i++)
+        ok &= (reqs[i].status == HAMLIB_REQ_DONE);
+
+    return ok;
+}
@@ -0,0 +1,83 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef HAMLIB_CLIENT_H
+#define HAMLIB_CLIENT_H 1
+
+#include <glib.h>
+
+#define HAMLIB_MAX_REQS 8        /* Max number of concurrent requests */
+#define HAMLIB_REQ_MAX_CMDS 4    /* Max number of pipelined commands */
+#define HAMLIB_REQ_CMD_SIZE 256  /* Size of the command buffer */
+#define HAMLIB_REQ_RESP_SIZE 128 /* Size of each response buffer */
+
+/* Request status */
+typedef enum {
+    HAMLIB_REQ_PENDING = 0, /* Still waiting for responses */
+    HAMLIB_REQ_DONE,        /* All responses received */
+    HAMLIB_REQ_TIMEOUT,     /* Deadline expired */
+    HAMLIB_REQ_FAILED       /* Socket error or connection closed */
+} hamlib_req_status_t;
+
+/*
+ * A batch of commands to one rigctld or rotctld server.
+ *
+ * The commands are written in one go and the responses are read back in
+ * order. Each response is framed either by a fixed number of lines, which is
+ * what the default protocol returns, or by the RPRT line that terminates
+ * every response in the extended protocol (commands prefixed with '+').
+ * An RPRT line always ends a response, so errors, which the default
+ * protocol reports with a lone RPRT line, are framed correctly too.
+ *
+ * Requests are plain structs that can live on the stack; use
+ * hamlib_req_init() and hamlib_req_add() to set them up and hamlib_req_run()
+ * to execute one or more of them concurrently. After a timeout the reply may
+ * still arrive, so the connection has to be reopened before it is used again.
+ */
+typedef struct {
+    gint sock;       /* Socket connected to the server */
+    gint64 start;    /* Monotonic time when the request was started (usec) */
+    gint64 deadline; /* Monotonic deadline for the last response (usec) */
+
+    gchar cmd[HAMLIB_REQ_CMD_SIZE]; /* Commands, each terminated by \n */
+    gsize cmdlen;                   /* Number of bytes in cmd */
+    gsize sent;                     /* Number of bytes sent so far */
+    guint ncmd;                     /* Number of commands */
+    guint nlines[HAMLIB_REQ_MAX_CMDS]; /* Lines per response; 0 = RPRT */
+
+    gchar resp[HAMLIB_REQ_MAX_CMDS][HAMLIB_REQ_RESP_SIZE]; /* Responses */
+    gint64 rtime[HAMLIB_REQ_MAX_CMDS]; /* When each response completed */
+    guint nresp;                       /* Number of complete responses */
+
+    /* parser state for the response being received */
+    gsize rlen;     /* Bytes stored in the current response */
+    guint lines;    /* Lines completed in the current response */
+    gchar head[5];  /* First characters of the current line */
+    guint headlen;  /* Number of characters in head */
+
+    hamlib_req_status_t status;
+} hamlib_req_t;
+
+gint hamlib_open(const gchar *host, gint port, gint timeout);
+void hamlib_close(gint sock);
+
+void hamlib_req_init(hamlib_req_t *req, gint sock, gint timeout);
+gboolean hamlib_req_add(hamlib_req_t *req, const gchar *cmd, guint nlines);
+gboolean hamlib_req_run(hamlib_req_t *reqs, guint n);
+
+#endif
@@ -0,0 +1,536 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Simulated rigctld and rotctld daemons.
+ *
+ * The simulators speak the default hamlib network protocol for the commands
+ * gpredict uses, on the loopback interface. The radio has a tuning step and
+ * the rotator a finite slew rate, and every response can be delayed, turned
+ * into an error or dropped, which makes it possible to exercise and compare
+ * the control loops without hardware. The commands received are counted and
+ * logged when a simulator stops.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <arpa/inet.h>   /* htons() */
+#include <netinet/in.h>  /* struct sockaddr_in */
+#include <netinet/tcp.h> /* TCP_NODELAY */
+#include <poll.h>        /* poll() */
+#include <sys/socket.h>  /* socket(), bind(), accept() */
+#include <unistd.h>      /* close() */
+#else
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "hamlib-sim.h"
+#include "sat-log.h"
+
+#ifdef WIN32
+#define poll(fds, nfds, timeout) WSAPoll(fds, nfds, timeout)
+#define sock_close(s) closesocket(s)
+#else
+#define sock_close(s) close(s)
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define POLL_INTERVAL 200 /* How often the threads check for a stop (msec) */
+#define LINE_SIZE 256     /* Max length of a command */
+
+struct _hamlib_sim {
+    hamlib_sim_type_t type;
+    hamlib_sim_conf_t conf;
+    gint sock;      /* Listening socket */
+    gint running;   /* Cleared to stop the threads; atomic */
+    GThread *thread; /* Thread accepting connections */
+
+    GMutex mutex;       /* Protects the members below */
+    GSList *conns;      /* Threads serving a connection */
+    GHashTable *counts; /* Number of commands received, by command */
+    gdouble freq[2];    /* Frequency of VFO A and B (Hz) */
+    gdouble txfreq;     /* Split transmit frequency (Hz) */
+    gint ptt;
+    gdouble az, el;     /* Rotator position (deg) */
+    gdouble taz, tel;   /* Rotator target (deg) */
+    gint64 tmove;       /* Monotonic time of the last position update */
+};
+
+typedef struct {
+    hamlib_sim_t *sim;
+    gint sock;
+} sim_conn_t;
+
+static const gchar *type_name(hamlib_sim_type_t type)
+{
+    return (type == HAMLIB_SIM_RIGCTLD) ? "rigctld" : "rotctld";
+}
+
+/*
+ * Parse a simulator specification.
+ *
+ * @param spec PORT[,key=value...] with the keys latency, jitter, fail, drop,
+ *             step, rate and speed; see hamlib_sim_conf_t.
+ * @param conf The configuration to fill in.
+ * @return TRUE if the specification is valid.
+ */
+gboolean hamlib_sim_parse(const gchar *spec, hamlib_sim_conf_t *conf)
+{
+    gchar **fields;
+    gchar *end, *val;
+    gdouble num;
+    gboolean ok = TRUE;
+    guint i;
+
+    conf->port = 0;
+    conf->latency = 0;
+    conf->jitter = 0;
+    conf->failprob = 0.0;
+    conf->dropprob = 0.0;
+    conf->step = 1.0;
+    conf->rate = 6.0;
+    conf->speed = 1.0;
+
+    fields = g_strsplit(spec, ",", -1);
+    for (i = 0; ok && fields[i] != NULL; i++)
+    {
+        if (i == 0)
+        {
+            conf->port = (gint)strtol(fields[0], &end, 10);
+            ok = (*end == '\0' && conf->port > 0 && conf->port < 65536);
+            continue;
+        }
+
+        val = strchr(fields[i], '=');
+        if (val == NULL)
+        {
+            ok = FALSE;
+            break;
+        }
+        *val++ = '\0';
+        num = g_ascii_strtod(val, &end);
+        if (*end != '\0' || num < 0.0)
+        {
+            ok = FALSE;
+            break;
+        }
+
+        if (!g_strcmp0(fields[i], "latency"))
+            conf->latency = (guint)num;
+        else if (!g_strcmp0(fields[i], "jitter"))
+            conf->jitter = (guint)num;
+        else if (!g_strcmp0(fields[i], "fail"))
+            conf->failprob = MIN(num, 1.0);
+        else if (!g_strcmp0(fields[i], "drop"))
+            conf->dropprob = MIN(num, 1.0);
+        else if (!g_strcmp0(fields[i], "step") && num > 0.0)
+            conf->step = num;
+        else if (!g_strcmp0(fields[i], "rate") && num > 0.0)
+            conf->rate = num;
+        else if (!g_strcmp0(fields[i], "speed") && num > 0.0)
+            conf->speed = num;
+        else
+            ok = FALSE;
+    }
+    g_strfreev(fields);
+
+    if (!ok)
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Invalid simulator specification: %s"), __func__,
+                    spec);
+
+    return ok;
+}
+
+/* VFO addressed by a command argument; everything but B is VFO A */
+static guint vfo_index(const gchar *vfo)
+{
+    return (!g_strcmp0(vfo, "VFOB") || !g_strcmp0(vfo, "Sub")) ? 1 : 0;
+}
+
+/* Move the rotator towards its target for the time elapsed since last time */
+static void move_rotator(hamlib_sim_t *sim)
+{
+    gint64 now = g_get_monotonic_time();
+    gdouble max;
+
+    max = sim->conf.rate * sim->conf.speed * (now - sim->tmove) / 1.0e6;
+    sim->az += CLAMP(sim->taz - sim->az, -max, max);
+    sim->el += CLAMP(sim->tel - sim->el, -max, max);
+    sim->tmove = now;
+}
+
+/* Frequency the radio ends up on when asked for freq */
+static gdouble tune(hamlib_sim_t *sim, const gchar *freq)
+{
+    return sim->conf.step * round(g_ascii_strtod(freq, NULL) / sim->conf.step);
+}
+
+/* Execute a rigctld command; argv[0] is the command, a VFO may follow */
+static void exec_rig_cmd(hamlib_sim_t *sim, gchar **argv, guint argc,
+                         GString *resp)
+{
+    const gchar *cmd = argv[0];
+    guint vfo = 0;
+    guint arg = 1;
+
+    if (argc > 1 && g_ascii_isalpha(argv[1][0]))
+    {
+        vfo = vfo_index(argv[1]);
+        arg = 2;
+    }
+
+    if (!strcmp(cmd, "F") && argc > arg)
+    {
+        sim->freq[vfo] = tune(sim, argv[arg]);
+        g_string_append(resp, "RPRT 0\n");
+    }
+    else if (!strcmp(cmd, "f"))
+        g_string_append_printf(resp, "%.0f\n", sim->freq[vfo]);
+    else if (!strcmp(cmd, "I") && argc > arg)
+    {
+        sim->txfreq = tune(sim, argv[arg]);
+        g_string_append(resp, "RPRT 0\n");
+    }
+    else if (!strcmp(cmd, "i"))
+        g_string_append_printf(resp, "%.0f\n", sim->txfreq);
+    else if (!strcmp(cmd, "T") && argc > arg)
+    {
+        sim->ptt = atoi(argv[arg]);
+        g_string_append(resp, "RPRT 0\n");
+    }
+    else if (!strcmp(cmd, "t"))
+        g_string_append_printf(resp, "%d\n", sim->ptt);
+    else if (!strcmp(cmd, "\x8b"))
+        g_string_append(resp, "0\n"); /* get_dcd */
+    else if (!strcmp(cmd, "\\chk_vfo"))
+        g_string_append(resp, "0\n");
+    else if (!strcmp(cmd, "S") || !strcmp(cmd, "\\set_vfo_opt") ||
+             !strcmp(cmd, "AOS") || !strcmp(cmd, "LOS"))
+        g_string_append(resp, "RPRT 0\n");
+    else
+        g_string_append(resp, "RPRT -4\n"); /* not implemented */
+}
+
+/* Execute a rotctld command */
+static void exec_rot_cmd(hamlib_sim_t *sim, gchar **argv, guint argc,
+                         GString *resp)
+{
+    const gchar *cmd = argv[0];
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    move_rotator(sim);
+
+    if (!strcmp(cmd, "P") && argc > 2)
+    {
+        sim->taz = g_ascii_strtod(argv[1], NULL);
+        sim->tel = g_ascii_strtod(argv[2], NULL);
+        g_string_append(resp, "RPRT 0\n");
+    }
+    else if (!strcmp(cmd, "p"))
+    {
+        g_string_append_printf(resp, "%s\n",
+                               g_ascii_formatd(buf, sizeof(buf), "%.6f",
+                                               sim->az));
+        g_string_append_printf(resp, "%s\n",
+                               g_ascii_formatd(buf, sizeof(buf), "%.6f",
+                                               sim->el));
+    }
+    else if (!strcmp(cmd, "S"))
+    {
+        sim->taz = sim->az;
+        sim->tel = sim->el;
+        g_string_append(resp, "RPRT 0\n");
+    }
+    else
+        g_string_append(resp, "RPRT -4\n"); /* not implemented */
+}
+
+/*
+ * Execute one command line.
+ *
+ * @return FALSE if the client asked to close the connection.
+ */
+static gboolean exec_line(hamlib_sim_t *sim, gchar *line, GRand *rand,
+                          GString *resp)
+{
+    gchar **tokens, *argv[8];
+    gchar *name;
+    guint i, argc = 0;
+    gdouble r;
+
+    /* numbers are padded with spaces, so there can be empty tokens */
+    tokens = g_strsplit_set(line, " \t\r", -1);
+    for (i = 0; tokens[i] != NULL && argc < G_N_ELEMENTS(argv); i++)
+        if (tokens[i][0] != '\0')
+            argv[argc++] = tokens[i];
+
+    if (argc == 0 || !strcmp(argv[0], "q") || !strcmp(argv[0], "Q"))
+    {
+        g_strfreev(tokens);
+        return (argc == 0);
+    }
+
+    g_mutex_lock(&sim->mutex);
+    name = g_strescape(argv[0], NULL);
+    g_hash_table_replace(
+        sim->counts, name,
+        GUINT_TO_POINTER(GPOINTER_TO_UINT(
+                             g_hash_table_lookup(sim->counts, name)) + 1));
+
+    r = g_rand_double(rand);
+    if (r < sim->conf.dropprob)
+        ; /* lost on the way; the client will time out */
+    else if (r < sim->conf.dropprob + sim->conf.failprob)
+        g_string_append(resp, "RPRT -1\n");
+    else if (sim->type == HAMLIB_SIM_RIGCTLD)
+        exec_rig_cmd(sim, argv, argc, resp);
+    else
+        exec_rot_cmd(sim, argv, argc, resp);
+    g_mutex_unlock(&sim->mutex);
+    g_strfreev(tokens);
+
+    return TRUE;
+}
+
+static gboolean send_all(gint sock, const gchar *buf, gsize len)
+{
+    gssize n;
+
+    while (len > 0)
+    {
+        n = send(sock, buf, len, MSG_NOSIGNAL);
+        if (n <= 0)
+            return FALSE;
+        buf += n;
+        len -= n;
+    }
+
+    return TRUE;
+}
+
+/* Serve one client connection */
+static gpointer conn_thread(gpointer data)
+{
+    sim_conn_t *conn = data;
+    hamlib_sim_t *sim = conn->sim;
+    GRand *rand = g_rand_new();
+    GString *resp = g_string_new(NULL);
+    gchar buf[LINE_SIZE];
+    gchar *eol;
+    struct pollfd pfd;
+    gsize len = 0;
+    gssize n;
+    gboolean alive = TRUE;
+    guint delay;
+
+    pfd.fd = conn->sock;
+    pfd.events = POLLIN;
+
+    while (alive && g_atomic_int_get(&sim->running))
+    {
+        if (poll(&pfd, 1, POLL_INTERVAL) <= 0)
+            continue;
+
+        n = recv(conn->sock, buf + len, sizeof(buf) - len - 1, 0);
+        if (n <= 0)
+            break;
+        len += n;
+        buf[len] = '\0';
+
+        while (alive && (eol = strchr(buf, '\n')) != NULL)
+        {
+            *eol = '\0';
+            alive = exec_line(sim, buf, rand, resp);
+            len -= eol + 1 - buf;
+            memmove(buf, eol + 1, len + 1);
+
+            if (resp->len == 0)
+                continue;
+
+            delay = sim->conf.latency;
+            if (sim->conf.jitter > 0)
+                delay += g_rand_int_range(rand, 0, sim->conf.jitter + 1);
+            if (delay > 0)
+                g_usleep(delay * 1000);
+
+            if (!send_all(conn->sock, resp->str, resp->len))
+                alive = FALSE;
+            g_string_truncate(resp, 0);
+        }
+
+        /* a line that does not fit is not a command we know */
+        if (len == sizeof(buf) - 1)
+            len = 0;
+    }
+
+    sock_close(conn->sock);
+    g_string_free(resp, TRUE);
+    g_rand_free(rand);
+    g_free(conn);
+
+    return NULL;
+}
+
+/* Accept client connections until the simulator is stopped */
+static gpointer accept_thread(gpointer data)
+{
+    hamlib_sim_t *sim = data;
+    sim_conn_t *conn;
+    struct pollfd pfd;
+    gint sock;
+    gint one = 1;
+
+    pfd.fd = sim->sock;
+    pfd.events = POLLIN;
+
+    while (g_atomic_int_get(&sim->running))
+    {
+        if (poll(&pfd, 1, POLL_INTERVAL) <= 0)
+            continue;
+
+        sock = accept(sim->sock, NULL, NULL);
+        if (sock == -1)
+            continue;
+
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&one,
+                   sizeof(one));
+
+        conn = g_new(sim_conn_t, 1);
+        conn->sim = sim;
+        conn->sock = sock;
+
+        g_mutex_lock(&sim->mutex);
+        sim->conns = g_slist_prepend(
+            sim->conns, g_thread_new("gpredict_simconn", conn_thread, conn));
+        g_mutex_unlock(&sim->mutex);
+    }
+
+    return NULL;
+}
+
+/*
+ * Start a simulated daemon.
+ *
+ * @param type The kind of daemon.
+ * @param conf The behaviour of the daemon.
+ * @return The simulator, or NULL if the port could not be opened.
+ */
+hamlib_sim_t *hamlib_sim_start(hamlib_sim_type_t type,
+                               const hamlib_sim_conf_t *conf)
+{
+    hamlib_sim_t *sim;
+    struct sockaddr_in addr;
+    gint sock;
+    gint one = 1;
+
+    sock = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to create socket: %s"),
+                    __func__, g_strerror(errno));
+        return NULL;
+    }
+
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (const char *)&one,
+               sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(conf->port);
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) == -1 ||
+        listen(sock, 4) == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to listen on port %d: %s"), __func__,
+                    conf->port, g_strerror(errno));
+        sock_close(sock);
+        return NULL;
+    }
+
+    sim = g_new0(hamlib_sim_t, 1);
+    sim->type = type;
+    sim->conf = *conf;
+    sim->sock = sock;
+    sim->running = TRUE;
+    sim->counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    sim->freq[0] = sim->freq[1] = 145.8e6;
+    sim->txfreq = 435.0e6;
+    sim->tmove = g_get_monotonic_time();
+    g_mutex_init(&sim->mutex);
+    sim->thread = g_thread_new("gpredict_sim", accept_thread, sim);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Simulated %s listening on port %d (latency %u ms, "
+                  "jitter %u ms, fail %.3f, drop %.3f)"),
+                __func__, type_name(type), conf->port, conf->latency,
+                conf->jitter, conf->failprob, conf->dropprob);
+
+    return sim;
+}
+
+/* Stop a simulator and log the commands it has received */
+void hamlib_sim_stop(hamlib_sim_t *sim)
+{
+    GString *buff;
+    GList *keys, *node;
+    GSList *conn;
+
+    if (sim == NULL)
+        return;
+
+    g_atomic_int_set(&sim->running, FALSE);
+    g_thread_join(sim->thread);
+    for (conn = sim->conns; conn != NULL; conn = conn->next)
+        g_thread_join(conn->data);
+    g_slist_free(sim->conns);
+    sock_close(sim->sock);
+
+    buff = g_string_new(NULL);
+    keys = g_list_sort(g_hash_table_get_keys(sim->counts),
+                       (GCompareFunc)g_strcmp0);
+    for (node = keys; node != NULL; node = node->next)
+        g_string_append_printf(
+            buff, "%s%s %u", buff->len ? ", " : "", (gchar *)node->data,
+            GPOINTER_TO_UINT(g_hash_table_lookup(sim->counts, node->data)));
+    g_list_free(keys);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Simulated %s on port %d got %s"),
+                __func__, type_name(sim->type), sim->conf.port,
+                buff->len ? buff->str : _("no commands"));
+    g_string_free(buff, TRUE);
+
+    g_hash_table_destroy(sim->counts);
+    g_mutex_clear(&sim->mutex);
+    g_free(sim);
+}
@@ -0,0 +1,49 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef HAMLIB_SIM_H
+#define HAMLIB_SIM_H 1
+
+#include <glib.h>
+
+/* Kind of daemon to simulate */
+typedef enum {
+    HAMLIB_SIM_RIGCTLD = 0,
+    HAMLIB_SIM_ROTCTLD
+} hamlib_sim_type_t;
+
+/* Behaviour of a simulated daemon */
+typedef struct {
+    gint port;         /* TCP port on the loopback interface */
+    guint latency;     /* Delay before each response (msec) */
+    guint jitter;      /* Max random delay added to the latency (msec) */
+    gdouble failprob;  /* Probability that a command returns an error */
+    gdouble dropprob;  /* Probability that a command gets no response */
+    gdouble step;      /* Tuning step of the radio (Hz) */
+    gdouble rate;      /* Slew rate of the rotator (deg/sec) */
+    gdouble speed;     /* Time scale of the slew, e.g. the module throttle */
+} hamlib_sim_conf_t;
+
+typedef struct _hamlib_sim hamlib_sim_t;
+
+gboolean hamlib_sim_parse(const gchar *spec, hamlib_sim_conf_t *conf);
+hamlib_sim_t *hamlib_sim_start(hamlib_sim_type_t type,
+                               const hamlib_sim_conf_t *conf);
+void hamlib_sim_stop(hamlib_sim_t *sim);
+
+#endif
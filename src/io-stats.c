@@ -0,0 +1,516 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * I/O statistics of the radio and rotator controllers.
+ *
+ * Every command sent to rigctld or rotctld is accounted for: the round-trip
+ * time of the ones that got a response goes into a histogram with
+ * logarithmic bins, the others are counted as errors or timeouts. Together
+ * with the tracking errors of a controller they form a report that can be
+ * shown in a dialog and saved as CSV or JSON, which helps choosing the cycle
+ * period, spotting a degraded CAT link and comparing control loops.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <gtk/gtk.h>
+#include <math.h>
+#include <string.h>
+
+#include "io-stats.h"
+#include "sat-log.h"
+
+void io_stats_reset(io_stats_t *stats)
+{
+    memset(stats, 0, sizeof(io_stats_t));
+}
+
+/* Account for a request of ncmd pipelined commands being sent */
+void io_stats_request(io_stats_t *stats, guint ncmd)
+{
+    stats->latest = g_get_monotonic_time();
+    if (stats->first == 0)
+        stats->first = stats->latest;
+
+    stats->queue = ncmd;
+    stats->maxqueue = MAX(stats->maxqueue, ncmd);
+}
+
+/* Upper bound of histogram bin i (ms); the last bin has none */
+static gdouble bin_limit(guint i)
+{
+    return ldexp(1.0, i);
+}
+
+/* Add the response to a command that took usec to complete */
+void io_stats_response(io_stats_t *stats, gint64 usec, gboolean ok)
+{
+    gdouble rtt = usec / 1.0e6;
+    guint i;
+
+    stats->count++;
+    if (!ok)
+        stats->errors++;
+
+    stats->last = rtt;
+    stats->mean += (rtt - stats->mean) / stats->count;
+    stats->max = MAX(stats->max, rtt);
+
+    for (i = 0; i < IO_STATS_NBINS - 1 && rtt * 1.0e3 >= bin_limit(i); i++)
+        ;
+    stats->hist[i]++;
+}
+
+/* Account for ncmd commands that did not get a response */
+void io_stats_timeout(io_stats_t *stats, guint ncmd)
+{
+    stats->timeouts += ncmd;
+}
+
+void io_stats_retry(io_stats_t *stats)
+{
+    stats->retries++;
+}
+
+/* Number of commands sent per second */
+gdouble io_stats_rate(const io_stats_t *stats)
+{
+    if (stats->latest <= stats->first)
+        return 0.0;
+
+    return (stats->count + stats->timeouts) * 1.0e6 /
+           (stats->latest - stats->first);
+}
+
+/*
+ * Estimate a percentile of the round-trip time from the histogram.
+ *
+ * @param p The percentile between 0 and 1.
+ * @return The upper bound of the bin the percentile falls in (sec), or the
+ *         max if that is lower.
+ */
+gdouble io_stats_percentile(const io_stats_t *stats, gdouble p)
+{
+    guint i, sum = 0;
+
+    if (stats->count == 0)
+        return 0.0;
+
+    for (i = 0; i < IO_STATS_NBINS - 1; i++)
+    {
+        sum += stats->hist[i];
+        if (sum >= p * stats->count)
+            return MIN(bin_limit(i) / 1.0e3, stats->max);
+    }
+
+    return stats->max;
+}
+
+/* One line summary for the controllers */
+gchar *io_stats_summary(const io_stats_t *stats)
+{
+    if (stats->count + stats->timeouts == 0)
+        return g_strdup(_("No commands"));
+
+    return g_strdup_printf(_("%.0f ms, %.1f cmd/s, %u errors"),
+                           stats->mean * 1.0e3, io_stats_rate(stats),
+                           stats->errors + stats->timeouts);
+}
+
+void io_stats_log(const gchar *name, const io_stats_t *stats)
+{
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %u commands, %u errors, %u timeouts, %u retries, "
+                  "round-trip %.1f ms mean, %.1f ms p95, %.1f ms max"),
+                name, stats->count, stats->errors, stats->timeouts,
+                stats->retries, stats->mean * 1.0e3,
+                io_stats_percentile(stats, 0.95) * 1.0e3, stats->max * 1.0e3);
+}
+
+void track_stats_add(track_stats_t *stats, gdouble err)
+{
+    err = fabs(err);
+
+    stats->count++;
+    stats->mean += (err - stats->mean) / stats->count;
+    stats->sumsq += err * err;
+    stats->max = MAX(stats->max, err);
+}
+
+gdouble track_stats_rms(const track_stats_t *stats)
+{
+    if (stats->count == 0)
+        return 0.0;
+
+    return sqrt(stats->sumsq / stats->count);
+}
+
+void track_stats_log(const gchar *name, const track_stats_t *stats)
+{
+    if (stats->count == 0)
+        return;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: %.3g mean, %.3g rms, %.3g max (%u samples)"), name,
+                stats->mean, track_stats_rms(stats), stats->max,
+                stats->count);
+}
+
+void io_report_add_io(io_report_t *report, const gchar *name,
+                      const io_stats_t *stats)
+{
+    g_return_if_fail(report->nio < IO_REPORT_MAX);
+
+    report->ionames[report->nio] = name;
+    report->io[report->nio++] = *stats;
+}
+
+void io_report_add_error(io_report_t *report, const gchar *name,
+                         const track_stats_t *stats)
+{
+    g_return_if_fail(report->nerr < IO_REPORT_MAX);
+
+    report->errnames[report->nerr] = name;
+    report->err[report->nerr++] = *stats;
+}
+
+/* Append a string to a JSON document */
+static void append_json_string(GString *buff, const gchar *str)
+{
+    const gchar *c;
+
+    g_string_append_c(buff, '"');
+    for (c = str; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            g_string_append_printf(buff, "\\%c", *c);
+        else if ((guchar)*c < 0x20)
+            g_string_append_printf(buff, "\\u%04x", (guchar)*c);
+        else
+            g_string_append_c(buff, *c);
+    }
+    g_string_append_c(buff, '"');
+}
+
+/* Append a field to a CSV line, quoting it if necessary */
+static void append_csv_string(GString *buff, const gchar *str)
+{
+    const gchar *c;
+
+    if (strpbrk(str, ",\"\n") == NULL)
+    {
+        g_string_append(buff, str);
+        return;
+    }
+
+    g_string_append_c(buff, '"');
+    for (c = str; *c != '\0'; c++)
+    {
+        if (*c == '"')
+            g_string_append_c(buff, '"');
+        g_string_append_c(buff, *c);
+    }
+    g_string_append_c(buff, '"');
+}
+
+/*
+ * Append a prefix and a number to a CSV or JSON document.
+ *
+ * The number always has a decimal point, whatever the locale.
+ */
+static void append_number(GString *buff, const gchar *prefix,
+                          const gchar *format, gdouble value)
+{
+    gchar str[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_string_append(buff, prefix);
+    g_string_append(buff, g_ascii_formatd(str, sizeof(str), format, value));
+}
+
+static const gchar *const csv_times[6] = {",", ",", ",", ",", ",", ","};
+static const gchar *const json_times[6] = {
+    ", \"last_ms\": ", ", \"mean_ms\": ", ", \"p50_ms\": ",
+    ", \"p95_ms\": ", ", \"p99_ms\": ", ", \"max_ms\": "};
+
+/* Append the round-trip times of a device, in ms, after their prefixes */
+static void append_times(GString *buff, const io_stats_t *stats,
+                         const gchar *const prefix[6])
+{
+    append_number(buff, prefix[0], "%.1f", stats->last * 1.0e3);
+    append_number(buff, prefix[1], "%.1f", stats->mean * 1.0e3);
+    append_number(buff, prefix[2], "%.1f",
+                  io_stats_percentile(stats, 0.50) * 1.0e3);
+    append_number(buff, prefix[3], "%.1f",
+                  io_stats_percentile(stats, 0.95) * 1.0e3);
+    append_number(buff, prefix[4], "%.1f",
+                  io_stats_percentile(stats, 0.99) * 1.0e3);
+    append_number(buff, prefix[5], "%.1f", stats->max * 1.0e3);
+}
+
+static void append_csv(GString *buff, const io_report_t *report)
+{
+    const io_stats_t *stats = report->io;
+    guint i, j;
+
+    g_string_append(buff, "device,commands,errors,timeouts,retries,"
+                          "rate (cmd/s),max queue,last (ms),mean (ms),"
+                          "p50 (ms),p95 (ms),p99 (ms),max (ms)");
+    for (j = 0; j < IO_STATS_NBINS - 1; j++)
+        g_string_append_printf(buff, ",<%.0f ms", bin_limit(j));
+    g_string_append_printf(buff, ",>=%.0f ms\n",
+                           bin_limit(IO_STATS_NBINS - 2));
+
+    for (i = 0; i < report->nio; i++)
+    {
+        append_csv_string(buff, report->ionames[i]);
+        g_string_append_printf(buff, ",%u,%u,%u,%u", stats[i].count,
+                               stats[i].errors, stats[i].timeouts,
+                               stats[i].retries);
+        append_number(buff, ",", "%.2f", io_stats_rate(&stats[i]));
+        g_string_append_printf(buff, ",%u", stats[i].maxqueue);
+        append_times(buff, &stats[i], csv_times);
+        for (j = 0; j < IO_STATS_NBINS; j++)
+            g_string_append_printf(buff, ",%u", stats[i].hist[j]);
+        g_string_append_c(buff, '\n');
+    }
+
+    if (report->nerr == 0)
+        return;
+
+    /* the tracking errors follow as a second table */
+    g_string_append(buff, "\ntracking error,samples,mean,rms,max\n");
+    for (i = 0; i < report->nerr; i++)
+    {
+        append_csv_string(buff, report->errnames[i]);
+        g_string_append_printf(buff, ",%u", report->err[i].count);
+        append_number(buff, ",", "%.6g", report->err[i].mean);
+        append_number(buff, ",", "%.6g", track_stats_rms(&report->err[i]));
+        append_number(buff, ",", "%.6g", report->err[i].max);
+        g_string_append_c(buff, '\n');
+    }
+}
+
+static void append_json(GString *buff, const io_report_t *report)
+{
+    const io_stats_t *stats = report->io;
+    guint i, j;
+
+    g_string_append(buff, "{\n  \"histogram_limits_ms\": [");
+    for (j = 0; j < IO_STATS_NBINS - 1; j++)
+        g_string_append_printf(buff, "%s%.0f", j ? ", " : "", bin_limit(j));
+    g_string_append(buff, "],\n  \"devices\": [");
+
+    for (i = 0; i < report->nio; i++)
+    {
+        g_string_append(buff, i ? ",\n    {\"name\": " : "\n    {\"name\": ");
+        append_json_string(buff, report->ionames[i]);
+        g_string_append_printf(buff,
+                               ", \"commands\": %u, \"errors\": %u, "
+                               "\"timeouts\": %u, \"retries\": %u",
+                               stats[i].count, stats[i].errors,
+                               stats[i].timeouts, stats[i].retries);
+        append_number(buff, ", \"rate\": ", "%.2f", io_stats_rate(&stats[i]));
+        g_string_append_printf(buff, ", \"max_queue\": %u",
+                               stats[i].maxqueue);
+        append_times(buff, &stats[i], json_times);
+        g_string_append(buff, ", \"histogram\": [");
+        for (j = 0; j < IO_STATS_NBINS; j++)
+            g_string_append_printf(buff, "%s%u", j ? ", " : "",
+                                   stats[i].hist[j]);
+        g_string_append(buff, "]}");
+    }
+    g_string_append(buff, "\n  ],\n  \"tracking_errors\": [");
+
+    for (i = 0; i < report->nerr; i++)
+    {
+        g_string_append(buff, i ? ",\n    {\"name\": " : "\n    {\"name\": ");
+        append_json_string(buff, report->errnames[i]);
+        g_string_append_printf(buff, ", \"samples\": %u",
+                               report->err[i].count);
+        append_number(buff, ", \"mean\": ", "%.6g", report->err[i].mean);
+        append_number(buff, ", \"rms\": ", "%.6g",
+                      track_stats_rms(&report->err[i]));
+        append_number(buff, ", \"max\": ", "%.6g", report->err[i].max);
+        g_string_append_c(buff, '}');
+    }
+    g_string_append(buff, report->nerr ? "\n  ]\n}\n" : "]\n}\n");
+}
+
+/*
+ * Save a report.
+ *
+ * The file is written as JSON if its name ends with .json and as comma
+ * separated values otherwise.
+ */
+gboolean io_report_save(const io_report_t *report, const gchar *filename)
+{
+    GString *buff;
+    GError *err = NULL;
+    gboolean retval;
+
+    buff = g_string_new(NULL);
+    if (g_str_has_suffix(filename, ".json"))
+        append_json(buff, report);
+    else
+        append_csv(buff, report);
+
+    retval = g_file_set_contents(filename, buff->str, buff->len, &err);
+    if (!retval)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not save %s (%s)"),
+                    __func__, filename, err->message);
+        g_clear_error(&err);
+    }
+
+    g_string_free(buff, TRUE);
+
+    return retval;
+}
+
+/* Human readable version of a report */
+static gchar *format_report(const io_report_t *report)
+{
+    const io_stats_t *stats = report->io;
+    const track_stats_t *err = report->err;
+    GString *buff;
+    guint i, j;
+
+    buff = g_string_new(NULL);
+    for (i = 0; i < report->nio; i++)
+    {
+        g_string_append_printf(buff, "%s\n", report->ionames[i]);
+        g_string_append_printf(buff,
+                               _("  Commands: %u (%.1f/s), errors: %u, "
+                                 "timeouts: %u, retries: %u\n"),
+                               stats[i].count + stats[i].timeouts,
+                               io_stats_rate(&stats[i]), stats[i].errors,
+                               stats[i].timeouts, stats[i].retries);
+        g_string_append_printf(buff,
+                               _("  Queue: %u (max %u)\n"), stats[i].queue,
+                               stats[i].maxqueue);
+        g_string_append_printf(buff,
+                               _("  Round-trip (ms): last %.1f, mean %.1f, "
+                                 "p50 %.1f, p95 %.1f, max %.1f\n"),
+                               stats[i].last * 1.0e3, stats[i].mean * 1.0e3,
+                               io_stats_percentile(&stats[i], 0.50) * 1.0e3,
+                               io_stats_percentile(&stats[i], 0.95) * 1.0e3,
+                               stats[i].max * 1.0e3);
+
+        for (j = 0; j < IO_STATS_NBINS; j++)
+        {
+            if (stats[i].hist[j] == 0)
+                continue;
+
+            if (j < IO_STATS_NBINS - 1)
+                g_string_append_printf(buff, "    < %5.0f ms: %u\n",
+                                       bin_limit(j), stats[i].hist[j]);
+            else
+                g_string_append_printf(buff, "    >=%5.0f ms: %u\n",
+                                       bin_limit(j - 1), stats[i].hist[j]);
+        }
+        g_string_append_c(buff, '\n');
+    }
+
+    for (i = 0; i < report->nerr; i++)
+        g_string_append_printf(buff,
+                               _("%s\n  %.3g mean, %.3g rms, %.3g max "
+                                 "(%u samples)\n\n"),
+                               report->errnames[i], err[i].mean,
+                               track_stats_rms(&err[i]), err[i].max,
+                               err[i].count);
+
+    return g_string_free(buff, FALSE);
+}
+
+static void save_dialog(GtkWidget *parent, const io_report_t *report)
+{
+    GtkWidget *dialog;
+    GtkFileFilter *filter;
+    gchar *filename;
+
+    dialog = gtk_file_chooser_dialog_new(_("Save I/O Statistics"),
+                                         GTK_WINDOW(parent),
+                                         GTK_FILE_CHOOSER_ACTION_SAVE,
+                                         "_Cancel", GTK_RESPONSE_CANCEL,
+                                         "_Save", GTK_RESPONSE_ACCEPT, NULL);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog),
+                                                   TRUE);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog),
+                                      "io-stats.csv");
+
+    filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, _("CSV or JSON files"));
+    gtk_file_filter_add_pattern(filter, "*.csv");
+    gtk_file_filter_add_pattern(filter, "*.json");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+    {
+        filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        io_report_save(report, filename);
+        g_free(filename);
+    }
+
+    gtk_widget_destroy(dialog);
+}
+
+/*
+ * Show a report in a dialog, from which it can be saved.
+ *
+ * The dialog is modal and shows the statistics as they are when it opens.
+ */
+void io_report_dialog(GtkWidget *parent, const gchar *title,
+                      const io_report_t *report)
+{
+    GtkWidget *dialog, *swin, *view;
+    GtkTextBuffer *text;
+    gchar *buff;
+
+    parent = gtk_widget_get_toplevel(parent);
+    dialog = gtk_dialog_new_with_buttons(title, GTK_WINDOW(parent),
+                                         GTK_DIALOG_MODAL |
+                                             GTK_DIALOG_DESTROY_WITH_PARENT,
+                                         "_Save", GTK_RESPONSE_ACCEPT,
+                                         "_Close", GTK_RESPONSE_CLOSE, NULL);
+    gtk_window_set_default_size(GTK_WINDOW(dialog), 520, 400);
+
+    buff = format_report(report);
+    text = gtk_text_buffer_new(NULL);
+    gtk_text_buffer_set_text(text, buff, -1);
+    g_free(buff);
+
+    view = gtk_text_view_new_with_buffer(text);
+    g_object_unref(text);
+    gtk_text_view_set_editable(GTK_TEXT_VIEW(view), FALSE);
+    gtk_text_view_set_monospace(GTK_TEXT_VIEW(view), TRUE);
+
+    swin = gtk_scrolled_window_new(NULL, NULL);
+    gtk_container_add(GTK_CONTAINER(swin), view);
+    gtk_box_pack_start(GTK_BOX(gtk_dialog_get_content_area(GTK_DIALOG(dialog))),
+                       swin, TRUE, TRUE, 0);
+    gtk_widget_show_all(dialog);
+
+    while (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+        save_dialog(dialog, report);
+
+    gtk_widget_destroy(dialog);
+}
@@ -0,0 +1,95 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef IO_STATS_H
+#define IO_STATS_H 1
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+/*
+ * Number of round-trip time histogram bins. Bin 0 counts times below 1 ms,
+ * bin i times from 2^(i-1) to 2^i ms and the last bin everything longer.
+ */
+#define IO_STATS_NBINS 14
+
+/*
+ * I/O statistics of one device, i.e. one rigctld or rotctld connection.
+ *
+ * The statistics are plain structs, so that they can be copied between the
+ * thread talking to the device and the UI.
+ */
+typedef struct {
+    guint count;    /* Number of commands that got a response */
+    guint errors;   /* Number of commands that returned an error */
+    guint timeouts; /* Number of commands without response */
+    guint retries;  /* Number of commands sent again after an error */
+    guint queue;    /* Commands in flight in the last request */
+    guint maxqueue; /* Max commands in flight in one request */
+    gdouble last;   /* Round-trip time of the last command (sec) */
+    gdouble mean;   /* Mean round-trip time (sec) */
+    gdouble max;    /* Max round-trip time (sec) */
+    gint64 first;   /* Monotonic time of the first request (usec); 0 if none */
+    gint64 latest;  /* Monotonic time of the latest request (usec) */
+    guint hist[IO_STATS_NBINS]; /* Round-trip time histogram */
+} io_stats_t;
+
+/* Statistics of a tracking error, e.g. the pointing error of a rotator */
+typedef struct {
+    guint count;   /* Number of samples */
+    gdouble mean;  /* Mean absolute error */
+    gdouble sumsq; /* Sum of the squared errors */
+    gdouble max;   /* Max absolute error */
+} track_stats_t;
+
+#define IO_REPORT_MAX 4 /* Max number of entries of each kind in a report */
+
+/* The statistics of a controller, for showing or saving them in one go */
+typedef struct {
+    guint nio;
+    const gchar *ionames[IO_REPORT_MAX]; /* Name of each device */
+    io_stats_t io[IO_REPORT_MAX];        /* I/O statistics of each device */
+    guint nerr;
+    const gchar *errnames[IO_REPORT_MAX]; /* Name and unit of each error */
+    track_stats_t err[IO_REPORT_MAX];     /* Tracking errors */
+} io_report_t;
+
+void io_stats_reset(io_stats_t *stats);
+void io_stats_request(io_stats_t *stats, guint ncmd);
+void io_stats_response(io_stats_t *stats, gint64 usec, gboolean ok);
+void io_stats_timeout(io_stats_t *stats, guint ncmd);
+void io_stats_retry(io_stats_t *stats);
+
+gdouble io_stats_rate(const io_stats_t *stats);
+gdouble io_stats_percentile(const io_stats_t *stats, gdouble p);
+gchar *io_stats_summary(const io_stats_t *stats);
+void io_stats_log(const gchar *name, const io_stats_t *stats);
+
+void track_stats_add(track_stats_t *stats, gdouble err);
+gdouble track_stats_rms(const track_stats_t *stats);
+void track_stats_log(const gchar *name, const track_stats_t *stats);
+
+void io_report_add_io(io_report_t *report, const gchar *name,
+                      const io_stats_t *stats);
+void io_report_add_error(io_report_t *report, const gchar *name,
+                         const track_stats_t *stats);
+gboolean io_report_save(const io_report_t *report, const gchar *filename);
+void io_report_dialog(GtkWidget *parent, const gchar *title,
+                      const io_report_t *report);
+
+#endif
@@ -0,0 +1,271 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Streaming reader of JSON records.
+ *
+ * The element and transmitter databases are JSON arrays of flat objects, one
+ * per record. They are read in one pass over the text, reporting each member
+ * and the end of each object through callbacks, without building a tree of
+ * the whole file. Members whose value is an object or an array are skipped.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <string.h>
+
+#include "json-stream.h"
+
+typedef struct {
+    const gchar *pos;
+    const gchar *end;
+    GString *key;
+    GString *value;
+} json_stream_t;
+
+typedef enum {
+    JSON_BAD = 0,         /* Malformed */
+    JSON_VALUE,           /* A string, number or boolean */
+    JSON_OTHER            /* Null, or a nested object or array */
+} json_kind_t;
+
+static void skip_space(json_stream_t *js)
+{
+    while (js->pos < js->end && g_ascii_isspace(*js->pos))
+        js->pos++;
+}
+
+/* Read a string into text; the position is at the opening quote */
+static gboolean read_string(json_stream_t *js, GString *text)
+{
+    const gchar *p = js->pos + 1;
+    const gchar *end = js->end;
+    gunichar c;
+    gint i;
+
+    g_string_truncate(text, 0);
+
+    for (; p < end && *p != '"'; p++)
+    {
+        if (*p != '\\')
+        {
+            g_string_append_c(text, *p);
+            continue;
+        }
+
+        if (++p >= end)
+            return FALSE;
+
+        switch (*p)
+        {
+        case 'b':
+            g_string_append_c(text, '\b');
+            break;
+        case 'f':
+            g_string_append_c(text, '\f');
+            break;
+        case 'n':
+            g_string_append_c(text, '\n');
+            break;
+        case 'r':
+            g_string_append_c(text, '\r');
+            break;
+        case 't':
+            g_string_append_c(text, '\t');
+            break;
+        case 'u':
+            if (end - p < 5)
+                return FALSE;
+            for (c = 0, i = 1; i <= 4; i++)
+            {
+                if (!g_ascii_isxdigit(p[i]))
+                    return FALSE;
+                c = c * 16 + g_ascii_xdigit_value(p[i]);
+            }
+            /* text outside the BMP is not expected */
+            g_string_append_unichar(text, g_unichar_validate(c) ? c : '?');
+            p += 4;
+            break;
+        default:
+            /* quote, backslash and slash */
+            g_string_append_c(text, *p);
+            break;
+        }
+    }
+
+    if (p >= end)
+        return FALSE;
+
+    js->pos = p + 1;
+
+    return TRUE;
+}
+
+/* Read a value into the value buffer; nested data is skipped */
+static json_kind_t read_value(json_stream_t *js)
+{
+    const gchar *start = js->pos;
+    gint depth = 0;
+
+    if (start >= js->end)
+        return JSON_BAD;
+
+    if (*start == '"')
+        return read_string(js, js->value) ? JSON_VALUE : JSON_BAD;
+
+    if (*start == '{' || *start == '[')
+    {
+        while (js->pos < js->end)
+        {
+            switch (*js->pos)
+            {
+            case '"':
+                if (!read_string(js, js->value))
+                    return JSON_BAD;
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0)
+                {
+                    js->pos++;
+                    return JSON_OTHER;
+                }
+                break;
+            default:
+                break;
+            }
+            js->pos++;
+        }
+        return JSON_BAD;
+    }
+
+    while (js->pos < js->end && !strchr(",}] \t\r\n", *js->pos))
+        js->pos++;
+    if (js->pos == start)
+        return JSON_BAD;
+
+    g_string_truncate(js->value, 0);
+    g_string_append_len(js->value, start, js->pos - start);
+
+    return strcmp(js->value->str, "null") ? JSON_VALUE : JSON_OTHER;
+}
+
+/* Read an object; the position is at the opening brace */
+static gboolean read_object(json_stream_t *js,
+                            const json_stream_parser_t *parser, gpointer data)
+{
+    for (js->pos++;;)
+    {
+        skip_space(js);
+        if (js->pos >= js->end)
+            return FALSE;
+
+        if (*js->pos == '}')
+        {
+            js->pos++;
+            if (parser->end_object != NULL)
+                parser->end_object(data);
+            return TRUE;
+        }
+        if (*js->pos == ',')
+        {
+            js->pos++;
+            continue;
+        }
+
+        if (*js->pos != '"' || !read_string(js, js->key))
+            return FALSE;
+        skip_space(js);
+        if (js->pos >= js->end || *js->pos != ':')
+            return FALSE;
+        js->pos++;
+        skip_space(js);
+
+        switch (read_value(js))
+        {
+        case JSON_BAD:
+            return FALSE;
+        case JSON_VALUE:
+            if (parser->member != NULL)
+                parser->member(js->key->str, js->value->str, data);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+/*
+ * Read a JSON array of objects, or a single object.
+ *
+ * The callbacks are called in the order of the text. The values are passed
+ * as they are written, without the quotes of strings, so numbers have to be
+ * converted by the caller; null values are left out.
+ *
+ * @param text The JSON text, which need not be terminated.
+ * @param len Length of text.
+ * @param parser The callbacks.
+ * @param data User data for the callbacks.
+ * @return FALSE if the text is malformed, in which case the objects up to
+ *         the error have been reported.
+ */
+gboolean json_stream_parse(const gchar *text, gsize len,
+                           const json_stream_parser_t *parser,
+                           gpointer data)
+{
+    json_stream_t js;
+    gboolean ok = TRUE;
+
+    js.pos = text;
+    js.end = text + len;
+    js.key = g_string_new(NULL);
+    js.value = g_string_new(NULL);
+
+    /* a byte order mark is not part of the text */
+    if (len >= 3 && !memcmp(text, "\xEF\xBB\xBF", 3))
+        js.pos += 3;
+
+    for (skip_space(&js); ok && js.pos < js.end; skip_space(&js))
+    {
+        switch (*js.pos)
+        {
+        case '[':
+        case ',':
+        case ']':
+            js.pos++;
+            break;
+        case '{':
+            ok = read_object(&js, parser, data);
+            break;
+        default:
+            ok = FALSE;
+            break;
+        }
+    }
+
+    g_string_free(js.key, TRUE);
+    g_string_free(js.value, TRUE);
+
+    return ok;
+}
@@ -0,0 +1,36 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H 1
+
+#include <glib.h>
+
+/* Callbacks of json_stream_parse(); either can be NULL */
+typedef struct {
+    /* A member of an object whose value is a string, number or boolean */
+    void (*member)(const gchar *key, const gchar *value, gpointer data);
+    /* The end of an object */
+    void (*end_object)(gpointer data);
+} json_stream_parser_t;
+
+gboolean json_stream_parse(const gchar *text, gsize len,
+                           const json_stream_parser_t *parser,
+                           gpointer data);
+
+#endif
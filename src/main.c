@@ -33,10 +33,16 @@
 #include "gtk-sat-selector.h"
 #include "gui.h"
 #include "first-time.h"
+#ifdef ENABLE_HAMLIB_SIM
+#include "hamlib-sim.h"
+#endif
+#include "map-tools.h"
 #include "tle-update.h"
 #include "mod-mgr.h"
+#include "sat-catalogue.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "trsp-store.h"
 
 
 /* Main application widget. */
@@ -48,17 +54,39 @@ static gboolean cleantle = FALSE;
 /* Command line flag for cleaning TRSP data */
 static gboolean cleantrsp = FALSE;
 
+/* Directory to export the satellite catalogue to */
+static gchar   *exportdir = NULL;
+
 /* Start application in fullscreen mode */
 static gboolean fullscreen = FALSE;
 
+#ifdef ENABLE_HAMLIB_SIM
+/* Specifications of the simulated rigctld and rotctld; see hamlib-sim.h */
+static gchar   *rigsim = NULL;
+static gchar   *rotsim = NULL;
+#endif
+
 /* Command line options. */
 static GOptionEntry entries[] = {
     {"clean-tle", 0, 0, G_OPTION_ARG_NONE, &cleantle,
      "Clean the TLE data in user's configuration directory", NULL},
     {"clean-trsp", 0, 0, G_OPTION_ARG_NONE, &cleantrsp,
      "Clean the transponder data in user's configuration directory", NULL},
+    {"export-satdata", 0, 0, G_OPTION_ARG_FILENAME, &exportdir,
+     "Write the satellite catalogue as .sat files to DIR and exit", "DIR"},
     {"fullscreen", 0, 0, G_OPTION_ARG_NONE, &fullscreen,
      "Start gpredict in fullscreen mode.", NULL},
+#ifdef ENABLE_HAMLIB_SIM
+    {"rigctld-sim", 0, 0, G_OPTION_ARG_STRING, &rigsim,
+     "Run a simulated rigctld on the loopback interface. The keys are "
+     "latency, jitter (ms), fail, drop (probability) and step (Hz).",
+     "PORT[,key=value...]"},
+    {"rotctld-sim", 0, 0, G_OPTION_ARG_STRING, &rotsim,
+     "Run a simulated rotctld on the loopback interface. The keys are "
+     "latency, jitter (ms), fail, drop (probability), rate (deg/s) and "
+     "speed (time scale).",
+     "PORT[,key=value...]"},
+#endif
     {NULL}
 };
 
@@ -87,6 +115,9 @@ static gpointer update_tle_thread(gpointer data);
 static gboolean reload_sats_idle_cb(gpointer data);
 static void     clean_tle(void);
 static void     clean_trsp(void);
+#ifdef ENABLE_HAMLIB_SIM
+static hamlib_sim_t *start_sim(hamlib_sim_type_t type, const gchar * spec);
+#endif
 
 #ifdef G_OS_WIN32
 static void     InitWinSock2(void);
@@ -99,6 +130,10 @@ int main(int argc, char *argv[])
     GError         *err = NULL;
     GOptionContext *context;
     guint           error = 0;
+    int             status = 0;
+#ifdef ENABLE_HAMLIB_SIM
+    hamlib_sim_t   *rigctld, *rotctld;
+#endif
 
 
 #ifdef ENABLE_NLS
@@ -148,7 +183,14 @@ int main(int argc, char *argv[])
                       ".config/Gpredict data dir in your home directory"),
                      error);
 
-        return 1;
+        status = 1;
+        goto done;
+    }
+
+    if (exportdir != NULL)
+    {
+        status = sat_catalogue_export(exportdir) < 0 ? 1 : 0;
+        goto done;
     }
 
     /* create application */
@@ -167,19 +209,31 @@ int main(int argc, char *argv[])
     InitWinSock2();
 #endif
 
-    gtk_main();
+#ifdef ENABLE_HAMLIB_SIM
+    rigctld = start_sim(HAMLIB_SIM_RIGCTLD, rigsim);
+    rotctld = start_sim(HAMLIB_SIM_ROTCTLD, rotsim);
+#endif
 
-    g_option_context_free(context);
+    gtk_main();
 
+#ifdef ENABLE_HAMLIB_SIM
+    hamlib_sim_stop(rigctld);
+    hamlib_sim_stop(rotctld);
+#endif
+    map_tools_mip_cache_clear();
     sat_cfg_save();
-    sat_log_close();
-    sat_cfg_close();
 
 #ifdef WIN32
     CloseWinSock2();
 #endif
 
-    return 0;
+    /* the log queues messages; close it on every way out to write them */
+  done:
+    g_option_context_free(context);
+    sat_log_close();
+    sat_cfg_close();
+
+    return status;
 }
 
 #ifdef WIN32
@@ -592,7 +646,8 @@ static          gpointer update_tle_thread(gpointer data)
 /*
  * Clean TLE data.
  *
- * This function removes all .sat files from the user's configuration directory.
+ * This function removes all .sat files and the satellite catalogue from the
+ * user's configuration directory.
  * The function is called when gpreidict is executed with the --clean-tle
  * command line option.
  */
@@ -629,7 +684,18 @@ static void clean_tle(void)
             g_free(path);
         }
     }
+    g_dir_close(targetdir);
     g_free(targetdirname);
+
+    /* rebuilt from the fresh .sat files by the first time check */
+    path = sat_catalogue_file_name();
+    if (g_file_test(path, G_FILE_TEST_EXISTS) && g_unlink(path))
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to delete %s"), __func__, path);
+    g_free(path);
+
+    /* make the next update fetch everything again */
+    tle_update_forget_sources();
 }
 
 /*
@@ -674,4 +740,20 @@ static void clean_trsp(void)
         }
     }
     g_free(targetdirname);
+
+    /* the store holds the imported transponders of all satellites */
+    trsp_store_forget();
 }
+
+#ifdef ENABLE_HAMLIB_SIM
+/* Start a simulated rigctld or rotctld if one was requested */
+static hamlib_sim_t *start_sim(hamlib_sim_type_t type, const gchar * spec)
+{
+    hamlib_sim_conf_t conf;
+
+    if (spec == NULL || !hamlib_sim_parse(spec, &conf))
+        return NULL;
+
+    return hamlib_sim_start(type, &conf);
+}
+#endif
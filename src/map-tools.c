@@ -25,85 +25,254 @@
   You should have received a copy of the GNU General Public License
   along with this program; if not, visit http://www.fsf.org/
 */
-#include <math.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <glib/gstdio.h>
+#include <string.h>
 #ifdef HAVE_CONFIG_H
 #  include <build-config.h>
 #endif
 
+#include "map-tools.h"
 
-/*! \brief Rotate map to be centered around a specific longitude.
- *  \param in Input map centered around 0 degrees longitude.
- *  \param out Output map that will be centered around clon. Must have the same
- *             dimension and color space as the input map.
- *  \param clon The longitude that should be at center between -180 and 180 degrees (East positive).
- * 
- * This function will rotate the input map to be centered around the specified longitude.
- * The output map must be pre-allocated and have the sae width, height and colorspace as the input
- * map. The longitude parameter must be between -180 and 180 degrees with negative values meaning
- * West of Greenwich,positive values meaning East of Greenwich.
+
+/*! \brief Multi-resolution map cache.
+ *
+ * Level 0 is the map as loaded from disk, each following level is half the
+ * size of the previous one. The levels are generated once in a background
+ * thread; until they are ready the nearest available level is used.
  */
-void map_tools_shift_center(GdkPixbuf *in, GdkPixbuf *out, float clon)
+struct _map_mip {
+    gchar      *fname;      /*!< File name or NULL if not cached. */
+    gint64      mtime;      /*!< Modification time of the file. */
+    gint64      size;       /*!< Size of the file. */
+    gint        refcount;   /*!< Users, the cache and the worker thread. */
+    GMutex      lock;       /*!< Protects levels and nlevels. */
+    GdkPixbuf  *levels[MAP_MIP_MAX_LEVELS];     /*!< The mip levels. */
+    guint       nlevels;    /*!< Number of levels generated so far. */
+    gint        building;   /*!< Set while the worker thread runs. */
+    gint        cancel;     /*!< Set to stop the worker thread. */
+};
+
+/*
+ * Maps loaded so far, keyed by file name. The cache holds a reference to
+ * each, so that the levels survive a module being reconfigured; it is only
+ * dropped when the file changes or by map_tools_mip_cache_clear().
+ */
+static GHashTable *mip_cache = NULL;
+
+
+static void mip_free(map_mip_t *mip)
 {
-    if (clon > 180.0)
-        clon = 180.0;
-    else if (clon < -180.0)
-        clon = -180.0;
-
-    int lon_x = round((clon+180.0) * gdk_pixbuf_get_width(in)/360.0);
-    int img_w = gdk_pixbuf_get_width(in);
-    int img_h = gdk_pixbuf_get_height(in);
-    
-    if (clon < 0.0) {
-        /* copy left side to right */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             lon_x + img_w/2,
-                             img_h,
-                             out,
-                             img_w - (lon_x + img_w/2),
-                             0);
-        /* copy right side to left */
-        gdk_pixbuf_copy_area(in,
-                             lon_x + img_w/2,
-                             0,
-                             img_w - (lon_x + img_w/2),
-                             img_h,
-                             out,
-                             0,
-                             0);
+    guint       i;
+
+    for (i = 0; i < mip->nlevels; i++)
+        g_object_unref(mip->levels[i]);
+
+    g_mutex_clear(&mip->lock);
+    g_free(mip->fname);
+    g_free(mip);
+}
+
+/*! \brief Generate the pre-scaled levels of a map.
+ *
+ * Each level is scaled down from the previous one, so the total work is
+ * only about one third of scaling the full-size map once. The thread holds
+ * a reference of its own, which it drops when it is done, so nobody has to
+ * wait for it.
+ */
+static gpointer mip_build_levels(gpointer data)
+{
+    map_mip_t  *mip = (map_mip_t *) data;
+    GdkPixbuf  *prev = mip->levels[0];
+    GdkPixbuf  *next;
+    gint        w = gdk_pixbuf_get_width(prev);
+    gint        h = gdk_pixbuf_get_height(prev);
+    guint       i;
+
+    for (i = 1; i < MAP_MIP_MAX_LEVELS; i++)
+    {
+        w /= 2;
+        h /= 2;
+        if (w < MAP_MIP_MIN_WIDTH || h < 1 || g_atomic_int_get(&mip->cancel))
+            break;
+
+        next = gdk_pixbuf_scale_simple(prev, w, h, GDK_INTERP_BILINEAR);
+        if (next == NULL)
+            break;
+
+        g_mutex_lock(&mip->lock);
+        mip->levels[i] = next;
+        mip->nlevels = i + 1;
+        g_mutex_unlock(&mip->lock);
+
+        prev = next;
     }
-    else if (clon > 0.0) {
-        /* copy left side to right */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             lon_x - img_w/2,
-                             img_h,
-                             out,
-                             img_w - (lon_x - img_w/2),
-                             0);
-        /* copy right side to left */
-        gdk_pixbuf_copy_area(in,
-                             lon_x - img_w/2,
-                             0,
-                             img_w - (lon_x - img_w/2),
-                             img_h,
-                             out,
-                             0,
-                             0);
+
+    g_atomic_int_set(&mip->building, 0);
+    map_tools_mip_unref(mip);
+
+    return NULL;
+}
+
+/*! \brief Create a new map cache from a pixbuf.
+ *  \param pixbuf The full size map. The cache takes its own reference.
+ *  \return A new cache with a reference count of one.
+ *
+ * The pre-scaled levels are generated in the background. The returned cache
+ * is not shared with other users; use map_tools_mip_ref_file() for that.
+ */
+map_mip_t *map_tools_mip_new(GdkPixbuf *pixbuf)
+{
+    map_mip_t  *mip = g_new0(map_mip_t, 1);
+
+    g_mutex_init(&mip->lock);
+    mip->refcount = 2;          /* the caller and the worker thread */
+    mip->levels[0] = g_object_ref(pixbuf);
+    mip->nlevels = 1;
+    mip->building = 1;
+    g_thread_unref(g_thread_new("map-mip", mip_build_levels, mip));
+
+    return mip;
+}
+
+/* Drop the reference of the cache to a map */
+static void mip_cache_remove(gpointer data)
+{
+    map_tools_mip_unref((map_mip_t *) data);
+}
+
+/*! \brief Get a shared map cache for a map file.
+ *  \param fname The full path to the map file.
+ *  \param error Location to store loading errors or NULL.
+ *  \return The cache for the file or NULL if the file could not be loaded.
+ *
+ * Maps are loaded from disk only once, unless the file changes; further
+ * users of the same file share the cache and its pre-scaled levels. Release
+ * with map_tools_mip_unref().
+ */
+map_mip_t *map_tools_mip_ref_file(const gchar *fname, GError **error)
+{
+    map_mip_t  *mip;
+    GdkPixbuf  *pixbuf;
+    GStatBuf    st;
+
+    if (mip_cache == NULL)
+        mip_cache = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                          mip_cache_remove);
+
+    if (g_stat(fname, &st) != 0)
+        memset(&st, 0, sizeof(st));
+
+    mip = g_hash_table_lookup(mip_cache, fname);
+    if (mip != NULL)
+    {
+        if (mip->mtime == (gint64) st.st_mtime &&
+            mip->size == (gint64) st.st_size)
+            return map_tools_mip_ref(mip);
+
+        /* the file has changed; users of the old map keep theirs */
+        g_hash_table_remove(mip_cache, fname);
     }
-    else {
-        /* no shifting of center */
-        gdk_pixbuf_copy_area(in,
-                             0,
-                             0,
-                             img_w,
-                             img_h,
-                             out,
-                             0,
-                             0);
-    }   
+
+    pixbuf = gdk_pixbuf_new_from_file(fname, error);
+    if (pixbuf == NULL)
+        return NULL;
+
+    mip = map_tools_mip_new(pixbuf);
+    g_object_unref(pixbuf);
+
+    mip->fname = g_strdup(fname);
+    mip->mtime = st.st_mtime;
+    mip->size = st.st_size;
+    g_hash_table_insert(mip_cache, mip->fname, map_tools_mip_ref(mip));
+
+    return mip;
+}
+
+/*! \brief Forget the cached maps, e.g. at shutdown.
+ *
+ * Maps still in use remain valid until their users release them.
+ */
+void map_tools_mip_cache_clear(void)
+{
+    if (mip_cache == NULL)
+        return;
+
+    g_hash_table_destroy(mip_cache);
+    mip_cache = NULL;
+}
+
+/*! \brief Take another reference to a map cache. */
+map_mip_t *map_tools_mip_ref(map_mip_t *mip)
+{
+    g_atomic_int_inc(&mip->refcount);
+
+    return mip;
+}
+
+/*! \brief Release a reference to a map cache.
+ *
+ * When only the worker thread is left it is told to stop; the cache is
+ * freed by whoever drops the last reference.
+ */
+void map_tools_mip_unref(map_mip_t *mip)
+{
+    gint        left;
+
+    if (mip == NULL)
+        return;
+
+    left = g_atomic_int_add(&mip->refcount, -1) - 1;
+    if (left == 0)
+        mip_free(mip);
+    else if (left == g_atomic_int_get(&mip->building))
+        g_atomic_int_set(&mip->cancel, 1);
+}
+
+/*! \brief Get the width of the full size map. */
+gint map_tools_mip_get_width(map_mip_t *mip)
+{
+    return gdk_pixbuf_get_width(mip->levels[0]);
+}
+
+/*! \brief Get the height of the full size map. */
+gint map_tools_mip_get_height(map_mip_t *mip)
+{
+    return gdk_pixbuf_get_height(mip->levels[0]);
 }
 
+/*! \brief Scale a cached map to a given size.
+ *  \param mip The map cache.
+ *  \param width The requested width.
+ *  \param height The requested height.
+ *  \return A newly allocated pixbuf of the requested size.
+ *
+ * The map is scaled from the smallest pre-scaled level that is at least as
+ * large as the requested size, which keeps the quality of scaling from the
+ * full size map while touching far fewer pixels.
+ */
+GdkPixbuf *map_tools_mip_scale(map_mip_t *mip, gint width, gint height)
+{
+    GdkPixbuf  *src;
+    GdkPixbuf  *dst;
+    guint       i;
+
+    g_mutex_lock(&mip->lock);
+    for (i = mip->nlevels - 1; i > 0; i--)
+    {
+        if (gdk_pixbuf_get_width(mip->levels[i]) >= width &&
+            gdk_pixbuf_get_height(mip->levels[i]) >= height)
+            break;
+    }
+    src = g_object_ref(mip->levels[i]);
+    g_mutex_unlock(&mip->lock);
+
+    if (gdk_pixbuf_get_width(src) == width &&
+        gdk_pixbuf_get_height(src) == height)
+        return src;
+
+    dst = gdk_pixbuf_scale_simple(src, width, height, GDK_INTERP_BILINEAR);
+    g_object_unref(src);
+
+    return dst;
+}
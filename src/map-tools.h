@@ -25,10 +25,31 @@
   You should have received a copy of the GNU General Public License
   along with this program; if not, visit http://www.fsf.org/
 */
+#ifndef MAP_TOOLS_H
+#define MAP_TOOLS_H 1
+
+#include <glib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #ifdef HAVE_CONFIG_H
 #  include <build-config.h>
 #endif
 
+/** Maximum number of levels in a map mip chain, including the original. */
+#define MAP_MIP_MAX_LEVELS  8
+
+/** Smallest width of a pre-scaled map level. */
+#define MAP_MIP_MIN_WIDTH   256
+
+/** Multi-resolution cache of a background map (opaque). */
+typedef struct _map_mip map_mip_t;
 
-void map_tools_shift_center(GdkPixbuf *in, GdkPixbuf *out, float clon);
+map_mip_t *map_tools_mip_ref_file(const gchar *fname, GError **error);
+map_mip_t *map_tools_mip_new(GdkPixbuf *pixbuf);
+map_mip_t *map_tools_mip_ref(map_mip_t *mip);
+void       map_tools_mip_unref(map_mip_t *mip);
+void       map_tools_mip_cache_clear(void);
+gint       map_tools_mip_get_width(map_mip_t *mip);
+gint       map_tools_mip_get_height(map_mip_t *mip);
+GdkPixbuf *map_tools_mip_scale(map_mip_t *mip, gint width, gint height);
+
+#endif
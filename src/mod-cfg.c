@@ -86,14 +86,15 @@ static gboolean overwrite_existing_module(void)
 
 
 /* Add a satellite to the list of selected satellites */
-static void add_selected_sat(GtkListStore * store, gint catnum)
+static void add_selected_sat(GtkListStore * store, sat_index_t * index,
+                             gint catnum)
 {
     gint            i, sats = 0;
     GtkTreeIter     iter;
     GtkTreeIter     node;       /* new top level node added to the tree store */
     gint            catnr;
     gboolean        found = FALSE;
-    sat_t           sat;
+    const sat_index_sat_t *sat;
 
     /* check if the satellite is already in the list */
 
@@ -128,7 +129,8 @@ static void add_selected_sat(GtkListStore * store, gint catnum)
     /* if we have made it so far, satellite is not in list */
 
     /* Get satellite data */
-    if (gtk_sat_data_read_sat(catnum, &sat))
+    sat = sat_index_lookup(index, catnum);
+    if (sat == NULL)
     {
         /* error */
         sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -140,11 +142,9 @@ static void add_selected_sat(GtkListStore * store, gint catnum)
         /* insert satellite into liststore */
         gtk_list_store_append(store, &node);
         gtk_list_store_set(store, &node,
-                           GTK_SAT_SELECTOR_COL_NAME, sat.nickname,
+                           GTK_SAT_SELECTOR_COL_NAME, sat->nickname,
                            GTK_SAT_SELECTOR_COL_CATNUM, catnum,
-                           GTK_SAT_SELECTOR_COL_EPOCH, sat.jul_epoch, -1);
-        g_free(sat.name);
-        g_free(sat.nickname);
+                           GTK_SAT_SELECTOR_COL_EPOCH, sat->epoch, -1);
     }
 }
 
@@ -166,7 +166,7 @@ static void addbut_clicked_cb(GtkButton * button, GtkSatSelector * selector)
         /* Add satellite to selected list */
         store =
             GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(satlist)));
-        add_selected_sat(store, catnum);
+        add_selected_sat(store, selector->index, catnum);
         /*tell the sat_selector to hide that satellite */
         gtk_sat_selector_mark_selected(selector, catnum);
     }
@@ -206,7 +206,7 @@ static void sat_activated_cb(GtkSatSelector * selector, gint catnr,
 
     /* Add satellite to selected list */
     store = GTK_LIST_STORE(gtk_tree_view_get_model(GTK_TREE_VIEW(satlist)));
-    add_selected_sat(store, catnr);
+    add_selected_sat(store, selector->index, catnr);
     /*tell the sat_selector it can hide that satellite */
     gtk_sat_selector_mark_selected(selector, catnr);
 }
@@ -586,7 +586,7 @@ static GtkWidget *create_selected_sats_list(GKeyFile * cfgdata, gboolean new,
         {
             for (i = 0; i < length; i++)
             {
-                add_selected_sat(store, sats[i]);
+                add_selected_sat(store, selector->index, sats[i]);
                 gtk_sat_selector_mark_selected(selector, sats[i]);
             }
             g_free(sats);
@@ -63,6 +63,7 @@
 #include "mod-mgr.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
+#include "sat-registry.h"
 
 extern GtkWidget *app;
 
@@ -581,6 +582,9 @@ void mod_mgr_reload_sats()
         return;
     }
 
+    /* the satellite data has changed; read it again */
+    sat_registry_invalidate();
+
     num = g_slist_length(modules);
     if (num == 0)
     {
@@ -589,11 +593,11 @@ void mod_mgr_reload_sats()
         return;
     }
 
-    /* for each module in the GSList execute sat_module_reload_sats() */
+    /* for each module in the GSList take in the new elements */
     for (i = 0; i < num; i++)
     {
         mod = GTK_SAT_MODULE(g_slist_nth_data(modules, i));
-        gtk_sat_module_reload_sats(mod);
+        gtk_sat_module_update_sats(mod);
     }
 }
 
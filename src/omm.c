@@ -0,0 +1,670 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Reader of CCSDS Orbit Mean-Elements Messages (OMM).
+ *
+ * The catalogue providers publish the mean elements of the satellites as OMM
+ * in CSV, JSON, KVN and XML, besides TLE. Unlike TLE, an OMM is not limited
+ * to five digit catalogue numbers. Each format is read in one pass over the
+ * data, and the fields of each record are stored straight into the columns
+ * of a cache, from which the elements are taken without going through TLE
+ * lines. Only the fields gpredict uses are kept.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json-stream.h"
+#include "omm.h"
+#include "sat-log.h"
+
+/* Fields that are not columns */
+#define FIELD_NONE   -1
+#define FIELD_EPOCH  (OMM_COL_NUM + 0)
+#define FIELD_NAME   (OMM_COL_NUM + 1)
+#define FIELD_ID     (OMM_COL_NUM + 2)
+
+/* Columns without which a record is of no use */
+#define REQUIRED_COLS ((1 << OMM_COL_CATNR) |                     \
+                       (1 << OMM_COL_EPOCH_YEAR) |                \
+                       (1 << OMM_COL_EPOCH_DAY) |                 \
+                       (1 << OMM_COL_MEAN_MOTION) |               \
+                       (1 << OMM_COL_ECCENTRICITY) |              \
+                       (1 << OMM_COL_INCLINATION) |               \
+                       (1 << OMM_COL_RA_OF_ASC_NODE) |            \
+                       (1 << OMM_COL_ARG_OF_PERICENTER) |         \
+                       (1 << OMM_COL_MEAN_ANOMALY))
+
+/* The OMM keywords that are read */
+static const struct {
+    const gchar *key;
+    gint field;
+} omm_fields[] = {
+    {"NORAD_CAT_ID", OMM_COL_CATNR},
+    {"EPOCH", FIELD_EPOCH},
+    {"MEAN_MOTION", OMM_COL_MEAN_MOTION},
+    {"ECCENTRICITY", OMM_COL_ECCENTRICITY},
+    {"INCLINATION", OMM_COL_INCLINATION},
+    {"RA_OF_ASC_NODE", OMM_COL_RA_OF_ASC_NODE},
+    {"ARG_OF_PERICENTER", OMM_COL_ARG_OF_PERICENTER},
+    {"MEAN_ANOMALY", OMM_COL_MEAN_ANOMALY},
+    {"BSTAR", OMM_COL_BSTAR},
+    {"MEAN_MOTION_DOT", OMM_COL_MEAN_MOTION_DOT},
+    {"MEAN_MOTION_DDOT", OMM_COL_MEAN_MOTION_DDOT},
+    {"ELEMENT_SET_NO", OMM_COL_ELEMENT_SET_NO},
+    {"REV_AT_EPOCH", OMM_COL_REV_AT_EPOCH},
+    {"OBJECT_NAME", FIELD_NAME},
+    {"OBJECT_ID", FIELD_ID},
+};
+
+/* A record being read */
+typedef struct {
+    gdouble vals[OMM_COL_NUM];
+    guint32 set;          /* Bit per column that has a value */
+    const gchar *name;
+    const gchar *id;
+} omm_rec_t;
+
+/* State of a read; see omm_read() */
+typedef struct {
+    omm_cache_t *cache;
+    const gchar *source;
+    omm_rec_t rec;
+    guint added;
+    guint skipped;
+    GString *text;        /* Value being read */
+    gint field;           /* Field of the XML element being read */
+} omm_reader_t;
+
+/* Look up a keyword; returns FIELD_NONE if it is not used */
+static gint find_field(const gchar *key, gsize len)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS(omm_fields); i++)
+    {
+        if (strlen(omm_fields[i].key) == len &&
+            !g_ascii_strncasecmp(omm_fields[i].key, key, len))
+            return omm_fields[i].field;
+    }
+
+    return FIELD_NONE;
+}
+
+
+/* Skip white space and a UTF-8 byte order mark */
+static const gchar *skip_lead(const gchar *pos, const gchar *end)
+{
+    if (end - pos >= 3 && !memcmp(pos, "\xEF\xBB\xBF", 3))
+        pos += 3;
+    while (pos < end && g_ascii_isspace(*pos))
+        pos++;
+
+    return pos;
+}
+
+/* Remove the white space around the text between start and stop */
+static void trim(const gchar **start, const gchar **stop)
+{
+    while (*start < *stop && g_ascii_isspace(**start))
+        (*start)++;
+    while (*stop > *start && g_ascii_isspace((*stop)[-1]))
+        (*stop)--;
+}
+
+/*
+ * Parse an epoch.
+ *
+ * The date is either YYYY-MM-DD or YYYY-DDD and can be followed by the time
+ * of day as Thh:mm:ss, with any number of decimals. The year is limited to
+ * the range of the two digit years of a TLE epoch.
+ */
+static gboolean parse_epoch(const gchar *text, gdouble *year, gdouble *day)
+{
+    GDate date;
+    guint y, a, b, doy, hh = 0, mm = 0;
+    gdouble ss = 0.0;
+    const gchar *time;
+    gint n = 0;
+
+    switch (sscanf(text, "%4u-%u-%u", &y, &a, &b))
+    {
+    case 3:
+        if (a > 12 || b > 31 || !g_date_valid_dmy(b, a, y))
+            return FALSE;
+        g_date_clear(&date, 1);
+        g_date_set_dmy(&date, b, a, y);
+        doy = g_date_get_day_of_year(&date);
+        break;
+    case 2:
+        if (a < 1 || a > (g_date_is_leap_year(y) ? 366u : 365u))
+            return FALSE;
+        doy = a;
+        break;
+    default:
+        return FALSE;
+    }
+
+    if (y < 1957 || y > 2056)
+        return FALSE;
+
+    time = strchr(text, 'T');
+    if (time != NULL)
+    {
+        if (sscanf(time + 1, "%2u:%2u:%n", &hh, &mm, &n) != 2 || n == 0 ||
+            hh > 23 || mm > 59)
+            return FALSE;
+        ss = g_ascii_strtod(time + 1 + n, NULL);
+        if (ss < 0.0 || ss >= 61.0)
+            return FALSE;
+    }
+
+    *year = y;
+    *day = doy + (hh * 3600.0 + mm * 60.0 + ss) / 86400.0;
+
+    return TRUE;
+}
+
+/* Set a field of the record being read from its text */
+static void set_value(omm_reader_t *reader, gint field, const gchar *value)
+{
+    omm_rec_t *rec = &reader->rec;
+    gdouble val;
+    gchar *end;
+
+    switch (field)
+    {
+    case FIELD_NONE:
+        return;
+
+    case FIELD_NAME:
+        rec->name = g_string_chunk_insert(reader->cache->strings, value);
+        return;
+
+    case FIELD_ID:
+        rec->id = g_string_chunk_insert(reader->cache->strings, value);
+        return;
+
+    case FIELD_EPOCH:
+        if (parse_epoch(value, &rec->vals[OMM_COL_EPOCH_YEAR],
+                        &rec->vals[OMM_COL_EPOCH_DAY]))
+            rec->set |= (1 << OMM_COL_EPOCH_YEAR) | (1 << OMM_COL_EPOCH_DAY);
+        return;
+
+    default:
+        break;
+    }
+
+    val = g_ascii_strtod(value, &end);
+    while (g_ascii_isspace(*end))
+        end++;
+    if (end == value || *end != '\0')
+        return;
+
+    rec->vals[field] = val;
+    rec->set |= 1 << field;
+}
+
+/* Store the record being read in the cache if it is complete */
+static void end_record(omm_reader_t *reader)
+{
+    omm_cache_t *cache = reader->cache;
+    omm_rec_t *rec = &reader->rec;
+    gdouble catnr = rec->vals[OMM_COL_CATNR];
+    guint i;
+
+    if (rec->set == 0 && rec->name == NULL && rec->id == NULL)
+        return;
+
+    if ((rec->set & REQUIRED_COLS) != REQUIRED_COLS || catnr < 1.0 ||
+        catnr > G_MAXINT32 || catnr != (gint)catnr)
+    {
+        sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                    _("%s: Incomplete element set %s in %s"), __func__,
+                    rec->name ? rec->name : "", reader->source);
+        reader->skipped++;
+    }
+    else
+    {
+        for (i = 0; i < OMM_COL_NUM; i++)
+            g_array_append_val(cache->cols[i], rec->vals[i]);
+        g_ptr_array_add(cache->names, (gpointer)rec->name);
+        g_ptr_array_add(cache->ids, (gpointer)rec->id);
+        cache->len++;
+        reader->added++;
+    }
+
+    memset(rec, 0, sizeof(*rec));
+}
+
+/*
+ * Get the next field of a CSV line.
+ *
+ * @return Where the field after it starts, or NULL if it is the last one.
+ */
+static const gchar *next_csv_field(const gchar *pos, const gchar *eol,
+                                   GString *field)
+{
+    const gchar *stop, *start;
+
+    g_string_truncate(field, 0);
+
+    if (pos < eol && *pos == '"')
+    {
+        /* a quote within quotes is doubled */
+        for (pos++; pos < eol; pos++)
+        {
+            if (*pos == '"' && (++pos >= eol || *pos != '"'))
+                break;
+            g_string_append_c(field, *pos);
+        }
+        stop = memchr(pos, ',', eol - pos);
+    }
+    else
+    {
+        stop = memchr(pos, ',', eol - pos);
+        start = pos;
+        pos = stop ? stop : eol;
+        trim(&start, &pos);
+        g_string_append_len(field, start, pos - start);
+    }
+
+    return stop ? stop + 1 : NULL;
+}
+
+/* CSV has a header line with the keywords and a line per record */
+static void read_csv(omm_reader_t *reader, const gchar *pos, const gchar *end)
+{
+    GArray *fields;
+    const gchar *eol, *next, *fpos;
+    gboolean header = TRUE;
+    gint field;
+    guint col;
+
+    fields = g_array_new(FALSE, FALSE, sizeof(gint));
+
+    for (; pos < end; pos = next)
+    {
+        eol = memchr(pos, '\n', end - pos);
+        next = eol ? eol + 1 : end;
+        if (eol == NULL)
+            eol = end;
+        if (eol > pos && eol[-1] == '\r')
+            eol--;
+        if (eol == pos)
+            continue;
+
+        for (fpos = pos, col = 0; fpos != NULL; col++)
+        {
+            fpos = next_csv_field(fpos, eol, reader->text);
+            if (header)
+            {
+                field = find_field(reader->text->str, reader->text->len);
+                g_array_append_val(fields, field);
+            }
+            else if (col < fields->len)
+            {
+                set_value(reader, g_array_index(fields, gint, col),
+                          reader->text->str);
+            }
+        }
+
+        if (!header)
+            end_record(reader);
+        header = FALSE;
+    }
+
+    g_array_unref(fields);
+}
+
+static void json_member(const gchar *key, const gchar *value, gpointer data)
+{
+    omm_reader_t *reader = data;
+
+    set_value(reader, find_field(key, strlen(key)), value);
+}
+
+static void json_end_object(gpointer data)
+{
+    end_record(data);
+}
+
+/* JSON is an array of flat objects, one per record */
+static void read_json(omm_reader_t *reader, const gchar *pos, const gchar *end)
+{
+    static const json_stream_parser_t parser = {
+        json_member, json_end_object
+    };
+
+    if (!json_stream_parse(pos, end - pos, &parser, reader))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Malformed JSON in %s"),
+                    __func__, reader->source);
+        memset(&reader->rec, 0, sizeof(reader->rec));
+    }
+}
+
+/*
+ * KVN has a KEY = value line per field, where the value may be followed by
+ * its unit in brackets. Each record starts with CCSDS_OMM_VERS.
+ */
+static void read_kvn(omm_reader_t *reader, const gchar *pos, const gchar *end)
+{
+    const gchar *eol, *next, *eq, *key, *kend, *val, *vend, *unit;
+
+    for (; pos < end; pos = next)
+    {
+        eol = memchr(pos, '\n', end - pos);
+        next = eol ? eol + 1 : end;
+        if (eol == NULL)
+            eol = end;
+
+        /* comments and blank lines have no keyword */
+        eq = memchr(pos, '=', eol - pos);
+        if (eq == NULL)
+            continue;
+
+        key = pos;
+        kend = eq;
+        trim(&key, &kend);
+        val = eq + 1;
+        unit = memchr(val, '[', eol - val);
+        vend = unit ? unit : eol;
+        trim(&val, &vend);
+
+        if (kend - key == 14 && !strncmp(key, "CCSDS_OMM_VERS", 14))
+        {
+            end_record(reader);
+            continue;
+        }
+
+        g_string_truncate(reader->text, 0);
+        g_string_append_len(reader->text, val, vend - val);
+        set_value(reader, find_field(key, kend - key), reader->text->str);
+    }
+
+    end_record(reader);
+}
+
+/* Element name without its namespace prefix */
+static const gchar *local_name(const gchar *name)
+{
+    const gchar *colon = strrchr(name, ':');
+
+    return colon ? colon + 1 : name;
+}
+
+static void xml_start(GMarkupParseContext *ctx, const gchar *element,
+                      const gchar **attr_names, const gchar **attr_values,
+                      gpointer data, GError **err)
+{
+    omm_reader_t *reader = data;
+
+    (void)ctx;
+    (void)attr_names;
+    (void)attr_values;
+    (void)err;
+
+    element = local_name(element);
+    if (!g_ascii_strcasecmp(element, "omm"))
+        memset(&reader->rec, 0, sizeof(reader->rec));
+
+    reader->field = find_field(element, strlen(element));
+    g_string_truncate(reader->text, 0);
+}
+
+static void xml_end(GMarkupParseContext *ctx, const gchar *element,
+                    gpointer data, GError **err)
+{
+    omm_reader_t *reader = data;
+
+    (void)ctx;
+    (void)err;
+
+    element = local_name(element);
+    if (!g_ascii_strcasecmp(element, "omm"))
+        end_record(reader);
+    else if (reader->field != FIELD_NONE)
+        set_value(reader, reader->field, g_strstrip(reader->text->str));
+
+    reader->field = FIELD_NONE;
+}
+
+static void xml_text(GMarkupParseContext *ctx, const gchar *text, gsize len,
+                     gpointer data, GError **err)
+{
+    omm_reader_t *reader = data;
+
+    (void)ctx;
+    (void)err;
+
+    if (reader->field != FIELD_NONE)
+        g_string_append_len(reader->text, text, len);
+}
+
+/* XML has an omm element per record, with an element per field */
+static void read_xml(omm_reader_t *reader, const gchar *pos, const gchar *end)
+{
+    static const GMarkupParser parser = {
+        xml_start, xml_end, xml_text, NULL, NULL
+    };
+    GMarkupParseContext *ctx;
+    GError *err = NULL;
+
+    ctx = g_markup_parse_context_new(&parser, 0, reader, NULL);
+    if (!g_markup_parse_context_parse(ctx, pos, end - pos, &err) ||
+        !g_markup_parse_context_end_parse(ctx, &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Malformed XML in %s (%s)"),
+                    __func__, reader->source, err->message);
+        g_clear_error(&err);
+    }
+    g_markup_parse_context_free(ctx);
+}
+
+/*
+ * Find out whether data is an OMM, and in which format.
+ *
+ * Only the start of the data is looked at, so that TLE files can be told
+ * apart without reading them twice.
+ */
+omm_format_t omm_detect(const gchar *data, gsize len)
+{
+    const gchar *end = data + len;
+    const gchar *eol;
+
+    data = skip_lead(data, end);
+    if (data >= end)
+        return OMM_FORMAT_NONE;
+
+    if (*data == '[' || *data == '{')
+        return OMM_FORMAT_JSON;
+    if (*data == '<')
+        return OMM_FORMAT_XML;
+    if (end - data >= 14 && !strncmp(data, "CCSDS_OMM_VERS", 14))
+        return OMM_FORMAT_KVN;
+
+    /* the header line of CSV */
+    eol = memchr(data, '\n', end - data);
+    if (g_strstr_len(data, (eol ? eol : end) - data, "NORAD_CAT_ID"))
+        return OMM_FORMAT_CSV;
+
+    return OMM_FORMAT_NONE;
+}
+
+omm_cache_t *omm_cache_new(void)
+{
+    omm_cache_t *cache = g_new0(omm_cache_t, 1);
+    guint i;
+
+    for (i = 0; i < OMM_COL_NUM; i++)
+        cache->cols[i] = g_array_new(FALSE, FALSE, sizeof(gdouble));
+    cache->names = g_ptr_array_new();
+    cache->ids = g_ptr_array_new();
+    cache->strings = g_string_chunk_new(4096);
+
+    return cache;
+}
+
+void omm_cache_free(omm_cache_t *cache)
+{
+    guint i;
+
+    if (cache == NULL)
+        return;
+
+    for (i = 0; i < OMM_COL_NUM; i++)
+        g_array_unref(cache->cols[i]);
+    g_ptr_array_unref(cache->names);
+    g_ptr_array_unref(cache->ids);
+    g_string_chunk_free(cache->strings);
+    g_free(cache);
+}
+
+/*
+ * Read OMM data into a cache.
+ *
+ * The format is found with omm_detect(). Records that lack any of the
+ * fields needed for the elements are skipped. Can be called from any thread
+ * as long as nobody else uses the cache.
+ *
+ * @param cache The cache to add the records to.
+ * @param data The OMM.
+ * @param len Length of data.
+ * @param source Where the data is from, for the log.
+ * @return The number of records added.
+ */
+guint omm_read(omm_cache_t *cache, const gchar *data, gsize len,
+               const gchar *source)
+{
+    omm_reader_t reader;
+    omm_format_t format;
+    const gchar *end = data + len;
+
+    memset(&reader, 0, sizeof(reader));
+    reader.cache = cache;
+    reader.source = source;
+    reader.field = FIELD_NONE;
+    reader.text = g_string_new(NULL);
+
+    format = omm_detect(data, len);
+    data = skip_lead(data, end);
+
+    switch (format)
+    {
+    case OMM_FORMAT_CSV:
+        read_csv(&reader, data, end);
+        break;
+    case OMM_FORMAT_JSON:
+        read_json(&reader, data, end);
+        break;
+    case OMM_FORMAT_KVN:
+        read_kvn(&reader, data, end);
+        break;
+    case OMM_FORMAT_XML:
+        read_xml(&reader, data, end);
+        break;
+    default:
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: %s is not an OMM"),
+                    __func__, source);
+        break;
+    }
+
+    if (reader.skipped > 0)
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Skipped %u incomplete element sets in %s"),
+                    __func__, reader.skipped, source);
+
+    g_string_free(reader.text, TRUE);
+
+    return reader.added;
+}
+
+gdouble omm_get(const omm_cache_t *cache, guint i, omm_col_t col)
+{
+    g_return_val_if_fail(i < cache->len, 0.0);
+
+    return g_array_index(cache->cols[col], gdouble, i);
+}
+
+/* The epoch of a record in TLE format, i.e. YYDDD.FFFFFFFF */
+gdouble omm_get_epoch(const omm_cache_t *cache, guint i)
+{
+    guint year = (guint)omm_get(cache, i, OMM_COL_EPOCH_YEAR);
+
+    return (year % 100) * 1000.0 + omm_get(cache, i, OMM_COL_EPOCH_DAY);
+}
+
+/*
+ * Get the elements of a record.
+ *
+ * The elements are the same as those Convert_Satellite_Data() would take
+ * from the TLE of the record. The status is unknown, since an OMM has no
+ * place for it.
+ */
+void omm_get_tle(const omm_cache_t *cache, guint i, tle_t *tle)
+{
+    const gchar *name = g_ptr_array_index(cache->names, i);
+    const gchar *id = g_ptr_array_index(cache->ids, i);
+    gdouble day = omm_get(cache, i, OMM_COL_EPOCH_DAY);
+
+    memset(tle, 0, sizeof(*tle));
+
+    tle->epoch = omm_get_epoch(cache, i);
+    tle->epoch_year = (guint)omm_get(cache, i, OMM_COL_EPOCH_YEAR);
+    tle->epoch_day = (guint)day;
+    tle->epoch_fod = day - tle->epoch_day;
+    tle->xndt2o = omm_get(cache, i, OMM_COL_MEAN_MOTION_DOT);
+    tle->xndd6o = omm_get(cache, i, OMM_COL_MEAN_MOTION_DDOT);
+    tle->bstar = omm_get(cache, i, OMM_COL_BSTAR);
+    tle->xincl = omm_get(cache, i, OMM_COL_INCLINATION);
+    tle->xnodeo = omm_get(cache, i, OMM_COL_RA_OF_ASC_NODE);
+    tle->eo = omm_get(cache, i, OMM_COL_ECCENTRICITY);
+    tle->omegao = omm_get(cache, i, OMM_COL_ARG_OF_PERICENTER);
+    tle->xmo = omm_get(cache, i, OMM_COL_MEAN_ANOMALY);
+    tle->xno = omm_get(cache, i, OMM_COL_MEAN_MOTION);
+    tle->catnr = (gint)omm_get(cache, i, OMM_COL_CATNR);
+    tle->elset = (gint)omm_get(cache, i, OMM_COL_ELEMENT_SET_NO);
+    tle->revnum = (gint)omm_get(cache, i, OMM_COL_REV_AT_EPOCH);
+    tle->status = OP_STAT_UNKNOWN;
+
+    /* avoid division by 0 */
+    if (tle->eo < 1.0e-6)
+        tle->eo = 1.0e-6;
+
+    /* 1998-067A is 98067A in a TLE */
+    if (id != NULL && strlen(id) > 5 && id[4] == '-')
+        g_snprintf(tle->idesg, sizeof(tle->idesg), "%.2s%s", id + 2, id + 5);
+    else if (id != NULL)
+        g_strlcpy(tle->idesg, id, sizeof(tle->idesg));
+
+    /* named like a bare TLE if there is no name */
+    if (name != NULL && *name != '\0')
+        g_strlcpy(tle->sat_name, name, sizeof(tle->sat_name));
+    else if (id != NULL && *id != '\0')
+        g_strlcpy(tle->sat_name, id, sizeof(tle->sat_name));
+    else
+        g_snprintf(tle->sat_name, sizeof(tle->sat_name), "%d", tle->catnr);
+    g_strdelimit(tle->sat_name, "&", '/');
+}
@@ -0,0 +1,79 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef OMM_H
+#define OMM_H 1
+
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+
+/* The numeric fields of an OMM record, one column each */
+typedef enum {
+    OMM_COL_CATNR = 0,    /* NORAD_CAT_ID */
+    OMM_COL_EPOCH_YEAR,   /* Year of EPOCH */
+    OMM_COL_EPOCH_DAY,    /* Day of the year of EPOCH, with the fraction */
+    OMM_COL_MEAN_MOTION,  /* rev/day */
+    OMM_COL_ECCENTRICITY,
+    OMM_COL_INCLINATION,  /* Degrees */
+    OMM_COL_RA_OF_ASC_NODE,
+    OMM_COL_ARG_OF_PERICENTER,
+    OMM_COL_MEAN_ANOMALY,
+    OMM_COL_BSTAR,
+    OMM_COL_MEAN_MOTION_DOT,
+    OMM_COL_MEAN_MOTION_DDOT,
+    OMM_COL_ELEMENT_SET_NO,
+    OMM_COL_REV_AT_EPOCH,
+    OMM_COL_NUM
+} omm_col_t;
+
+/* Formats an OMM can be written in */
+typedef enum {
+    OMM_FORMAT_NONE = 0,  /* Not an OMM, e.g. TLE */
+    OMM_FORMAT_CSV,
+    OMM_FORMAT_JSON,
+    OMM_FORMAT_KVN,
+    OMM_FORMAT_XML
+} omm_format_t;
+
+/*
+ * Records read from OMM data, stored by column.
+ *
+ * Record i is at position i of each column. Only the complete records are
+ * kept, so a record can be turned into elements without further checks.
+ */
+typedef struct {
+    guint len;                   /* Number of records */
+    GArray *cols[OMM_COL_NUM];   /* gdouble per record */
+    GPtrArray *names;            /* OBJECT_NAME, or NULL */
+    GPtrArray *ids;              /* OBJECT_ID, or NULL */
+    GStringChunk *strings;
+} omm_cache_t;
+
+omm_format_t omm_detect(const gchar *data, gsize len);
+
+omm_cache_t *omm_cache_new(void);
+void omm_cache_free(omm_cache_t *cache);
+guint omm_read(omm_cache_t *cache, const gchar *data, gsize len,
+               const gchar *source);
+
+gdouble omm_get(const omm_cache_t *cache, guint i, omm_col_t col);
+gdouble omm_get_epoch(const omm_cache_t *cache, guint i);
+void omm_get_tle(const omm_cache_t *cache, guint i, tle_t *tle);
+
+#endif
@@ -0,0 +1,200 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Pass cache.
+ *
+ * A cached pass is reused for as long as predicting the pass again would
+ * give the same result: the observer has not moved, the TLE has not changed
+ * and the pass has not ended. The next pass and the current pass of a
+ * satellite are kept apart, so asking for one does not evict the other. The
+ * track of a pass, which is what rotator planning needs, is sampled on
+ * first use and shared as well.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+
+#include "pass-cache.h"
+#include "qth-data.h"
+#include "sat-log.h"
+
+/* How long to remember that a satellite has no pass (sec) */
+#define NO_PASS_TTL 60.0
+
+typedef struct {
+    gdouble epoch;         /* Epoch of the TLE the pass was predicted from */
+    qth_small_t qth;       /* Observer the pass was predicted for */
+    gdouble tcomp;         /* When the pass was predicted (Julian date) */
+    gboolean current;      /* Whether it was predicted as the current pass */
+    pass_t *pass;          /* The pass; NULL if there was none */
+    rot_track_t *track;    /* Track of the pass; NULL until needed */
+} pass_cache_entry_t;
+
+/* The cached passes of a satellite, indexed by the current flag */
+typedef struct {
+    pass_cache_entry_t *entries[2];
+} pass_cache_sat_t;
+
+static void entry_free(pass_cache_entry_t *entry)
+{
+    if (entry == NULL)
+        return;
+
+    free_pass(entry->pass);
+    rot_track_unref(entry->track);
+    g_free(entry);
+}
+
+static void sat_free(gpointer data)
+{
+    pass_cache_sat_t *cached = data;
+
+    entry_free(cached->entries[0]);
+    entry_free(cached->entries[1]);
+    g_free(cached);
+}
+
+pass_cache_t *pass_cache_new(void)
+{
+    pass_cache_t *cache = g_new0(pass_cache_t, 1);
+
+    cache->entries = g_hash_table_new_full(g_int_hash, g_int_equal, g_free,
+                                           sat_free);
+
+    return cache;
+}
+
+void pass_cache_free(pass_cache_t *cache)
+{
+    if (cache == NULL)
+        return;
+
+    g_hash_table_destroy(cache->entries);
+    g_free(cache);
+}
+
+/* Whether the entry still holds what predicting the pass would give */
+static gboolean entry_valid(pass_cache_entry_t *entry, sat_t *sat, qth_t *qth,
+                            gdouble t, gboolean current)
+{
+    if (entry->epoch != sat->tle.epoch || t < entry->tcomp ||
+        qth_small_dist(qth, entry->qth) > 1.0)
+        return FALSE;
+
+    if (entry->pass == NULL)
+        return !current && t < entry->tcomp + NO_PASS_TTL / 86400.0;
+
+    if (t > entry->pass->los)
+        return FALSE;
+
+    if (current)
+        return entry->pass->aos <= t;
+
+    /* a current pass may not reach the minimum elevation of a next pass */
+    return !entry->current || entry->pass->aos <= t;
+}
+
+/*
+ * Get the pass of a satellite at time t.
+ *
+ * @param cache The cache.
+ * @param sat The satellite.
+ * @param qth The observer.
+ * @param t The time (Julian date).
+ * @param current Whether to get the pass in progress as get_current_pass()
+ *                does, or the next one as get_pass() does.
+ * @return A copy of the pass, to be freed with free_pass(), or NULL if there
+ *         is none.
+ */
+pass_t *pass_cache_get_pass(pass_cache_t *cache, sat_t *sat, qth_t *qth,
+                            gdouble t, gboolean current)
+{
+    pass_cache_sat_t *cached;
+    pass_cache_entry_t *entry;
+    gint *key;
+
+    current = current ? TRUE : FALSE;
+
+    cached = g_hash_table_lookup(cache->entries, &sat->tle.catnr);
+    if (cached == NULL)
+    {
+        cached = g_new0(pass_cache_sat_t, 1);
+        key = g_new(gint, 1);
+        *key = sat->tle.catnr;
+        g_hash_table_insert(cache->entries, key, cached);
+    }
+
+    entry = cached->entries[current];
+    if (entry != NULL && entry_valid(entry, sat, qth, t, current))
+        return entry->pass ? copy_pass(entry->pass) : NULL;
+
+    entry_free(entry);
+    entry = g_new0(pass_cache_entry_t, 1);
+    entry->epoch = sat->tle.epoch;
+    qth_small_save(qth, &entry->qth);
+    entry->tcomp = t;
+    entry->current = current;
+    if (current)
+        entry->pass = get_current_pass(sat, qth, t);
+    else
+        entry->pass = get_pass(sat, qth, t, 3.0);
+    cached->entries[current] = entry;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Predicted %s pass of %d"),
+                __func__, current ? "current" : "next", sat->tle.catnr);
+
+    return entry->pass ? copy_pass(entry->pass) : NULL;
+}
+
+/*
+ * Get the track of a pass.
+ *
+ * The track is sampled once for each pass the cache holds for the
+ * satellite. Other passes are sampled each time.
+ *
+ * @return A new reference to the track, or NULL if the pass is empty.
+ */
+rot_track_t *pass_cache_get_track(pass_cache_t *cache, sat_t *sat, qth_t *qth,
+                                  const pass_t *pass)
+{
+    pass_cache_sat_t *cached;
+    pass_cache_entry_t *entry = NULL;
+    guint i;
+
+    cached = g_hash_table_lookup(cache->entries, &sat->tle.catnr);
+    for (i = 0; cached != NULL && i < 2 && entry == NULL; i++)
+    {
+        entry = cached->entries[i];
+        if (entry != NULL &&
+            (entry->pass == NULL || entry->epoch != sat->tle.epoch ||
+             entry->pass->aos != pass->aos || entry->pass->los != pass->los))
+            entry = NULL;
+    }
+
+    if (entry == NULL)
+        return rot_track_new(sat, qth, pass->aos, pass->los);
+
+    if (entry->track == NULL)
+        entry->track = rot_track_new(sat, qth, pass->aos, pass->los);
+
+    return rot_track_ref(entry->track);
+}
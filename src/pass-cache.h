@@ -0,0 +1,49 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef PASS_CACHE_H
+#define PASS_CACHE_H 1
+
+#include <glib.h>
+
+#include "gtk-sat-data.h"
+#include "predict-tools.h"
+#include "rot-planner.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+/*
+ * Passes and tracks of the satellites in a module.
+ *
+ * The controllers of a module ask for the pass of their target every cycle.
+ * The cache keeps the last next pass and the last current pass of each
+ * satellite, so that each is predicted once however many controllers
+ * follow the satellite.
+ */
+typedef struct {
+    GHashTable *entries; /* Passes of each satellite by catalogue number */
+} pass_cache_t;
+
+pass_cache_t *pass_cache_new(void);
+void pass_cache_free(pass_cache_t *cache);
+
+pass_t *pass_cache_get_pass(pass_cache_t *cache, sat_t *sat, qth_t *qth,
+                            gdouble t, gboolean current);
+rot_track_t *pass_cache_get_track(pass_cache_t *cache, sat_t *sat, qth_t *qth,
+                                  const pass_t *pass);
+
+#endif
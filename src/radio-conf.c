@@ -45,8 +45,12 @@
 #define KEY_VFO_UP      "VFO_UP"
 #define KEY_SIG_AOS     "SIGNAL_AOS"
 #define KEY_SIG_LOS     "SIGNAL_LOS"
+#define KEY_TOLERANCE   "TOLERANCE"
+#define KEY_STEP        "STEP"
 
 #define DEFAULT_CYCLE_MS    1000
+#define DEFAULT_TOLERANCE   10
+#define DEFAULT_STEP        1
 
 /**
  * \brief Read radio configuration.
@@ -237,6 +241,24 @@ gboolean radio_conf_read(radio_conf_t * conf)
     conf->signal_aos = g_key_file_get_boolean(cfg, GROUP, KEY_SIG_AOS, NULL);
     conf->signal_los = g_key_file_get_boolean(cfg, GROUP, KEY_SIG_LOS, NULL);
 
+    /* Doppler tolerance and tuning step are only saved if not default */
+    if (g_key_file_has_key(cfg, GROUP, KEY_TOLERANCE, NULL))
+        conf->tolerance = g_key_file_get_integer(cfg, GROUP, KEY_TOLERANCE,
+                                                 NULL);
+    else
+        conf->tolerance = DEFAULT_TOLERANCE;
+
+    if (conf->tolerance < 1)
+        conf->tolerance = 1;
+
+    if (g_key_file_has_key(cfg, GROUP, KEY_STEP, NULL))
+        conf->step = g_key_file_get_integer(cfg, GROUP, KEY_STEP, NULL);
+    else
+        conf->step = DEFAULT_STEP;
+
+    if (conf->step < 1)
+        conf->step = 1;
+
     g_key_file_free(cfg);
     sat_log_log(SAT_LOG_LEVEL_INFO,
                 _("%s: Read radio configuration %s"), __func__, conf->name);
@@ -289,6 +311,12 @@ void radio_conf_save(radio_conf_t * conf)
     g_key_file_set_boolean(cfg, GROUP, KEY_SIG_AOS, conf->signal_aos);
     g_key_file_set_boolean(cfg, GROUP, KEY_SIG_LOS, conf->signal_los);
 
+    if (conf->tolerance != DEFAULT_TOLERANCE)
+        g_key_file_set_integer(cfg, GROUP, KEY_TOLERANCE, conf->tolerance);
+
+    if (conf->step != DEFAULT_STEP)
+        g_key_file_set_integer(cfg, GROUP, KEY_STEP, conf->step);
+
     confdir = get_hwconf_dir();
     fname = g_strconcat(confdir, G_DIR_SEPARATOR_S, conf->name, ".rig", NULL);
     g_free(confdir);
@@ -74,6 +74,9 @@ typedef struct {
     gboolean        signal_los; /*!< Send LOS notification to RIG */
 
     gint            vfo_opt;    /*!< Keep track of vfo_opt being enabled in rigctld */
+
+    gint            tolerance;  /*!< Doppler tolerance in Hz; smaller errors are not corrected */
+    gint            step;       /*!< Tuning step of the radio in Hz */
 } radio_conf_t;
 
 
@@ -0,0 +1,580 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Rotator trajectory planning.
+ *
+ * The track of a pass is sampled once and the rotator commands for the whole
+ * pass are planned from it. Planning the whole pass at once allows choosing
+ * between the normal and the flipped orientation and placing the azimuth
+ * unwind, if one is needed at all, where it costs the least. A simple slew
+ * model of the rotator is used to send each command early enough and to
+ * estimate the pointing error of each alternative.
+ *
+ * A track does not depend on the rotator, so one track serves every rotator
+ * following the same satellite.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <math.h>
+#include <string.h>
+
+#include "predict-tools.h"
+#include "rot-planner.h"
+#include "sat-log.h"
+
+/* One way of tracking the pass */
+typedef struct {
+    gboolean flipped; /* Track with El > 90 */
+    gdouble *az;      /* Continuous azimuth of each sample */
+    gdouble *el;      /* Elevation of each sample */
+    guint unwind;     /* Sample where the azimuth unwinds; 0 if never */
+    GArray *cmds;     /* Commands; positions as az and el above */
+    gdouble meanerr;  /* Predicted mean pointing error (deg) */
+    gdouble maxerr;   /* Predicted max pointing error (deg) */
+} rot_path_t;
+
+static gdouble wrap180(gdouble a)
+{
+    a = fmod(a, 360.0);
+    if (a > 180.0)
+        a -= 360.0;
+    else if (a <= -180.0)
+        a += 360.0;
+
+    return a;
+}
+
+/*
+ * Find a multiple of 360 degrees that moves an azimuth range between min and
+ * max into the range between lo and hi.
+ *
+ * If several ones do, the one moving first closest to pos is chosen.
+ * Returns FALSE if the range does not fit.
+ */
+static gboolean fit_shift(gdouble min, gdouble max, gdouble first, gdouble pos,
+                          gdouble lo, gdouble hi, gdouble *shift)
+{
+    gdouble kmin = ceil((lo - min) / 360.0);
+    gdouble kmax = floor((hi - max) / 360.0);
+
+    if (kmin > kmax)
+        return FALSE;
+
+    *shift = 360.0 * CLAMP(rint((pos - first) / 360.0), kmin, kmax);
+
+    return TRUE;
+}
+
+static gboolean fits(gdouble min, gdouble max, gdouble lo, gdouble hi)
+{
+    return ceil((lo - min) / 360.0) <= floor((hi - max) / 360.0);
+}
+
+/*
+ * Map the pass onto the travel of the rotator.
+ *
+ * The azimuth is unwrapped into a continuous curve, which is then moved by
+ * multiples of 360 degrees between the azimuth stops. If it is too long for
+ * that, it is split once where the elevation is the lowest, i.e. where
+ * unwinding the azimuth costs the least.
+ */
+static void plan_track(rot_path_t *path, const gdouble *az, const gdouble *el,
+                       guint n, rotor_conf_t *conf, gdouble pos)
+{
+    gdouble lo = conf->azstoppos;
+    gdouble hi = conf->azstoppos + conf->maxaz - conf->minaz;
+    gdouble *a = path->az;
+    gdouble *pmin, *pmax, *smin, *smax;
+    gdouble shift, shift2;
+    guint i, best = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        if (path->flipped)
+        {
+            a[i] = az[i] + 180.0;
+            path->el[i] = 180.0 - el[i];
+        }
+        else
+        {
+            a[i] = az[i];
+            path->el[i] = el[i];
+        }
+
+        if (i > 0)
+            a[i] = a[i - 1] + wrap180(a[i] - a[i - 1]);
+    }
+
+    /* extremes of each prefix and suffix of the track */
+    pmin = g_new(gdouble, n);
+    pmax = g_new(gdouble, n);
+    smin = g_new(gdouble, n);
+    smax = g_new(gdouble, n);
+
+    pmin[0] = pmax[0] = a[0];
+    for (i = 1; i < n; i++)
+    {
+        pmin[i] = MIN(pmin[i - 1], a[i]);
+        pmax[i] = MAX(pmax[i - 1], a[i]);
+    }
+    smin[n - 1] = smax[n - 1] = a[n - 1];
+    for (i = n - 1; i > 0; i--)
+    {
+        smin[i - 1] = MIN(smin[i], a[i - 1]);
+        smax[i - 1] = MAX(smax[i], a[i - 1]);
+    }
+
+    path->unwind = 0;
+    if (fit_shift(pmin[n - 1], pmax[n - 1], a[0], pos, lo, hi, &shift))
+    {
+        for (i = 0; i < n; i++)
+            a[i] += shift;
+    }
+    else
+    {
+        for (i = 1; i < n; i++)
+            if (fits(pmin[i - 1], pmax[i - 1], lo, hi) &&
+                fits(smin[i], smax[i], lo, hi) &&
+                (best == 0 || el[i] < el[best]))
+                best = i;
+
+        if (best > 0)
+        {
+            fit_shift(pmin[best - 1], pmax[best - 1], a[0], pos, lo, hi,
+                      &shift);
+            fit_shift(smin[best], smax[best], a[best], a[best - 1] + shift, lo,
+                      hi, &shift2);
+            for (i = 0; i < n; i++)
+                a[i] += (i < best) ? shift : shift2;
+            path->unwind = best;
+        }
+        else
+        {
+            /* the rotator can not follow the pass; center what it can */
+            shift = 360.0 * rint(((lo + hi) - (pmin[n - 1] + pmax[n - 1])) /
+                                 720.0);
+            for (i = 0; i < n; i++)
+                a[i] = CLAMP(a[i] + shift, lo, hi);
+        }
+    }
+
+    g_free(pmin);
+    g_free(pmax);
+    g_free(smin);
+    g_free(smax);
+}
+
+/*
+ * Time to move an axis over d degrees with a trapezoidal velocity profile.
+ * A speed or acceleration of 0 means unknown, i.e. unlimited.
+ */
+static gdouble move_time(gdouble d, gdouble vmax, gdouble amax)
+{
+    d = fabs(d);
+
+    if (vmax <= 0.0)
+        return 0.0;
+
+    if (amax <= 0.0)
+        return d / vmax;
+
+    if (d > vmax * vmax / amax)
+        return d / vmax + vmax / amax;
+
+    return 2.0 * sqrt(d / amax);
+}
+
+static void add_cmd(GArray *cmds, gdouble t, gdouble az, gdouble el,
+                    rotor_conf_t *conf)
+{
+    rot_plan_cmd_t cmd;
+
+    cmd.t = t;
+    cmd.az = az;
+    cmd.el = CLAMP(el, conf->minel, conf->maxel);
+    g_array_append_val(cmds, cmd);
+}
+
+/*
+ * Plan the commands for a track.
+ *
+ * Each command points the rotator at where the satellite will be two
+ * thresholds further along the track. It is sent when the satellite is one
+ * threshold past the previous command, less half the time the rotator needs
+ * for the move, so that the rotator passes the satellite half way. This
+ * keeps the pointing error within the threshold, as long as the rotator is
+ * fast enough, with as few commands as possible.
+ */
+static void plan_commands(rot_path_t *path, guint n, gdouble aos,
+                          gdouble step, rotor_conf_t *conf, gdouble threshold,
+                          gdouble cycle)
+{
+    gdouble *a = path->az;
+    gdouble *e = path->el;
+    gdouble d, t, last;
+    guint j, m, mid;
+
+    path->cmds = g_array_new(FALSE, FALSE, sizeof(rot_plan_cmd_t));
+
+    /* position the rotator for AOS */
+    add_cmd(path->cmds, aos, a[0], e[0], conf);
+    last = aos;
+
+    j = 0;
+    while (j < n - 1)
+    {
+        mid = 0;
+        for (m = j + 1; m < n - 1 && m != path->unwind; m++)
+        {
+            d = MAX(fabs(a[m] - a[j]), fabs(e[m] - e[j]));
+            if (mid == 0 && d > threshold)
+                mid = m;
+            if (d > 2.0 * threshold)
+                break;
+        }
+
+        d = MAX(fabs(a[m] - a[j]), fabs(e[m] - e[j]));
+        if (m == path->unwind)
+        {
+            /* nothing to gain by unwinding early */
+            t = aos + m * step / 86400.0;
+        }
+        else if (d > threshold)
+        {
+            if (mid == 0)
+                mid = m;
+            t = aos + mid * step / 86400.0 -
+                MAX(move_time(a[m] - a[j], conf->azrate, conf->azaccel),
+                    move_time(e[m] - e[j], conf->elrate, conf->elaccel)) /
+                    2.0 / 86400.0;
+        }
+        else
+        {
+            /* the satellite stays within the threshold until LOS */
+            break;
+        }
+
+        t = MAX(t, last + cycle / 86400.0);
+        add_cmd(path->cmds, t, a[m], e[m], conf);
+        last = t;
+        j = m;
+    }
+}
+
+/* Move an axis towards target for dt seconds */
+static void follow(gdouble *pos, gdouble *vel, gdouble target, gdouble vmax,
+                   gdouble amax, gdouble dt)
+{
+    gdouble d = target - *pos;
+    gdouble v;
+
+    if (vmax <= 0.0)
+    {
+        *pos = target;
+        *vel = 0.0;
+        return;
+    }
+
+    /* fastest speed from which we can still stop at target */
+    v = (amax > 0.0) ? MIN(vmax, sqrt(2.0 * amax * fabs(d))) : vmax;
+    if (d < 0.0)
+        v = -v;
+    if (amax > 0.0)
+        v = CLAMP(v, *vel - amax * dt, *vel + amax * dt);
+
+    if (v * d >= 0.0 && fabs(v * dt) >= fabs(d))
+    {
+        *pos = target;
+        *vel = 0.0;
+    }
+    else
+    {
+        *pos += v * dt;
+        *vel = v;
+    }
+}
+
+/* Estimate the pointing error by running the commands through the slew model */
+static void simulate(rot_path_t *path, guint n, gdouble aos, gdouble step,
+                     rotor_conf_t *conf)
+{
+    rot_plan_cmd_t *cmds = (rot_plan_cmd_t *)path->cmds->data;
+    gdouble pa = cmds[0].az;
+    gdouble pe = cmds[0].el;
+    gdouble va = 0.0, ve = 0.0;
+    gdouble t, err, sum = 0.0;
+    guint i, c = 0;
+
+    path->maxerr = 0.0;
+    for (i = 0; i < n; i++)
+    {
+        t = aos + i * step / 86400.0;
+        while (c + 1 < path->cmds->len && cmds[c + 1].t <= t)
+            c++;
+
+        if (i > 0)
+        {
+            follow(&pa, &va, cmds[c].az, conf->azrate, conf->azaccel, step);
+            follow(&pe, &ve, cmds[c].el, conf->elrate, conf->elaccel, step);
+        }
+
+        /* an azimuth error matters less the higher up we point */
+        err = hypot((pa - path->az[i]) * cos(de2ra * path->el[i]),
+                    pe - path->el[i]);
+        sum += err;
+        path->maxerr = MAX(path->maxerr, err);
+    }
+
+    path->meanerr = sum / n;
+}
+
+/*
+ * Find the difference between the rotator azimuth and the travel position.
+ *
+ * The travel starts at the end stop, which the rotator calls minaz, so the
+ * two differ by a multiple of 360 degrees. Returns FALSE if they do not, i.e.
+ * if the rotator picks the way to an azimuth by itself.
+ */
+static gboolean travel_offset(rotor_conf_t *conf, gdouble *offset)
+{
+    gdouble d = conf->minaz - conf->azstoppos;
+
+    *offset = 360.0 * rint(d / 360.0);
+
+    return fabs(d - *offset) < 0.5;
+}
+
+/*
+ * Convert an azimuth on the rotator travel to what rotctld expects.
+ *
+ * The azimuth stays on the branch it was planned on; wrapping it into the
+ * range of the rotator could pick the other end of a travel over 360 deg.
+ */
+static gdouble rotator_az(gdouble az, rotor_conf_t *conf)
+{
+    gdouble offset;
+
+    if (travel_offset(conf, &offset))
+        return CLAMP(az + offset, conf->minaz, conf->maxaz);
+
+    while (az > conf->maxaz)
+        az -= 360.0;
+    while (az < conf->minaz)
+        az += 360.0;
+
+    return CLAMP(az, conf->minaz, conf->maxaz);
+}
+
+/*
+ * Sample the track of a pass.
+ *
+ * @param sat The satellite; it is not modified.
+ * @param qth The observer.
+ * @param aos Start of the pass (Julian date).
+ * @param los End of the pass (Julian date).
+ * @return A new track with a reference count of 1, or NULL if the pass is
+ *         empty.
+ */
+rot_track_t *rot_track_new(sat_t *sat, qth_t *qth, gdouble aos, gdouble los)
+{
+    rot_track_t *track;
+    sat_t sat_working;
+    gdouble duration, step;
+    guint i;
+
+    duration = (los - aos) * 86400.0;
+    if (duration <= 0.0)
+        return NULL;
+
+    step = ROT_PLAN_STEP;
+    if (duration / step > ROT_PLAN_MAX - 1)
+        step = duration / (ROT_PLAN_MAX - 1);
+
+    track = g_new0(rot_track_t, 1);
+    track->refcount = 1;
+    track->catnum = sat->tle.catnr;
+    track->aos = aos;
+    track->los = los;
+    track->step = step;
+    track->n = (guint)ceil(duration / step) + 1;
+    track->az = g_new(gdouble, track->n);
+    track->el = g_new(gdouble, track->n);
+
+    memcpy(&sat_working, sat, sizeof(sat_t));
+    for (i = 0; i < track->n; i++)
+    {
+        predict_calc(&sat_working, qth, aos + i * step / 86400.0);
+        track->az[i] = sat_working.az;
+        track->el[i] = sat_working.el;
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Computed %u samples for satellite %d"), __func__,
+                track->n, track->catnum);
+
+    return track;
+}
+
+rot_track_t *rot_track_ref(rot_track_t *track)
+{
+    if (track != NULL)
+        g_atomic_int_inc(&track->refcount);
+
+    return track;
+}
+
+void rot_track_unref(rot_track_t *track)
+{
+    if (track == NULL)
+        return;
+
+    if (g_atomic_int_dec_and_test(&track->refcount))
+    {
+        g_free(track->az);
+        g_free(track->el);
+        g_free(track);
+    }
+}
+
+/*
+ * Plan the rotator commands for a pass.
+ *
+ * @param track The track of the pass.
+ * @param conf The rotator configuration.
+ * @param threshold Pointing error that triggers a new command (deg).
+ * @param cycle Minimum time between commands (sec).
+ * @param havepos Whether the position of the rotator is known.
+ * @param az The azimuth of the rotator, if known.
+ * @return A new plan.
+ */
+rot_plan_t *rot_plan_new(const rot_track_t *track, rotor_conf_t *conf,
+                         gdouble threshold, gdouble cycle, gboolean havepos,
+                         gdouble az)
+{
+    rot_plan_t *plan;
+    rot_path_t paths[2], *best = NULL;
+    gdouble aos = track->aos;
+    gdouble step = track->step;
+    gdouble pos, lo, hi, offset;
+    guint i, n = track->n, npaths;
+
+    /* where the rotator is on its travel; without a position start from
+       the middle, which leaves room in both directions */
+    lo = conf->azstoppos;
+    hi = conf->azstoppos + conf->maxaz - conf->minaz;
+    pos = (lo + hi) / 2.0;
+    if (havepos && travel_offset(conf, &offset))
+    {
+        pos = CLAMP(az - offset, lo, hi);
+    }
+    else if (havepos)
+    {
+        pos = az;
+        while (pos > hi)
+            pos -= 360.0;
+        while (pos < lo)
+            pos += 360.0;
+    }
+
+    /* the flipped orientation needs an elevation range up to 180 deg */
+    npaths = (conf->maxel >= 180.0) ? 2 : 1;
+    for (i = 0; i < npaths; i++)
+    {
+        paths[i].flipped = (i == 1);
+        paths[i].az = g_new(gdouble, n);
+        paths[i].el = g_new(gdouble, n);
+        plan_track(&paths[i], track->az, track->el, n, conf, pos);
+        plan_commands(&paths[i], n, aos, step, conf, threshold, cycle);
+        simulate(&paths[i], n, aos, step, conf);
+
+        if (best == NULL || paths[i].meanerr < best->meanerr - 0.01 ||
+            (paths[i].meanerr < best->meanerr + 0.01 &&
+             paths[i].cmds->len < best->cmds->len))
+            best = &paths[i];
+    }
+
+    plan = g_new0(rot_plan_t, 1);
+    plan->catnum = track->catnum;
+    plan->aos = aos;
+    plan->los = track->los;
+    plan->flipped = best->flipped;
+    plan->unwind = best->unwind ? aos + best->unwind * step / 86400.0 : 0.0;
+    plan->meanerr = best->meanerr;
+    plan->maxerr = best->maxerr;
+    plan->ncmd = best->cmds->len;
+    plan->cmds = (rot_plan_cmd_t *)g_array_free(best->cmds, FALSE);
+    best->cmds = NULL;
+
+    for (i = 0; i < plan->ncmd; i++)
+        plan->cmds[i].az = rotator_az(plan->cmds[i].az, conf);
+
+    for (i = 0; i < npaths; i++)
+    {
+        g_free(paths[i].az);
+        g_free(paths[i].el);
+        if (paths[i].cmds != NULL)
+            g_array_free(paths[i].cmds, TRUE);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Planned %u commands for satellite %d (flipped: %d, "
+                  "unwind: %d, error: %.1f\302\260 mean, %.1f\302\260 max)"),
+                __func__, plan->ncmd, plan->catnum, plan->flipped,
+                plan->unwind > 0.0, plan->meanerr, plan->maxerr);
+
+    return plan;
+}
+
+void rot_plan_free(rot_plan_t *plan)
+{
+    if (plan == NULL)
+        return;
+
+    g_free(plan->cmds);
+    g_free(plan);
+}
+
+/*
+ * Get the command that applies at time t.
+ *
+ * Before AOS this is the command that positions the rotator for the pass.
+ * Returns NULL after LOS.
+ */
+const rot_plan_cmd_t *rot_plan_lookup(const rot_plan_t *plan, gdouble t)
+{
+    guint lo = 0, hi = plan->ncmd, mid;
+
+    if (t > plan->los)
+        return NULL;
+
+    while (hi - lo > 1)
+    {
+        mid = (lo + hi) / 2;
+        if (plan->cmds[mid].t <= t)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    return &plan->cmds[lo];
+}
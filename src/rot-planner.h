@@ -0,0 +1,84 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef ROT_PLANNER_H
+#define ROT_PLANNER_H 1
+
+#include <glib.h>
+
+#include "gtk-sat-data.h"
+#include "rotor-conf.h"
+#include "sgpsdp/sgp4sdp4.h"
+
+#define ROT_PLAN_STEP 1.0  /* Time between track samples (sec) */
+#define ROT_PLAN_MAX 10800 /* Max number of track samples in a plan */
+
+/*
+ * The track of a satellite sampled over a pass.
+ *
+ * A track is immutable once created and reference counted, so that it can be
+ * shared by every rotator following the satellite.
+ */
+typedef struct {
+    gint refcount;  /* Reference count; use rot_track_ref/unref() */
+    gint catnum;    /* Catalogue number of the satellite */
+    gdouble aos;    /* Time of the first sample (Julian date) */
+    gdouble los;    /* End of the pass (Julian date) */
+    gdouble step;   /* Time between samples (sec) */
+    guint n;        /* Number of samples; at least 2 */
+    gdouble *az;    /* Azimuth at each sample (deg) */
+    gdouble *el;    /* Elevation at each sample (deg) */
+} rot_track_t;
+
+/* A position command in the plan */
+typedef struct {
+    gdouble t;  /* When to send the command (Julian date) */
+    gdouble az; /* Azimuth in rotator units */
+    gdouble el; /* Elevation in rotator units */
+} rot_plan_cmd_t;
+
+/*
+ * Position commands for tracking a satellite through one pass.
+ *
+ * The first command positions the rotator for AOS and applies until the
+ * second one is due; the last one applies until LOS.
+ */
+typedef struct {
+    gint catnum;          /* Catalogue number of the satellite */
+    gdouble aos;          /* Start of the plan (Julian date) */
+    gdouble los;          /* End of the plan (Julian date) */
+    gboolean flipped;     /* Whether the pass is tracked with El > 90 */
+    gdouble unwind;       /* When the azimuth has to unwind; 0 if never */
+    gdouble meanerr;      /* Predicted mean pointing error (deg) */
+    gdouble maxerr;       /* Predicted max pointing error (deg) */
+    guint ncmd;           /* Number of commands; at least 1 */
+    rot_plan_cmd_t *cmds; /* Commands in order of time */
+} rot_plan_t;
+
+rot_track_t *rot_track_new(sat_t *sat, qth_t *qth, gdouble aos, gdouble los);
+rot_track_t *rot_track_ref(rot_track_t *track);
+void rot_track_unref(rot_track_t *track);
+
+rot_plan_t *rot_plan_new(const rot_track_t *track, rotor_conf_t *conf,
+                         gdouble threshold, gdouble cycle, gboolean havepos,
+                         gdouble az);
+void rot_plan_free(rot_plan_t *plan);
+
+const rot_plan_cmd_t *rot_plan_lookup(const rot_plan_t *plan, gdouble t);
+
+#endif
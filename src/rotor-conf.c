@@ -45,10 +45,24 @@
 #define KEY_MAXEL       "MaxEl"
 #define KEY_AZSTOPPOS   "AzStopPos"
 #define KEY_THLD        "Threshold"
+#define KEY_AZRATE      "AzRate"
+#define KEY_ELRATE      "ElRate"
+#define KEY_AZACCEL     "AzAccel"
+#define KEY_ELACCEL     "ElAccel"
 
 #define DEFAULT_CYCLE_MS    1000
 #define DEFAULT_THLD_DEG    5.0
 
+/* Read an optional, non-negative rate; 0 if missing or invalid */
+static gdouble read_rate(GKeyFile * cfg, const gchar * key)
+{
+    gdouble         rate;
+
+    rate = g_key_file_get_double(cfg, GROUP, key, NULL);
+
+    return (rate > 0.0) ? rate : 0.0;
+}
+
 /**
  * \brief Read rotator configuration.
  * \param conf Pointer to a rotor_conf_t structure where the data will be
@@ -216,11 +230,23 @@ gboolean rotor_conf_read(rotor_conf_t * conf)
         conf->azstoppos = conf->minaz;
     }
 
+    /* slew rates and accelerations are optional; 0 means unknown */
+    conf->azrate = read_rate(cfg, KEY_AZRATE);
+    conf->elrate = read_rate(cfg, KEY_ELRATE);
+    conf->azaccel = read_rate(cfg, KEY_AZACCEL);
+    conf->elaccel = read_rate(cfg, KEY_ELACCEL);
+
     g_key_file_free(cfg);
 
     return TRUE;
 }
 
+static void save_rate(GKeyFile * cfg, const gchar * key, gdouble rate)
+{
+    if (rate > 0.0)
+        g_key_file_set_double(cfg, GROUP, key, rate);
+}
+
 /**
  * \brief Save rotator configuration.
  * \param conf Pointer to the rotator configuration.
@@ -260,6 +286,12 @@ void rotor_conf_save(rotor_conf_t * conf)
     else
         g_key_file_set_double(cfg, GROUP, KEY_THLD, conf->threshold);
 
+    /* slew model is only saved if known */
+    save_rate(cfg, KEY_AZRATE, conf->azrate);
+    save_rate(cfg, KEY_ELRATE, conf->elrate);
+    save_rate(cfg, KEY_AZACCEL, conf->azaccel);
+    save_rate(cfg, KEY_ELACCEL, conf->elaccel);
+
     /* build filename */
     confdir = get_hwconf_dir();
     fname = g_strconcat(confdir, G_DIR_SEPARATOR_S, conf->name, ".rot", NULL);
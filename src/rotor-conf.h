@@ -51,6 +51,10 @@ typedef struct {
     gdouble         maxel;      /*!< Upper elevation limit */
     gdouble         azstoppos;  /*!< absolute position of rotation stops; normally = minaz */
     gdouble         threshold;  /*!< Angle difference that triggers new motion command */
+    gdouble         azrate;     /*!< Az slew rate in deg/s; 0 if unknown */
+    gdouble         elrate;     /*!< El slew rate in deg/s; 0 if unknown */
+    gdouble         azaccel;    /*!< Az acceleration in deg/s/s; 0 if unknown */
+    gdouble         elaccel;    /*!< El acceleration in deg/s/s; 0 if unknown */
 } rotor_conf_t;
 
 
@@ -0,0 +1,687 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Satellite catalogue.
+ *
+ * All satellites are kept in one file that is mapped into memory, instead of
+ * one .sat key file per satellite (on Windows, where a mapped file cannot be
+ * replaced, it is read into memory instead). Entries are validated when the
+ * catalogue is written, so reading a satellite is a binary search and a copy.
+ * The file is only ever replaced as a whole, atomically, and the catalogue in
+ * use is swapped under a lock, so readers holding a reference are not
+ * disturbed.
+ *
+ * The .sat files remain the format of the data shipped with gpredict and the
+ * fallback for satellites missing from the catalogue. They are imported once
+ * when there is no catalogue and can be exported again.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "compat.h"
+#include "gpredict-utils.h"
+#include "sat-catalogue.h"
+#include "sat-log.h"
+
+#define CAT_FILE_NAME "satellites.db"
+#define FIXED_SIZE offsetof(sat_cat_entry_t, tle)
+
+typedef struct {
+    sat_cat_entry_t entry;
+    gchar *name;
+    gchar *nickname;
+    gchar *website;
+} build_rec_t;
+
+/* The catalogue in use; see sat_catalogue_get_default() */
+static GMutex default_lock;
+static sat_catalogue_t *default_cat = NULL;
+static gboolean default_tried = FALSE;
+
+/* Check the structure of a mapped catalogue */
+static gboolean check_catalogue(const gchar *data, gsize len)
+{
+    const sat_cat_header_t *header = (const sat_cat_header_t *)data;
+    const sat_cat_entry_t *entry;
+    gint32 last = G_MININT32;
+    guint i;
+
+    if (len < sizeof(sat_cat_header_t) ||
+        memcmp(header->magic, SAT_CAT_MAGIC, sizeof(header->magic)) ||
+        header->version != SAT_CAT_VERSION ||
+        header->entrysize < FIXED_SIZE || header->entrysize % 8 != 0)
+        return FALSE;
+
+    if (header->strings < sizeof(sat_cat_header_t) +
+                              (guint64)header->count * header->entrysize ||
+        header->strsize == 0 ||
+        (guint64)header->strings + header->strsize > len ||
+        data[header->strings] != '\0' ||
+        data[header->strings + header->strsize - 1] != '\0')
+        return FALSE;
+
+    /* the index relies on the order */
+    for (i = 0; i < header->count; i++)
+    {
+        entry = (const sat_cat_entry_t *)(data + sizeof(sat_cat_header_t) +
+                                          i * header->entrysize);
+        if (entry->catnr <= last || entry->name >= header->strsize ||
+            entry->nickname >= header->strsize ||
+            entry->website >= header->strsize ||
+            entry->tle1[SAT_CAT_TLE_LEN - 1] != '\0' ||
+            entry->tle2[SAT_CAT_TLE_LEN - 1] != '\0')
+            return FALSE;
+        last = entry->catnr;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Open a catalogue file.
+ *
+ * @param path The file.
+ * @return A new reference to the catalogue, or NULL if the file could not be
+ *         read or is not a valid catalogue.
+ */
+sat_catalogue_t *sat_catalogue_open(const gchar *path)
+{
+    sat_catalogue_t *cat;
+    GBytes *bytes;
+    GError *err = NULL;
+    const gchar *data;
+    gsize len;
+
+    bytes = load_replaceable_file(path, &err);
+    if (bytes == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not open %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+        return NULL;
+    }
+
+    data = g_bytes_get_data(bytes, &len);
+    if (!check_catalogue(data, len))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: %s is not a valid catalogue"),
+                    __func__, path);
+        g_bytes_unref(bytes);
+        return NULL;
+    }
+
+    cat = g_new0(sat_catalogue_t, 1);
+    cat->refcount = 1;
+    cat->data = bytes;
+    cat->header = (const sat_cat_header_t *)data;
+    cat->entries = data + sizeof(sat_cat_header_t);
+    cat->strings = data + cat->header->strings;
+    cat->native = (cat->header->entrysize == sizeof(sat_cat_entry_t) &&
+                   cat->header->tlesize == sizeof(tle_t));
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Opened %s with %u satellites"),
+                __func__, path, cat->header->count);
+
+    return cat;
+}
+
+sat_catalogue_t *sat_catalogue_ref(sat_catalogue_t *cat)
+{
+    g_atomic_int_inc(&cat->refcount);
+
+    return cat;
+}
+
+void sat_catalogue_unref(sat_catalogue_t *cat)
+{
+    if (cat == NULL || !g_atomic_int_dec_and_test(&cat->refcount))
+        return;
+
+    g_bytes_unref(cat->data);
+    g_free(cat);
+}
+
+guint sat_catalogue_size(const sat_catalogue_t *cat)
+{
+    return cat->header->count;
+}
+
+const sat_cat_entry_t *sat_catalogue_nth(const sat_catalogue_t *cat, guint i)
+{
+    g_return_val_if_fail(i < cat->header->count, NULL);
+
+    return (const sat_cat_entry_t *)(cat->entries + i * cat->header->entrysize);
+}
+
+/* Find a satellite; returns NULL if it is not in the catalogue */
+const sat_cat_entry_t *sat_catalogue_lookup(const sat_catalogue_t *cat,
+                                            gint catnr)
+{
+    const sat_cat_entry_t *entry;
+    guint lo = 0, hi = cat->header->count, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        entry = sat_catalogue_nth(cat, mid);
+        if (entry->catnr == catnr)
+            return entry;
+        if (entry->catnr < catnr)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return NULL;
+}
+
+/* A string of an entry; NULL if it is missing */
+const gchar *sat_catalogue_str(const sat_catalogue_t *cat, guint32 offset)
+{
+    return offset ? cat->strings + offset : NULL;
+}
+
+/*
+ * Get the elements of an entry, parsing them if necessary.
+ *
+ * @return FALSE if the entry has no TLE lines and its parsed elements can
+ *         not be used; see sat_cat_builder_add_elements().
+ */
+gboolean sat_catalogue_get_tle(const sat_catalogue_t *cat,
+                               const sat_cat_entry_t *entry, tle_t *tle)
+{
+    gchar *rawtle;
+
+    if (cat->native)
+    {
+        *tle = entry->tle;
+        return TRUE;
+    }
+
+    if (entry->tle1[0] == '\0')
+        return FALSE;
+
+    /* the lines were validated when the catalogue was written */
+    rawtle = g_strconcat(entry->tle1, entry->tle2, NULL);
+    Convert_Satellite_Data(rawtle, tle);
+    tle->status = entry->status;
+    g_free(rawtle);
+
+    return TRUE;
+}
+
+static void free_rec(gpointer data)
+{
+    build_rec_t *rec = data;
+
+    g_free(rec->name);
+    g_free(rec->nickname);
+    g_free(rec->website);
+    g_free(rec);
+}
+
+sat_cat_builder_t *sat_cat_builder_new(void)
+{
+    sat_cat_builder_t *builder = g_new0(sat_cat_builder_t, 1);
+
+    builder->entries = g_hash_table_new_full(g_int_hash, g_int_equal, NULL,
+                                             free_rec);
+
+    return builder;
+}
+
+void sat_cat_builder_free(sat_cat_builder_t *builder)
+{
+    if (builder == NULL)
+        return;
+
+    g_hash_table_destroy(builder->entries);
+    g_free(builder);
+}
+
+static void add_rec(sat_cat_builder_t *builder, build_rec_t *rec)
+{
+    /* the key lives in the record */
+    g_hash_table_replace(builder->entries, &rec->entry.catnr, rec);
+}
+
+/* Fill in the rest of a record whose elements are set and add it */
+static void add_parsed(sat_cat_builder_t *builder, build_rec_t *rec,
+                       const gchar *name, const gchar *nickname,
+                       const gchar *website, gint status)
+{
+    rec->entry.catnr = rec->entry.tle.catnr;
+    rec->entry.status = status;
+    rec->entry.tle.status = status;
+    rec->entry.epoch = rec->entry.tle.epoch;
+    rec->name = g_strdup(name ? name : "Error");
+    rec->nickname = g_strdup(nickname ? nickname : rec->name);
+    rec->website = g_strdup(website);
+    add_rec(builder, rec);
+}
+
+/*
+ * Add a satellite, replacing any with the same catalogue number.
+ *
+ * @return FALSE if the TLE lines are not valid, in which case the satellite
+ *         is not added.
+ */
+gboolean sat_cat_builder_add(sat_cat_builder_t *builder, const gchar *name,
+                             const gchar *nickname, const gchar *website,
+                             const gchar *tle1, const gchar *tle2,
+                             gint status)
+{
+    build_rec_t *rec;
+    gchar *rawtle;
+
+    if (tle1 == NULL || tle2 == NULL || strlen(tle1) >= SAT_CAT_TLE_LEN ||
+        strlen(tle2) >= SAT_CAT_TLE_LEN)
+        return FALSE;
+
+    rawtle = g_strconcat(tle1, tle2, NULL);
+    if (!Good_Elements(rawtle))
+    {
+        g_free(rawtle);
+        return FALSE;
+    }
+
+    rec = g_new0(build_rec_t, 1);
+    Convert_Satellite_Data(rawtle, &rec->entry.tle);
+    g_free(rawtle);
+
+    g_strlcpy(rec->entry.tle1, tle1, SAT_CAT_TLE_LEN);
+    g_strlcpy(rec->entry.tle2, tle2, SAT_CAT_TLE_LEN);
+    add_parsed(builder, rec, name, nickname, website, status);
+
+    return TRUE;
+}
+
+/*
+ * Add a satellite from its elements, replacing any with the same catalogue
+ * number.
+ *
+ * This is for elements that do not come from TLE lines, e.g. those read
+ * from an OMM. The entry has no lines, so it can only be read by a build
+ * with the same tle_t and is not exported.
+ *
+ * @return FALSE if the elements have no catalogue number.
+ */
+gboolean sat_cat_builder_add_elements(sat_cat_builder_t *builder,
+                                      const gchar *name,
+                                      const gchar *nickname,
+                                      const gchar *website, const tle_t *tle,
+                                      gint status)
+{
+    build_rec_t *rec;
+
+    if (tle == NULL || tle->catnr <= 0)
+        return FALSE;
+
+    rec = g_new0(build_rec_t, 1);
+    rec->entry.tle = *tle;
+    add_parsed(builder, rec, name, nickname, website, status);
+
+    return TRUE;
+}
+
+/*
+ * Add an entry of another catalogue as it is.
+ *
+ * @return FALSE if the elements of the entry can not be read, in which case
+ *         it is not added.
+ */
+gboolean sat_cat_builder_add_entry(sat_cat_builder_t *builder,
+                                   const sat_catalogue_t *cat,
+                                   const sat_cat_entry_t *entry)
+{
+    build_rec_t *rec = g_new0(build_rec_t, 1);
+
+    memcpy(&rec->entry, entry, FIXED_SIZE);
+    if (!sat_catalogue_get_tle(cat, entry, &rec->entry.tle))
+    {
+        g_free(rec);
+        return FALSE;
+    }
+    rec->name = g_strdup(sat_catalogue_str(cat, entry->name));
+    rec->nickname = g_strdup(sat_catalogue_str(cat, entry->nickname));
+    rec->website = g_strdup(sat_catalogue_str(cat, entry->website));
+    add_rec(builder, rec);
+
+    return TRUE;
+}
+
+static gint compare_recs(gconstpointer a, gconstpointer b)
+{
+    const build_rec_t *ra = *(build_rec_t *const *)a;
+    const build_rec_t *rb = *(build_rec_t *const *)b;
+
+    return (ra->entry.catnr > rb->entry.catnr) -
+           (ra->entry.catnr < rb->entry.catnr);
+}
+
+/* Append a string to the string table and return its offset */
+static guint32 add_string(GString *strings, const gchar *str)
+{
+    guint32 offset = strings->len;
+
+    if (str == NULL)
+        return 0;
+
+    g_string_append_len(strings, str, strlen(str) + 1);
+
+    return offset;
+}
+
+/*
+ * Write the catalogue to a file.
+ *
+ * The file is replaced atomically, so that a reader sees either the old or
+ * the new catalogue.
+ */
+gboolean sat_cat_builder_save(sat_cat_builder_t *builder, const gchar *path)
+{
+    sat_cat_header_t header;
+    GPtrArray *recs;
+    GHashTableIter iter;
+    gpointer rec;
+    GString *strings;
+    GByteArray *buff;
+    GError *err = NULL;
+    build_rec_t *r;
+    gboolean retval;
+    guint i;
+
+    recs = g_ptr_array_sized_new(g_hash_table_size(builder->entries));
+    g_hash_table_iter_init(&iter, builder->entries);
+    while (g_hash_table_iter_next(&iter, NULL, &rec))
+        g_ptr_array_add(recs, rec);
+    g_ptr_array_sort(recs, compare_recs);
+
+    strings = g_string_new(NULL);
+    g_string_append_len(strings, "", 1);
+    for (i = 0; i < recs->len; i++)
+    {
+        r = g_ptr_array_index(recs, i);
+        r->entry.name = add_string(strings, r->name);
+        r->entry.nickname = add_string(strings, r->nickname);
+        r->entry.website = add_string(strings, r->website);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SAT_CAT_MAGIC, sizeof(header.magic));
+    header.version = SAT_CAT_VERSION;
+    header.entrysize = sizeof(sat_cat_entry_t);
+    header.tlesize = sizeof(tle_t);
+    header.count = recs->len;
+    header.strings = sizeof(header) + recs->len * sizeof(sat_cat_entry_t);
+    header.strsize = strings->len;
+    header.created = g_get_real_time() / G_USEC_PER_SEC;
+
+    buff = g_byte_array_sized_new(header.strings + header.strsize);
+    g_byte_array_append(buff, (const guint8 *)&header, sizeof(header));
+    for (i = 0; i < recs->len; i++)
+    {
+        r = g_ptr_array_index(recs, i);
+        g_byte_array_append(buff, (const guint8 *)&r->entry,
+                            sizeof(sat_cat_entry_t));
+    }
+    g_byte_array_append(buff, (const guint8 *)strings->str, strings->len);
+
+    retval = g_file_set_contents(path, (const gchar *)buff->data, buff->len,
+                                 &err);
+    if (!retval)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not write %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+    }
+
+    g_byte_array_unref(buff);
+    g_string_free(strings, TRUE);
+    g_ptr_array_free(recs, TRUE);
+
+    return retval;
+}
+
+/* Path of the catalogue in the user's configuration directory */
+gchar *sat_catalogue_file_name(void)
+{
+    return sat_file_name(CAT_FILE_NAME);
+}
+
+/*
+ * Get the catalogue in use.
+ *
+ * @return A new reference to the catalogue, or NULL if there is none, in
+ *         which case the satellites are read from the .sat files.
+ */
+sat_catalogue_t *sat_catalogue_get_default(void)
+{
+    sat_catalogue_t *cat;
+    gchar *path;
+
+    g_mutex_lock(&default_lock);
+    if (default_cat == NULL && !default_tried)
+    {
+        path = sat_catalogue_file_name();
+        if (g_file_test(path, G_FILE_TEST_EXISTS))
+            default_cat = sat_catalogue_open(path);
+        g_free(path);
+        default_tried = TRUE;
+    }
+    cat = default_cat ? sat_catalogue_ref(default_cat) : NULL;
+    g_mutex_unlock(&default_lock);
+
+    return cat;
+}
+
+/*
+ * Replace the catalogue in use.
+ *
+ * The file is replaced atomically and the new catalogue is used from then
+ * on; satellites already read are not affected.
+ */
+gboolean sat_catalogue_commit(sat_cat_builder_t *builder)
+{
+    sat_catalogue_t *cat, *old;
+    gchar *path;
+
+    path = sat_catalogue_file_name();
+    if (!sat_cat_builder_save(builder, path))
+    {
+        g_free(path);
+        return FALSE;
+    }
+    cat = sat_catalogue_open(path);
+    g_free(path);
+    if (cat == NULL)
+        return FALSE;
+
+    g_mutex_lock(&default_lock);
+    old = default_cat;
+    default_cat = cat;
+    default_tried = TRUE;
+    g_mutex_unlock(&default_lock);
+
+    sat_catalogue_unref(old);
+
+    return TRUE;
+}
+
+/* Add the satellite in a .sat file; returns FALSE if it is not valid */
+static gboolean import_sat_file(sat_cat_builder_t *builder, const gchar *path)
+{
+    GKeyFile *data;
+    GError *err = NULL;
+    gchar *name, *nickname, *website, *tle1, *tle2;
+    gint status = OP_STAT_UNKNOWN;
+    gboolean retval;
+
+    data = g_key_file_new();
+    if (!g_key_file_load_from_file(data, path, G_KEY_FILE_NONE, &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to load data from %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+        g_key_file_free(data);
+        return FALSE;
+    }
+
+    name = g_key_file_get_string(data, "Satellite", "NAME", NULL);
+    nickname = g_key_file_get_string(data, "Satellite", "NICKNAME", NULL);
+    website = g_key_file_get_string(data, "Satellite", "WEBSITE", NULL);
+    tle1 = g_key_file_get_string(data, "Satellite", "TLE1", NULL);
+    tle2 = g_key_file_get_string(data, "Satellite", "TLE2", NULL);
+    if (g_key_file_has_key(data, "Satellite", "STATUS", NULL))
+        status = g_key_file_get_integer(data, "Satellite", "STATUS", NULL);
+
+    retval = sat_cat_builder_add(builder, name, nickname, website, tle1, tle2,
+                                 status);
+    if (!retval)
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: TLE data in %s appears to be bad"), __func__, path);
+
+    g_free(name);
+    g_free(nickname);
+    g_free(website);
+    g_free(tle1);
+    g_free(tle2);
+    g_key_file_free(data);
+
+    return retval;
+}
+
+/*
+ * Build the catalogue from the .sat files in a directory.
+ *
+ * @param dir The directory.
+ * @return The number of satellites imported, or -1 if the catalogue could
+ *         not be written.
+ */
+gint sat_catalogue_import(const gchar *dir)
+{
+    sat_cat_builder_t *builder;
+    GDir *gdir;
+    GError *err = NULL;
+    const gchar *fname;
+    gchar *path;
+    gint num = 0;
+
+    gdir = g_dir_open(dir, 0, &err);
+    if (gdir == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not open %s (%s)"),
+                    __func__, dir, err->message);
+        g_clear_error(&err);
+        return -1;
+    }
+
+    builder = sat_cat_builder_new();
+    while ((fname = g_dir_read_name(gdir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        path = g_build_filename(dir, fname, NULL);
+        if (import_sat_file(builder, path))
+            num++;
+        g_free(path);
+    }
+    g_dir_close(gdir);
+
+    if (!sat_catalogue_commit(builder))
+        num = -1;
+    sat_cat_builder_free(builder);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Imported %d satellites from %s"),
+                __func__, num, dir);
+
+    return num;
+}
+
+/*
+ * Write the catalogue in use as .sat files.
+ *
+ * @param dir The directory to write the files to.
+ * @return The number of files written, or -1 if there is no catalogue.
+ */
+gint sat_catalogue_export(const gchar *dir)
+{
+    sat_catalogue_t *cat;
+    const sat_cat_entry_t *entry;
+    GKeyFile *data;
+    gchar *fname, *path;
+    const gchar *website;
+    gint num = 0;
+    guint skipped = 0;
+    guint i;
+
+    cat = sat_catalogue_get_default();
+    if (cat == NULL)
+        return -1;
+
+    for (i = 0; i < sat_catalogue_size(cat); i++)
+    {
+        entry = sat_catalogue_nth(cat, i);
+
+        /* a .sat file can only hold TLE lines */
+        if (entry->tle1[0] == '\0')
+        {
+            skipped++;
+            continue;
+        }
+
+        data = g_key_file_new();
+        g_key_file_set_string(data, "Satellite", "VERSION", "1.1");
+        g_key_file_set_string(data, "Satellite", "NAME",
+                              sat_catalogue_str(cat, entry->name));
+        g_key_file_set_string(data, "Satellite", "NICKNAME",
+                              sat_catalogue_str(cat, entry->nickname));
+        website = sat_catalogue_str(cat, entry->website);
+        if (website != NULL)
+            g_key_file_set_string(data, "Satellite", "WEBSITE", website);
+        g_key_file_set_string(data, "Satellite", "TLE1", entry->tle1);
+        g_key_file_set_string(data, "Satellite", "TLE2", entry->tle2);
+        g_key_file_set_integer(data, "Satellite", "STATUS", entry->status);
+
+        fname = g_strdup_printf("%d.sat", entry->catnr);
+        path = g_build_filename(dir, fname, NULL);
+        if (!gpredict_save_key_file(data, path))
+            num++;
+        g_free(path);
+        g_free(fname);
+        g_key_file_free(data);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Exported %d satellites to %s"),
+                __func__, num, dir);
+    if (skipped > 0)
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Skipped %u satellites without TLE lines"),
+                    __func__, skipped);
+    sat_catalogue_unref(cat);
+
+    return num;
+}
@@ -0,0 +1,121 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_CATALOGUE_H
+#define SAT_CATALOGUE_H 1
+
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+
+#define SAT_CAT_MAGIC "GPSATCAT"
+#define SAT_CAT_VERSION 1
+#define SAT_CAT_TLE_LEN 72 /* Room for a TLE line and its terminator */
+
+/*
+ * File header.
+ *
+ * The file is a local cache in host byte order: the header is followed by
+ * count entries of entrysize bytes sorted by catalogue number, and by a table
+ * of NUL terminated strings. Offset 0 of the string table is an empty string,
+ * which stands for a missing one.
+ */
+typedef struct {
+    gchar magic[8];    /* SAT_CAT_MAGIC, not terminated */
+    guint32 version;   /* SAT_CAT_VERSION */
+    guint32 entrysize; /* Size of an entry */
+    guint32 tlesize;   /* Size of the parsed elements in an entry */
+    guint32 count;     /* Number of entries */
+    guint32 strings;   /* File offset of the string table */
+    guint32 strsize;   /* Size of the string table */
+    gint64 created;    /* When the file was written (Unix time) */
+} sat_cat_header_t;
+
+/*
+ * One satellite.
+ *
+ * The elements are stored both as TLE lines, which are what the .sat files
+ * hold, and parsed. The parsed copy is only used if the file was written by
+ * a build with the same tle_t; otherwise the lines are parsed again.
+ * Elements that did not come from TLE lines, e.g. from an OMM, have empty
+ * lines.
+ */
+typedef struct {
+    gint32 catnr;
+    gint32 status;                 /* op_stat_t */
+    gdouble epoch;                 /* Epoch in TLE format */
+    guint32 name;                  /* String table offsets */
+    guint32 nickname;
+    guint32 website;
+    guint32 reserved;
+    gchar tle1[SAT_CAT_TLE_LEN];   /* Validated TLE lines */
+    gchar tle2[SAT_CAT_TLE_LEN];
+    tle_t tle;                     /* Parsed elements */
+} sat_cat_entry_t;
+
+/* A catalogue file in memory; see sat_catalogue_open() */
+typedef struct {
+    gint refcount;
+    GBytes *data;
+    const sat_cat_header_t *header;
+    const gchar *entries;
+    const gchar *strings;
+    gboolean native; /* Whether the parsed elements can be used */
+} sat_catalogue_t;
+
+/* A catalogue being put together; see sat_cat_builder_new() */
+typedef struct {
+    GHashTable *entries; /* Entries keyed by catalogue number */
+} sat_cat_builder_t;
+
+sat_catalogue_t *sat_catalogue_open(const gchar *path);
+sat_catalogue_t *sat_catalogue_ref(sat_catalogue_t *cat);
+void sat_catalogue_unref(sat_catalogue_t *cat);
+
+guint sat_catalogue_size(const sat_catalogue_t *cat);
+const sat_cat_entry_t *sat_catalogue_nth(const sat_catalogue_t *cat, guint i);
+const sat_cat_entry_t *sat_catalogue_lookup(const sat_catalogue_t *cat,
+                                            gint catnr);
+const gchar *sat_catalogue_str(const sat_catalogue_t *cat, guint32 offset);
+gboolean sat_catalogue_get_tle(const sat_catalogue_t *cat,
+                               const sat_cat_entry_t *entry, tle_t *tle);
+
+sat_cat_builder_t *sat_cat_builder_new(void);
+void sat_cat_builder_free(sat_cat_builder_t *builder);
+gboolean sat_cat_builder_add(sat_cat_builder_t *builder, const gchar *name,
+                             const gchar *nickname, const gchar *website,
+                             const gchar *tle1, const gchar *tle2,
+                             gint status);
+gboolean sat_cat_builder_add_elements(sat_cat_builder_t *builder,
+                                      const gchar *name,
+                                      const gchar *nickname,
+                                      const gchar *website, const tle_t *tle,
+                                      gint status);
+gboolean sat_cat_builder_add_entry(sat_cat_builder_t *builder,
+                                   const sat_catalogue_t *cat,
+                                   const sat_cat_entry_t *entry);
+gboolean sat_cat_builder_save(sat_cat_builder_t *builder, const gchar *path);
+
+gchar *sat_catalogue_file_name(void);
+sat_catalogue_t *sat_catalogue_get_default(void);
+gboolean sat_catalogue_commit(sat_cat_builder_t *builder);
+
+gint sat_catalogue_import(const gchar *dir);
+gint sat_catalogue_export(const gchar *dir);
+
+#endif
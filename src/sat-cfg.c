@@ -138,7 +138,8 @@ sat_cfg_bool_t  sat_cfg_bool[SAT_CFG_BOOL_NUM] = {
     {"TLE", "PROXY_AUTH", FALSE},
     {"TLE", "ADD_NEW_SATS", TRUE},
     {"LOG", "KEEP_LOG_FILES", FALSE},
-    {"PREDICT", "USE_REAL_T0", FALSE}
+    {"PREDICT", "USE_REAL_T0", FALSE},
+    {"MODULES", "SHM_FEED", FALSE}
 };
 
 /** Array containing the integer configuration parameters */
@@ -169,6 +170,8 @@ sat_cfg_int_t   sat_cfg_int[SAT_CFG_INT_NUM] = {
     {"MODULES", "MAP_TRACK_COLOUR", 0xFF1200BB},
     {"MODULES", "MAP_TRACK_NUM", 3},
     {"MODULES", "MAP_SHADOW_ALPHA", 0xDD},
+    {"MODULES", "MAP_LOD_THRESHOLD", 1000},
+    {"MODULES", "MAP_CLUSTER_SIZE", 0},
     {"MODULES", "POLAR_REFRESH", 3},
     {"MODULES", "POLAR_CHART_ORIENT", POLAR_VIEW_NESW},
     {"MODULES", "POLAR_BGD_COLOUR", 0xFFFFFFFF},
@@ -211,6 +214,7 @@ sat_cfg_int_t   sat_cfg_int[SAT_CFG_INT_NUM] = {
     {"TLE", "AUTO_UPDATE_FREQ", 2},     /* weekly, see tle_auto_upd_freq_t */
     {"TLE", "AUTO_UPDATE_ACTION", 1},   /* notify, see tle_auto_upd_action_t */
     {"TLE", "LAST_UPDATE", 0},
+    {"TLE", "PARALLEL_DOWNLOADS", 4},
     {"LOG", "CLEAN_AGE", 0},    /* 0 = Never clean */
     {"LOG", "LEVEL", 2}
 };
@@ -59,6 +59,7 @@ typedef enum {
     SAT_CFG_BOOL_TLE_ADD_NEW,   /*!< Add new satellites to database. */
     SAT_CFG_BOOL_KEEP_LOG_FILES,        /*!< Whether to keep old log files */
     SAT_CFG_BOOL_PRED_USE_REAL_T0,      /*!< Whether to use current time as T0 fro predictions */
+    SAT_CFG_BOOL_MOD_SHM_FEED,  /*!< Publish a live tracking feed in shared memory */
     SAT_CFG_BOOL_NUM            /*!< Number of boolean parameters */
 } sat_cfg_bool_e;
 
@@ -90,6 +91,8 @@ typedef enum {
     SAT_CFG_INT_MAP_TRACK_COL,  /*!< Ground Track colour. */
     SAT_CFG_INT_MAP_TRACK_NUM,  /*!< Number of orbits to show ground track for */
     SAT_CFG_INT_MAP_SHADOW_ALPHA,       /*!< Tranparency of shadow under satellite marker. */
+    SAT_CFG_INT_MAP_LOD_THRESHOLD,      /*!< Number of satellites above which the map uses LOD rendering. */
+    SAT_CFG_INT_MAP_CLUSTER_SIZE,       /*!< Cluster cell size in pixels for LOD rendering (0 = off). */
     SAT_CFG_INT_POLAR_REFRESH,  /*!< Polar refresh rate (cycle). */
     SAT_CFG_INT_POLAR_ORIENTATION,      /*!< Orientation of the polar charts. */
     SAT_CFG_INT_POLAR_BGD_COL,  /*!< Polar view, background colour. */
@@ -132,6 +135,7 @@ typedef enum {
     SAT_CFG_INT_TLE_AUTO_UPD_FREQ,      /*!< TLE auto-update frequency. */
     SAT_CFG_INT_TLE_AUTO_UPD_ACTION,    /*!< TLE auto-update action. */
     SAT_CFG_INT_TLE_LAST_UPDATE,        /*!< Date and time of last update, Unix seconds. */
+    SAT_CFG_INT_TLE_PARALLEL,   /*!< Max. number of TLE files fetched at a time. */
     SAT_CFG_INT_LOG_CLEAN_AGE,  /*!< Age of log file to delete (seconds) */
     SAT_CFG_INT_LOG_LEVEL,      /*!< Logging level */
     SAT_CFG_INT_NUM             /*!< Number of integer parameters. */
@@ -0,0 +1,507 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Index of the satellite data for the satellite lists.
+ *
+ * The lists only show the name, catalogue number and epoch of a satellite,
+ * so they do not need satellites that are read and initialised for
+ * propagation. The index takes those fields from the satellite catalogue,
+ * which the TLE updater keeps current, and the category membership from the
+ * .cat files, in one pass. It is kept until either of them changes.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compat.h"
+#include "gpredict-utils.h"
+#include "sat-catalogue.h"
+#include "sat-index.h"
+#include "sat-log.h"
+#include "sat-registry.h"
+
+static GMutex index_lock;
+static sat_index_t *default_index = NULL;
+
+static gint compare_sats(gconstpointer a, gconstpointer b)
+{
+    const sat_index_sat_t *sa = a;
+    const sat_index_sat_t *sb = b;
+
+    return (sa->catnum > sb->catnum) - (sa->catnum < sb->catnum);
+}
+
+static gint compare_cats(gconstpointer a, gconstpointer b)
+{
+    const sat_index_cat_t *ca = *(sat_index_cat_t *const *)a;
+    const sat_index_cat_t *cb = *(sat_index_cat_t *const *)b;
+
+    return gpredict_strcmp(ca->name, cb->name);
+}
+
+static void free_cat(gpointer data)
+{
+    sat_index_cat_t *cat = data;
+
+    g_array_unref(cat->members);
+    g_free(cat);
+}
+
+/*
+ * Summarise the .cat files, so that a change to any of them can be noticed
+ * without reading them.
+ */
+static guint64 get_catstamp(const gchar *dirname)
+{
+    GDir *dir;
+    GStatBuf st;
+    const gchar *fname;
+    gchar *path;
+    guint64 stamp = 0;
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+        return 0;
+
+    /* independent of the order of the files */
+    while ((fname = g_dir_read_name(dir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".cat"))
+            continue;
+
+        path = g_build_filename(dirname, fname, NULL);
+        if (g_stat(path, &st) == 0)
+            stamp += (g_str_hash(fname) + 1) *
+                     ((guint64)st.st_mtime * 1000003u + st.st_size + 1);
+        g_free(path);
+    }
+    g_dir_close(dir);
+
+    return stamp;
+}
+
+static void add_sat(sat_index_t *index, gint catnum, gint status,
+                    gdouble epoch, const gchar *name, const gchar *nickname,
+                    const gchar *idesg)
+{
+    sat_index_sat_t sat;
+    gchar *text, *key;
+
+    if (nickname == NULL)
+        nickname = name;
+
+    /* the newlines keep matches from spanning fields */
+    text = g_strdup_printf("%s\n%s\n%d\n%s", nickname, name ? name : "",
+                           catnum, idesg ? idesg : "");
+    key = g_utf8_casefold(text, -1);
+
+    sat.catnum = catnum;
+    sat.status = status;
+    sat.epoch = epoch;
+    sat.name = g_string_chunk_insert(index->strings, name);
+    sat.nickname = g_string_chunk_insert(index->strings, nickname);
+    sat.idesg = g_string_chunk_insert(index->strings, idesg ? idesg : "");
+    sat.key = g_string_chunk_insert(index->strings, key);
+    g_array_append_val(index->sats, sat);
+
+    g_free(key);
+    g_free(text);
+}
+
+static void add_catalogue_sats(sat_index_t *index, sat_catalogue_t *cat)
+{
+    const sat_cat_entry_t *entry;
+    tle_t tle;
+    gchar idesg[9];
+    guint i;
+
+    /* the catalogue is sorted already */
+    for (i = 0; i < sat_catalogue_size(cat); i++)
+    {
+        entry = sat_catalogue_nth(cat, i);
+
+        /* columns 10-17 of line 1, if there are lines */
+        if (entry->tle1[0] != '\0')
+        {
+            memcpy(idesg, entry->tle1 + 9, 8);
+            idesg[8] = '\0';
+        }
+        else if (sat_catalogue_get_tle(cat, entry, &tle))
+        {
+            g_strlcpy(idesg, tle.idesg, sizeof(idesg));
+        }
+        else
+        {
+            idesg[0] = '\0';
+        }
+        add_sat(index, entry->catnr, entry->status,
+                Julian_Date_of_Epoch(entry->epoch),
+                sat_catalogue_str(cat, entry->name),
+                sat_catalogue_str(cat, entry->nickname), g_strstrip(idesg));
+    }
+}
+
+/* Without a catalogue, the satellites have to be read one by one */
+static void add_sat_files(sat_index_t *index, const gchar *dirname)
+{
+    GDir *dir;
+    const gchar *fname;
+    const sat_t *sat;
+    gint catnum;
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir == NULL)
+        return;
+
+    while ((fname = g_dir_read_name(dir)) != NULL)
+    {
+        if (!g_str_has_suffix(fname, ".sat"))
+            continue;
+
+        catnum = (gint)g_ascii_strtoll(fname, NULL, 10);
+        sat = sat_registry_get(catnum);
+        if (sat == NULL)
+            continue;
+
+        add_sat(index, catnum, sat->tle.status, sat->jul_epoch, sat->name,
+                sat->nickname, sat->tle.idesg);
+        sat_registry_release(sat);
+    }
+    g_dir_close(dir);
+
+    g_array_sort(index->sats, compare_sats);
+}
+
+/*
+ * Read a .cat file: the category name on the first line, followed by one
+ * catalogue number per line.
+ */
+static void add_cat_file(sat_index_t *index, const gchar *dirname,
+                         const gchar *fname)
+{
+    sat_index_cat_t *cat;
+    GError *err = NULL;
+    gchar *path, *contents;
+    gchar **lines;
+    gint catnum;
+    guint i;
+
+    path = g_build_filename(dirname, fname, NULL);
+    if (!g_file_get_contents(path, &contents, NULL, &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to open %s: %s"),
+                    __func__, fname, err->message);
+        g_clear_error(&err);
+        g_free(path);
+        return;
+    }
+    g_free(path);
+
+    lines = g_strsplit(contents, "\n", -1);
+    g_free(contents);
+    if (lines[0] == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to read %s"), __func__,
+                    fname);
+        g_strfreev(lines);
+        return;
+    }
+
+    cat = g_new0(sat_index_cat_t, 1);
+    cat->name = g_string_chunk_insert(index->strings, g_strstrip(lines[0]));
+    cat->file = g_string_chunk_insert(index->strings, fname);
+    cat->members = g_array_new(FALSE, FALSE, sizeof(gint));
+    for (i = 1; lines[i] != NULL; i++)
+    {
+        if (*g_strstrip(lines[i]) == '\0')
+            continue;
+
+        catnum = (gint)g_ascii_strtoll(lines[i], NULL, 0);
+        g_array_append_val(cat->members, catnum);
+    }
+    g_ptr_array_add(index->cats, cat);
+
+    g_strfreev(lines);
+}
+
+/* Build an index, taking over the reference to the catalogue */
+static sat_index_t *build_index(sat_catalogue_t *cat, const gchar *dirname,
+                                guint64 catstamp)
+{
+    sat_index_t *index;
+    GDir *dir;
+    const gchar *fname;
+
+    index = g_new0(sat_index_t, 1);
+    index->refcount = 1;
+    index->sats = g_array_new(FALSE, FALSE, sizeof(sat_index_sat_t));
+    index->cats = g_ptr_array_new_with_free_func(free_cat);
+    index->strings = g_string_chunk_new(4096);
+    index->source = cat;
+    index->catstamp = catstamp;
+    g_mutex_init(&index->lock);
+
+    if (cat != NULL)
+        add_catalogue_sats(index, cat);
+    else
+        add_sat_files(index, dirname);
+
+    dir = g_dir_open(dirname, 0, NULL);
+    if (dir != NULL)
+    {
+        while ((fname = g_dir_read_name(dir)) != NULL)
+            if (g_str_has_suffix(fname, ".cat"))
+                add_cat_file(index, dirname, fname);
+        g_dir_close(dir);
+    }
+    g_ptr_array_sort(index->cats, compare_cats);
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: Indexed %d satellites in %d categories"), __func__,
+                index->sats->len, index->cats->len);
+
+    return index;
+}
+
+/*
+ * Get the index of the current satellite data.
+ *
+ * @return A new reference to the index. It is rebuilt when the satellite
+ *         catalogue or a .cat file has changed since the last call, and
+ *         every time if there is no catalogue.
+ */
+sat_index_t *sat_index_get(void)
+{
+    sat_catalogue_t *cat;
+    sat_index_t *index, *old = NULL;
+    gchar *dirname;
+    guint64 catstamp;
+
+    dirname = get_satdata_dir();
+    catstamp = get_catstamp(dirname);
+    cat = sat_catalogue_get_default();
+
+    g_mutex_lock(&index_lock);
+    if (cat != NULL && default_index != NULL &&
+        default_index->source == cat && default_index->catstamp == catstamp)
+    {
+        index = sat_index_ref(default_index);
+        g_mutex_unlock(&index_lock);
+        sat_catalogue_unref(cat);
+        g_free(dirname);
+        return index;
+    }
+    g_mutex_unlock(&index_lock);
+
+    index = build_index(cat, dirname, catstamp);
+    g_free(dirname);
+
+    g_mutex_lock(&index_lock);
+    old = default_index;
+    default_index = (cat != NULL) ? sat_index_ref(index) : NULL;
+    g_mutex_unlock(&index_lock);
+
+    sat_index_unref(old);
+
+    return index;
+}
+
+sat_index_t *sat_index_ref(sat_index_t *index)
+{
+    g_atomic_int_inc(&index->refcount);
+
+    return index;
+}
+
+void sat_index_unref(sat_index_t *index)
+{
+    if (index == NULL || !g_atomic_int_dec_and_test(&index->refcount))
+        return;
+
+    g_array_unref(index->sats);
+    g_ptr_array_unref(index->cats);
+    g_string_chunk_free(index->strings);
+    sat_catalogue_unref(index->source);
+    if (index->grams != NULL)
+        g_hash_table_destroy(index->grams);
+    g_mutex_clear(&index->lock);
+    g_free(index);
+}
+
+/* Position of a satellite in index->sats; -1 if it is not in the index */
+gint sat_index_find(const sat_index_t *index, gint catnum)
+{
+    const sat_index_sat_t *sat;
+    sat_index_sat_t key;
+
+    key.catnum = catnum;
+    sat = bsearch(&key, index->sats->data, index->sats->len,
+                  sizeof(sat_index_sat_t), compare_sats);
+
+    return sat ? (gint)(sat - (const sat_index_sat_t *)index->sats->data) : -1;
+}
+
+/* Find a satellite; returns NULL if it is not in the index */
+const sat_index_sat_t *sat_index_lookup(const sat_index_t *index,
+                                        gint catnum)
+{
+    gint pos = sat_index_find(index, catnum);
+
+    return pos < 0 ? NULL
+                   : &g_array_index(index->sats, sat_index_sat_t, pos);
+}
+
+/* Turn what the user typed into a key for sat_index_match() */
+gchar *sat_index_search_key(const gchar *text)
+{
+    return g_utf8_casefold(text, -1);
+}
+
+/* Whether the name, nickname, catalogue number or international designator
+   contains the search key */
+gboolean sat_index_match(const sat_index_sat_t *sat, const gchar *key)
+{
+    return strstr(sat->key, key) != NULL;
+}
+
+static guint get_gram(const gchar *s)
+{
+    const guchar *u = (const guchar *)s;
+
+    return (u[0] << 16) | (u[1] << 8) | u[2];
+}
+
+/*
+ * Build the trigram index: for each three byte sequence in the search keys,
+ * the positions of the satellites having it, in increasing order.
+ */
+static void build_grams(sat_index_t *index)
+{
+    const sat_index_sat_t *sat;
+    GArray *list;
+    const gchar *p;
+    guint i, gram;
+
+    index->grams = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                         (GDestroyNotify)g_array_unref);
+
+    for (i = 0; i < index->sats->len; i++)
+    {
+        sat = &g_array_index(index->sats, sat_index_sat_t, i);
+        for (p = sat->key; p[0] && p[1] && p[2]; p++)
+        {
+            if (p[0] == '\n' || p[1] == '\n' || p[2] == '\n')
+                continue;
+
+            gram = get_gram(p);
+            list = g_hash_table_lookup(index->grams, GUINT_TO_POINTER(gram));
+            if (list == NULL)
+            {
+                list = g_array_new(FALSE, FALSE, sizeof(guint));
+                g_hash_table_insert(index->grams, GUINT_TO_POINTER(gram),
+                                    list);
+            }
+            else if (g_array_index(list, guint, list->len - 1) == i)
+            {
+                continue;
+            }
+            g_array_append_val(list, i);
+        }
+    }
+}
+
+/*
+ * Find the satellites matching a search key.
+ *
+ * Keys of three bytes or more only look at the satellites that have the
+ * rarest trigram of the key, so the cost depends on how many satellites
+ * could match rather than on the size of the index. Runs in any thread; the
+ * trigram index is built by the first search.
+ *
+ * @param index The index.
+ * @param key The search key from sat_index_search_key().
+ * @param within The result of an earlier search for a part of the key, which
+ *               is a superset of this one, or NULL.
+ * @return The positions in index->sats of the matching satellites, in
+ *         increasing order.
+ */
+GArray *sat_index_search(sat_index_t *index, const gchar *key,
+                         const GArray *within)
+{
+    const GArray *candidates = within;
+    const GArray *list;
+    GArray *result;
+    gsize i, len = strlen(key);
+    guint pos, n;
+
+    result = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    if (len >= 3)
+    {
+        g_mutex_lock(&index->lock);
+        if (index->grams == NULL)
+            build_grams(index);
+        g_mutex_unlock(&index->lock);
+
+        for (i = 0; i + 3 <= len; i++)
+        {
+            list = g_hash_table_lookup(index->grams,
+                                       GUINT_TO_POINTER(get_gram(key + i)));
+            if (list == NULL)
+                return result;
+
+            if (candidates == NULL || list->len < candidates->len)
+                candidates = list;
+        }
+    }
+
+    n = candidates ? candidates->len : index->sats->len;
+    for (i = 0; i < n; i++)
+    {
+        pos = candidates ? g_array_index(candidates, guint, i) : i;
+        if (sat_index_match(&g_array_index(index->sats, sat_index_sat_t, pos),
+                            key))
+            g_array_append_val(result, pos);
+    }
+
+    return result;
+}
+
+static gint compare_pos(gconstpointer a, gconstpointer b)
+{
+    guint pa = *(const guint *)a;
+    guint pb = *(const guint *)b;
+
+    return (pa > pb) - (pa < pb);
+}
+
+/* Whether a search result has the satellite at a position */
+gboolean sat_index_result_has(const GArray *result, gint pos)
+{
+    guint key = pos;
+
+    return pos >= 0 && bsearch(&key, result->data, result->len, sizeof(guint),
+                               compare_pos) != NULL;
+}
@@ -0,0 +1,76 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_INDEX_H
+#define SAT_INDEX_H 1
+
+#include <glib.h>
+
+#include "sat-catalogue.h"
+
+/* What the satellite lists show and search for a satellite */
+typedef struct {
+    gint catnum;
+    gint status;          /* op_stat_t */
+    gdouble epoch;        /* Epoch of the elements (Julian date) */
+    const gchar *name;
+    const gchar *nickname;
+    const gchar *idesg;   /* International designator */
+    const gchar *key;     /* What searches match; see sat_index_match() */
+} sat_index_sat_t;
+
+/* A satellite category, i.e. a .cat file */
+typedef struct {
+    const gchar *name;    /* Clear text name */
+    const gchar *file;    /* File name without the path */
+    GArray *members;      /* Catalogue numbers (gint) in file order */
+} sat_index_cat_t;
+
+/*
+ * Index of the satellite data; see sat_index_get().
+ *
+ * An index is never modified once built, except for the trigram index used
+ * by sat_index_search(), which is built on first use under the lock. It can
+ * be read from any thread by whoever holds a reference.
+ */
+typedef struct {
+    gint refcount;
+    GArray *sats;         /* sat_index_sat_t sorted by catalogue number */
+    GPtrArray *cats;      /* sat_index_cat_t sorted by name */
+    GStringChunk *strings;
+    sat_catalogue_t *source; /* Catalogue the index was built from, if any */
+    guint64 catstamp;     /* Summary of the .cat files */
+    GMutex lock;          /* Protects grams */
+    GHashTable *grams;    /* Positions in sats (GArray of guint) by trigram */
+} sat_index_t;
+
+sat_index_t *sat_index_get(void);
+sat_index_t *sat_index_ref(sat_index_t *index);
+void sat_index_unref(sat_index_t *index);
+
+gint sat_index_find(const sat_index_t *index, gint catnum);
+const sat_index_sat_t *sat_index_lookup(const sat_index_t *index,
+                                        gint catnum);
+
+gchar *sat_index_search_key(const gchar *text);
+gboolean sat_index_match(const sat_index_sat_t *sat, const gchar *key);
+GArray *sat_index_search(sat_index_t *index, const gchar *key,
+                         const GArray *within);
+gboolean sat_index_result_has(const GArray *result, gint pos);
+
+#endif
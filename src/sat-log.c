@@ -34,7 +34,18 @@
  * choose to keep old log files. In that case the old files are kept
  * under gpredict-X.log file name, where X is the file age in seconds
  * (unix time as returned by g_get_current_time).
- * 
+ *
+ * Messages are not formatted by the thread that logs them. The format
+ * pointer and a copy of the arguments go into a ring owned by the calling
+ * thread, and a writer thread formats them and writes them to the log
+ * file in batches with one flush per batch. A ring has a single producer
+ * and a single consumer and needs no lock; the writer is only woken
+ * through a mutex when it is idle. Messages that do not fit in a full ring
+ * are counted and the count is written to the log. Before the log has
+ * been initialised and after it has been closed, messages are written
+ * synchronously as before. An error message is queued like the others,
+ * but the thread logging it waits until it has been written, so that it
+ * is in the file even if gpredict exits or crashes right after.
  */
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
@@ -43,6 +54,8 @@
 #include <glib/gprintf.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
+#include <stdint.h>
+#include <string.h>
 #include <time.h>
 
 #include "compat.h"
@@ -50,11 +63,90 @@
 #include "sat-log.h"
 
 
+#define LOG_RING_SIZE   (1 << 17)       /* Bytes per thread; power of 2 */
+#define LOG_REC_MAX     (LOG_RING_SIZE / 4)     /* Largest record */
+#define LOG_MAX_ARGS    32      /* Most arguments that can be deferred */
+#define LOG_BATCH_SIZE  (1 << 16)       /* Bytes written per flush */
+#define LOG_IDLE_WAIT   G_USEC_PER_SEC  /* Longest sleep of the writer */
+#define LOG_ALIGN(n)    (((n) + 7) & ~((gsize) 7))
+#define LOG_REC_HDR     LOG_ALIGN(sizeof(log_rec_t))
+#define LOG_PREC_STAR   (-2)
+
+/* Record flags */
+#define LOG_REC_TEXT    1       /* Holds a formatted message, not arguments */
+#define LOG_REC_PAD     2       /* Skips to the start of the ring */
+
+/*
+ * A message in a ring. The header is followed by nargs arguments and by
+ * the strings they refer to, or by the text of the message.
+ */
+typedef struct {
+    guint32         size;       /* Bytes in the record, multiple of 8 */
+    guint16         level;
+    guint16         nargs;
+    guint32         seq;        /* Order of the message among all threads */
+    guint32         flags;
+    gint64          time;       /* g_get_real_time() */
+    const gchar    *fmt;
+} log_rec_t;
+
+/* An argument; strings are stored as offsets into the record, -1 for NULL */
+typedef union {
+    gint64          i;
+    guint64         u;
+    gdouble         d;
+    gconstpointer   p;
+} log_arg_t;
+
+/* A conversion in a format string */
+typedef struct {
+    guint           len;        /* Length, '%' included */
+    guint           prefix;     /* Length up to the length modifier */
+    gboolean        width_star; /* Width given as an argument */
+    gint            prec;       /* Precision, -1 or LOG_PREC_STAR */
+    gchar           length;     /* Length modifier; H is hh and q is ll */
+    gchar           type;       /* i, u, c, f, s, p or % */
+} log_spec_t;
+
+/* The ring of a thread, written by that thread and read by the writer */
+typedef struct {
+    gchar          *buf;
+    gint            head;       /* Write position, moved by the owner */
+    gint            tail;       /* Read position, moved by the writer */
+    gint            dropped;    /* Messages that did not fit */
+    guint           reported;   /* Dropped messages already logged */
+    gint            orphaned;   /* The owner has exited */
+} log_ring_t;
+
+/* Cached formatting of the time of the last message */
+typedef struct {
+    gint64          sec;
+    gchar           str[32];
+} log_clock_t;
+
 static gboolean initialised = FALSE;
 static GIOChannel *logfile = NULL;
 static sat_log_level_t loglevel = SAT_LOG_LEVEL_DEBUG;
 static gboolean debug_to_stderr = FALSE; // whether to also send debug msg to stderr
 
+static GThread *writer = NULL;
+static gint     running = 0;    /* Messages go through the rings */
+static gint     queuing = 0;    /* Threads that may be queueing a message */
+static gint     writer_idle = 0;
+static gint     log_seq = 0;
+static GMutex   wake_lock;
+static GCond    wake_cond;
+static GMutex   rings_lock;     /* Protects rings */
+static GSList  *rings = NULL;
+static GMutex   output_lock;    /* Serialises writes to the log */
+static gint     drains = 0;     /* Passes of the writer over the rings */
+static gboolean writer_done = FALSE;    /* The writer has drained for good */
+static GMutex   flush_lock;     /* Protects drains and writer_done */
+static GCond    flush_cond;
+
+static void     orphan_ring(gpointer data);
+static GPrivate ring_key = G_PRIVATE_INIT(orphan_ring);
+
 /** String representation of debug levels. */
 const gchar    *debug_level_str[] = {
     N_(" --- "),
@@ -64,8 +156,13 @@ const gchar    *debug_level_str[] = {
     N_("DEBUG")
 };
 
-static void     manage_debug_message(sat_log_level_t debug_level,
-                                     const gchar * message);
+static void     start_writer(void);
+static void     stop_writer(void);
+static void     write_message_now(sat_log_level_t level, const gchar * fmt,
+                                  va_list ap);
+static void     queue_message(sat_log_level_t level, const gchar * fmt,
+                              va_list ap);
+static void     flush_rings(void);
 static void     log_rotate(void);
 static void     clean_log_dir(const gchar * dirname, glong age);
 
@@ -78,7 +175,8 @@ static void     clean_log_dir(const gchar * dirname, glong age);
  * creates it.
  * Then, if there is a gpredict.log file it is either deleted or
  * renamed, depending on the sat-cfg settings.
- * Finally, a new gpredict.log file is created and opened.
+ * Finally, a new gpredict.log file is created and opened, and the
+ * writer thread is started.
  */
 void sat_log_init()
 {
@@ -133,6 +231,7 @@ void sat_log_init()
     if (!err)
     {
         initialised = TRUE;
+        start_writer();
         sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Session started"), __func__);
     }
 }
@@ -143,9 +242,13 @@ void sat_log_close()
     if (initialised)
     {
         sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Session ended"), __func__);
+        stop_writer();
+
+        g_mutex_lock(&output_lock);
         g_io_channel_shutdown(logfile, TRUE, NULL);
         g_io_channel_unref(logfile);
         logfile = NULL;
+        g_mutex_unlock(&output_lock);
         initialised = FALSE;
 
         /* Always call log_rotate to get rid of old logs */
@@ -154,13 +257,15 @@ void sat_log_close()
 }
 
 
-/** Log messages from gpredict */
-void sat_log_log(sat_log_level_t level, const gchar * fmt, ...)
+/**
+ * Log messages from gpredict.
+ *
+ * Use sat_log_log(), which leaves out messages above SAT_LOG_MAX_LEVEL at
+ * compile time. Messages above the current log level are dropped here,
+ * before anything is formatted or copied.
+ */
+void sat_log_message(sat_log_level_t level, const gchar * fmt, ...)
 {
-    gchar          *msg;        /* formatted debug message */
-    gchar         **msgv;       /* debug message line by line */
-    guint           numlines;   /* the number of lines in the message */
-    guint           i;
     va_list         ap;
 
     if (level > loglevel)
@@ -168,28 +273,22 @@ void sat_log_log(sat_log_level_t level, const gchar * fmt, ...)
 
     va_start(ap, fmt);
 
-    /* create character string and split it in case
-       it is a multi-line message */
-    msg = g_strdup_vprintf(fmt, ap);
-
-    /* remove trailing \n */
-    g_strchomp(msg);
-
-    /* split the message in case it is a multiline message */
-    msgv = g_strsplit_set(msg, "\n", 0);
-    numlines = g_strv_length(msgv);
-
-    g_free(msg);
-
-    /* for each line in msgv, call the real debug handler
-       which will print the debug message and save it to
-       a logfile
-     */
-    for (i = 0; i < numlines; i++)
-        manage_debug_message(level, msgv[i]);
+    /* counted before the check, so that the writer can wait for it */
+    g_atomic_int_inc(&queuing);
+    if (g_atomic_int_get(&running))
+    {
+        queue_message(level, fmt, ap);
+        g_atomic_int_add(&queuing, -1);
+        if (level == SAT_LOG_LEVEL_ERROR)
+            flush_rings();
+    }
+    else
+    {
+        g_atomic_int_add(&queuing, -1);
+        write_message_now(level, fmt, ap);
+    }
 
     va_end(ap);
-    g_strfreev(msgv);
 }
 
 void sat_log_set_visible(gboolean visible)
@@ -203,35 +302,675 @@ void sat_log_set_level(sat_log_level_t level)
         (level <= SAT_LOG_LEVEL_DEBUG) loglevel = level;
 }
 
-static void manage_debug_message(sat_log_level_t debug_level,
-                                 const gchar * message)
+/**
+ * Parse a conversion of a format string.
+ *
+ * @param p The conversion, starting at the '%'.
+ * @param spec Where to store the result.
+ * @return FALSE if the conversion cannot be deferred; this includes
+ *         positional arguments, %n, long double and wide strings.
+ */
+static gboolean parse_spec(const gchar * p, log_spec_t * spec)
 {
-    gchar          *msg_time;
-    GDateTime      *now;
-    gchar          *msg;
-    gsize           written;
-    GError         *error = NULL;
+    const gchar    *q = p + 1;
+    guint           digits;
+
+    memset(spec, 0, sizeof(*spec));
+    spec->prec = -1;
+
+    if (*q == '%')
+    {
+        spec->len = spec->prefix = 2;
+        spec->type = '%';
+        return TRUE;
+    }
+
+    /* positional arguments, e.g. %1$s */
+    for (digits = 0; g_ascii_isdigit(q[digits]); digits++);
+    if (digits > 0 && q[digits] == '$')
+        return FALSE;
+
+    while (*q != '\0' && strchr("-+ #0'", *q) != NULL)
+        q++;
+
+    if (*q == '*')
+    {
+        spec->width_star = TRUE;
+        q++;
+    }
+    else
+    {
+        for (digits = 0; g_ascii_isdigit(*q); digits++, q++);
+        if (digits > 6)
+            return FALSE;
+    }
+
+    if (*q == '.')
+    {
+        q++;
+        if (*q == '*')
+        {
+            spec->prec = LOG_PREC_STAR;
+            q++;
+        }
+        else
+        {
+            spec->prec = 0;
+            for (digits = 0; g_ascii_isdigit(*q); digits++, q++)
+                spec->prec = spec->prec * 10 + (*q - '0');
+            if (digits > 6)
+                return FALSE;
+        }
+    }
+
+    spec->prefix = q - p;
+
+    switch (*q)
+    {
+    case 'h':
+    case 'l':
+        spec->length = *q++;
+        if (*q == spec->length)
+        {
+            spec->length = spec->length == 'h' ? 'H' : 'q';
+            q++;
+        }
+        break;
+    case 'z':
+    case 'j':
+    case 't':
+    case 'L':
+        spec->length = *q++;
+        break;
+    }
+
+    switch (*q)
+    {
+    case 'd':
+    case 'i':
+        spec->type = 'i';
+        break;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        spec->type = 'u';
+        break;
+    case 'c':
+    case 's':
+    case 'p':
+        if (spec->length != 0)
+            return FALSE;
+        spec->type = *q;
+        break;
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        if (spec->length != 0 && spec->length != 'l')
+            return FALSE;
+        spec->type = 'f';
+        break;
+    default:
+        return FALSE;
+    }
+
+    spec->len = q + 1 - p;
+
+    return TRUE;
+}
+
+/**
+ * Copy the arguments of a message.
+ *
+ * @param fmt The format string.
+ * @param ap The arguments.
+ * @param args Where to store the arguments.
+ * @param strs The strings to copy, by argument; NULL for other arguments.
+ * @param lens The lengths of the strings to copy.
+ * @param nargs Where to store the number of arguments.
+ * @param strsize Where to store the space needed for the strings.
+ * @return FALSE if the message cannot be deferred.
+ */
+static gboolean capture_args(const gchar * fmt, va_list ap, log_arg_t * args,
+                             const gchar ** strs, gsize * lens,
+                             guint * nargs, gsize * strsize)
+{
+    const gchar    *p;
+    const gchar    *str, *end;
+    log_spec_t      spec;
+    guint           n = 0;
+    gint            prec;
+
+    *strsize = 0;
+
+    for (p = strchr(fmt, '%'); p != NULL; p = strchr(p + spec.len, '%'))
+    {
+        if (!parse_spec(p, &spec))
+            return FALSE;
+        if (spec.type == '%')
+            continue;
+        if (n + 3 > LOG_MAX_ARGS)
+            return FALSE;
+
+        if (spec.width_star)
+        {
+            strs[n] = NULL;
+            args[n++].i = va_arg(ap, int);
+        }
+        prec = spec.prec;
+        if (prec == LOG_PREC_STAR)
+        {
+            prec = va_arg(ap, int);
+            strs[n] = NULL;
+            args[n++].i = prec;
+        }
+
+        strs[n] = NULL;
+        switch (spec.type)
+        {
+        case 'i':
+            switch (spec.length)
+            {
+            case 'H':
+                args[n].i = (signed char)va_arg(ap, int);
+                break;
+            case 'h':
+                args[n].i = (short)va_arg(ap, int);
+                break;
+            case 'l':
+                args[n].i = va_arg(ap, long);
+                break;
+            case 'q':
+                args[n].i = va_arg(ap, long long);
+                break;
+            case 'z':
+                args[n].i = va_arg(ap, gssize);
+                break;
+            case 'j':
+                args[n].i = va_arg(ap, intmax_t);
+                break;
+            case 't':
+                args[n].i = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                args[n].i = va_arg(ap, int);
+            }
+            break;
+        case 'u':
+            switch (spec.length)
+            {
+            case 'H':
+                args[n].u = (unsigned char)va_arg(ap, unsigned int);
+                break;
+            case 'h':
+                args[n].u = (unsigned short)va_arg(ap, unsigned int);
+                break;
+            case 'l':
+                args[n].u = va_arg(ap, unsigned long);
+                break;
+            case 'q':
+                args[n].u = va_arg(ap, unsigned long long);
+                break;
+            case 'z':
+                args[n].u = va_arg(ap, gsize);
+                break;
+            case 'j':
+                args[n].u = va_arg(ap, uintmax_t);
+                break;
+            case 't':
+                args[n].u = va_arg(ap, ptrdiff_t);
+                break;
+            default:
+                args[n].u = va_arg(ap, unsigned int);
+            }
+            break;
+        case 'c':
+            args[n].i = va_arg(ap, int);
+            break;
+        case 'f':
+            args[n].d = va_arg(ap, double);
+            break;
+        case 'p':
+            args[n].p = va_arg(ap, gpointer);
+            break;
+        case 's':
+            str = va_arg(ap, const gchar *);
+            args[n].i = -1;
+            if (str != NULL)
+            {
+                /* with a precision the string need not be terminated */
+                end = prec >= 0 ? memchr(str, '\0', prec) : NULL;
+                if (prec >= 0)
+                    lens[n] = end != NULL ? (gsize) (end - str) : (gsize) prec;
+                else
+                    lens[n] = strlen(str);
+                strs[n] = str;
+                *strsize += lens[n] + 1;
+            }
+            break;
+        }
+        n++;
+    }
+
+    *nargs = n;
+
+    return TRUE;
+}
+
+/**
+ * Get the ring of the calling thread.
+ *
+ * The ring is created and handed to the writer the first time a thread
+ * logs a message.
+ */
+static log_ring_t *get_ring(void)
+{
+    log_ring_t     *ring = g_private_get(&ring_key);
+
+    if (G_UNLIKELY(ring == NULL))
+    {
+        ring = g_new0(log_ring_t, 1);
+        ring->buf = g_malloc(LOG_RING_SIZE);
+        g_private_set(&ring_key, ring);
+
+        g_mutex_lock(&rings_lock);
+        rings = g_slist_prepend(rings, ring);
+        g_mutex_unlock(&rings_lock);
+    }
+
+    return ring;
+}
+
+/** Mark the ring of an exiting thread; the writer frees it once drained. */
+static void orphan_ring(gpointer data)
+{
+    log_ring_t     *ring = data;
+
+    g_atomic_int_set(&ring->orphaned, 1);
+}
+
+/**
+ * Reserve space for a record.
+ *
+ * @param ring The ring of the calling thread.
+ * @param size The size of the record.
+ * @param head Where to store the write position after the record.
+ * @return The record, or NULL if the ring is full.
+ *
+ * A record does not wrap around the end of the ring. If it does not fit
+ * before the end, a padding record tells the writer to skip to the start;
+ * if not even a header fits, the writer skips without one.
+ */
+static log_rec_t *ring_reserve(log_ring_t * ring, guint size, guint * head)
+{
+    guint           pos = (guint) ring->head;
+    guint           tail = (guint) g_atomic_int_get(&ring->tail);
+    guint           off = pos & (LOG_RING_SIZE - 1);
+    guint           room = LOG_RING_SIZE - off;
+    guint           need = room < size ? room + size : size;
+    log_rec_t      *pad;
+
+    if (LOG_RING_SIZE - (pos - tail) < need)
+        return NULL;
+
+    if (room < size)
+    {
+        if (room >= LOG_REC_HDR)
+        {
+            pad = (log_rec_t *) (ring->buf + off);
+            pad->size = room;
+            pad->flags = LOG_REC_PAD;
+        }
+        pos += room;
+        off = 0;
+    }
+
+    *head = pos + size;
+
+    return (log_rec_t *) (ring->buf + off);
+}
+
+/** Get the oldest record of a ring, or NULL if it is empty. */
+static log_rec_t *ring_peek(log_ring_t * ring)
+{
+    guint           head = (guint) g_atomic_int_get(&ring->head);
+    guint           tail = (guint) ring->tail;
+    guint           off, room;
+    log_rec_t      *rec = NULL;
+
+    while (tail != head)
+    {
+        off = tail & (LOG_RING_SIZE - 1);
+        room = LOG_RING_SIZE - off;
+        if (room < LOG_REC_HDR)
+        {
+            tail += room;
+            continue;
+        }
+
+        rec = (log_rec_t *) (ring->buf + off);
+        if (!(rec->flags & LOG_REC_PAD))
+            break;
+
+        tail += rec->size;
+        rec = NULL;
+    }
+
+    if (tail != (guint) ring->tail)
+        g_atomic_int_set(&ring->tail, (gint) tail);
+
+    return rec;
+}
+
+/** Release the oldest record of a ring to its owner. */
+static void ring_pop(log_ring_t * ring, const log_rec_t * rec)
+{
+    g_atomic_int_set(&ring->tail, (gint) ((guint) ring->tail + rec->size));
+}
+
+static void wake_writer(void)
+{
+    g_mutex_lock(&wake_lock);
+    g_cond_signal(&wake_cond);
+    g_mutex_unlock(&wake_lock);
+}
+
+/** Copy a message into the ring of the calling thread. */
+static void queue_message(sat_log_level_t level, const gchar * fmt,
+                          va_list ap)
+{
+    log_ring_t     *ring = get_ring();
+    log_rec_t      *rec;
+    log_arg_t      *recargs;
+    log_arg_t       args[LOG_MAX_ARGS];
+    const gchar    *strs[LOG_MAX_ARGS];
+    gsize           lens[LOG_MAX_ARGS];
+    gchar          *text = NULL;
+    gchar          *dest;
+    gsize           size, strsize, len = 0;
+    guint           nargs = 0;
+    guint           head, i;
+    gboolean        captured;
+    va_list         aq;
+
+    G_VA_COPY(aq, ap);
+    captured = capture_args(fmt, aq, args, strs, lens, &nargs, &strsize);
+    va_end(aq);
+
+    size = LOG_REC_HDR + nargs * sizeof(log_arg_t) + strsize;
+    if (G_UNLIKELY(!captured || size > LOG_REC_MAX))
+    {
+        /* format it here and keep as much of it as fits */
+        text = g_strdup_vprintf(fmt, ap);
+        len = MIN(strlen(text), LOG_REC_MAX - LOG_REC_HDR - 1);
+        while (len > 0 && (text[len] & 0xC0) == 0x80)
+            len--;
+        nargs = 0;
+        size = LOG_REC_HDR + len + 1;
+    }
+
+    rec = ring_reserve(ring, LOG_ALIGN(size), &head);
+    if (G_UNLIKELY(rec == NULL))
+    {
+        g_atomic_int_inc(&ring->dropped);
+        g_free(text);
+        return;
+    }
+
+    rec->size = LOG_ALIGN(size);
+    rec->level = level;
+    rec->nargs = nargs;
+    rec->seq = (guint32) g_atomic_int_add(&log_seq, 1);
+    rec->time = g_get_real_time();
+    rec->fmt = fmt;
+    dest = (gchar *) rec + LOG_REC_HDR;
+
+    if (text != NULL)
+    {
+        rec->flags = LOG_REC_TEXT;
+        memcpy(dest, text, len);
+        dest[len] = '\0';
+        g_free(text);
+    }
+    else
+    {
+        rec->flags = 0;
+        recargs = (log_arg_t *) dest;
+        dest += nargs * sizeof(log_arg_t);
+        for (i = 0; i < nargs; i++)
+        {
+            recargs[i] = args[i];
+            if (strs[i] != NULL)
+            {
+                recargs[i].i = dest - (gchar *) rec;
+                memcpy(dest, strs[i], lens[i]);
+                dest[lens[i]] = '\0';
+                dest += lens[i] + 1;
+            }
+        }
+    }
+
+    /* the atomic operations are full barriers */
+    g_atomic_int_set(&ring->head, (gint) head);
+
+    if (g_atomic_int_get(&writer_idle))
+        wake_writer();
+}
+
+/**
+ * Wait until the messages queued by the calling thread have been written.
+ *
+ * The pass of the writer under way may have missed them, the next one
+ * has not.
+ */
+static void flush_rings(void)
+{
+    gint            target;
+
+    g_mutex_lock(&flush_lock);
+    target = drains + 2;
+    g_mutex_unlock(&flush_lock);
+
+    wake_writer();
+
+    g_mutex_lock(&flush_lock);
+    while (drains - target < 0 && !writer_done)
+        g_cond_wait(&flush_cond, &flush_lock);
+    g_mutex_unlock(&flush_lock);
+}
+
+/** Count a pass of the writer over the rings and wake the flushing threads. */
+static void drained(gboolean done)
+{
+    g_mutex_lock(&flush_lock);
+    drains++;
+    writer_done = done;
+    g_cond_broadcast(&flush_cond);
+    g_mutex_unlock(&flush_lock);
+}
+
+/**
+ * Format a record.
+ *
+ * @param msg Where to append the message.
+ * @param rec The record.
+ *
+ * Each conversion is formatted on its own with the arguments that were
+ * copied. Integers are formatted as long long since they were widened
+ * when they were copied, and arguments for '*' are written into the
+ * conversion.
+ */
+static void format_record(GString * msg, const log_rec_t * rec)
+{
+    const log_arg_t *args;
+    const gchar    *p, *q, *c;
+    log_spec_t      spec;
+    gchar           conv[64];
+    gsize           len;
+    guint           n = 0;
+    gint            value;
+
+    if (rec->flags & LOG_REC_TEXT)
+    {
+        g_string_append(msg, (const gchar *)rec + LOG_REC_HDR);
+        return;
+    }
+
+    args = (const log_arg_t *)((const gchar *)rec + LOG_REC_HDR);
+
+    for (p = rec->fmt; (q = strchr(p, '%')) != NULL; p = q + spec.len)
+    {
+        g_string_append_len(msg, p, q - p);
+        parse_spec(q, &spec);
+
+        if (spec.type == '%')
+        {
+            g_string_append_c(msg, '%');
+            continue;
+        }
+
+        /* the conversion up to the length modifier, with '*' resolved */
+        len = 0;
+        for (c = q; c < q + spec.prefix; c++)
+        {
+            if (*c == '.' && c[1] == '*' && args[n].i < 0)
+            {
+                /* a negative precision is taken as omitted */
+                c++;
+                n++;
+            }
+            else if (*c == '*')
+            {
+                value = (gint) args[n++].i;
+                len += g_snprintf(conv + len, sizeof(conv) - len, "%d",
+                                  value);
+            }
+            else
+            {
+                conv[len++] = *c;
+            }
+        }
+
+        if (spec.type == 'i' || spec.type == 'u')
+        {
+            conv[len++] = 'l';
+            conv[len++] = 'l';
+            conv[len++] = q[spec.len - 1];
+        }
+        else
+        {
+            memcpy(conv + len, q + spec.prefix, spec.len - spec.prefix);
+            len += spec.len - spec.prefix;
+        }
+        conv[len] = '\0';
+
+        switch (spec.type)
+        {
+        case 'i':
+            g_string_append_printf(msg, conv, (long long)args[n].i);
+            break;
+        case 'u':
+            g_string_append_printf(msg, conv, (unsigned long long)args[n].u);
+            break;
+        case 'c':
+            g_string_append_printf(msg, conv, (int)args[n].i);
+            break;
+        case 'f':
+            g_string_append_printf(msg, conv, args[n].d);
+            break;
+        case 'p':
+            g_string_append_printf(msg, conv, args[n].p);
+            break;
+        case 's':
+            g_string_append_printf(msg, conv, args[n].i < 0 ? NULL :
+                                   (const gchar *)rec + args[n].i);
+            break;
+        }
+        n++;
+    }
+
+    g_string_append(msg, p);
+}
+
+/** Format a time stamp, reusing the last one within the same second. */
+static const gchar *format_time(log_clock_t * clock, gint64 time)
+{
+    GDateTime      *dt;
+    gchar          *str;
+    gint64          sec = time / G_USEC_PER_SEC;
+
+    if (sec != clock->sec)
+    {
+        dt = g_date_time_new_from_unix_local(sec);
+        str = g_date_time_format(dt, "%Y/%m/%d %H:%M:%S");
+        g_strlcpy(clock->str, str != NULL ? str : "", sizeof(clock->str));
+        g_free(str);
+        g_date_time_unref(dt);
+        clock->sec = sec;
+    }
+
+    return clock->str;
+}
+
+/**
+ * Append a message to the output, one log line per line of the message.
+ *
+ * @param out The output.
+ * @param clock The time stamp cache of the caller.
+ * @param time The time of the message.
+ * @param level The level of the message.
+ * @param msg The message; trailing white space is removed.
+ */
+static void append_message(GString * out, log_clock_t * clock, gint64 time,
+                           sat_log_level_t level, GString * msg)
+{
+    const gchar    *msg_time = format_time(clock, time);
+    const gchar    *line, *end;
 
-    /* get the time */
-    now = g_date_time_new_now_local();
-    msg_time = g_date_time_format(now, "%Y/%m/%d %H:%M:%S");
-    g_date_time_unref(now);
+    while (msg->len > 0 && g_ascii_isspace(msg->str[msg->len - 1]))
+        g_string_truncate(msg, msg->len - 1);
 
-    /* send debug messages to stderr */
-    if G_UNLIKELY(debug_to_stderr)
-            g_fprintf(stderr, "%s  %s  %s\n", msg_time,
-                      debug_level_str[debug_level], message);
+    for (line = msg->str;; line = end + 1)
+    {
+        end = strchr(line, '\n');
+        if (end == NULL)
+            end = line + strlen(line);
+
+        /* send debug messages to stderr */
+        if G_UNLIKELY(debug_to_stderr)
+            g_fprintf(stderr, "%s  %s  %.*s\n", msg_time,
+                      debug_level_str[level], (int)(end - line), line);
+
+        g_string_append_printf(out, "%s%s%d%s", msg_time,
+                               SAT_LOG_MSG_SEPARATOR, level,
+                               SAT_LOG_MSG_SEPARATOR);
+        g_string_append_len(out, line, end - line);
+        g_string_append_c(out, '\n');
+
+        if (*end == '\0')
+            break;
+    }
+}
 
-    msg = g_strdup_printf("%s%s%d%s%s\n", msg_time, SAT_LOG_MSG_SEPARATOR,
-                          debug_level, SAT_LOG_MSG_SEPARATOR, message);
+/** Write the output to the log file, or to stderr if there is none. */
+static void write_output(GString * out)
+{
+    gsize           written;
+    GError         *error = NULL;
 
-    g_free(msg_time);
+    if (out->len == 0)
+        return;
 
-    /* print debug message */
-    if G_LIKELY(initialised)
+    g_mutex_lock(&output_lock);
+    if G_LIKELY(logfile != NULL)
     {
-        /* save to file */
-        g_io_channel_write_chars(logfile, msg, -1, &written, &error);
+        g_io_channel_write_chars(logfile, out->str, out->len, &written,
+                                 &error);
         if G_UNLIKELY
             (error != NULL)
         {
@@ -242,11 +981,182 @@ static void manage_debug_message(sat_log_level_t debug_level,
     }
     else
     {
-        /* send to stderr */
-        g_fprintf(stderr, "%s", msg);
+        g_fprintf(stderr, "%s", out->str);
+    }
+    g_mutex_unlock(&output_lock);
+
+    g_string_truncate(out, 0);
+}
+
+/** Format and write a message on the calling thread. */
+static void write_message_now(sat_log_level_t level, const gchar * fmt,
+                              va_list ap)
+{
+    log_clock_t     clock = { -1, "" };
+    GString        *msg = g_string_new(NULL);
+    GString        *out = g_string_new(NULL);
+
+    g_string_vprintf(msg, fmt, ap);
+    append_message(out, &clock, g_get_real_time(), level, msg);
+    write_output(out);
+
+    g_string_free(msg, TRUE);
+    g_string_free(out, TRUE);
+}
+
+/**
+ * Write the messages in the rings.
+ *
+ * @param out Output buffer.
+ * @param msg Message buffer.
+ * @param clock Time stamp cache.
+ *
+ * The rings are merged in the order the messages were logged.
+ */
+static void drain_rings(GString * out, GString * msg, log_clock_t * clock)
+{
+    static GPtrArray *active = NULL;
+    GSList         *node, *next;
+    log_ring_t     *ring, *best;
+    log_rec_t      *rec, *first;
+    guint           i, dropped;
+
+    if (active == NULL)
+        active = g_ptr_array_new();
+    g_ptr_array_set_size(active, 0);
+
+    /* free the rings of threads that have exited once they are empty */
+    g_mutex_lock(&rings_lock);
+    for (node = rings; node != NULL; node = next)
+    {
+        next = node->next;
+        ring = node->data;
+        if (g_atomic_int_get(&ring->orphaned) && ring_peek(ring) == NULL &&
+            (guint) g_atomic_int_get(&ring->dropped) == ring->reported)
+        {
+            rings = g_slist_delete_link(rings, node);
+            g_free(ring->buf);
+            g_free(ring);
+        }
+        else
+        {
+            g_ptr_array_add(active, ring);
+        }
+    }
+    g_mutex_unlock(&rings_lock);
+
+    for (;;)
+    {
+        best = NULL;
+        first = NULL;
+        for (i = 0; i < active->len; i++)
+        {
+            ring = g_ptr_array_index(active, i);
+            rec = ring_peek(ring);
+            if (rec != NULL &&
+                (first == NULL || (gint32) (rec->seq - first->seq) < 0))
+            {
+                best = ring;
+                first = rec;
+            }
+        }
+        if (best == NULL)
+            break;
+
+        g_string_truncate(msg, 0);
+        format_record(msg, first);
+        append_message(out, clock, first->time, first->level, msg);
+        ring_pop(best, first);
+
+        if (out->len >= LOG_BATCH_SIZE)
+            write_output(out);
+    }
+
+    for (i = 0; i < active->len; i++)
+    {
+        ring = g_ptr_array_index(active, i);
+        dropped = (guint) g_atomic_int_get(&ring->dropped);
+        if G_UNLIKELY(dropped != ring->reported)
+        {
+            g_string_printf(msg, _("%s: Dropped %u messages"), __func__,
+                            dropped - ring->reported);
+            append_message(out, clock, g_get_real_time(),
+                           SAT_LOG_LEVEL_WARN, msg);
+            ring->reported = dropped;
+        }
+    }
+
+    write_output(out);
+}
+
+/** Writer thread. */
+static gpointer log_writer(gpointer data)
+{
+    log_clock_t     clock = { -1, "" };
+    GString        *out = g_string_sized_new(LOG_BATCH_SIZE);
+    GString        *msg = g_string_new(NULL);
+    gboolean        pending;
+    GSList         *node;
+
+    (void)data;
+
+    while (g_atomic_int_get(&running))
+    {
+        drain_rings(out, msg, &clock);
+        drained(FALSE);
+
+        /*
+           A thread that queues a message after the check below sees
+           writer_idle set and signals under wake_lock, so the signal
+           cannot be missed.
+         */
+        g_mutex_lock(&wake_lock);
+        g_atomic_int_set(&writer_idle, 1);
+
+        pending = FALSE;
+        g_mutex_lock(&rings_lock);
+        for (node = rings; node != NULL && !pending; node = node->next)
+            pending = ring_peek(node->data) != NULL;
+        g_mutex_unlock(&rings_lock);
+
+        if (!pending && g_atomic_int_get(&running))
+            g_cond_wait_until(&wake_cond, &wake_lock,
+                              g_get_monotonic_time() + LOG_IDLE_WAIT);
+
+        g_atomic_int_set(&writer_idle, 0);
+        g_mutex_unlock(&wake_lock);
     }
 
-    g_free(msg);
+    /*
+       A thread that saw running set may still be queueing a message. Wait
+       for those before the last drain; later messages are written directly.
+     */
+    while (g_atomic_int_get(&queuing) > 0)
+        g_thread_yield();
+
+    drain_rings(out, msg, &clock);
+    drained(TRUE);
+
+    g_string_free(out, TRUE);
+    g_string_free(msg, TRUE);
+
+    return NULL;
+}
+
+static void start_writer(void)
+{
+    writer_done = FALSE;
+    g_atomic_int_set(&running, 1);
+    writer = g_thread_new("sat-log", log_writer, NULL);
+}
+
+/** Stop the writer once it has written the queued messages. */
+static void stop_writer(void)
+{
+    g_atomic_int_set(&running, 0);
+    wake_writer();
+    g_thread_join(writer);
+    writer = NULL;
 }
 
 /** Perform log rotation and other maintenance in log directory */
@@ -37,9 +37,24 @@ typedef enum {
     SAT_LOG_LEVEL_DEBUG = 4
 } sat_log_level_t;
 
+/*
+ * Messages above SAT_LOG_MAX_LEVEL are left out at compile time, e.g.
+ * with -DSAT_LOG_MAX_LEVEL=SAT_LOG_LEVEL_INFO, and their arguments are not
+ * evaluated.
+ */
+#ifndef SAT_LOG_MAX_LEVEL
+#define SAT_LOG_MAX_LEVEL SAT_LOG_LEVEL_DEBUG
+#endif
+
+#define sat_log_log(level, ...)                         \
+    do {                                                \
+        if ((level) <= SAT_LOG_MAX_LEVEL)               \
+            sat_log_message(level, __VA_ARGS__);        \
+    } while (0)
+
 void            sat_log_init(void);
 void            sat_log_close(void);
-void            sat_log_log(sat_log_level_t level, const char *fmt, ...);
+void            sat_log_message(sat_log_level_t level, const char *fmt, ...);
 void            sat_log_set_visible(gboolean visible);
 void            sat_log_set_level(sat_log_level_t level);
 
@@ -51,6 +51,9 @@ static GtkWidget *orbit;
 /* map center spin box */
 static GtkWidget *center;
 
+/* level-of-detail spin boxes */
+static GtkWidget *lodthld, *clustsz;
+
 /* misc bookkeeping */
 static gboolean dirty = FALSE;
 static gboolean reset = FALSE;
@@ -106,6 +109,14 @@ static void center_changed(GtkWidget * spin, gpointer data)
     dirty = TRUE;
 }
 
+static void lod_changed(GtkWidget * spin, gpointer data)
+{
+    (void)spin;
+    (void)data;
+
+    dirty = TRUE;
+}
+
 static gboolean shadow_changed(GtkRange * range, GtkScrollType scroll,
                                gdouble value, gpointer data)
 {
@@ -264,6 +275,14 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         /* center longitude */
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(center),
                                   sat_cfg_get_int_def(SAT_CFG_INT_MAP_CENTER));
+
+        /* level of detail */
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(lodthld),
+                                  sat_cfg_get_int_def
+                                  (SAT_CFG_INT_MAP_LOD_THRESHOLD));
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(clustsz),
+                                  sat_cfg_get_int_def
+                                  (SAT_CFG_INT_MAP_CLUSTER_SIZE));
     }
     else
     {
@@ -353,6 +372,14 @@ static void reset_cb(GtkWidget * button, gpointer cfg)
         /* center longitude */
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(center),
                                   sat_cfg_get_int(SAT_CFG_INT_MAP_CENTER));
+
+        /* level of detail */
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(lodthld),
+                                  sat_cfg_get_int
+                                  (SAT_CFG_INT_MAP_LOD_THRESHOLD));
+        gtk_spin_button_set_value(GTK_SPIN_BUTTON(clustsz),
+                                  sat_cfg_get_int
+                                  (SAT_CFG_INT_MAP_CLUSTER_SIZE));
     }
 
     /* map file */
@@ -498,6 +525,16 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
                                    MOD_CFG_MAP_CENTER,
                                    gtk_spin_button_get_value_as_int
                                    (GTK_SPIN_BUTTON(center)));
+
+            /* level of detail */
+            g_key_file_set_integer(cfg, MOD_CFG_MAP_SECTION,
+                                   MOD_CFG_MAP_LOD_THRESHOLD,
+                                   gtk_spin_button_get_value_as_int
+                                   (GTK_SPIN_BUTTON(lodthld)));
+            g_key_file_set_integer(cfg, MOD_CFG_MAP_SECTION,
+                                   MOD_CFG_MAP_CLUSTER_SIZE,
+                                   gtk_spin_button_get_value_as_int
+                                   (GTK_SPIN_BUTTON(clustsz)));
         }
         else
         {
@@ -590,6 +627,14 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
             sat_cfg_set_int(SAT_CFG_INT_MAP_CENTER,
                             gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
                                                              (center)));
+
+            /* level of detail */
+            sat_cfg_set_int(SAT_CFG_INT_MAP_LOD_THRESHOLD,
+                            gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
+                                                             (lodthld)));
+            sat_cfg_set_int(SAT_CFG_INT_MAP_CLUSTER_SIZE,
+                            gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON
+                                                             (clustsz)));
         }
 
         dirty = FALSE;
@@ -656,6 +701,12 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
             g_key_file_remove_key(cfg,
                                   MOD_CFG_MAP_SECTION,
                                   MOD_CFG_MAP_CENTER, NULL);
+            g_key_file_remove_key(cfg,
+                                  MOD_CFG_MAP_SECTION,
+                                  MOD_CFG_MAP_LOD_THRESHOLD, NULL);
+            g_key_file_remove_key(cfg,
+                                  MOD_CFG_MAP_SECTION,
+                                  MOD_CFG_MAP_CLUSTER_SIZE, NULL);
         }
         else
         {
@@ -691,6 +742,10 @@ void sat_pref_map_view_ok(GKeyFile * cfg)
 
             /* map center */
             sat_cfg_reset_int(SAT_CFG_INT_MAP_CENTER);
+
+            /* level of detail */
+            sat_cfg_reset_int(SAT_CFG_INT_MAP_LOD_THRESHOLD);
+            sat_cfg_reset_int(SAT_CFG_INT_MAP_CLUSTER_SIZE);
         }
         reset = FALSE;
     }
@@ -1423,6 +1478,94 @@ static void create_center_selector(GKeyFile * cfg, GtkBox * vbox)
     gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
 }
 
+/**
+ * Create level-of-detail selector widgets.
+ *
+ * @param cfg The module configuration or NULL in global mode.
+ * @param vbox The container box in which the widgets should be packed into.
+ *
+ * This function creates the widgets for selecting the number of satellites
+ * above which the map switches to point sprites, and the size of the cells
+ * used to aggregate dense regions into count bubbles.
+ *
+ */
+static void create_lod_selector(GKeyFile * cfg, GtkBox * vbox)
+{
+    GtkWidget      *label;
+    GtkWidget      *hbox;
+    gint            val;
+
+    hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_box_set_homogeneous(GTK_BOX(hbox), FALSE);
+    gtk_box_pack_start(vbox, hbox, FALSE, TRUE, 0);
+
+    label = gtk_label_new(_("Simplify map above"));
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    lodthld = gtk_spin_button_new_with_range(0, 100000, 100);
+    gtk_widget_set_tooltip_text(lodthld,
+                                _("Above this number of satellites only the "
+                                  "selected and tracked satellites get labels "
+                                  "and footprints. Set to 0 to disable."));
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(lodthld), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(lodthld), TRUE);
+
+    if (cfg != NULL)
+    {
+        val = mod_cfg_get_int(cfg,
+                              MOD_CFG_MAP_SECTION,
+                              MOD_CFG_MAP_LOD_THRESHOLD,
+                              SAT_CFG_INT_MAP_LOD_THRESHOLD);
+    }
+    else
+    {
+        val = sat_cfg_get_int(SAT_CFG_INT_MAP_LOD_THRESHOLD);
+    }
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(lodthld), val);
+    g_signal_connect(G_OBJECT(lodthld), "value-changed",
+                     G_CALLBACK(lod_changed), NULL);
+
+    gtk_box_pack_start(GTK_BOX(hbox), lodthld, FALSE, FALSE, 0);
+
+    label = gtk_label_new(_("satellites"));
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_box_set_homogeneous(GTK_BOX(hbox), FALSE);
+    gtk_box_pack_start(vbox, hbox, FALSE, TRUE, 0);
+
+    label = gtk_label_new(_("Cluster dense regions in cells of"));
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+
+    clustsz = gtk_spin_button_new_with_range(0, SAT_MAP_LOD_MAX_CLUSTER, 1);
+    gtk_widget_set_tooltip_text(clustsz,
+                                _("Size of the cells used to aggregate "
+                                  "satellites into count bubbles when the "
+                                  "map is simplified. Set to 0 to disable."));
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(clustsz), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(clustsz), TRUE);
+
+    if (cfg != NULL)
+    {
+        val = mod_cfg_get_int(cfg,
+                              MOD_CFG_MAP_SECTION,
+                              MOD_CFG_MAP_CLUSTER_SIZE,
+                              SAT_CFG_INT_MAP_CLUSTER_SIZE);
+    }
+    else
+    {
+        val = sat_cfg_get_int(SAT_CFG_INT_MAP_CLUSTER_SIZE);
+    }
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(clustsz), val);
+    g_signal_connect(G_OBJECT(clustsz), "value-changed",
+                     G_CALLBACK(lod_changed), NULL);
+
+    gtk_box_pack_start(GTK_BOX(hbox), clustsz, FALSE, FALSE, 0);
+
+    label = gtk_label_new(_("pixels"));
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+}
+
 /**
  * Create RESET button.
  *
@@ -1489,6 +1632,7 @@ GtkWidget      *sat_pref_map_view_create(GKeyFile * cfg)
                        FALSE, TRUE, 5);
     create_orbit_selector(cfg, GTK_BOX(vbox));
     create_center_selector(cfg, GTK_BOX(vbox));
+    create_lod_selector(cfg, GTK_BOX(vbox));
     gtk_box_pack_start(GTK_BOX(vbox),
                        gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
                        FALSE, TRUE, 5);
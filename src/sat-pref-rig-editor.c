@@ -43,6 +43,8 @@ static GtkWidget *lo;           /* local oscillator of downconverter */
 static GtkWidget *loup;         /* local oscillator of upconverter */
 static GtkWidget *sigaos;       /* AOS signalling */
 static GtkWidget *siglos;       /* LOS signalling */
+static GtkWidget *tol;          /* Doppler tolerance */
+static GtkWidget *step;         /* tuning step */
 
 
 static void clear_widgets()
@@ -58,6 +60,8 @@ static void clear_widgets()
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(ptt), FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(sigaos), FALSE);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(siglos), FALSE);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tol), 10);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(step), 1);
 }
 
 static void update_widgets(radio_conf_t * conf)
@@ -103,6 +107,10 @@ static void update_widgets(radio_conf_t * conf)
     /* AOS / LOS signalling */
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(sigaos), conf->signal_aos);
     gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(siglos), conf->signal_los);
+
+    /* Doppler tolerance and tuning step in Hz */
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tol), conf->tolerance);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(step), conf->step);
 }
 
 /*
@@ -436,6 +444,43 @@ static GtkWidget *create_editor_widgets(radio_conf_t * conf)
     gtk_widget_set_tooltip_text(siglos,
                                 _("Enable LOS signalling for this radio."));
 
+    /* Doppler tolerance */
+    label = gtk_label_new(_("Tolerance"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 9, 1, 1);
+
+    tol = gtk_spin_button_new_with_range(1, 10000, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(tol), 10);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(tol), 0);
+    gtk_widget_set_tooltip_text(tol,
+                                _
+                                ("Largest frequency error that is tolerated "
+                                 "before a new frequency is sent to the radio."));
+    gtk_grid_attach(GTK_GRID(table), tol, 1, 9, 2, 1);
+
+    label = gtk_label_new(_("Hz"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 3, 9, 1, 1);
+
+    /* Tuning step */
+    label = gtk_label_new(_("Tuning step"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 10, 1, 1);
+
+    step = gtk_spin_button_new_with_range(1, 10000, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(step), 1);
+    gtk_spin_button_set_digits(GTK_SPIN_BUTTON(step), 0);
+    gtk_widget_set_tooltip_text(step,
+                                _
+                                ("Smallest frequency step of the radio. "
+                                 "Frequencies sent to the radio are rounded "
+                                 "to this step."));
+    gtk_grid_attach(GTK_GRID(table), step, 1, 10, 2, 1);
+
+    label = gtk_label_new(_("Hz"));
+    g_object_set(label, "xalign", 0.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 3, 10, 1, 1);
+
     if (conf->name != NULL)
         update_widgets(conf);
 
@@ -511,6 +556,10 @@ static gboolean apply_changes(radio_conf_t * conf)
     conf->signal_aos = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(sigaos));
     conf->signal_los = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(siglos));
 
+    /* Doppler tolerance and tuning step */
+    conf->tolerance = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(tol));
+    conf->step = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(step));
+
     return TRUE;
 }
 
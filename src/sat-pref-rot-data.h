@@ -40,6 +40,10 @@ typedef enum {
     ROT_LIST_COL_AZSTOPPOS,     /*!< Position of the azimuth rotation stops.
                                    Should default to MINAZ, unless specified
                                    otherwise */
+    ROT_LIST_COL_AZRATE,        /*!< Az slew rate. */
+    ROT_LIST_COL_ELRATE,        /*!< El slew rate. */
+    ROT_LIST_COL_AZACCEL,       /*!< Az acceleration. */
+    ROT_LIST_COL_ELACCEL,       /*!< El acceleration. */
     ROT_LIST_COL_NUM            /*!< The number of fields in the list. */
 } rotor_list_col_t;
 
@@ -43,6 +43,10 @@ static GtkWidget *maxaz;
 static GtkWidget *minel;
 static GtkWidget *maxel;
 static GtkWidget *azstoppos;
+static GtkWidget *azrate;
+static GtkWidget *elrate;
+static GtkWidget *azaccel;
+static GtkWidget *elaccel;
 
 /* Update widgets from the currently selected row in the treeview */
 static void update_widgets(rotor_conf_t * conf)
@@ -68,6 +72,12 @@ static void update_widgets(rotor_conf_t * conf)
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(minel), conf->minel);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxel), conf->maxel);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(azstoppos), conf->azstoppos);
+
+    /* slew model */
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), conf->azrate);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), conf->elrate);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azaccel), conf->azaccel);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elaccel), conf->elaccel);
 }
 
 /* called when the user clicks on the CLEAR button */
@@ -82,6 +92,10 @@ static void clear_widgets()
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(minel), 0);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(maxel), 90);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(azstoppos), 0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), 0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), 0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azaccel), 0);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elaccel), 0);
 }
 
 /*
@@ -292,6 +306,57 @@ static GtkWidget *create_editor_widgets(rotor_conf_t * conf)
                                   "\342\206\222 +180\302\260 rotor is -180\302\260."));
     gtk_grid_attach(GTK_GRID(table), azstoppos, 3, 7, 1, 1);
 
+    gtk_grid_attach(GTK_GRID(table),
+                    gtk_separator_new(GTK_ORIENTATION_HORIZONTAL),
+                    0, 8, 4, 1);
+
+    /* Slew model */
+    label = gtk_label_new(_(" Az speed"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 9, 1, 1);
+    azrate = gtk_spin_button_new_with_range(0, 100, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azrate), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(azrate), TRUE);
+    gtk_widget_set_tooltip_text(azrate,
+                                _("Azimuth slew rate in Â°/s. "
+                                  "Gpredict uses it to plan the rotator "
+                                  "commands ahead of the satellite. "
+                                  "Use 0 if unknown."));
+    gtk_grid_attach(GTK_GRID(table), azrate, 1, 9, 1, 1);
+
+    label = gtk_label_new(_(" El speed"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 9, 1, 1);
+    elrate = gtk_spin_button_new_with_range(0, 100, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elrate), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(elrate), TRUE);
+    gtk_widget_set_tooltip_text(elrate,
+                                _("Elevation slew rate in Â°/s. "
+                                  "Use 0 if unknown."));
+    gtk_grid_attach(GTK_GRID(table), elrate, 3, 9, 1, 1);
+
+    label = gtk_label_new(_(" Az accel"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 0, 10, 1, 1);
+    azaccel = gtk_spin_button_new_with_range(0, 100, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(azaccel), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(azaccel), TRUE);
+    gtk_widget_set_tooltip_text(azaccel,
+                                _("Azimuth acceleration in Â°/sÂ². "
+                                  "Use 0 if unknown."));
+    gtk_grid_attach(GTK_GRID(table), azaccel, 1, 10, 1, 1);
+
+    label = gtk_label_new(_(" El accel"));
+    g_object_set(label, "xalign", 1.0, "yalign", 0.5, NULL);
+    gtk_grid_attach(GTK_GRID(table), label, 2, 10, 1, 1);
+    elaccel = gtk_spin_button_new_with_range(0, 100, 0.1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(elaccel), 0);
+    gtk_spin_button_set_numeric(GTK_SPIN_BUTTON(elaccel), TRUE);
+    gtk_widget_set_tooltip_text(elaccel,
+                                _("Elevation acceleration in Â°/sÂ². "
+                                  "Use 0 if unknown."));
+    gtk_grid_attach(GTK_GRID(table), elaccel, 3, 10, 1, 1);
+
     if (conf->name != NULL)
         update_widgets(conf);
 
@@ -330,6 +395,12 @@ static gboolean apply_changes(rotor_conf_t * conf)
     /* az stop position */
     conf->azstoppos = gtk_spin_button_get_value(GTK_SPIN_BUTTON(azstoppos));
 
+    /* slew model */
+    conf->azrate = gtk_spin_button_get_value(GTK_SPIN_BUTTON(azrate));
+    conf->elrate = gtk_spin_button_get_value(GTK_SPIN_BUTTON(elrate));
+    conf->azaccel = gtk_spin_button_get_value(GTK_SPIN_BUTTON(azaccel));
+    conf->elaccel = gtk_spin_button_get_value(GTK_SPIN_BUTTON(elaccel));
+
     return TRUE;
 }
 
@@ -78,7 +78,11 @@ static void add_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, conf.minel,
                            ROT_LIST_COL_MAXEL, conf.maxel,
                            ROT_LIST_COL_AZTYPE, conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, conf.azrate,
+                           ROT_LIST_COL_ELRATE, conf.elrate,
+                           ROT_LIST_COL_AZACCEL, conf.azaccel,
+                           ROT_LIST_COL_ELACCEL, conf.elaccel, -1);
 
         g_free(conf.name);
 
@@ -137,7 +141,11 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, &conf.minel,
                            ROT_LIST_COL_MAXEL, &conf.maxel,
                            ROT_LIST_COL_AZTYPE, &conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, &conf.azrate,
+                           ROT_LIST_COL_ELRATE, &conf.elrate,
+                           ROT_LIST_COL_AZACCEL, &conf.azaccel,
+                           ROT_LIST_COL_ELACCEL, &conf.elaccel, -1);
     }
     else
     {
@@ -172,7 +180,11 @@ static void edit_cb(GtkWidget * button, gpointer data)
                            ROT_LIST_COL_MINEL, conf.minel,
                            ROT_LIST_COL_MAXEL, conf.maxel,
                            ROT_LIST_COL_AZTYPE, conf.aztype,
-                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos, -1);
+                           ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
+                           ROT_LIST_COL_AZRATE, conf.azrate,
+                           ROT_LIST_COL_ELRATE, conf.elrate,
+                           ROT_LIST_COL_AZACCEL, conf.azaccel,
+                           ROT_LIST_COL_ELACCEL, conf.elaccel, -1);
     }
 
     /* clean up memory */
@@ -258,7 +270,11 @@ static GtkTreeModel *create_and_fill_model()
                                    G_TYPE_DOUBLE,       // Min El
                                    G_TYPE_DOUBLE,       // Max El
                                    G_TYPE_INT,  // Az type
-                                   G_TYPE_DOUBLE        // Az Stop Position
+                                   G_TYPE_DOUBLE,       // Az Stop Position
+                                   G_TYPE_DOUBLE,       // Az rate
+                                   G_TYPE_DOUBLE,       // El rate
+                                   G_TYPE_DOUBLE,       // Az acceleration
+                                   G_TYPE_DOUBLE        // El acceleration
         );
     gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE(liststore),
                                          ROT_LIST_COL_NAME,
@@ -291,6 +307,10 @@ static GtkTreeModel *create_and_fill_model()
                                        ROT_LIST_COL_MAXEL, conf.maxel,
                                        ROT_LIST_COL_AZTYPE, conf.aztype,
                                        ROT_LIST_COL_AZSTOPPOS, conf.azstoppos,
+                                       ROT_LIST_COL_AZRATE, conf.azrate,
+                                       ROT_LIST_COL_ELRATE, conf.elrate,
+                                       ROT_LIST_COL_AZACCEL, conf.azaccel,
+                                       ROT_LIST_COL_ELACCEL, conf.elaccel,
                                        -1);
 
                     sat_log_log(SAT_LOG_LEVEL_DEBUG,
@@ -621,7 +641,11 @@ void sat_pref_rot_ok()
                                ROT_LIST_COL_MINEL, &conf.minel,
                                ROT_LIST_COL_MAXEL, &conf.maxel,
                                ROT_LIST_COL_AZTYPE, &conf.aztype,
-                               ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos, -1);
+                               ROT_LIST_COL_AZSTOPPOS, &conf.azstoppos,
+                               ROT_LIST_COL_AZRATE, &conf.azrate,
+                               ROT_LIST_COL_ELRATE, &conf.elrate,
+                               ROT_LIST_COL_AZACCEL, &conf.azaccel,
+                               ROT_LIST_COL_ELACCEL, &conf.elaccel, -1);
             rotor_conf_save(&conf);
 
             /* free conf buffer */
@@ -0,0 +1,269 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Registry of satellites shared by the modules.
+ *
+ * Each satellite is read and initialised once, however many modules, views
+ * and dialogs use it, and is freed when the last of them lets go of it.
+ * The shared copy is never modified. A module tracks a satellite with its
+ * own sat_t, because the propagator keeps its working state there, but the
+ * strings are those of the shared copy and the copy is a memcpy instead of
+ * a read and an initialisation.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#include "gtk-sat-data.h"
+#include "sat-log.h"
+#include "sat-registry.h"
+
+typedef struct {
+    gint catnum;
+    gint refcount;
+    gboolean stale; /* Not in the index any more */
+    sat_t sat;      /* Initialised at epoch */
+} reg_entry_t;
+
+/* A satellite of a module; see sat_registry_new_sat() */
+typedef struct {
+    sat_t sat; /* Must be first */
+    reg_entry_t *shared;
+} module_sat_t;
+
+static GMutex reg_lock;
+static GHashTable *reg_index = NULL; /* reg_entry_t keyed by catnum */
+static guint reg_generation = 0;     /* Bumped by sat_registry_invalidate() */
+
+static reg_entry_t *get_entry(const sat_t *sat)
+{
+    return (reg_entry_t *)((gchar *)sat - G_STRUCT_OFFSET(reg_entry_t, sat));
+}
+
+static void free_entry(reg_entry_t *entry)
+{
+    g_free(entry->sat.name);
+    g_free(entry->sat.nickname);
+    g_free(entry->sat.website);
+    g_free(entry);
+}
+
+/*
+ * Get a satellite, reading it if nobody uses it yet.
+ *
+ * @param catnum The catalogue number.
+ * @return The satellite, which must not be modified, or NULL if it could not
+ *         be read. Release it with sat_registry_release().
+ */
+const sat_t *sat_registry_get(gint catnum)
+{
+    reg_entry_t *entry, *found;
+    guint generation;
+
+    g_mutex_lock(&reg_lock);
+
+    if (reg_index == NULL)
+        reg_index = g_hash_table_new(g_int_hash, g_int_equal);
+
+    entry = g_hash_table_lookup(reg_index, &catnum);
+    if (entry != NULL)
+    {
+        entry->refcount++;
+        g_mutex_unlock(&reg_lock);
+        return &entry->sat;
+    }
+
+    /* read without the lock, so that other satellites are not held up */
+    for (;;)
+    {
+        generation = reg_generation;
+        g_mutex_unlock(&reg_lock);
+
+        entry = g_new0(reg_entry_t, 1);
+        entry->catnum = catnum;
+        entry->refcount = 1;
+        if (gtk_sat_data_read_sat(catnum, &entry->sat))
+        {
+            free_entry(entry);
+            return NULL;
+        }
+
+        g_mutex_lock(&reg_lock);
+
+        /* somebody else may have read it meanwhile */
+        found = g_hash_table_lookup(reg_index, &catnum);
+        if (found != NULL)
+        {
+            found->refcount++;
+            g_mutex_unlock(&reg_lock);
+            free_entry(entry);
+            return &found->sat;
+        }
+
+        if (generation == reg_generation)
+            break;
+
+        /* the data has changed while it was read */
+        free_entry(entry);
+    }
+
+    g_hash_table_insert(reg_index, &entry->catnum, entry);
+
+    g_mutex_unlock(&reg_lock);
+
+    return &entry->sat;
+}
+
+void sat_registry_release(const sat_t *sat)
+{
+    reg_entry_t *entry;
+
+    if (sat == NULL)
+        return;
+
+    entry = get_entry(sat);
+
+    g_mutex_lock(&reg_lock);
+    if (--entry->refcount > 0)
+    {
+        g_mutex_unlock(&reg_lock);
+        return;
+    }
+    if (!entry->stale)
+        g_hash_table_remove(reg_index, &entry->catnum);
+    g_mutex_unlock(&reg_lock);
+
+    free_entry(entry);
+}
+
+/*
+ * Create a satellite for a module.
+ *
+ * The satellite can be propagated like one read with gtk_sat_data_read_sat()
+ * but must be freed with sat_registry_free_sat(), and its strings must not
+ * be changed.
+ *
+ * @return The satellite, or NULL if it could not be read.
+ */
+sat_t *sat_registry_new_sat(gint catnum)
+{
+    const sat_t *shared;
+    module_sat_t *msat;
+
+    shared = sat_registry_get(catnum);
+    if (shared == NULL)
+        return NULL;
+
+    msat = g_new(module_sat_t, 1);
+    msat->sat = *shared;
+    msat->shared = get_entry(shared);
+
+    return &msat->sat;
+}
+
+void sat_registry_free_sat(sat_t *sat)
+{
+    module_sat_t *msat = (module_sat_t *)sat;
+
+    if (sat == NULL)
+        return;
+
+    sat_registry_release(&msat->shared->sat);
+    g_free(msat);
+}
+
+/*
+ * Bring a satellite of a module up to date with the satellite data.
+ *
+ * The satellite is updated in place, so that pointers to it remain valid.
+ * If its elements have changed since it was created it takes the new ones
+ * and must be initialised again; otherwise its propagator state is kept.
+ *
+ * @return What has changed, as sat_update_t flags.
+ */
+guint sat_registry_update_sat(sat_t *sat)
+{
+    module_sat_t *msat = (module_sat_t *)sat;
+    reg_entry_t *old = msat->shared;
+    const sat_t *shared;
+    guint changes = SAT_UPDATE_NONE;
+
+    shared = sat_registry_get(old->catnum);
+    if (shared == NULL)
+        return SAT_UPDATE_NONE;
+
+    msat->shared = get_entry(shared);
+    if (msat->shared == old)
+    {
+        /* still the same data */
+        sat_registry_release(shared);
+        return SAT_UPDATE_NONE;
+    }
+
+    if (g_strcmp0(shared->name, old->sat.name) ||
+        g_strcmp0(shared->nickname, old->sat.nickname))
+        changes |= SAT_UPDATE_NAME;
+
+    if (shared->tle.epoch != sat->tle.epoch)
+    {
+        msat->sat = *shared;
+        sat_registry_release(&old->sat);
+        return changes | SAT_UPDATE_ELEMENTS;
+    }
+
+    /* same elements; the strings belong to the entry */
+    sat->name = shared->name;
+    sat->nickname = shared->nickname;
+    sat->website = shared->website;
+    memcpy(sat->tle.sat_name, shared->tle.sat_name, sizeof(sat->tle.sat_name));
+    sat->tle.status = shared->tle.status;
+    sat_registry_release(&old->sat);
+
+    return changes;
+}
+
+/*
+ * Forget the satellites read so far.
+ *
+ * Called when the satellite data has changed, so that the satellites are
+ * read again. Satellites in use remain valid until they are released.
+ */
+void sat_registry_invalidate(void)
+{
+    GHashTableIter iter;
+    gpointer entry;
+
+    g_mutex_lock(&reg_lock);
+    if (reg_index != NULL)
+    {
+        g_hash_table_iter_init(&iter, reg_index);
+        while (g_hash_table_iter_next(&iter, NULL, &entry))
+            ((reg_entry_t *)entry)->stale = TRUE;
+        g_hash_table_remove_all(reg_index);
+    }
+    reg_generation++;
+    g_mutex_unlock(&reg_lock);
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Satellites will be read again"),
+                __func__);
+}
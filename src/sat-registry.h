@@ -0,0 +1,42 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SAT_REGISTRY_H
+#define SAT_REGISTRY_H 1
+
+#include <glib.h>
+
+#include "sgpsdp/sgp4sdp4.h"
+
+/* What sat_registry_update_sat() has changed */
+typedef enum {
+    SAT_UPDATE_NONE = 0,
+    SAT_UPDATE_NAME = 1 << 0,    /* Name or nickname */
+    SAT_UPDATE_ELEMENTS = 1 << 1 /* Elements; the satellite needs an init */
+} sat_update_t;
+
+const sat_t *sat_registry_get(gint catnum);
+void sat_registry_release(const sat_t *sat);
+
+sat_t *sat_registry_new_sat(gint catnum);
+void sat_registry_free_sat(sat_t *sat);
+guint sat_registry_update_sat(sat_t *sat);
+
+void sat_registry_invalidate(void);
+
+#endif
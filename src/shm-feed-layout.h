@@ -0,0 +1,99 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Layout of the live tracking feed.
+ *
+ * A module with the SHM_FEED option publishes the state of its satellites
+ * after every update in a POSIX shared memory object called
+ * "/gpredict-<module>", where characters of the module name other than
+ * letters, digits, '-' and '_' are replaced by '_'. This header only depends
+ * on the C standard library so that other programs can include it as is.
+ *
+ * The object starts with a shm_feed_header_t, followed by nframes frames of
+ * framesize bytes each. A frame is a shm_feed_frame_t followed by nsats
+ * shm_feed_sat_t entries of satsize bytes each. Readers should use the sizes
+ * from the header rather than sizeof(), so that fields can be appended
+ * without breaking them; a change that would is flagged by a new version.
+ *
+ * The frames form a ring guarded by seqlocks. gpredict writes the frame after
+ * the latest one, bumping its seq to an odd value before and to an even value
+ * after writing, and then makes it the latest. To read a snapshot without
+ * locking:
+ *
+ *   1. load latest (acquire) and pick that frame;
+ *   2. load seq (acquire); if it is odd, go back to 1;
+ *   3. copy the frame;
+ *   4. issue an acquire fence and load seq again; if it has changed, go
+ *      back to 1.
+ *
+ * A reader that is slower than nframes - 1 module updates can keep missing
+ * its snapshot; reading only the fields needed keeps the copy short.
+ *
+ * All times are Julian dates (UTC); the Unix time is (jd - 2440587.5) * 86400.
+ * The feed is only updated while the module is, i.e. not while it is hidden
+ * or iconified, so readers should check rtime to detect stale data.
+ */
+#ifndef SHM_FEED_LAYOUT_H
+#define SHM_FEED_LAYOUT_H 1
+
+#include <stdint.h>
+
+#define SHM_FEED_MAGIC 0x46525047u /* "GPRF" in little endian */
+#define SHM_FEED_VERSION 1
+#define SHM_FEED_NAME_SIZE 32
+
+typedef struct {
+    uint32_t magic;     /* SHM_FEED_MAGIC */
+    uint32_t version;   /* SHM_FEED_VERSION */
+    uint32_t nframes;   /* Number of frames in the ring */
+    uint32_t maxsats;   /* Max number of satellites in a frame */
+    uint32_t framesize; /* Size of a frame including its satellites */
+    uint32_t satsize;   /* Size of a satellite entry */
+    uint32_t latest;    /* Index of the latest complete frame */
+    int32_t pid;        /* Process ID of the writer */
+} shm_feed_header_t;
+
+typedef struct {
+    uint32_t seq;    /* Odd while the frame is being written */
+    uint32_t nsats;  /* Number of satellite entries that follow */
+    uint64_t tick;   /* Number of the module update */
+    double time;     /* Module time, which may be simulated */
+    double rtime;    /* Real time of the update */
+    double qth_lat;  /* Observer latitude (deg, north positive) */
+    double qth_lon;  /* Observer longitude (deg, east positive) */
+    double qth_alt;  /* Observer altitude (m) */
+} shm_feed_frame_t;
+
+typedef struct {
+    int32_t catnr;                 /* Catalogue number */
+    char name[SHM_FEED_NAME_SIZE]; /* Nickname, NUL terminated */
+    int32_t reserved;
+    double az;         /* Azimuth (deg) */
+    double el;         /* Elevation (deg) */
+    double range;      /* Range (km) */
+    double range_rate; /* Range rate (km/s) */
+    double doppler;    /* Doppler shift at 100 MHz (Hz) */
+    double lat;        /* Sub-satellite latitude (deg) */
+    double lon;        /* Sub-satellite longitude (deg) */
+    double alt;        /* Altitude (km) */
+    double aos;        /* Next AOS; 0 if none is known */
+    double los;        /* Next LOS; 0 if none is known */
+} shm_feed_sat_t;
+
+#endif
@@ -0,0 +1,208 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Live tracking feed in shared memory.
+ *
+ * The module writes a frame after each update and readers in other processes
+ * pick up the latest one without locking and without a round trip through
+ * gpredict; see shm-feed-layout.h for the protocol.
+ */
+#define _POSIX_C_SOURCE 200809L /* shm_open(), ftruncate() */
+
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <errno.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>    /* O_* constants */
+#include <sys/mman.h> /* shm_open(), mmap() */
+#include <unistd.h>   /* ftruncate(), getpid() */
+#endif
+
+#include "sat-log.h"
+#include "shm-feed.h"
+
+#define FRAME_SIZE                                                             \
+    (sizeof(shm_feed_frame_t) + SHM_FEED_MAX_SATS * sizeof(shm_feed_sat_t))
+
+/*
+ * Create the feed of a module.
+ *
+ * @param module The name of the module.
+ * @return The feed, or NULL if the shared memory could not be set up.
+ */
+shm_feed_t *shm_feed_new(const gchar *module)
+{
+#ifdef WIN32
+    sat_log_log(SAT_LOG_LEVEL_WARN,
+                _("%s: The tracking feed is not available on this platform"),
+                __func__);
+    (void)module;
+
+    return NULL;
+#else
+    shm_feed_t *feed;
+    shm_feed_header_t *header;
+    gchar *canon, *name;
+    gsize size;
+    gint fd;
+
+    canon = g_strcanon(g_strdup(module),
+                       G_CSET_A_2_Z G_CSET_a_2_z G_CSET_DIGITS "-_", '_');
+    name = g_strconcat("/gpredict-", canon, NULL);
+    g_free(canon);
+
+    size = sizeof(shm_feed_header_t) + SHM_FEED_NFRAMES * FRAME_SIZE;
+    fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+    if (fd == -1 || ftruncate(fd, size) == -1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not create %s: %s"),
+                    __func__, name, g_strerror(errno));
+        if (fd != -1)
+            close(fd);
+        g_free(name);
+        return NULL;
+    }
+
+    header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (header == MAP_FAILED)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not map %s: %s"),
+                    __func__, name, g_strerror(errno));
+        shm_unlink(name);
+        g_free(name);
+        return NULL;
+    }
+
+    /* readers trust the header once they see the magic */
+    g_atomic_int_set((gint *)&header->magic, 0);
+    memset((gchar *)header + sizeof(header->magic), 0,
+           size - sizeof(header->magic));
+    header->version = SHM_FEED_VERSION;
+    header->nframes = SHM_FEED_NFRAMES;
+    header->maxsats = SHM_FEED_MAX_SATS;
+    header->framesize = FRAME_SIZE;
+    header->satsize = sizeof(shm_feed_sat_t);
+    header->latest = SHM_FEED_NFRAMES - 1;
+    header->pid = getpid();
+    g_atomic_int_set((gint *)&header->magic, SHM_FEED_MAGIC);
+
+    feed = g_new0(shm_feed_t, 1);
+    feed->name = name;
+    feed->size = size;
+    feed->header = header;
+
+    sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Publishing tracking feed in %s"),
+                __func__, name);
+
+    return feed;
+#endif
+}
+
+/* Remove the feed; readers that still have it mapped see it stop */
+void shm_feed_free(shm_feed_t *feed)
+{
+    if (feed == NULL)
+        return;
+
+#ifndef WIN32
+    munmap(feed->header, feed->size);
+    shm_unlink(feed->name);
+#endif
+    g_free(feed->name);
+    g_free(feed);
+}
+
+static shm_feed_frame_t *get_frame(shm_feed_t *feed, guint i)
+{
+    return (shm_feed_frame_t *)((gchar *)feed->header +
+                                sizeof(shm_feed_header_t) + i * FRAME_SIZE);
+}
+
+static void fill_sat(shm_feed_sat_t *entry, const sat_t *sat)
+{
+    entry->catnr = sat->tle.catnr;
+    g_strlcpy(entry->name, sat->nickname ? sat->nickname : sat->name,
+              sizeof(entry->name));
+    entry->az = sat->az;
+    entry->el = sat->el;
+    entry->range = sat->range;
+    entry->range_rate = sat->range_rate;
+    entry->doppler = -100.0e06 * (sat->range_rate / 299792.4580);
+    entry->lat = sat->ssplat;
+    entry->lon = sat->ssplon;
+    entry->alt = sat->alt;
+    entry->aos = sat->aos;
+    entry->los = sat->los;
+}
+
+/*
+ * Publish the state of the satellites after a module update.
+ *
+ * @param feed The feed.
+ * @param sats The satellites of the module.
+ * @param qth The observer.
+ * @param t The module time (Julian date).
+ * @param rt The real time of the update (Julian date).
+ */
+void shm_feed_publish(shm_feed_t *feed, GHashTable *sats, qth_t *qth,
+                      gdouble t, gdouble rt)
+{
+    shm_feed_frame_t *frame;
+    shm_feed_sat_t *entries;
+    GHashTableIter iter;
+    gpointer sat;
+    guint i, n = 0;
+
+    i = (feed->header->latest + 1) % SHM_FEED_NFRAMES;
+    frame = get_frame(feed, i);
+    entries = (shm_feed_sat_t *)(frame + 1);
+
+    /* the atomic operations are full barriers; see shm-feed-layout.h */
+    g_atomic_int_inc((gint *)&frame->seq);
+
+    g_hash_table_iter_init(&iter, sats);
+    while (n < SHM_FEED_MAX_SATS && g_hash_table_iter_next(&iter, NULL, &sat))
+        fill_sat(&entries[n++], sat);
+
+    frame->nsats = n;
+    frame->tick = ++feed->tick;
+    frame->time = t;
+    frame->rtime = rt;
+    frame->qth_lat = qth->lat;
+    frame->qth_lon = qth->lon;
+    frame->qth_alt = qth->alt;
+
+    g_atomic_int_inc((gint *)&frame->seq);
+    g_atomic_int_set((gint *)&feed->header->latest, i);
+
+    if (n < g_hash_table_size(sats) && !feed->truncated)
+    {
+        sat_log_log(SAT_LOG_LEVEL_WARN,
+                    _("%s: Only the first %d satellites fit in %s"), __func__,
+                    SHM_FEED_MAX_SATS, feed->name);
+        feed->truncated = TRUE;
+    }
+}
@@ -0,0 +1,44 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef SHM_FEED_H
+#define SHM_FEED_H 1
+
+#include <glib.h>
+
+#include "gtk-sat-data.h"
+#include "shm-feed-layout.h"
+
+#define SHM_FEED_NFRAMES 4    /* Frames in the ring */
+#define SHM_FEED_MAX_SATS 512 /* Satellites per frame */
+
+/* Writer side of a live tracking feed; see shm-feed-layout.h */
+typedef struct {
+    gchar *name;               /* Name of the shared memory object */
+    gsize size;                /* Size of the mapping */
+    shm_feed_header_t *header; /* The mapping */
+    guint64 tick;              /* Number of frames written */
+    gboolean truncated;        /* Whether the overflow has been logged */
+} shm_feed_t;
+
+shm_feed_t *shm_feed_new(const gchar *module);
+void shm_feed_free(shm_feed_t *feed);
+void shm_feed_publish(shm_feed_t *feed, GHashTable *sats, qth_t *qth,
+                      gdouble t, gdouble rt);
+
+#endif
@@ -0,0 +1,275 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Headless test of the hamlib clients against the simulated daemons.
+ *
+ * A simulated rigctld and rotctld are started on the loopback interface and
+ * a synthetic overhead pass is tracked through them, the way the radio and
+ * rotator controllers do it: the radio is tuned to the Doppler shifted
+ * downlink and the frequency read back in the same round trip, the rotator
+ * gets the position of the satellite and is asked for its own. Requests that
+ * time out are followed by a reconnect. At the end the I/O statistics and
+ * the tracking errors are reported.
+ *
+ * The simulators take the same specifications as the --rigctld-sim and
+ * --rotctld-sim options, so a degraded link can be reproduced with e.g.
+ * --rig 4532,latency=50,jitter=30,drop=0.02
+ */
+#include <glib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hamlib-client.h"
+#include "hamlib-sim.h"
+#include "io-stats.h"
+#include "sat-log.h"
+
+#define CONNECT_TIMEOUT 1000 /* Connection timeout (msec) */
+#define DOWNLINK 435.0e6     /* Downlink frequency of the pass (Hz) */
+#define DOPPLER 10.0e3       /* Max Doppler shift of the pass (Hz) */
+#define MAX_EL 80.0          /* Max elevation of the pass (deg) */
+
+static gchar *rigspec = "4532,latency=20,jitter=10,step=10";
+static gchar *rotspec = "4533,latency=20,jitter=10,rate=6";
+static gint duration = 60;
+static gint cycle = 200;
+static gboolean verbose = FALSE;
+
+static GOptionEntry entries[] = {
+    {"rig", 0, 0, G_OPTION_ARG_STRING, &rigspec,
+     "Simulated rigctld; see --rigctld-sim", "PORT[,key=value...]"},
+    {"rot", 0, 0, G_OPTION_ARG_STRING, &rotspec,
+     "Simulated rotctld; see --rotctld-sim", "PORT[,key=value...]"},
+    {"duration", 0, 0, G_OPTION_ARG_INT, &duration,
+     "Duration of the pass (sec)", "SEC"},
+    {"cycle", 0, 0, G_OPTION_ARG_INT, &cycle,
+     "Control cycle and request timeout (msec)", "MSEC"},
+    {"verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose,
+     "Show debug messages", NULL},
+    {NULL}
+};
+
+/* One simulated device and the client talking to it */
+typedef struct {
+    const gchar *name;
+    hamlib_sim_t *sim;
+    gint port;
+    gint sock;
+    gboolean failed;   /* Last set command failed and is sent again */
+    io_stats_t stats;
+    track_stats_t err; /* Tracking error */
+} device_t;
+
+/* The clients and simulators log through sat-log; print to the console */
+void sat_log_message(sat_log_level_t level, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (level > SAT_LOG_LEVEL_INFO && !verbose)
+        return;
+
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+}
+
+/* Position and downlink of the satellite t seconds into the pass */
+static void pass_at(gdouble t, gdouble *az, gdouble *el, gdouble *freq)
+{
+    gdouble f = CLAMP(t / duration, 0.0, 1.0);
+
+    *az = 30.0 + 120.0 * f;
+    *el = MAX_EL * sin(G_PI * f);
+    *freq = DOWNLINK - DOPPLER * tanh(10.0 * (f - 0.5));
+}
+
+static gboolean start_device(device_t *dev, hamlib_sim_type_t type,
+                             const gchar *name, const gchar *spec)
+{
+    hamlib_sim_conf_t conf;
+
+    memset(dev, 0, sizeof(device_t));
+    dev->name = name;
+    dev->sock = -1;
+    io_stats_reset(&dev->stats);
+
+    if (!hamlib_sim_parse(spec, &conf))
+    {
+        printf("Invalid %s specification: %s\n", name, spec);
+        return FALSE;
+    }
+
+    dev->port = conf.port;
+    dev->sim = hamlib_sim_start(type, &conf);
+    if (dev->sim == NULL)
+        return FALSE;
+
+    dev->sock = hamlib_open("127.0.0.1", dev->port, CONNECT_TIMEOUT);
+
+    return (dev->sock >= 0);
+}
+
+static void stop_device(device_t *dev)
+{
+    if (dev->sock >= 0)
+        hamlib_close(dev->sock);
+    hamlib_sim_stop(dev->sim);
+}
+
+/*
+ * Account for a request of a set and a get command.
+ *
+ * Returns TRUE if the get command got a response. A connection whose
+ * request timed out or failed is reopened, so that a late reply is not taken
+ * for the reply to the next request.
+ */
+static gboolean finish_request(device_t *dev, hamlib_req_t *req)
+{
+    gboolean setok = (req->nresp > 0 && !strncmp(req->resp[0], "RPRT 0", 6));
+    guint i;
+
+    for (i = 0; i < req->nresp; i++)
+        io_stats_response(&dev->stats, req->rtime[i] - req->start,
+                          i > 0 || setok);
+    if (req->nresp < req->ncmd)
+        io_stats_timeout(&dev->stats, req->ncmd - req->nresp);
+
+    if (dev->failed)
+        io_stats_retry(&dev->stats);
+    dev->failed = !setok;
+
+    if (req->status == HAMLIB_REQ_TIMEOUT || req->status == HAMLIB_REQ_FAILED)
+    {
+        if (dev->sock >= 0)
+            hamlib_close(dev->sock);
+        dev->sock = hamlib_open("127.0.0.1", dev->port, CONNECT_TIMEOUT);
+    }
+
+    return (req->nresp == req->ncmd && strncmp(req->resp[1], "RPRT", 4));
+}
+
+/* Track the pass; returns FALSE if no position or frequency was read */
+static gboolean run_pass(device_t *rig, device_t *rot)
+{
+    hamlib_req_t req[2];
+    gchar cmd[64];
+    gchar azbuf[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar elbuf[G_ASCII_DTOSTR_BUF_SIZE];
+    gdouble az, el, freq, t, raz, rel;
+    gint64 start, next, now;
+
+    start = g_get_monotonic_time();
+    for (next = start; next - start < (gint64)duration * 1000000;
+         next += (gint64)cycle * 1000)
+    {
+        now = g_get_monotonic_time();
+        if (now < next)
+            g_usleep(next - now);
+
+        /* command where the satellite is now */
+        pass_at((next - start) / 1.0e6, &az, &el, &freq);
+
+        hamlib_req_init(&req[0], rig->sock, cycle);
+        g_snprintf(cmd, sizeof(cmd), "F %10.0f\x0a", freq);
+        hamlib_req_add(&req[0], cmd, 1);
+        hamlib_req_add(&req[0], "f\x0a", 1);
+
+        hamlib_req_init(&req[1], rot->sock, cycle);
+        g_snprintf(cmd, sizeof(cmd), "P %s %s\x0a",
+                   g_ascii_formatd(azbuf, sizeof(azbuf), "%.2f", az),
+                   g_ascii_formatd(elbuf, sizeof(elbuf), "%.2f", el));
+        hamlib_req_add(&req[1], cmd, 1);
+        hamlib_req_add(&req[1], "p\x0a", 2);
+
+        io_stats_request(&rig->stats, req[0].ncmd);
+        io_stats_request(&rot->stats, req[1].ncmd);
+        hamlib_req_run(req, 2);
+
+        /* compare with where the satellite is when the answers arrive */
+        if (finish_request(rig, &req[0]))
+        {
+            t = (req[0].rtime[1] - start) / 1.0e6;
+            pass_at(t, &az, &el, &freq);
+            track_stats_add(&rig->err,
+                            g_ascii_strtod(req[0].resp[1], NULL) - freq);
+        }
+
+        if (finish_request(rot, &req[1]) &&
+            sscanf(req[1].resp[1], "%lf\n%lf", &raz, &rel) == 2)
+        {
+            t = (req[1].rtime[1] - start) / 1.0e6;
+            pass_at(t, &az, &el, &freq);
+            track_stats_add(&rot->err,
+                            hypot((raz - az) * cos(el * G_PI / 180.0),
+                                  rel - el));
+        }
+    }
+
+    return (rig->err.count > 0 && rot->err.count > 0);
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *err = NULL;
+    device_t rig, rot;
+    gboolean ok;
+
+    context = g_option_context_new("");
+    g_option_context_set_summary(
+        context, "Track a synthetic pass with simulated rigctld and rotctld "
+                 "and report the tracking errors.");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &err))
+    {
+        printf("%s\n", err->message);
+        g_clear_error(&err);
+        g_option_context_free(context);
+        return 1;
+    }
+    g_option_context_free(context);
+
+    if (duration <= 0 || cycle <= 0)
+    {
+        printf("The duration and the cycle must be positive\n");
+        return 1;
+    }
+
+    ok = start_device(&rig, HAMLIB_SIM_RIGCTLD, "rigctld", rigspec);
+    ok &= start_device(&rot, HAMLIB_SIM_ROTCTLD, "rotctld", rotspec);
+
+    if (ok)
+    {
+        printf("Tracking a %d s pass with a %d ms cycle\n", duration, cycle);
+        ok = run_pass(&rig, &rot);
+    }
+
+    stop_device(&rig);
+    stop_device(&rot);
+
+    io_stats_log(rig.name, &rig.stats);
+    io_stats_log(rot.name, &rot.stats);
+    track_stats_log("Downlink frequency error (Hz)", &rig.err);
+    track_stats_log("Pointing error (deg)", &rot.err);
+
+    return ok ? 0 : 1;
+}
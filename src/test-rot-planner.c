@@ -0,0 +1,164 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Unit test for the rotator planner.
+ *
+ * Plans synthetic passes through north for rotators with more than 360 deg
+ * of azimuth travel and checks that the commands stay on the planned branch
+ * of the travel.
+ */
+#include <glib.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "predict-tools.h"
+#include "rot-planner.h"
+#include "sat-log.h"
+
+#define PASS_SAMPLES 601 /* Ten minute pass, one sample per second */
+
+/* The planner only logs and the tracks are synthetic */
+void sat_log_message(sat_log_level_t level, const char *fmt, ...)
+{
+    (void)level;
+    (void)fmt;
+}
+
+void predict_calc(sat_t *sat, qth_t *qth, gdouble t)
+{
+    (void)sat;
+    (void)qth;
+    (void)t;
+}
+
+/* A pass from az0 to az1 through north, up to 40 deg elevation */
+static rot_track_t *north_pass(gdouble az0, gdouble az1)
+{
+    rot_track_t *track = g_new0(rot_track_t, 1);
+    gdouble f;
+    guint i;
+
+    track->refcount = 1;
+    track->aos = 2459000.5;
+    track->step = 1.0;
+    track->n = PASS_SAMPLES;
+    track->los = track->aos + (track->n - 1) / 86400.0;
+    track->az = g_new(gdouble, track->n);
+    track->el = g_new(gdouble, track->n);
+
+    for (i = 0; i < track->n; i++)
+    {
+        f = (gdouble)i / (track->n - 1);
+        track->az[i] = fmod(az0 + f * (az1 - az0) + 360.0, 360.0);
+        track->el[i] = 40.0 * sin(G_PI * f);
+    }
+
+    return track;
+}
+
+/*
+ * Plan a pass and check the commands.
+ *
+ * Returns the number of failed checks.
+ */
+static gint check_plan(const gchar *name, rot_track_t *track,
+                       rotor_conf_t *conf, gboolean havepos, gdouble pos,
+                       gdouble first)
+{
+    rot_plan_t *plan;
+    gint errors = 0;
+    guint i;
+
+    plan = rot_plan_new(track, conf, 5.0, 1.0, havepos, pos);
+
+    printf("%s: %u commands, first at %.1f (expected %.1f), unwind: %d\n",
+           name, plan->ncmd, plan->cmds[0].az, first, plan->unwind > 0.0);
+
+    if (fabs(plan->cmds[0].az - first) > 1.0)
+    {
+        printf("  FAIL: pass does not start on the planned branch\n");
+        errors++;
+    }
+
+    if (plan->unwind > 0.0)
+    {
+        printf("  FAIL: pass unwinds although it fits the travel\n");
+        errors++;
+    }
+
+    for (i = 0; i < plan->ncmd; i++)
+    {
+        if (plan->cmds[i].az < conf->minaz || plan->cmds[i].az > conf->maxaz)
+        {
+            printf("  FAIL: command %u at %.1f is out of range\n", i,
+                   plan->cmds[i].az);
+            errors++;
+        }
+
+        if (i > 0 && fabs(plan->cmds[i].az - plan->cmds[i - 1].az) > 180.0)
+        {
+            printf("  FAIL: command %u jumps from %.1f to %.1f\n", i,
+                   plan->cmds[i - 1].az, plan->cmds[i].az);
+            errors++;
+        }
+    }
+
+    rot_plan_free(plan);
+
+    return errors;
+}
+
+int main(void)
+{
+    rotor_conf_t conf = { 0 };
+    rot_track_t *track;
+    gint errors = 0;
+
+    /* 720 deg of travel with the end stop in the south */
+    conf.minaz = -180.0;
+    conf.maxaz = 540.0;
+    conf.minel = 0.0;
+    conf.maxel = 90.0;
+    conf.azrate = 6.0;
+    conf.elrate = 6.0;
+
+    /* from north-west to north-east; 300 deg is -60 deg on the first lap */
+    track = north_pass(300.0, 420.0);
+
+    conf.azstoppos = -180.0;
+    errors += check_plan("stop at minaz, rotator at start of travel", track,
+                         &conf, TRUE, -170.0, -60.0);
+    errors += check_plan("stop at minaz, rotator at end of travel", track,
+                         &conf, TRUE, 530.0, 300.0);
+
+    /* the same stop seen as a bearing; the rotator still calls it -180 */
+    conf.azstoppos = 180.0;
+    errors += check_plan("stop at 180, rotator at start of travel", track,
+                         &conf, TRUE, -170.0, -60.0);
+    errors += check_plan("stop at 180, rotator at end of travel", track,
+                         &conf, TRUE, 530.0, 300.0);
+    errors += check_plan("stop at 180, rotator position unknown", track, &conf,
+                         FALSE, 0.0, 300.0);
+
+    rot_track_unref(track);
+
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Unit test for the conditional fetch of the TLE files.
+ *
+ * A TLE file is served by a minimal HTTP server on the loopback interface
+ * and fetched three times: the first fetch saves the validators of the file,
+ * the second one is answered with 304 Not Modified and the third one fails.
+ */
+#include <arpa/inet.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sat-log.h"
+#include "tle-fetch.h"
+
+#define ETAG "\"v1\""
+#define LAST_MODIFIED "Tue, 15 Nov 1994 08:12:31 GMT"
+#define LAST_MODIFIED_TIME 784887151
+
+static const gchar tle_data[] =
+    "ISS (ZARYA)\n"
+    "1 25544U 98067A   19001.50000000  .00001000  00000-0  20000-4 0  9991\n"
+    "2 25544  51.6400 200.0000 0005000 100.0000 260.0000 15.50000000100006\n";
+
+/* The loopback HTTP server */
+typedef struct {
+    gint sock;
+    gint port;
+    gint stop;
+    gint fail;        /* Answer with 500 Internal Server Error */
+    gint conditional; /* Last request had If-None-Match and If-Modified-Since */
+    GThread *thread;
+} server_t;
+
+/* The fetch only logs */
+void sat_log_message(sat_log_level_t level, const char *fmt, ...)
+{
+    (void)level;
+    (void)fmt;
+}
+
+/* Read the request headers; returns them or NULL if the client went away */
+static gchar *read_request(gint sock)
+{
+    GString *req = g_string_new(NULL);
+    gchar buff[512];
+    ssize_t len;
+
+    while (strstr(req->str, "\r\n\r\n") == NULL)
+    {
+        len = recv(sock, buff, sizeof(buff), 0);
+        if (len <= 0)
+            return g_string_free(req, TRUE);
+        g_string_append_len(req, buff, len);
+    }
+
+    return g_string_free(req, FALSE);
+}
+
+static void answer(server_t *srv, gint sock)
+{
+    gchar *req;
+    gchar *resp;
+    gboolean etag, modified;
+
+    req = read_request(sock);
+    if (req == NULL)
+        return;
+
+    etag = (strstr(req, "If-None-Match: " ETAG "\r\n") != NULL);
+    modified = (strstr(req, "If-Modified-Since: " LAST_MODIFIED "\r\n") !=
+                NULL);
+    g_atomic_int_set(&srv->conditional, etag && modified);
+
+    if (g_atomic_int_get(&srv->fail))
+        resp = g_strdup("HTTP/1.1 500 Internal Server Error\r\n"
+                        "Content-Length: 0\r\n"
+                        "Connection: close\r\n\r\n");
+    else if (etag)
+        resp = g_strdup("HTTP/1.1 304 Not Modified\r\n"
+                        "ETag: " ETAG "\r\n"
+                        "Connection: close\r\n\r\n");
+    else
+        resp = g_strdup_printf("HTTP/1.1 200 OK\r\n"
+                               "ETag: " ETAG "\r\n"
+                               "Last-Modified: " LAST_MODIFIED "\r\n"
+                               "Content-Length: %u\r\n"
+                               "Connection: close\r\n\r\n%s",
+                               (guint)strlen(tle_data), tle_data);
+
+    if (send(sock, resp, strlen(resp), 0) < 0)
+        perror("send");
+
+    g_free(resp);
+    g_free(req);
+}
+
+static gpointer server_thread(gpointer data)
+{
+    server_t *srv = data;
+    struct pollfd pfd;
+    gint sock;
+
+    pfd.fd = srv->sock;
+    pfd.events = POLLIN;
+
+    while (!g_atomic_int_get(&srv->stop))
+    {
+        if (poll(&pfd, 1, 100) <= 0)
+            continue;
+
+        sock = accept(srv->sock, NULL, NULL);
+        if (sock < 0)
+            continue;
+
+        answer(srv, sock);
+        close(sock);
+    }
+
+    return NULL;
+}
+
+static gboolean server_start(server_t *srv)
+{
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+
+    memset(srv, 0, sizeof(server_t));
+
+    srv->sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv->sock < 0)
+    {
+        perror("socket");
+        return FALSE;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    if (bind(srv->sock, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(srv->sock, 4) < 0 ||
+        getsockname(srv->sock, (struct sockaddr *)&addr, &len) < 0)
+    {
+        perror("bind");
+        close(srv->sock);
+        return FALSE;
+    }
+
+    srv->port = ntohs(addr.sin_port);
+    srv->thread = g_thread_new("http", server_thread, srv);
+
+    return TRUE;
+}
+
+static void server_stop(server_t *srv)
+{
+    g_atomic_int_set(&srv->stop, 1);
+    g_thread_join(srv->thread);
+    close(srv->sock);
+}
+
+/* Fetch the file; returns the number of failed checks */
+static gint check_fetch(const gchar *name, gchar **files,
+                        const gchar *cachedir, GKeyFile *validators,
+                        guint success, guint unchanged, gboolean cached)
+{
+    gchar *locfile;
+    gchar *etag;
+    gint64 modified;
+    guint fetched, same;
+    gint errors = 0;
+
+    fetched = tle_fetch_files(files, cachedir, NULL, validators, 1, NULL,
+                              NULL, &same);
+
+    locfile = g_build_filename(cachedir, "file-0.tle", NULL);
+    etag = g_key_file_get_string(validators, files[0], "ETag", NULL);
+    modified = g_key_file_get_int64(validators, files[0], "Modified", NULL);
+
+    printf("%s: %u fetched, %u unchanged, ETag %s, modified %" G_GINT64_FORMAT
+           "\n", name, fetched, same, etag ? etag : "none", modified);
+
+    if (fetched != success || same != unchanged)
+    {
+        printf("  FAIL: expected %u fetched and %u unchanged\n", success,
+               unchanged);
+        errors++;
+    }
+
+    if (g_strcmp0(etag, ETAG) || modified != LAST_MODIFIED_TIME)
+    {
+        printf("  FAIL: validators not saved\n");
+        errors++;
+    }
+
+    if (g_file_test(locfile, G_FILE_TEST_EXISTS) != cached)
+    {
+        printf("  FAIL: cache file %s\n", cached ? "missing" : "not removed");
+        errors++;
+    }
+
+    g_remove(locfile);
+    g_free(locfile);
+    g_free(etag);
+
+    return errors;
+}
+
+int main(void)
+{
+    server_t srv;
+    GKeyFile *validators;
+    GError *err = NULL;
+    gchar *files[2];
+    gchar *cachedir;
+    gint errors = 0;
+
+    cachedir = g_dir_make_tmp("test-tle-fetch-XXXXXX", &err);
+    if (cachedir == NULL)
+    {
+        printf("%s\n", err->message);
+        g_clear_error(&err);
+        return 1;
+    }
+
+    if (!server_start(&srv))
+    {
+        g_rmdir(cachedir);
+        g_free(cachedir);
+        return 1;
+    }
+
+    files[0] = g_strdup_printf("http://127.0.0.1:%d/tle.txt", srv.port);
+    files[1] = NULL;
+    validators = g_key_file_new();
+
+    errors += check_fetch("first fetch", files, cachedir, validators, 1, 0,
+                          TRUE);
+
+    errors += check_fetch("not modified", files, cachedir, validators, 0, 1,
+                          FALSE);
+    if (!g_atomic_int_get(&srv.conditional))
+    {
+        printf("  FAIL: request is not conditional\n");
+        errors++;
+    }
+
+    g_atomic_int_set(&srv.fail, 1);
+    errors += check_fetch("server error", files, cachedir, validators, 0, 0,
+                          FALSE);
+
+    server_stop(&srv);
+
+    g_key_file_free(validators);
+    g_free(files[0]);
+    g_rmdir(cachedir);
+    g_free(cachedir);
+
+    printf("%s: %d errors\n", errors ? "FAILED" : "PASSED", errors);
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,467 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Benchmark of the TLE parser.
+ *
+ * The files of a TLE update are read with tle_parser_read_files() and with
+ * the reader it replaced, which read each file with fgets() one after the
+ * other, and the sets are merged the way the update does it: the newest
+ * epoch of a satellite wins. Both readers must end up with the same sets.
+ *
+ * Without arguments a full catalogue of synthetic 3LE sets is generated
+ * and split over several files, a tenth of the sets also appearing with an
+ * older epoch in the next file. Real files, e.g. the active.txt of
+ * CelesTrak, can be given instead.
+ */
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+#include "tle-parser.h"
+
+static gint numsets = 30000;
+static gint numfiles = 8;
+static gint runs = 5;
+
+static GOptionEntry entries[] = {
+    {"sets", 0, 0, G_OPTION_ARG_INT, &numsets,
+     "Number of synthetic sets (max 99999)", "N"},
+    {"files", 0, 0, G_OPTION_ARG_INT, &numfiles,
+     "Number of files the synthetic sets are split over", "N"},
+    {"runs", 0, 0, G_OPTION_ARG_INT, &runs,
+     "Number of runs; the best one is reported", "N"},
+    {NULL}
+};
+
+/* A merged set, as new_tle_t in the update */
+typedef struct {
+    gdouble epoch;
+    gint status;
+    gchar *satname;
+    gchar *line1;
+    gchar *line2;
+} merged_t;
+
+/* The readers only log */
+void sat_log_message(sat_log_level_t level, const char *fmt, ...)
+{
+    (void)level;
+    (void)fmt;
+}
+
+static void merged_free(gpointer data)
+{
+    merged_t *set = data;
+
+    g_free(set->satname);
+    g_free(set->line1);
+    g_free(set->line2);
+    g_free(set);
+}
+
+static GHashTable *merged_new(void)
+{
+    return g_hash_table_new_full(g_int_hash, g_int_equal, g_free,
+                                 merged_free);
+}
+
+/* Merge a set; the newest epoch wins. Returns TRUE if the set is new. */
+static gboolean merge(GHashTable *data, guint catnum, gdouble epoch,
+                      gint status, const gchar *name, const gchar *line1,
+                      const gchar *line2)
+{
+    merged_t *set;
+    guint *key;
+
+    set = g_hash_table_lookup(data, &catnum);
+    if (set != NULL && set->epoch >= epoch)
+        return FALSE;
+
+    if (set == NULL)
+    {
+        set = g_new0(merged_t, 1);
+        key = g_new(guint, 1);
+        *key = catnum;
+        g_hash_table_insert(data, key, set);
+    }
+
+    g_free(set->satname);
+    g_free(set->line1);
+    g_free(set->line2);
+    set->epoch = epoch;
+    set->status = status;
+    set->satname = g_strdup(name);
+    set->line1 = g_strdup(line1);
+    set->line2 = g_strdup(line2);
+
+    return TRUE;
+}
+
+/*
+ * The reader replaced by the TLE parser, without the sync of the .cat file.
+ *
+ * Returns the number of sets read.
+ */
+static gint old_read_tle(const gchar *path, GHashTable *data)
+{
+    tle_t tle;
+    gchar tle_str[3][80];
+    gchar tle_working[3][80];
+    gchar linetmp[80];
+    guint linesneeded = 3;
+    gchar catstr[6];
+    gchar idstr[7] = "\0\0\0\0\0\0\0", idyearstr[3];
+    gchar *b;
+    FILE *fp;
+    gint retcode = 0;
+    guint catnr, i, idyear;
+
+    fp = g_fopen(path, "r");
+    if (fp == NULL)
+        return 0;
+
+    /* set b to non-null as a flag */
+    b = tle_working[0];
+
+    while (fgets(linetmp, 80, fp))
+    {
+        /* read in the number of lines needed to potentially get to a new tle */
+        switch (linesneeded)
+        {
+        case 3:
+            strncpy(tle_working[0], linetmp, 80);
+            tle_working[0][79] = 0;
+            b = fgets(tle_working[1], 80, fp);
+            if (b == NULL)
+            {
+                tle_working[1][0] = '\0';
+                break;
+            }
+            if (fgets(tle_working[2], 80, fp) == NULL)
+                tle_working[2][0] = '\0';
+            break;
+        case 2:
+            strncpy(tle_working[0], tle_working[2], 80);
+            strncpy(tle_working[1], linetmp, 80);
+            if (fgets(tle_working[2], 80, fp) == NULL)
+                tle_working[2][0] = '\0';
+            break;
+        default:
+            strncpy(tle_working[0], tle_working[1], 80);
+            strncpy(tle_working[1], tle_working[2], 80);
+            memcpy(tle_working[2], linetmp, 80);
+            tle_working[2][79] = 0;
+            break;
+        }
+
+        /* a tle must be two or three lines */
+        if (b == NULL)
+            break;
+
+        g_strstrip(tle_working[0]);
+        g_strstrip(tle_working[1]);
+        g_strstrip(tle_working[2]);
+
+        if ((tle_working[1][0] == '1') && (tle_working[2][0] == '2') &&
+            Checksum_Good(tle_working[1]) && Checksum_Good(tle_working[2]))
+        {
+            strncpy(tle_str[0], tle_working[0], 80);
+            tle_str[0][79] = 0;
+            strncpy(tle_str[1], tle_working[1], 80);
+            strncpy(tle_str[2], tle_working[2], 80);
+            linesneeded = 3;
+        }
+        else if ((tle_working[0][0] == '1') && (tle_working[1][0] == '2') &&
+                 Checksum_Good(tle_working[0]) &&
+                 Checksum_Good(tle_working[1]))
+        {
+            memcpy(idstr, &tle_working[0][11], 6);
+            g_strstrip(idstr);
+            memcpy(idyearstr, &tle_working[0][9], 2);
+            idstr[6] = 0;
+            idyearstr[2] = '\0';
+            idyear = g_ascii_strtod(idyearstr, NULL);
+            idyear += (idyear >= 57) ? 1900 : 2000;
+
+            snprintf(tle_str[0], 79, "%d-%s", idyear, idstr);
+            strncpy(tle_str[1], tle_working[0], 80);
+            strncpy(tle_str[2], tle_working[1], 80);
+            linesneeded = 2;
+        }
+        else
+        {
+            /* junk; read another line */
+            linesneeded = 1;
+            continue;
+        }
+
+        tle_str[1][69] = '\0';
+        tle_str[2][69] = '\0';
+
+        for (i = 2; i < 7; i++)
+            catstr[i - 2] = tle_str[1][i];
+        catstr[5] = '\0';
+        catnr = (guint)g_ascii_strtod(catstr, NULL);
+
+        if (Get_Next_Tle_Set(tle_str, &tle) == 1 &&
+            merge(data, catnr, tle.epoch, tle.status, tle.sat_name,
+                  tle_str[1], tle_str[2]))
+            retcode++;
+    }
+
+    fclose(fp);
+
+    return retcode;
+}
+
+static gint old_read_files(gchar **paths, GHashTable *data)
+{
+    gint num = 0;
+    guint i;
+
+    for (i = 0; paths[i] != NULL; i++)
+        num += old_read_tle(paths[i], data);
+
+    return num;
+}
+
+static gint new_read_files(gchar **paths, GHashTable *data)
+{
+    GPtrArray *files;
+    tle_parser_file_t *file;
+    tle_parser_elem_t *elem;
+    gint num = 0;
+    guint i, j;
+
+    files = tle_parser_read_files(paths);
+    for (i = 0; i < files->len; i++)
+    {
+        file = g_ptr_array_index(files, i);
+        for (j = 0; j < file->elems->len; j++)
+        {
+            elem = &g_array_index(file->elems, tle_parser_elem_t, j);
+            if (merge(data, elem->catnum, elem->epoch, elem->status,
+                      elem->name, elem->line1, elem->line2))
+                num++;
+        }
+    }
+    g_ptr_array_unref(files);
+
+    return num;
+}
+
+/* Put the checksum of a TLE line in column 69 */
+static void set_checksum(gchar *line)
+{
+    guint sum = 0;
+    guint i;
+
+    for (i = 0; i < 68; i++)
+    {
+        if (g_ascii_isdigit(line[i]))
+            sum += line[i] - '0';
+        else if (line[i] == '-')
+            sum++;
+    }
+
+    line[68] = '0' + sum % 10;
+    line[69] = '\0';
+}
+
+static void write_set(FILE *fp, guint catnum, gdouble epoch)
+{
+    gchar line1[80];
+    gchar line2[80];
+
+    g_snprintf(line1, sizeof(line1),
+               "1 %05uU %02u%03u%-3s %02u%012.8f  .00001000  00000-0  "
+               "20000-4 0  999", catnum, 57 + catnum % 43, catnum % 1000,
+               "A", 19, epoch);
+    g_snprintf(line2, sizeof(line2),
+               "2 %05u  51.6416 %8.4f 0006703 130.5360 %8.4f "
+               "15.72125391%05u", catnum, fmod(catnum * 7.3, 360.0),
+               fmod(catnum * 3.1, 360.0), catnum % 100000);
+    set_checksum(line1);
+    set_checksum(line2);
+
+    fprintf(fp, "SAT %05u%s\n%s\n%s\n", catnum,
+            (catnum % 5) ? "" : " [+]", line1, line2);
+}
+
+/* Generate the synthetic files; returns the paths */
+static gchar **generate(const gchar *dir)
+{
+    gchar **paths = g_new0(gchar *, numfiles + 1);
+    FILE **fp = g_new0(FILE *, numfiles);
+    gint i;
+
+    for (i = 0; i < numfiles; i++)
+    {
+        paths[i] = g_strdup_printf("%s%sfile-%d.tle", dir, G_DIR_SEPARATOR_S,
+                                   i);
+        fp[i] = g_fopen(paths[i], "w");
+        if (fp[i] == NULL)
+        {
+            printf("Could not create %s\n", paths[i]);
+            exit(1);
+        }
+    }
+
+    for (i = 0; i < numsets; i++)
+    {
+        write_set(fp[i % numfiles], i + 1, 1.0 + (i % 365));
+        if (i % 10 == 0)
+            write_set(fp[(i + 1) % numfiles], i + 1, 0.5 + (i % 365));
+    }
+
+    for (i = 0; i < numfiles; i++)
+        fclose(fp[i]);
+    g_free(fp);
+
+    return paths;
+}
+
+/* Whether both readers have merged the same sets */
+static gboolean same_sets(GHashTable *a, GHashTable *b)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+    merged_t *seta, *setb;
+
+    if (g_hash_table_size(a) != g_hash_table_size(b))
+        return FALSE;
+
+    g_hash_table_iter_init(&iter, a);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+    {
+        seta = value;
+        setb = g_hash_table_lookup(b, key);
+        if (setb == NULL || seta->epoch != setb->epoch ||
+            seta->status != setb->status ||
+            strcmp(seta->satname, setb->satname) ||
+            strcmp(seta->line1, setb->line1) ||
+            strcmp(seta->line2, setb->line2))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Time a reader; returns the best run in msec */
+static gdouble bench(const gchar *name,
+                     gint (*read_files)(gchar **, GHashTable *),
+                     gchar **paths, GHashTable **result)
+{
+    GHashTable *data = NULL;
+    gint64 start, best = G_MAXINT64;
+    gint num = 0;
+    gint i;
+
+    for (i = 0; i < runs; i++)
+    {
+        data = merged_new();
+        start = g_get_monotonic_time();
+        num = read_files(paths, data);
+        best = MIN(best, g_get_monotonic_time() - start);
+
+        if (i < runs - 1)
+            g_hash_table_destroy(data);
+    }
+
+    printf("%-12s %6d sets %10.2f ms\n", name, num, best / 1000.0);
+    *result = data;
+
+    return best / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    GOptionContext *context;
+    GError *err = NULL;
+    GHashTable *olddata, *newdata;
+    gchar **paths;
+    gchar *dir = NULL;
+    gdouble oldtime, newtime;
+    gboolean ok;
+    gint i;
+
+    context = g_option_context_new("[FILE...]");
+    g_option_context_set_summary(
+        context, "Time tle_parser_read_files() against the old TLE reader.");
+    g_option_context_add_main_entries(context, entries, NULL);
+    if (!g_option_context_parse(context, &argc, &argv, &err))
+    {
+        printf("%s\n", err->message);
+        g_clear_error(&err);
+        g_option_context_free(context);
+        return 1;
+    }
+    g_option_context_free(context);
+
+    if (numsets < 1 || numsets > 99999 || numfiles < 1 || runs < 1)
+    {
+        printf("Invalid number of sets, files or runs\n");
+        return 1;
+    }
+
+    if (argc > 1)
+    {
+        paths = g_strdupv(&argv[1]);
+    }
+    else
+    {
+        dir = g_dir_make_tmp("test-tle-parser-XXXXXX", &err);
+        if (dir == NULL)
+        {
+            printf("%s\n", err->message);
+            g_clear_error(&err);
+            return 1;
+        }
+        paths = generate(dir);
+        printf("%d synthetic sets in %d files\n", numsets, numfiles);
+    }
+
+    oldtime = bench("old reader", old_read_files, paths, &olddata);
+    newtime = bench("tle-parser", new_read_files, paths, &newdata);
+    printf("Speedup: %.1fx on %u processors\n", oldtime / newtime,
+           g_get_num_processors());
+
+    ok = same_sets(olddata, newdata);
+    if (!ok)
+        printf("FAILED: the readers merged different sets\n");
+
+    g_hash_table_destroy(olddata);
+    g_hash_table_destroy(newdata);
+
+    if (dir != NULL)
+    {
+        for (i = 0; paths[i] != NULL; i++)
+            g_remove(paths[i]);
+        g_rmdir(dir);
+        g_free(dir);
+    }
+    g_strfreev(paths);
+
+    return ok ? 0 : 1;
+}
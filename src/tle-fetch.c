@@ -0,0 +1,452 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Fetching of the TLE files to the cache for the network update.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <string.h>
+#ifdef WIN32
+#include "win32-fetch.h"
+#else
+#include <curl/curl.h>
+#endif
+
+#include "sat-log.h"
+#include "tle-fetch.h"
+
+
+#ifdef WIN32
+/**
+ * Fetch TLE files to the cache.
+ *
+ * @param files NULL terminated list of URLs.
+ * @param cachedir The directory the files are fetched to.
+ * @param proxy The proxy server or NULL.
+ * @param validators Not used; conditional requests need curl.
+ * @param parallel Not used; the files are fetched one at a time.
+ * @param progress Function called with the progress of the fetch (can be NULL)
+ * @param data User data passed to progress.
+ * @param unchanged Location to store the number of unchanged files.
+ * @return The number of files fetched.
+ */
+guint tle_fetch_files(gchar ** files, const gchar * cachedir,
+                      const gchar * proxy, GKeyFile * validators,
+                      guint parallel, tle_fetch_progress_t progress,
+                      gpointer data, guint * unchanged)
+{
+    guint           numfiles, i;
+    gchar          *locfile;
+    int             res;
+    FILE           *outfile;
+    guint           success = 0;        /* no. of successful downloads */
+
+    (void)validators;
+    (void)parallel;
+
+    *unchanged = 0;
+    numfiles = g_strv_length(files);
+
+    for (i = 0; i < numfiles; i++)
+    {
+        /* set activity message */
+        if (progress != NULL)
+            progress(files[i], i, numfiles, data);
+
+        /* create local cache file file-%d.tle */
+        locfile = g_strdup_printf("%s%sfile-%d.tle", cachedir,
+                                  G_DIR_SEPARATOR_S, i);
+        outfile = g_fopen(locfile, "wb");
+        if (outfile != NULL)
+        {
+            res = win32_fetch(files[i], outfile, proxy, "gpredict/win32");
+            if (res != 0)
+            {
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: Error fetching %s (%x)"),
+                            __func__, files[i], res);
+            }
+            else
+            {
+                sat_log_log(SAT_LOG_LEVEL_INFO,
+                            _("%s: Successfully fetched %s"),
+                            __func__, files[i]);
+                success++;
+            }
+            fclose(outfile);
+        }
+        else
+        {
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: Failed to open %s preventing update"),
+                        __func__, locfile);
+        }
+        /* update progress indicator */
+        if (progress != NULL)
+            progress(NULL, i + 1, numfiles, data);
+
+        g_free(locfile);
+    }
+
+    return success;
+}
+#else
+/** Outcome of fetching a TLE file. */
+typedef enum {
+    TLE_FETCH_FAILED = 0,       /*!< The file could not be fetched. */
+    TLE_FETCH_NEW,              /*!< The file has been fetched to the cache. */
+    TLE_FETCH_UNCHANGED         /*!< The file has not changed since last time. */
+} tle_fetch_result_t;
+
+/**
+ * Check whether the validators of a URL can be remembered.
+ *
+ * The URL is used as group name in the validators file, and the key file
+ * format does not allow brackets or line breaks in group names.
+ */
+static gboolean can_remember(const gchar * url)
+{
+    return strpbrk(url, "[]\r\n") == NULL;
+}
+
+/**
+ * Write TLE data block to file.
+ *
+ * @param ptr Pointer to the data block to be written.
+ * @param size Size of data block.
+ * @param nmemb Size multiplier?
+ * @param stream Pointer to the file handle.
+ * @return The number of bytes actually written.
+ *
+ * This function writes the received data to the file pointed to by stream.
+ * It is used as write callback by to curl exec function.
+ */
+static size_t my_write_func(void *ptr, size_t size, size_t nmemb,
+                            FILE * stream)
+{
+    /*** FIXME: TBC whether this works in wintendo */
+    return fwrite(ptr, size, nmemb, stream);
+}
+
+/** A TLE file being fetched. */
+typedef struct {
+    const gchar    *url;
+    gchar          *locfile;    /*!< The cache file the data is written to. */
+    FILE           *outfile;
+    CURL           *curl;
+    struct curl_slist *headers; /*!< Extra request headers. */
+    gchar          *etag;       /*!< ETag of the response, if any. */
+} tle_fetch_t;
+
+/**
+ * Pick the ETag from the response headers.
+ *
+ * This function is used as header callback by curl. Each response starts
+ * with its status line, so that the ETag of a redirect is not taken for
+ * that of the file.
+ */
+static size_t header_func(char *buffer, size_t size, size_t nitems,
+                          void *data)
+{
+    tle_fetch_t    *fetch = data;
+    size_t          len = size * nitems;
+
+    if (len >= 5 && !g_ascii_strncasecmp(buffer, "HTTP/", 5))
+    {
+        g_free(fetch->etag);
+        fetch->etag = NULL;
+    }
+    else if (len > 5 && !g_ascii_strncasecmp(buffer, "ETag:", 5))
+    {
+        g_free(fetch->etag);
+        fetch->etag = g_strstrip(g_strndup(buffer + 5, len - 5));
+    }
+
+    return len;
+}
+
+/**
+ * Start fetching a TLE file.
+ *
+ * If the file has been fetched before the request is conditional, so that
+ * the server only sends the file if it has changed since.
+ *
+ * @return TRUE if the transfer has been added to multi.
+ */
+static gboolean start_fetch(CURLM * multi, tle_fetch_t * fetch,
+                            GKeyFile * validators, const gchar * proxy)
+{
+    gchar          *etag;
+    gchar          *header;
+    gint64          modified;
+
+    fetch->outfile = g_fopen(fetch->locfile, "wb");
+    if (fetch->outfile == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Failed to open %s preventing update"),
+                    __func__, fetch->locfile);
+        return FALSE;
+    }
+
+    fetch->curl = curl_easy_init();
+    if (proxy != NULL)
+        curl_easy_setopt(fetch->curl, CURLOPT_PROXY, proxy);
+
+    curl_easy_setopt(fetch->curl, CURLOPT_URL, fetch->url);
+    curl_easy_setopt(fetch->curl, CURLOPT_PRIVATE, fetch);
+    curl_easy_setopt(fetch->curl, CURLOPT_USERAGENT, "gpredict/curl");
+    curl_easy_setopt(fetch->curl, CURLOPT_CONNECTTIMEOUT, 10);
+    curl_easy_setopt(fetch->curl, CURLOPT_WRITEDATA, fetch->outfile);
+    curl_easy_setopt(fetch->curl, CURLOPT_WRITEFUNCTION, my_write_func);
+    curl_easy_setopt(fetch->curl, CURLOPT_HEADERDATA, fetch);
+    curl_easy_setopt(fetch->curl, CURLOPT_HEADERFUNCTION, header_func);
+    curl_easy_setopt(fetch->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(fetch->curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(fetch->curl, CURLOPT_FILETIME, 1L);
+
+    if (can_remember(fetch->url))
+    {
+        etag = g_key_file_get_string(validators, fetch->url, "ETag", NULL);
+        if (etag != NULL)
+        {
+            header = g_strdup_printf("If-None-Match: %s", etag);
+            fetch->headers = curl_slist_append(NULL, header);
+            curl_easy_setopt(fetch->curl, CURLOPT_HTTPHEADER, fetch->headers);
+            g_free(header);
+            g_free(etag);
+        }
+
+        modified = g_key_file_get_int64(validators, fetch->url, "Modified",
+                                        NULL);
+        if (modified > 0)
+        {
+            curl_easy_setopt(fetch->curl, CURLOPT_TIMECONDITION,
+                             (long)CURL_TIMECOND_IFMODSINCE);
+            curl_easy_setopt(fetch->curl, CURLOPT_TIMEVALUE, (long)modified);
+        }
+    }
+
+    curl_multi_add_handle(multi, fetch->curl);
+
+    return TRUE;
+}
+
+/**
+ * Finish a transfer and remember the validators of a fetched file.
+ *
+ * Cache files that have not been fetched are removed, so that only fresh
+ * data is read by the update.
+ */
+static tle_fetch_result_t finish_fetch(CURLM * multi, tle_fetch_t * fetch,
+                                       CURLcode res, GKeyFile * validators)
+{
+    tle_fetch_result_t result;
+    long            code = 0;
+    long            unmet = 0;
+    long            filetime = -1;
+
+    fclose(fetch->outfile);
+    fetch->outfile = NULL;
+
+    curl_easy_getinfo(fetch->curl, CURLINFO_RESPONSE_CODE, &code);
+    curl_easy_getinfo(fetch->curl, CURLINFO_CONDITION_UNMET, &unmet);
+    curl_easy_getinfo(fetch->curl, CURLINFO_FILETIME, &filetime);
+
+    if (res != CURLE_OK)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error fetching %s (%s)"),
+                    __func__, fetch->url, curl_easy_strerror(res));
+        result = TLE_FETCH_FAILED;
+    }
+    else if (code == 304 || unmet)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: %s has not changed"), __func__, fetch->url);
+        result = TLE_FETCH_UNCHANGED;
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Successfully fetched %s"), __func__, fetch->url);
+        result = TLE_FETCH_NEW;
+
+        if (can_remember(fetch->url))
+        {
+            g_key_file_remove_group(validators, fetch->url, NULL);
+            if (fetch->etag != NULL && fetch->etag[0] != '\0')
+                g_key_file_set_string(validators, fetch->url, "ETag",
+                                      fetch->etag);
+            if (filetime > 0)
+                g_key_file_set_int64(validators, fetch->url, "Modified",
+                                     filetime);
+        }
+    }
+
+    if (result != TLE_FETCH_NEW)
+        g_remove(fetch->locfile);
+
+    curl_multi_remove_handle(multi, fetch->curl);
+    curl_easy_cleanup(fetch->curl);
+    fetch->curl = NULL;
+
+    return result;
+}
+
+/**
+ * Fetch TLE files to the cache.
+ *
+ * The files are fetched concurrently, at most parallel at a time, and only
+ * if they have changed since they were last fetched. The i-th URL is
+ * fetched to file-i.tle in cachedir; the cache files of the URLs that have
+ * not changed or could not be fetched are removed.
+ *
+ * @param files NULL terminated list of URLs.
+ * @param cachedir The directory the files are fetched to.
+ * @param proxy The proxy server or NULL.
+ * @param validators The validators of the files fetched before; updated
+ *                   with those of the files fetched now.
+ * @param parallel The maximum number of concurrent transfers.
+ * @param progress Function called with the progress of the fetch (can be NULL)
+ * @param data User data passed to progress.
+ * @param unchanged Location to store the number of unchanged files.
+ * @return The number of files fetched.
+ */
+guint tle_fetch_files(gchar ** files, const gchar * cachedir,
+                      const gchar * proxy, GKeyFile * validators,
+                      guint parallel, tle_fetch_progress_t progress,
+                      gpointer data, guint * unchanged)
+{
+    tle_fetch_t    *fetches;
+    tle_fetch_t    *fetch;
+    CURLM          *multi;
+    CURLMcode       mres;
+    CURLMsg        *msg;
+    CURLcode        res;
+    char           *priv;
+    gint            running = 0;
+    gint            left;
+    guint           numfiles, i;
+    guint           next = 0, active = 0, done = 0;
+    guint           success = 0;        /* no. of successful downloads */
+
+    *unchanged = 0;
+    numfiles = g_strv_length(files);
+    parallel = MAX(1, parallel);
+
+    /* local cache files file-%d.tle */
+    fetches = g_new0(tle_fetch_t, numfiles);
+    for (i = 0; i < numfiles; i++)
+    {
+        fetches[i].url = files[i];
+        fetches[i].locfile = g_strdup_printf("%s%sfile-%d.tle", cachedir,
+                                             G_DIR_SEPARATOR_S, i);
+    }
+
+    multi = curl_multi_init();
+
+    while (done < numfiles)
+    {
+        /* keep up to parallel transfers going */
+        while (next < numfiles && active < parallel)
+        {
+            fetch = &fetches[next++];
+            if (!start_fetch(multi, fetch, validators, proxy))
+            {
+                done++;
+                continue;
+            }
+            active++;
+
+            /* set activity message */
+            if (progress != NULL)
+                progress(fetch->url, done, numfiles, data);
+        }
+
+        if (active == 0)
+            continue;
+
+        mres = curl_multi_perform(multi, &running);
+        if (mres != CURLM_OK)
+        {
+            sat_log_log(SAT_LOG_LEVEL_ERROR,
+                        _("%s: Error fetching TLE files (%s)"),
+                        __func__, curl_multi_strerror(mres));
+            break;
+        }
+
+        while ((msg = curl_multi_info_read(multi, &left)) != NULL)
+        {
+            if (msg->msg != CURLMSG_DONE)
+                continue;
+
+            res = msg->data.result;
+            curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+            fetch = (tle_fetch_t *) priv;
+
+            switch (finish_fetch(multi, fetch, res, validators))
+            {
+            case TLE_FETCH_NEW:
+                success++;
+                break;
+            case TLE_FETCH_UNCHANGED:
+                (*unchanged)++;
+                break;
+            default:
+                break;
+            }
+            active--;
+            done++;
+        }
+
+        if (running > 0)
+            curl_multi_wait(multi, NULL, 0, 100, NULL);
+
+        /* update progress indicator */
+        if (progress != NULL)
+            progress(NULL, done, numfiles, data);
+    }
+
+    /* clean up transfers left by an error */
+    for (i = 0; i < numfiles; i++)
+    {
+        if (fetches[i].curl != NULL)
+        {
+            curl_multi_remove_handle(multi, fetches[i].curl);
+            curl_easy_cleanup(fetches[i].curl);
+        }
+        if (fetches[i].outfile != NULL)
+            fclose(fetches[i].outfile);
+        curl_slist_free_all(fetches[i].headers);
+        g_free(fetches[i].etag);
+        g_free(fetches[i].locfile);
+    }
+    g_free(fetches);
+
+    curl_multi_cleanup(multi);
+
+    return success;
+}
+#endif
@@ -0,0 +1,36 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef TLE_FETCH_H
+#define TLE_FETCH_H 1
+
+#include <glib.h>
+
+/*
+ * Progress of a fetch; url is the file whose transfer has just started or
+ * NULL, done and total are the number of files finished and to fetch.
+ */
+typedef void (*tle_fetch_progress_t)(const gchar *url, guint done,
+                                     guint total, gpointer data);
+
+guint tle_fetch_files(gchar **files, const gchar *cachedir,
+                      const gchar *proxy, GKeyFile *validators,
+                      guint parallel, tle_fetch_progress_t progress,
+                      gpointer data, guint *unchanged);
+
+#endif
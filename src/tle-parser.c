@@ -0,0 +1,298 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Reader of TLE files as fetched by the TLE updater.
+ *
+ * A file is mapped into memory and scanned a line at a time through a window
+ * of three lines, without copying the text. The window holds either a name
+ * and a TLE (3LE), a bare TLE (2LE), or a line of something else, which is
+ * skipped. Only the sets that pass the line checks are copied out and
+ * converted, so a full catalogue is read in one pass over the file.
+ *
+ * Files that hold an OMM instead, as the catalogue providers also publish,
+ * are handed over to the OMM reader.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "omm.h"
+#include "sat-log.h"
+#include "sgpsdp/sgp4sdp4.h"
+#include "tle-parser.h"
+
+/* A line of the mapped file, without the surrounding white space */
+typedef struct {
+    const gchar *text;
+    gsize len;
+} span_t;
+
+/* What each character adds to the checksum of a TLE line */
+static const guint8 checksum_value[256] = {
+    ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4, ['5'] = 5,
+    ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9, ['-'] = 1,
+};
+
+/*
+ * Get the next line of the file.
+ *
+ * @return FALSE at the end of the file.
+ */
+static gboolean next_line(const gchar **pos, const gchar *end, span_t *line)
+{
+    const gchar *start = *pos;
+    const gchar *stop;
+
+    if (start >= end)
+        return FALSE;
+
+    stop = memchr(start, '\n', end - start);
+    *pos = stop ? stop + 1 : end;
+    if (stop == NULL)
+        stop = end;
+
+    while (start < stop && g_ascii_isspace(*start))
+        start++;
+    while (stop > start && g_ascii_isspace(stop[-1]))
+        stop--;
+
+    line->text = start;
+    line->len = stop - start;
+
+    return TRUE;
+}
+
+/* Whether a line is TLE line num with a good checksum; see Checksum_Good() */
+static gboolean is_tle_line(const span_t *line, gchar num)
+{
+    guint sum = 0;
+    guint i;
+
+    if (line->len < 69 || line->text[0] != num)
+        return FALSE;
+
+    for (i = 0; i < 68; i++)
+        sum += checksum_value[(guchar)line->text[i]];
+
+    return line->text[68] == '0' + (gchar)(sum % 10);
+}
+
+static void copy_line(gchar *dest, const span_t *line, gsize max)
+{
+    gsize len = MIN(line->len, max);
+
+    memcpy(dest, line->text, len);
+    dest[len] = '\0';
+}
+
+/*
+ * Convert an element set and add it to the file.
+ *
+ * @param name The name line, or NULL for a bare TLE, which is named after
+ *             its international designator in the form yyyy-nnnaaa.
+ */
+static void add_set(tle_parser_file_t *file, const span_t *name,
+                    const span_t *line1, const span_t *line2)
+{
+    tle_parser_elem_t elem;
+    gchar lines[3][80];
+    gchar idstr[7], idyearstr[3];
+    guint idyear;
+    tle_t tle;
+
+    if (name != NULL)
+    {
+        copy_line(lines[0], name, 79);
+    }
+    else
+    {
+        memcpy(idstr, &line1->text[11], 6);
+        idstr[6] = '\0';
+        g_strstrip(idstr);
+        memcpy(idyearstr, &line1->text[9], 2);
+        idyearstr[2] = '\0';
+        idyear = g_ascii_strtoull(idyearstr, NULL, 10);
+
+        /* there is a two digit year field that started around sputnik */
+        idyear += (idyear >= 57) ? 1900 : 2000;
+        snprintf(lines[0], 79, "%u-%s", idyear, idstr);
+    }
+    copy_line(lines[1], line1, 69);
+    copy_line(lines[2], line2, 69);
+
+    if (Get_Next_Tle_Set(lines, &tle) != 1)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Invalid data for %.5s in %s"),
+                    __func__, &lines[1][2], file->path);
+        return;
+    }
+
+    elem.catnum = tle.catnr;
+    elem.status = tle.status;
+    elem.epoch = tle.epoch;
+    elem.name = g_string_chunk_insert(file->strings, tle.sat_name);
+    memcpy(elem.line1, lines[1], sizeof(elem.line1));
+    memcpy(elem.line2, lines[2], sizeof(elem.line2));
+    g_array_append_val(file->elems, elem);
+}
+
+/*
+ * Read the element sets of a TLE file.
+ *
+ * Both 3LE and 2LE files are read, and anything between the sets is
+ * skipped. An OMM file is read into omm instead of elems. Can be called
+ * from any thread.
+ *
+ * @param path The file.
+ * @return The sets, to be freed with tle_parser_file_free(). If the file
+ *         could not be read, failed is set and there are no sets.
+ */
+tle_parser_file_t *tle_parser_read(const gchar *path)
+{
+    tle_parser_file_t *file;
+    GMappedFile *map;
+    GError *err = NULL;
+    const gchar *pos, *end;
+    span_t win[3];
+    guint n = 0, used;
+
+    file = g_new0(tle_parser_file_t, 1);
+    file->path = g_strdup(path);
+    file->elems = g_array_new(FALSE, FALSE, sizeof(tle_parser_elem_t));
+    file->strings = g_string_chunk_new(4096);
+
+    map = g_mapped_file_new(path, FALSE, &err);
+    if (map == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not open %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+        file->failed = TRUE;
+        return file;
+    }
+
+    pos = g_mapped_file_get_contents(map);
+    end = pos + g_mapped_file_get_length(map);
+
+    if (omm_detect(pos, end - pos) != OMM_FORMAT_NONE)
+    {
+        file->omm = omm_cache_new();
+        omm_read(file->omm, pos, end - pos, path);
+        g_mapped_file_unref(map);
+        return file;
+    }
+
+    for (;;)
+    {
+        while (n < 3 && next_line(&pos, end, &win[n]))
+            n++;
+
+        /* a set has at least two lines */
+        if (n < 2)
+            break;
+
+        if (n == 3 && is_tle_line(&win[1], '1') && is_tle_line(&win[2], '2'))
+        {
+            add_set(file, &win[0], &win[1], &win[2]);
+            used = 3;
+        }
+        else if (is_tle_line(&win[0], '1') && is_tle_line(&win[1], '2'))
+        {
+            add_set(file, NULL, &win[0], &win[1]);
+            used = 2;
+        }
+        else
+        {
+            used = 1;
+        }
+
+        memmove(win, win + used, (n - used) * sizeof(span_t));
+        n -= used;
+    }
+
+    g_mapped_file_unref(map);
+
+    return file;
+}
+
+void tle_parser_file_free(tle_parser_file_t *file)
+{
+    if (file == NULL)
+        return;
+
+    g_free(file->path);
+    g_array_unref(file->elems);
+    g_string_chunk_free(file->strings);
+    omm_cache_free(file->omm);
+    g_free(file);
+}
+
+/* Read the file at position GPOINTER_TO_UINT(job) - 1 into files */
+static void read_job(gpointer job, gpointer files)
+{
+    guint i = GPOINTER_TO_UINT(job) - 1;
+    GPtrArray *result = files;
+
+    g_ptr_array_index(result, i) =
+        tle_parser_read(g_ptr_array_index(result, i));
+}
+
+/*
+ * Read several TLE files in parallel.
+ *
+ * @param paths NULL terminated list of files.
+ * @return The tle_parser_file_t of each file in the order of paths. Free
+ *         with g_ptr_array_unref().
+ */
+GPtrArray *tle_parser_read_files(gchar **paths)
+{
+    GPtrArray *files;
+    GThreadPool *pool;
+    guint num, i;
+
+    num = g_strv_length(paths);
+    files = g_ptr_array_new_full(num, (GDestroyNotify)tle_parser_file_free);
+
+    /* the jobs replace the paths with what was read from them */
+    for (i = 0; i < num; i++)
+        g_ptr_array_add(files, paths[i]);
+
+    pool = (num > 1) ? g_thread_pool_new(read_job, files,
+                                         MIN(num, g_get_num_processors()),
+                                         FALSE, NULL) : NULL;
+    if (pool == NULL)
+    {
+        for (i = 0; i < num; i++)
+            read_job(GUINT_TO_POINTER(i + 1), files);
+        return files;
+    }
+
+    for (i = 0; i < num; i++)
+        g_thread_pool_push(pool, GUINT_TO_POINTER(i + 1), NULL);
+
+    /* wait for the jobs to finish */
+    g_thread_pool_free(pool, FALSE, TRUE);
+
+    return files;
+}
@@ -0,0 +1,49 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef TLE_PARSER_H
+#define TLE_PARSER_H 1
+
+#include <glib.h>
+
+#include "omm.h"
+
+/* An element set read from a file */
+typedef struct {
+    guint catnum;
+    gint status;          /* op_stat_t */
+    gdouble epoch;        /* Epoch in TLE format */
+    const gchar *name;    /* Satellite name, without the status */
+    gchar line1[70];      /* TLE lines, trimmed to 69 characters */
+    gchar line2[70];
+} tle_parser_elem_t;
+
+/* The element sets of a file */
+typedef struct {
+    gchar *path;
+    gboolean failed;      /* The file could not be read */
+    GArray *elems;        /* tle_parser_elem_t in file order */
+    GStringChunk *strings;
+    omm_cache_t *omm;     /* Element sets of an OMM file, otherwise NULL */
+} tle_parser_file_t;
+
+tle_parser_file_t *tle_parser_read(const gchar *path);
+GPtrArray *tle_parser_read_files(gchar **paths);
+void tle_parser_file_free(tle_parser_file_t *file);
+
+#endif
@@ -32,27 +32,25 @@
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
 #endif
-#ifdef WIN32
-#include "win32-fetch.h"
-#else
-#include <curl/curl.h>
-#endif
 
 #include "compat.h"
 #include "gpredict-utils.h"
+#include "omm.h"
+#include "sat-catalogue.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
 #include "sgpsdp/sgp4sdp4.h"
+#include "tle-fetch.h"
+#include "tle-parser.h"
 #include "tle-update.h"
 
 
 /* private function prototypes */
-#ifndef WIN32
-static size_t   my_write_func(void *ptr, size_t size, size_t nmemb,
-                              FILE * stream);
-#endif
-static gint     read_fresh_tle(const gchar * dir, const gchar * fnam,
-                               GHashTable * data);
+static void     sync_cat_file(const gchar * fnam,
+                              const tle_parser_file_t * file);
+static gint     merge_fresh_tle(const gchar * fnam,
+                                const tle_parser_file_t * file,
+                                GHashTable * data);
 static gboolean is_tle_file(const gchar * dir, const gchar * fnam);
 
 
@@ -63,8 +61,17 @@ static void     update_tle_in_file(const gchar * ldname,
                                    guint * sat_ski,
                                    guint * sat_nod, guint * sat_tot);
 
+static void     update_catalogue(sat_catalogue_t * cat, GHashTable * data,
+                                 gboolean silent, GtkWidget * label1,
+                                 GtkWidget * label2);
+
 static guint    add_new_sats(GHashTable * data);
 static gboolean is_computer_generated_name(gchar * satname);
+static gboolean add_to_catalogue(sat_cat_builder_t * builder,
+                                 const gchar * name, const gchar * nickname,
+                                 const gchar * website, const gchar * tle1,
+                                 const gchar * tle2, const tle_t * elements,
+                                 gint status);
 
 
 /** Free a new_tle_t structure. */
@@ -77,10 +84,17 @@ static void free_new_tle(gpointer data)
     g_free(tle->satname);
     g_free(tle->line1);
     g_free(tle->line2);
+    g_free(tle->elements);
     g_free(tle->srcfile);
     g_free(tle);
 }
 
+/** Compare two file names in a GPtrArray. */
+static gint compare_names(gconstpointer a, gconstpointer b)
+{
+    return strcmp(*(const gchar * const *)a, *(const gchar * const *)b);
+}
+
 
 /**
  * Update TLE files from local files.
@@ -105,11 +119,17 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
     GHashTable     *data;       /* hash table with fresh TLE data */
     GDir           *cache_dir;  /* directory to scan fresh TLE */
     GDir           *loc_dir;    /* directory for gpredict TLE files */
+    sat_catalogue_t *cat;       /* satellite catalogue, if any */
     GError         *err = NULL;
     gchar          *text;
     gchar          *ldname;
     gchar          *userconfdir;
     const gchar    *fnam;
+    GPtrArray      *names;      /* names of the fresh TLE files */
+    GPtrArray      *files;      /* data read from them */
+    const tle_parser_file_t *file;
+    gchar         **paths;
+    guint           i;
     guint           num = 0;
     guint           updated, updated_tmp;
     guint           skipped, skipped_tmp;
@@ -160,36 +180,53 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
     else
     {
         /* scan directory for tle files */
+        names = g_ptr_array_new_with_free_func(g_free);
         while ((fnam = g_dir_read_name(cache_dir)) != NULL)
         {
             /* check that we got a TLE file */
             if (is_tle_file(dir, fnam))
-            {
-                /* status message */
-                if (!silent && (label1 != NULL))
-                {
-                    text = g_strdup_printf(_("Reading data from %s"), fnam);
-                    gtk_label_set_text(GTK_LABEL(label1), text);
-                    g_free(text);
+                g_ptr_array_add(names, g_strdup(fnam));
+            else
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: No valid TLE data found in %s"),
+                            __func__, fnam);
+        }
 
-                    /* Force the drawing queue to be processed otherwise there will
-                       not be any visual feedback, ie. frozen GUI
-                       - see Gtk+ FAQ http://www.gtk.org/faq/#AEN602
-                     */
-                    while (g_main_context_iteration(NULL, FALSE));
+        /* merge in the order of the names, whatever the order of the dir */
+        g_ptr_array_sort(names, compare_names);
 
-                    /* give user a chance to follow progress */
-                    g_usleep(G_USEC_PER_SEC / 100);
-                }
+        paths = g_new0(gchar *, names->len + 1);
+        for (i = 0; i < names->len; i++)
+            paths[i] = g_strconcat(dir, G_DIR_SEPARATOR_S,
+                                   g_ptr_array_index(names, i), NULL);
 
-                /* now, do read the fresh data */
-                num = read_fresh_tle(dir, fnam, data);
-            }
-            else
-            {
-                num = 0;
-            }
+        /* status message */
+        if (!silent && (label1 != NULL))
+        {
+            text = g_strdup_printf(_("Reading data from %s"), dir);
+            gtk_label_set_text(GTK_LABEL(label1), text);
+            g_free(text);
+
+            /* Force the drawing queue to be processed otherwise there will
+               not be any visual feedback, ie. frozen GUI
+               - see Gtk+ FAQ http://www.gtk.org/faq/#AEN602
+             */
+            while (g_main_context_iteration(NULL, FALSE));
+        }
+
+        /* now, do read the fresh data */
+        files = tle_parser_read_files(paths);
+        g_strfreev(paths);
+
+        for (i = 0; i < files->len; i++)
+        {
+            file = g_ptr_array_index(files, i);
+            fnam = g_ptr_array_index(names, i);
+
+            if (!file->failed)
+                sync_cat_file(fnam, file);
 
+            num = merge_fresh_tle(fnam, file, data);
             if (num < 1)
             {
                 sat_log_log(SAT_LOG_LEVEL_ERROR,
@@ -204,9 +241,25 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
             }
         }
 
+        g_ptr_array_unref(files);
+        g_ptr_array_unref(names);
+
         /* close directory since we don't need it anymore */
         g_dir_close(cache_dir);
 
+        /* update the satellite catalogue in one go if there is one */
+        cat = sat_catalogue_get_default();
+        if (cat != NULL)
+        {
+            update_catalogue(cat, data, silent, label1, label2);
+            sat_catalogue_unref(cat);
+            if (!silent && (progress != NULL))
+                gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress), 1.0);
+            g_hash_table_destroy(data);
+            g_mutex_unlock(&tle_file_in_progress);
+            return;
+        }
+
         /* now we load each .sat file and update if we have new data */
         userconfdir = get_user_conf_dir();
         ldname = g_strconcat(userconfdir, G_DIR_SEPARATOR_S, "satdata", NULL);
@@ -414,6 +467,211 @@ void tle_update_from_files(const gchar * dir, const gchar * filter,
 }
 
 
+/**
+ * Add a satellite to the catalogue being built.
+ *
+ * The satellite is added from its TLE lines if it has any, and otherwise
+ * from its elements, as read from an OMM.
+ *
+ * @return FALSE if the satellite could not be added.
+ */
+static gboolean add_to_catalogue(sat_cat_builder_t * builder,
+                                 const gchar * name, const gchar * nickname,
+                                 const gchar * website, const gchar * tle1,
+                                 const gchar * tle2, const tle_t * elements,
+                                 gint status)
+{
+    if (tle1 != NULL && tle1[0] != '\0')
+        return sat_cat_builder_add(builder, name, nickname, website,
+                                   tle1, tle2, status);
+
+    if (elements == NULL)
+        return FALSE;
+
+    return sat_cat_builder_add_elements(builder, name, nickname, website,
+                                        elements, status);
+}
+
+/**
+ * Update the satellite catalogue.
+ *
+ * @param cat The catalogue in use.
+ * @param data Hash table with the fresh TLE data.
+ * @param silent TRUE if the labels should not be updated.
+ * @param label1 Activity label (can be NULL)
+ * @param label2 Statistics label (can be NULL)
+ *
+ * This function applies the same rules as update_tle_in_file() to every
+ * satellite in the catalogue, adds the new satellites if the user wants
+ * them, and replaces the catalogue once at the end. Entries that are not
+ * changed are copied as they are.
+ */
+static void update_catalogue(sat_catalogue_t * cat, GHashTable * data,
+                             gboolean silent, GtkWidget * label1,
+                             GtkWidget * label2)
+{
+    sat_cat_builder_t *builder;
+    const sat_cat_entry_t *entry;
+    new_tle_t      *ntle;
+    GHashTableIter  iter;
+    gpointer        value;
+    const gchar    *name, *nickname, *tle1, *tle2;
+    const tle_t    *elements;
+    tle_t           oldtle;
+    gint            status;
+    guint           catnr;
+    guint           updated = 0;
+    guint           skipped = 0;
+    guint           nodata = 0;
+    guint           newsats = 0;
+    guint           i;
+    gboolean        updateddata;
+    gchar          *text;
+
+    if (!silent && (label1 != NULL))
+    {
+        gtk_label_set_text(GTK_LABEL(label1), _("Updating data..."));
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    builder = sat_cat_builder_new();
+
+    for (i = 0; i < sat_catalogue_size(cat); i++)
+    {
+        entry = sat_catalogue_nth(cat, i);
+        catnr = entry->catnr;
+        ntle = (new_tle_t *) g_hash_table_lookup(data, &catnr);
+
+        if (ntle == NULL)
+        {
+            /* no new data found for this sat => obsolete */
+            nodata++;
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _
+                        ("%s: No new TLE data found for %d. Satellite might be obsolete."),
+                        __func__, catnr);
+            sat_cat_builder_add_entry(builder, cat, entry);
+            continue;
+        }
+
+        /* This satellite is not new */
+        ntle->isnew = FALSE;
+
+        name = sat_catalogue_str(cat, entry->name);
+        nickname = sat_catalogue_str(cat, entry->nickname);
+        tle1 = entry->tle1;
+        tle2 = entry->tle2;
+        elements = NULL;
+        if (tle1[0] == '\0' && sat_catalogue_get_tle(cat, entry, &oldtle))
+            elements = &oldtle;
+        status = entry->status;
+        updateddata = FALSE;
+
+        /* see update_tle_in_file() for the rules */
+        if (ntle->satname != NULL &&
+            !is_computer_generated_name(ntle->satname))
+        {
+            if (name == NULL || is_computer_generated_name((gchar *) name))
+            {
+                name = ntle->satname;
+                updateddata = TRUE;
+            }
+            if (nickname == NULL ||
+                is_computer_generated_name((gchar *) nickname))
+            {
+                nickname = ntle->satname;
+                updateddata = TRUE;
+            }
+        }
+
+        if (entry->epoch < ntle->epoch)
+        {
+            tle1 = ntle->line1;
+            tle2 = ntle->line2;
+            elements = ntle->elements;
+            status = ntle->status;
+            updateddata = TRUE;
+        }
+        else if (entry->epoch == ntle->epoch)
+        {
+            if ((status != (gint) ntle->status) &&
+                (ntle->status != OP_STAT_UNKNOWN))
+            {
+                status = ntle->status;
+                updateddata = TRUE;
+            }
+        }
+
+        if (updateddata &&
+            add_to_catalogue(builder, name, nickname,
+                             sat_catalogue_str(cat, entry->website),
+                             tle1, tle2, elements, status))
+        {
+            sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                        _("%s: Data for  %d updated."), __func__, catnr);
+            updated++;
+        }
+        else
+        {
+            sat_cat_builder_add_entry(builder, cat, entry);
+            skipped++;
+        }
+    }
+
+    /* see if we have any new sats that need to be added */
+    if (sat_cfg_get_bool(SAT_CFG_BOOL_TLE_ADD_NEW))
+    {
+        g_hash_table_iter_init(&iter, data);
+        while (g_hash_table_iter_next(&iter, NULL, &value))
+        {
+            ntle = (new_tle_t *) value;
+            if (ntle->isnew &&
+                add_to_catalogue(builder, ntle->satname, ntle->satname,
+                                 NULL, ntle->line1, ntle->line2,
+                                 ntle->elements, ntle->status))
+                newsats++;
+        }
+
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s: Added %d new satellites to local database"),
+                    __func__, newsats);
+    }
+
+    if ((updated > 0) || (newsats > 0))
+    {
+        if (sat_catalogue_commit(builder))
+        {
+            gint64          now;
+
+            /* store time of update */
+            now = g_get_real_time() / G_USEC_PER_SEC;
+            sat_cfg_set_int(SAT_CFG_INT_TLE_LAST_UPDATE, now);
+        }
+        else
+        {
+            skipped += updated;
+            updated = 0;
+            newsats = 0;
+        }
+    }
+    sat_cat_builder_free(builder);
+
+    if (!silent && (label2 != NULL))
+    {
+        text = g_strdup_printf(_("Satellites updated:\t %d\n"
+                                 "Satellites skipped:\t %d\n"
+                                 "Missing Satellites:\t %d\n"
+                                 "New Satellites:\t\t %d"),
+                               updated, skipped, nodata, newsats);
+        gtk_label_set_text(GTK_LABEL(label2), text);
+        g_free(text);
+    }
+
+    sat_log_log(SAT_LOG_LEVEL_INFO,
+                _("%s: TLE elements updated (%d updated, %d skipped)."),
+                __func__, updated, skipped);
+}
+
 /** Check if satellite is new, if so, add it to local database */
 static void check_and_add_sat(gpointer key, gpointer value, gpointer user_data)
 {
@@ -428,6 +686,16 @@ static void check_and_add_sat(gpointer key, gpointer value, gpointer user_data)
     if (!ntle->isnew)
         return;
 
+    /* a .sat file can only hold TLE lines */
+    if (ntle->line1 == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _
+                    ("%s: %d has no TLE lines and can only be kept in the catalogue."),
+                    __func__, ntle->catnum);
+        return;
+    }
+
     /* create config data */
     satdata = g_key_file_new();
 
@@ -459,9 +727,124 @@ static guint add_new_sats(GHashTable * data)
     return num;
 }
 
+/**
+ * Name of the file where the validators of the sources are kept. It is not
+ * in the cache, where every file is read as TLE data and removed after the
+ * update.
+ */
+#define TLE_VALIDATORS_FILE "tle-sources.ini"
+
+/**
+ * Load the validators of the TLE sources.
+ *
+ * For each URL that has been fetched, the validators file holds the ETag
+ * and the modification time reported by the server, so that the next
+ * update only fetches the files that have changed since.
+ */
+static GKeyFile *load_validators(void)
+{
+    GKeyFile       *validators;
+    gchar          *path;
+
+    validators = g_key_file_new();
+    path = sat_file_name(TLE_VALIDATORS_FILE);
+    g_key_file_load_from_file(validators, path, G_KEY_FILE_NONE, NULL);
+    g_free(path);
+
+    return validators;
+}
+
+/** Save the validators of the TLE sources, forgetting URLs not in files. */
+static void save_validators(GKeyFile * validators, gchar ** files)
+{
+    gchar         **groups;
+    gchar          *path;
+    GError         *err = NULL;
+    guint           i, j;
+
+    groups = g_key_file_get_groups(validators, NULL);
+    for (i = 0; groups[i] != NULL; i++)
+    {
+        for (j = 0; files[j] != NULL; j++)
+            if (!strcmp(groups[i], files[j]))
+                break;
+
+        if (files[j] == NULL)
+            g_key_file_remove_group(validators, groups[i], NULL);
+    }
+    g_strfreev(groups);
+
+    path = sat_file_name(TLE_VALIDATORS_FILE);
+    if (!g_key_file_save_to_file(validators, path, &err))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Error writing %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+    }
+    g_free(path);
+}
+
+/**
+ * Forget which TLE files have been fetched.
+ *
+ * The next update from network fetches all files again. To be called when
+ * the local satellite data has been discarded.
+ */
+void tle_update_forget_sources(void)
+{
+    gchar          *path;
+
+    path = sat_file_name(TLE_VALIDATORS_FILE);
+    if (g_file_test(path, G_FILE_TEST_EXISTS) && g_remove(path))
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: Failed to remove %s"), __func__, path);
+    g_free(path);
+}
+
+/** The widgets showing the progress of a fetch. */
+typedef struct {
+    GtkWidget      *progress;   /*!< GtkProgressBar, can be NULL. */
+    GtkWidget      *label1;     /*!< GtkLabel for activity string. */
+    gdouble         start;      /*!< Fraction when the fetch started. */
+} fetch_ui_t;
+
+/** Show the progress of tle_fetch_files(). */
+static void fetch_progress(const gchar * url, guint done, guint total,
+                           gpointer data)
+{
+    fetch_ui_t     *ui = data;
+    gchar          *text;
+
+    /* set activity message */
+    if (url != NULL && ui->label1 != NULL)
+    {
+        text = g_strdup_printf(_("Fetching %s"), url);
+        gtk_label_set_text(GTK_LABEL(ui->label1), text);
+        g_free(text);
+    }
+
+    if (ui->progress != NULL)
+    {
+        /* complete download corresponds to 50% */
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ui->progress),
+                                      ui->start + (0.5 - ui->start) * done /
+                                      (1.0 * total));
+
+        /* Force the drawing queue to be processed otherwise there will
+           not be any visual feedback, ie. frozen GUI
+           - see Gtk+ FAQ http://www.gtk.org/faq/#AEN602
+         */
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+}
+
 /**
  * Update TLE files from network.
  *
+ * Only the files that have changed since the last update are fetched and
+ * read; see tle_fetch_files().
+ *
  * @param silent TRUE if function should execute without graphical status indicator.
  * @param progress Pointer to a GtkProgressBar progress indicator (can be NULL)
  * @param label1 GtkLabel for activity string.
@@ -476,24 +859,16 @@ void tle_update_from_network(gboolean silent,
     gchar          *proxy = NULL;
     gchar          *files_tmp;
     gchar         **files;
-    guint           numfiles, i;
-    gchar          *curfile;
+    guint           numfiles;
     gchar          *locfile;
-    gchar          *userconfdir;
-#ifdef WIN32
-    int             res;
-#else
-    CURL           *curl;
-    CURLcode        res;
-#endif
-    gdouble         fraction, start = 0;
-    FILE           *outfile;
+    GKeyFile       *validators;
+    fetch_ui_t      ui;
     GDir           *dir;
     gchar          *cache;
     const gchar    *fname;
-    gchar          *text;
     GError         *err = NULL;
-    guint           success = 0;        /* no. of successful downloads */
+    guint           success;    /* no. of successful downloads */
+    guint           unchanged;  /* no. of files not changed since last time */
 
     /* bail out if we are already in an update process */
     if (g_mutex_trylock(&tle_in_progress) == FALSE)
@@ -534,115 +909,18 @@ void tle_update_from_network(gboolean silent,
     }
     else
     {
-        /* initialise progress bar */
-        if (!silent && (progress != NULL))
-            start = gtk_progress_bar_get_fraction(GTK_PROGRESS_BAR(progress));
-
-#ifndef WIN32
-        /* initialise curl */
-        curl = curl_easy_init();
-        if (proxy != NULL)
-            curl_easy_setopt(curl, CURLOPT_PROXY, proxy);
-
-        curl_easy_setopt(curl, CURLOPT_USERAGENT, "gpredict/curl");
-        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10);
-#endif
-
-        /* get files */
-        for (i = 0; i < numfiles; i++)
-        {
-            /* set URL */
-            curfile = g_strdup(files[i]);
-#ifndef WIN32
-            curl_easy_setopt(curl, CURLOPT_URL, curfile);
-#endif
-
-            /* set activity message */
-            if (!silent && (label1 != NULL))
-            {
-
-                text = g_strdup_printf(_("Fetching %s"), files[i]);
-                gtk_label_set_text(GTK_LABEL(label1), text);
-                g_free(text);
-            }
-
-            /* create local cache file ~/.config/Gpredict/satdata/cache/file-%d.tle */
-            userconfdir = get_user_conf_dir();
-            locfile = g_strdup_printf("%s%ssatdata%scache%sfile-%d.tle",
-                                      userconfdir, G_DIR_SEPARATOR_S,
-                                      G_DIR_SEPARATOR_S, G_DIR_SEPARATOR_S, i);
-            outfile = g_fopen(locfile, "wb");
-            if (outfile != NULL)
-            {
-#ifdef WIN32
-                res = win32_fetch(curfile, outfile, proxy, "gpredict/win32");
-                if (res != 0)
-                {
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _("%s: Error fetching %s (%x)"),
-                                __func__, curfile, res);
-                }
-                else
-                {
-                    sat_log_log(SAT_LOG_LEVEL_INFO,
-                                _("%s: Successfully fetched %s"),
-                                __func__, curfile);
-                    success++;
-                }
-#else
-                curl_easy_setopt(curl, CURLOPT_WRITEDATA, outfile);
-                curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, my_write_func);
-                curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-                /* get file */
-                res = curl_easy_perform(curl);
-
-                if (res != CURLE_OK)
-                {
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _("%s: Error fetching %s (%s)"),
-                                __func__, curfile, curl_easy_strerror(res));
-                }
-                else
-                {
-                    sat_log_log(SAT_LOG_LEVEL_INFO,
-                                _("%s: Successfully fetched %s"),
-                                __func__, curfile);
-                    success++;
-                }
-#endif
-                fclose(outfile);
-            }
-            else
-            {
-                sat_log_log(SAT_LOG_LEVEL_INFO,
-                            _("%s: Failed to open %s preventing update"),
-                            __func__, locfile);
-            }
-            /* update progress indicator */
-            if (!silent && (progress != NULL))
-            {
-
-                /* complete download corresponds to 50% */
-                fraction = start + (0.5 - start) * i / (1.0 * numfiles);
-                gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progress),
-                                              fraction);
-
-                /* Force the drawing queue to be processed otherwise there will
-                   not be any visual feedback, ie. frozen GUI
-                   - see Gtk+ FAQ http://www.gtk.org/faq/#AEN602
-                 */
-                while (g_main_context_iteration(NULL, FALSE));
-            }
-
-            g_free(userconfdir);
-            g_free(curfile);
-            g_free(locfile);
-        }
-
-#ifndef WIN32
-        curl_easy_cleanup(curl);
-#endif
+        validators = load_validators();
+        ui.progress = progress;
+        ui.label1 = label1;
+        ui.start = (progress != NULL) ?
+            gtk_progress_bar_get_fraction(GTK_PROGRESS_BAR(progress)) : 0.0;
+        cache = sat_file_name("cache");
+        success = tle_fetch_files(files, cache, proxy, validators,
+                                  MAX(1, sat_cfg_get_int
+                                      (SAT_CFG_INT_TLE_PARALLEL)),
+                                  silent ? NULL : fetch_progress, &ui,
+                                  &unchanged);
+        g_free(cache);
 
         /* continue update if we have fetched at least one file */
         if (success > 0)
@@ -655,6 +933,15 @@ void tle_update_from_network(gboolean silent,
             tle_update_from_files(cache, NULL, silent, progress, label1,
                                   label2);
             g_free(cache);
+
+            /* the data of the files fetched is in now */
+            save_validators(validators, files);
+        }
+        else if (unchanged > 0)
+        {
+            sat_log_log(SAT_LOG_LEVEL_INFO,
+                        _("%s: TLE files have not changed since last update"),
+                        __func__);
         }
         else
         {
@@ -664,6 +951,7 @@ void tle_update_from_network(gboolean silent,
                         __func__);
         }
 
+        g_key_file_free(validators);
     }
 
     /* clear cache and memory */
@@ -689,11 +977,10 @@ void tle_update_from_network(gboolean silent,
         /* delete files in cache one by one */
         while ((fname = g_dir_read_name(dir)) != NULL)
         {
-
             locfile = g_strconcat(cache, G_DIR_SEPARATOR_S, fname, NULL);
             if (g_remove(locfile))
-                    sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                _("%s: Failed to remove %s"), __func__, locfile);
+                sat_log_log(SAT_LOG_LEVEL_ERROR,
+                            _("%s: Failed to remove %s"), __func__, locfile);
             g_free(locfile);
         }
         /* close cache */
@@ -704,27 +991,6 @@ void tle_update_from_network(gboolean silent,
     g_mutex_unlock(&tle_in_progress);
 }
 
-#ifndef WIN32
-/**
- * Write TLE data block to file.
- *
- * @param ptr Pointer to the data block to be written.
- * @param size Size of data block.
- * @param nmemb Size multiplier?
- * @param stream Pointer to the file handle.
- * @return The number of bytes actually written.
- *
- * This function writes the received data to the file pointed to by stream.
- * It is used as write callback by to curl exec function.
- */
-static size_t my_write_func(void *ptr, size_t size, size_t nmemb,
-                            FILE * stream)
-{
-    /*** FIXME: TBC whether this works in wintendo */
-    return fwrite(ptr, size, nmemb, stream);
-}
-#endif
-
 /**
  * Check whether file is TLE file.
  * @param dir The directory.
@@ -733,7 +999,7 @@ static size_t my_write_func(void *ptr, size_t size, size_t nmemb,
  * This function checks whether the file with path dir/fnam is a potential
  * TLE file. Checks performed:
  *   - It is a real file
- *   - suffix is .txt or .tle
+ *   - suffix is .txt or .tle, or that of an OMM (.csv, .json, .xml, .kvn)
  */
 static gboolean is_tle_file(const gchar * dir, const gchar * fnam)
 {
@@ -746,7 +1012,11 @@ static gboolean is_tle_file(const gchar * dir, const gchar * fnam)
 
     if (g_file_test(path, G_FILE_TEST_IS_REGULAR) &&
         (g_str_has_suffix(fname_lower, ".tle") ||
-         g_str_has_suffix(fname_lower, ".txt")))
+         g_str_has_suffix(fname_lower, ".txt") ||
+         g_str_has_suffix(fname_lower, ".csv") ||
+         g_str_has_suffix(fname_lower, ".json") ||
+         g_str_has_suffix(fname_lower, ".xml") ||
+         g_str_has_suffix(fname_lower, ".kvn")))
     {
         fileIsOk = TRUE;
     }
@@ -757,362 +1027,213 @@ static gboolean is_tle_file(const gchar * dir, const gchar * fnam)
 }
 
 /**
- * Read fresh TLE data into hash table.
+ * Update the category of a TLE file.
  *
- * @param dir The directory to read from.
- * @param fnam The name of the file to read from.
- * @param fresh_data Hash table where the data should be stored.
- * @return The number of satellites successfully read.
- * 
- * This function will read fresh TLE data from local files into memory.
- * If there is a saetllite category (.cat file) with the same name as the
- * input file it will also update the satellites in that category.
+ * @param fnam The name of the TLE file.
+ * @param file The data read from the file.
+ *
+ * If there is a satellite category (.cat file) with the same name as the
+ * TLE file, its satellites are replaced with those in the TLE file.
  */
-static gint read_fresh_tle(const gchar * dir, const gchar * fnam,
-                           GHashTable * data)
+static void sync_cat_file(const gchar * fnam, const tle_parser_file_t * file)
 {
-    new_tle_t      *ntle;
-    tle_t           tle;
-    gchar          *path;
-    gchar           tle_str[3][80];
-    gchar           tle_working[3][80];
-    gchar           linetmp[80];
-    guint           linesneeded = 3;
-    gchar           catstr[6];
-    gchar           idstr[7] = "\0\0\0\0\0\0\0", idyearstr[3];
-    gchar          *b;
-    FILE           *fp;
-    gint            retcode = 0;
-    guint           catnr, i, idyear;
-    guint          *key = NULL;
-
-    /* category sync related */
-    gchar          *catname, *catpath, *buff, **buffv;
+    gchar          *catname, *catpath, **buffv;
     FILE           *catfile;
     gchar           category[80];
-    gboolean        catsync = FALSE;    /* whether .cat file should be synced. NB: not effective since 1.4 */
-
-    /* 
-       Normal cases to check
-       1. 3 line tle file as in amateur.txt from celestrak
-       2. 2 line tle file as in .... from celestrak
+    guint           i;
 
-       corner cases to check 
-       1. 3 line tle with something at the end. (nasa.all from amsat)
-       2. 2 line tle with only one in the file
-       3. 2 line tle file reading the last one.
-     */
+    buffv = g_strsplit(fnam, ".", 0);
+    catname = g_strconcat(buffv[0], ".cat", NULL);
+    g_strfreev(buffv);
+    catpath = sat_file_name(catname);
+    g_free(catname);
 
-    path = g_strconcat(dir, G_DIR_SEPARATOR_S, fnam, NULL);
-    fp = g_fopen(path, "r");
-    if (fp != NULL)
+    /* read category name for catfile */
+    catfile = g_fopen(catpath, "r");
+    if (catfile == NULL)
     {
-        /* Prepare .cat file for sync while we read data */
-        buffv = g_strsplit(fnam, ".", 0);
-        catname = g_strconcat(buffv[0], ".cat", NULL);
-        g_strfreev(buffv);
-        catpath = sat_file_name(catname);
-        g_free(catname);
-
-        /* read category name for catfile */
-        catfile = g_fopen(catpath, "r");
-        if (catfile != NULL)
-        {
-            b = fgets(category, 80, catfile);
-            if (b == NULL)
-            {
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%s: There is no category in %s"),
-                            __FILE__, __func__, catpath);
-            }
-            fclose(catfile);
-            catsync = TRUE;
-        }
-        else
-        {
-            /* There is no category with this name (could be update from custom file) */
-            sat_log_log(SAT_LOG_LEVEL_INFO,
-                        _("%s:%s: There is no category called %s"),
-                        __FILE__, __func__, fnam);
-        }
-
-        /* reopen a new catfile and write category name */
-        if (catsync)
-        {
-            catfile = g_fopen(catpath, "w");
-            if (catfile != NULL)
-            {
-                fputs(category, catfile);
-            }
-            else
-            {
-                catsync = FALSE;
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _
-                            ("%s:%s: Could not reopen .cat file while reading TLE from %s"),
-                            __FILE__, __func__, fnam);
-            }
-
-            /* .cat file now contains the category name;
-               satellite catnums will be added during update in the while loop */
-        }
-
-        /* set b to non-null as a flag */
-        b = path;
-
-        /* read lines from tle file */
-        while (fgets(linetmp, 80, fp))
-        {
-            /*read in the number of lines needed to potentially get to a new tle */
-            switch (linesneeded)
-            {
-            case 3:
-                strncpy(tle_working[0], linetmp, 80);
-                tle_working[0][79] = 0;         // make coverity happy
-                /* b is being used a flag here
-                   if b==NULL then we only have one line read in 
-                   and there is no way we have a full tle as there 
-                   is only one line in the buffer.
-                   A TLE must be two or three lines.
-                 */
-                b = fgets(tle_working[1], 80, fp);
-                if (b == NULL)
-                {
-                    /* make sure there is no junk in tle_working[1] */
-                    tle_working[1][0] = '\0';
-                    break;
-                }
-                /* make sure there is no junk in tle_working[2] */
-                if (fgets(tle_working[2], 80, fp) == NULL)
-                {
-                    tle_working[2][0] = '\0';
-                }
-
-                break;
-            case 2:
-                strncpy(tle_working[0], tle_working[2], 80);
-                strncpy(tle_working[1], linetmp, 80);
-                /* make sure there is no junk in tle_working[2] */
-                if (fgets(tle_working[2], 80, fp) == NULL)
-                {
-                    tle_working[2][0] = '\0';
-                }
-                break;
-            case 1:
-                strncpy(tle_working[0], tle_working[1], 80);
-                strncpy(tle_working[1], tle_working[2], 80);
-                memcpy(tle_working[2], linetmp, 80);
-                tle_working[2][79] = 0;         // make coverity happy
-                break;
-            default:
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _
-                            ("%s:%s: Something wrote linesneeded to an illegal value %d"),
-                            __FILE__, __func__, linesneeded);
-                break;
-            }
-            /* b can only be null if there is only one line in the buffer */
-            /* a tle must be two or three */
-            if (b == NULL)
-            {
-                break;
-            }
-            /* remove leading and trailing whitespace to be more forgiving */
-            g_strstrip(tle_working[0]);
-            g_strstrip(tle_working[1]);
-            g_strstrip(tle_working[2]);
-
-            /* there are three possibilities at this point */
-            /* first is that line 0 is a name and normal text for three line element and that lines 1 and 2 
-               are the corresponding tle */
-            /* second is that line 0 and line 1 are a tle for a bare tle */
-            /* third is that neither of these is true and we are consuming either text at the top of the 
-               file or a text file that happens to be in the update directory 
-             */
-            if ((tle_working[1][0] == '1') &&
-                (tle_working[2][0] == '2') &&
-                Checksum_Good(tle_working[1]) && Checksum_Good(tle_working[2]))
-            {
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s:%s: Processing a three line TLE"),
-                            __FILE__, __func__);
-
-                /* it appears that the first line may be a name followed by a tle */
-                strncpy(tle_str[0], tle_working[0], 80);
-                tle_str[0][79] = 0;         // make coverity happy
-                strncpy(tle_str[1], tle_working[1], 80);
-                strncpy(tle_str[2], tle_working[2], 80);
-                /* we consumed three lines so we need three lines */
-                linesneeded = 3;
-
-            }
-            else if ((tle_working[0][0] == '1') &&
-                     (tle_working[1][0] == '2') &&
-                     Checksum_Good(tle_working[0]) &&
-                     Checksum_Good(tle_working[1]))
-            {
-                sat_log_log(SAT_LOG_LEVEL_DEBUG,
-                            _("%s:%s: Processing a bare two line TLE"),
-                            __FILE__, __func__);
-
-                /* first line appears to belong to the start of bare TLE */
-                /* put in a dummy name of form yyyy-nnaa base on international id */
-                /* this special form will be overwritten if a three line tle ever has another name */
-
-                memcpy(idstr, &tle_working[0][11], 6);
-                g_strstrip(idstr);
-                memcpy(idyearstr, &tle_working[0][9], 2);
-                idstr[6] = 0;
-                idyearstr[2] = '\0';
-                idyear = g_ascii_strtod(idyearstr, NULL);
-
-                /* there is a two digit year field that started around sputnik */
-                if (idyear >= 57)
-                    idyear += 1900;
-                else
-                    idyear += 2000;
-
-                snprintf(tle_str[0], 79, "%d-%s", idyear, idstr);
-                strncpy(tle_str[1], tle_working[0], 80);
-                strncpy(tle_str[2], tle_working[1], 80);
-
-                /* we consumed two lines so we need two lines */
-                linesneeded = 2;
-            }
-            else
-            {
-                /* we appear to have junk 
-                   read another line in and do nothing else */
-                linesneeded = 1;
-                /* skip back to beginning of loop */
-                continue;
-            }
-
-
-            tle_str[1][69] = '\0';
-            tle_str[2][69] = '\0';
+        /* There is no category with this name (could be update from custom file) */
+        sat_log_log(SAT_LOG_LEVEL_INFO,
+                    _("%s:%s: There is no category called %s"),
+                    __FILE__, __func__, fnam);
+        g_free(catpath);
+        return;
+    }
 
-            /* copy catnum and convert to integer */
-            for (i = 2; i < 7; i++)
-            {
-                catstr[i - 2] = tle_str[1][i];
-            }
-            catstr[5] = '\0';
-            catnr = (guint) g_ascii_strtod(catstr, NULL);
+    if (fgets(category, 80, catfile) == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s:%s: There is no category in %s"),
+                    __FILE__, __func__, catpath);
+        category[0] = '\0';
+    }
+    fclose(catfile);
 
+    /* reopen a new catfile and write category name and satellites */
+    catfile = g_fopen(catpath, "w");
+    if (catfile != NULL)
+    {
+        fputs(category, catfile);
+        for (i = 0; i < file->elems->len; i++)
+            fprintf(catfile, "%u\n",
+                    g_array_index(file->elems, tle_parser_elem_t,
+                                  i).catnum);
+        for (i = 0; file->omm != NULL && i < file->omm->len; i++)
+            fprintf(catfile, "%u\n",
+                    (guint) omm_get(file->omm, i, OMM_COL_CATNR));
+        fclose(catfile);
+    }
+    else
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _
+                    ("%s:%s: Could not reopen .cat file while reading TLE from %s"),
+                    __FILE__, __func__, fnam);
+    }
 
-            if (Get_Next_Tle_Set(tle_str, &tle) != 1)
-            {
-                /* TLE data not good */
-                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                            _("%s:%s: Invalid data for %d"),
-                            __FILE__, __func__, catnr);
-            }
-            else
-            {
-                if (catsync)
-                {
-                    /* store catalog number in catfile */
-                    buff = g_strdup_printf("%d\n", catnr);
-                    fputs(buff, catfile);
-                    g_free(buff);
-                }
+    g_free(catpath);
+}
 
-                /* add data to hash table */
-                key = g_try_new0(guint, 1);
-                *key = catnr;
+/** Make a fresh element set the data of a satellite in the hash table. */
+static void take_set(new_tle_t * ntle, const new_tle_t * set)
+{
+    ntle->epoch = set->epoch;
+    ntle->status = set->status;
+    g_free(ntle->line1);
+    ntle->line1 = g_strdup(set->line1);
+    g_free(ntle->line2);
+    ntle->line2 = g_strdup(set->line2);
+    g_free(ntle->elements);
+    ntle->elements = NULL;
+    if (set->elements != NULL)
+    {
+        ntle->elements = g_new(tle_t, 1);
+        *ntle->elements = *set->elements;
+    }
+    g_free(ntle->srcfile);
+    ntle->srcfile = g_strdup(set->srcfile);
+    ntle->isnew = TRUE; /* flag will be reset when using data */
+}
 
-                ntle = g_hash_table_lookup(data, key);
+/**
+ * Merge a fresh element set into hash table.
+ *
+ * @param set The element set, whose strings are copied as needed.
+ * @param data Hash table where the data should be stored.
+ * @return TRUE if the satellite was not already in the hash table.
+ */
+static gboolean merge_set(const new_tle_t * set, GHashTable * data)
+{
+    new_tle_t      *ntle;
+    guint          *key;
 
-                /* check if satellite already in hash table */
-                if (ntle == NULL)
-                {
+    ntle = g_hash_table_lookup(data, &set->catnum);
 
-                    /* create new_tle structure */
-                    ntle = g_try_new(new_tle_t, 1);
-                    ntle->catnum = catnr;
-                    ntle->epoch = tle.epoch;
-                    ntle->status = tle.status;
-                    ntle->satname = g_strdup(tle.sat_name);
-                    ntle->line1 = g_strdup(tle_str[1]);
-                    ntle->line2 = g_strdup(tle_str[2]);
-                    ntle->srcfile = g_strdup(fnam);
-                    ntle->isnew = TRUE; /* flag will be reset when using data */
-
-                    g_hash_table_insert(data, key, ntle);
-                    retcode++;
-                }
-                else
-                {
-                    /* satellite is already in hash */
-                    /* apply various merge routines */
+    /* check if satellite already in hash table */
+    if (ntle == NULL)
+    {
+        /* create new_tle structure */
+        ntle = g_new0(new_tle_t, 1);
+        ntle->catnum = set->catnum;
+        ntle->satname = g_strdup(set->satname);
+        take_set(ntle, set);
+
+        key = g_new(guint, 1);
+        *key = set->catnum;
+        g_hash_table_insert(data, key, ntle);
+        return TRUE;
+    }
 
-                    /* time merge */
-                    if (ntle->epoch == tle.epoch)
-                    {
-                        /* if satellite epoch has the same time,  merge status as appropriate */
-                        if (ntle->status != tle.status)
-                        {
-                            /* log if there is something funny about the data coming in */
-                            sat_log_log(SAT_LOG_LEVEL_WARN,
-                                        _
-                                        ("%s:%s: Two different statuses for %d (%s) at the same time."),
-                                        __FILE__, __func__, ntle->catnum,
-                                        ntle->satname);
-                            if (tle.status != OP_STAT_UNKNOWN)
-                                ntle->status = tle.status;
-                        }
-                    }
-                    else if (ntle->epoch < tle.epoch)
-                    {
-                        /* if the satellite in the hash is older than 
-                           the one just loaded, copy the values over. */
-
-                        ntle->catnum = catnr;
-                        ntle->epoch = tle.epoch;
-                        ntle->status = tle.status;
-                        g_free(ntle->line1);
-                        ntle->line1 = g_strdup(tle_str[1]);
-                        g_free(ntle->line2);
-                        ntle->line2 = g_strdup(tle_str[2]);
-                        g_free(ntle->srcfile);
-                        ntle->srcfile = g_strdup(fnam);
-                        ntle->isnew = TRUE;     /* flag will be reset when using data */
-                    }
+    /* satellite is already in hash */
+    /* apply various merge routines */
 
-                    /* merge based on name */
-                    if (is_computer_generated_name(ntle->satname) &&
-                        !is_computer_generated_name(tle_str[0]))
-                    {
-                        g_free(ntle->satname);
-                        ntle->satname = g_strdup(tle.sat_name);
-                    }
+    /* time merge */
+    if (ntle->epoch == set->epoch)
+    {
+        /* if satellite epoch has the same time,  merge status as appropriate */
+        if (ntle->status != set->status)
+        {
+            /* log if there is something funny about the data coming in */
+            sat_log_log(SAT_LOG_LEVEL_WARN,
+                        _
+                        ("%s:%s: Two different statuses for %d (%s) at the same time."),
+                        __FILE__, __func__, ntle->catnum, ntle->satname);
+            if (set->status != OP_STAT_UNKNOWN)
+                ntle->status = set->status;
+        }
+    }
+    else if (ntle->epoch < set->epoch)
+    {
+        /* if the satellite in the hash is older than
+           the one just loaded, copy the values over. */
+        take_set(ntle, set);
+    }
 
-                    /* free the key since we do not commit it to the cache */
-                    g_free(key);
-                }
-            }
+    /* merge based on name */
+    if (is_computer_generated_name(ntle->satname) &&
+        !is_computer_generated_name(set->satname))
+    {
+        g_free(ntle->satname);
+        ntle->satname = g_strdup(set->satname);
+    }
 
-        }
+    return FALSE;
+}
 
-        if (catsync)
-        {
-            /* close category file */
-            fclose(catfile);
-        }
+/**
+ * Merge fresh TLE data into hash table.
+ *
+ * @param fnam The name of the file the data was read from.
+ * @param file The data read from the file.
+ * @param data Hash table where the data should be stored.
+ * @return The number of satellites not already in the hash table.
+ *
+ * The newest elements of a satellite win, whether they come from a TLE or
+ * from an OMM. Since the files are merged in the order of their names, the
+ * outcome does not depend on which of them was read first.
+ */
+static gint merge_fresh_tle(const gchar * fnam,
+                            const tle_parser_file_t * file,
+                            GHashTable * data)
+{
+    tle_parser_elem_t *elem;
+    new_tle_t       set;
+    tle_t           tle;
+    gint            retcode = 0;
+    guint           i;
 
-        g_free(catpath);
+    memset(&set, 0, sizeof(set));
+    set.srcfile = (gchar *) fnam;
 
-        /* close input TLE file */
-        fclose(fp);
+    for (i = 0; i < file->elems->len; i++)
+    {
+        elem = &g_array_index(file->elems, tle_parser_elem_t, i);
+
+        set.catnum = elem->catnum;
+        set.epoch = elem->epoch;
+        set.status = elem->status;
+        set.satname = (gchar *) elem->name;
+        set.line1 = elem->line1;
+        set.line2 = elem->line2;
+        if (merge_set(&set, data))
+            retcode++;
     }
 
-    else
+    /* an OMM has the elements without TLE lines */
+    set.line1 = NULL;
+    set.line2 = NULL;
+    set.elements = &tle;
+    for (i = 0; file->omm != NULL && i < file->omm->len; i++)
     {
-        sat_log_log(SAT_LOG_LEVEL_ERROR,
-                    _("%s:%s: Failed to open %s"), __FILE__, __func__, path);
+        omm_get_tle(file->omm, i, &tle);
+
+        set.catnum = tle.catnr;
+        set.epoch = tle.epoch;
+        set.status = tle.status;
+        set.satname = tle.sat_name;
+        if (merge_set(&set, data))
+            retcode++;
     }
-    g_free(path);
 
     return retcode;
 }
@@ -1295,7 +1416,15 @@ static void update_tle_in_file(const gchar * ldname,
             g_free(satname);
             g_free(satnickname);
 
-            if (tle.epoch < ntle->epoch)
+            if (tle.epoch < ntle->epoch && ntle->line1 == NULL)
+            {
+                /* a .sat file can only hold TLE lines */
+                sat_log_log(SAT_LOG_LEVEL_INFO,
+                            _
+                            ("%s: %d has no TLE lines and can only be kept in the catalogue."),
+                            __func__, catnr);
+            }
+            else if (tle.epoch < ntle->epoch)
             {
                 /* new data is newer than what we already have */
                 /* store new data */
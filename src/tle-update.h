@@ -58,8 +58,9 @@ typedef struct {
     guint           catnum;     /*!< Catalog number. */
     gdouble         epoch;      /*!< Epoch. */
     gchar          *satname;    /*!< Satellite name. */
-    gchar          *line1;      /*!< Line 1. */
-    gchar          *line2;      /*!< Line 2. */
+    gchar          *line1;      /*!< Line 1, NULL for OMM elements. */
+    gchar          *line2;      /*!< Line 2, NULL for OMM elements. */
+    tle_t          *elements;   /*!< Elements read from an OMM, otherwise NULL. */
     gchar          *srcfile;    /*!< The file where TLE comes from (needed for cat) */
     gboolean        isnew;      /*!< Flag indicating whether sat is new. */
     op_stat_t       status;     /*!< Enum indicating current satellite status. */
@@ -83,6 +84,7 @@ void            tle_update_from_network(gboolean silent,
                                         GtkWidget * progress,
                                         GtkWidget * label1,
                                         GtkWidget * label2);
+void            tle_update_forget_sources(void);
 
 const gchar    *tle_update_freq_to_str(tle_auto_upd_freq_t freq);
 
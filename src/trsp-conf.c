@@ -32,6 +32,7 @@
 #include "gpredict-utils.h"
 #include "sat-log.h"
 #include "trsp-conf.h"
+#include "trsp-store.h"
 
 #define KEY_UP_LOW      "UP_LOW"
 #define KEY_UP_HIGH     "UP_HIGH"
@@ -64,11 +65,52 @@ static void check_trsp_freq(trsp_t * trsp)
         trsp->uphigh = trsp->uplow;
 }
 
+/**
+ * Read the transponders of a satellite from the transponder store.
+ *
+ * @param store The transponder store.
+ * @param recs The transponders of the satellite.
+ * @param count The number of transponders.
+ * @return The new transponder list.
+ */
+static GSList *read_stored_transponders(const trsp_store_t * store,
+                                        const trsp_store_rec_t * recs,
+                                        guint count)
+{
+    GSList         *trsplist = NULL;
+    trsp_t         *trsp;
+    const gchar    *name;
+    guint           i;
+
+    for (i = 0; i < count; i++)
+    {
+        trsp = g_new(trsp_t, 1);
+
+        name = trsp_store_str(store, recs[i].name);
+        trsp->name = g_strdup(name ? name : "");
+        trsp->uplow = recs[i].uplow;
+        trsp->uphigh = recs[i].uphigh;
+        trsp->downlow = recs[i].downlow;
+        trsp->downhigh = recs[i].downhigh;
+        check_trsp_freq(trsp);
+        trsp->invert = recs[i].invert ? TRUE : FALSE;
+        trsp->mode = g_strdup(trsp_store_str(store, recs[i].mode));
+        trsp->baud = recs[i].baud;
+
+        trsplist = g_slist_prepend(trsplist, trsp);
+    }
+
+    return g_slist_reverse(trsplist);
+}
+
 /**
  * Read transponder data file.
  * 
  * @param catnum The catalog number of the satellite to read transponders for.
  * @return  The new transponder list.
+ *
+ * The transponders are taken from the transponder store if the satellite is
+ * in it, and from the .trsp file of the satellite otherwise.
  */
 GSList *read_transponders(guint catnum)
 {
@@ -79,9 +121,24 @@ GSList *read_transponders(guint catnum)
     gchar          *name, *fname;
     gchar         **groups;
     gsize           numgrp, i;
+    trsp_store_t   *store;
+    const trsp_store_rec_t *recs = NULL;
+    guint           count;
 
 #define INFO_MSG N_("%s: Could not read %s from %s:'%s'. Using default.")
 
+    store = trsp_store_get_default();
+    if (store != NULL)
+    {
+        recs = trsp_store_lookup(store, catnum, &count);
+        if (recs != NULL)
+            trsplist = read_stored_transponders(store, recs, count);
+        trsp_store_unref(store);
+
+        if (recs != NULL)
+            return trsplist;
+    }
+
     name = g_strdup_printf("%d.trsp", catnum);
     fname = trsp_file_name(name);
 
@@ -0,0 +1,443 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+/*
+ * Transponder store.
+ *
+ * The transponders imported from the transmitter database are kept in one
+ * file that is mapped into memory (read on Windows, see
+ * load_replaceable_file()), with an index of the satellites, instead of one
+ * .trsp key file per satellite. Reading the transponders of a
+ * satellite is a binary search and a copy. Like the satellite catalogue,
+ * the file is only replaced as a whole and the store in use is swapped
+ * under a lock.
+ *
+ * The .trsp files remain the format of the data shipped with gpredict and
+ * of the user's own transponders, which are used for satellites that are
+ * not in the store.
+ */
+#ifdef HAVE_CONFIG_H
+#include <build-config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "compat.h"
+#include "sat-log.h"
+#include "trsp-store.h"
+
+typedef struct {
+    gint32 catnum;
+    guint32 seq;        /* Order in which it was added */
+    trsp_store_rec_t rec;
+} build_rec_t;
+
+/* The store in use; see trsp_store_get_default() */
+static GMutex default_lock;
+static trsp_store_t *default_store = NULL;
+static gboolean default_tried = FALSE;
+
+/* Check the structure of a mapped store */
+static gboolean check_store(const gchar *data, gsize len)
+{
+    const trsp_store_header_t *header = (const trsp_store_header_t *)data;
+    const trsp_store_sat_t *sats;
+    const trsp_store_rec_t *recs;
+    gint32 last = G_MININT32;
+    guint i;
+
+    if (len < sizeof(trsp_store_header_t) ||
+        memcmp(header->magic, TRSP_STORE_MAGIC, sizeof(header->magic)) ||
+        header->version != TRSP_STORE_VERSION)
+        return FALSE;
+
+    if (header->strings < sizeof(trsp_store_header_t) +
+                              (guint64)header->satcount *
+                                  sizeof(trsp_store_sat_t) +
+                              (guint64)header->trspcount *
+                                  sizeof(trsp_store_rec_t) ||
+        header->strsize == 0 ||
+        (guint64)header->strings + header->strsize > len ||
+        data[header->strings] != '\0' ||
+        data[header->strings + header->strsize - 1] != '\0')
+        return FALSE;
+
+    /* the index relies on the order */
+    sats = (const trsp_store_sat_t *)(data + sizeof(trsp_store_header_t));
+    for (i = 0; i < header->satcount; i++)
+    {
+        if (sats[i].catnum <= last ||
+            (guint64)sats[i].first + sats[i].count > header->trspcount)
+            return FALSE;
+        last = sats[i].catnum;
+    }
+
+    recs = (const trsp_store_rec_t *)(sats + header->satcount);
+    for (i = 0; i < header->trspcount; i++)
+    {
+        if (recs[i].name >= header->strsize || recs[i].mode >= header->strsize)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Open a store file.
+ *
+ * @param path The file.
+ * @return A new reference to the store, or NULL if the file could not be
+ *         read or is not a valid store.
+ */
+trsp_store_t *trsp_store_open(const gchar *path)
+{
+    trsp_store_t *store;
+    GBytes *bytes;
+    GError *err = NULL;
+    const gchar *data;
+    gsize len;
+
+    bytes = load_replaceable_file(path, &err);
+    if (bytes == NULL)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not open %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+        return NULL;
+    }
+
+    data = g_bytes_get_data(bytes, &len);
+    if (!check_store(data, len))
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR,
+                    _("%s: %s is not a valid transponder store"), __func__,
+                    path);
+        g_bytes_unref(bytes);
+        return NULL;
+    }
+
+    store = g_new0(trsp_store_t, 1);
+    store->refcount = 1;
+    store->data = bytes;
+    store->header = (const trsp_store_header_t *)data;
+    store->sats = (const trsp_store_sat_t *)(data +
+                                             sizeof(trsp_store_header_t));
+    store->recs = (const trsp_store_rec_t *)(store->sats +
+                                             store->header->satcount);
+    store->strings = data + store->header->strings;
+
+    sat_log_log(SAT_LOG_LEVEL_DEBUG,
+                _("%s: Opened %s with %u transponders of %u satellites"),
+                __func__, path, store->header->trspcount,
+                store->header->satcount);
+
+    return store;
+}
+
+trsp_store_t *trsp_store_ref(trsp_store_t *store)
+{
+    g_atomic_int_inc(&store->refcount);
+
+    return store;
+}
+
+void trsp_store_unref(trsp_store_t *store)
+{
+    if (store == NULL || !g_atomic_int_dec_and_test(&store->refcount))
+        return;
+
+    g_bytes_unref(store->data);
+    g_free(store);
+}
+
+/*
+ * Find the transponders of a satellite.
+ *
+ * @param count Where the number of transponders is stored.
+ * @return The first transponder, or NULL if the satellite is not in the
+ *         store.
+ */
+const trsp_store_rec_t *trsp_store_lookup(const trsp_store_t *store,
+                                          gint catnum, guint *count)
+{
+    const trsp_store_sat_t *sat;
+    guint lo = 0, hi = store->header->satcount, mid;
+
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        sat = &store->sats[mid];
+        if (sat->catnum == catnum)
+        {
+            *count = sat->count;
+            return &store->recs[sat->first];
+        }
+        if (sat->catnum < catnum)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return NULL;
+}
+
+/* A string of a transponder; NULL if it is missing */
+const gchar *trsp_store_str(const trsp_store_t *store, guint32 offset)
+{
+    return offset ? store->strings + offset : NULL;
+}
+
+trsp_store_builder_t *trsp_store_builder_new(void)
+{
+    trsp_store_builder_t *builder = g_new0(trsp_store_builder_t, 1);
+
+    builder->recs = g_array_new(FALSE, FALSE, sizeof(build_rec_t));
+    builder->strings = g_string_new(NULL);
+    g_string_append_len(builder->strings, "", 1);
+    builder->offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                             NULL);
+
+    return builder;
+}
+
+void trsp_store_builder_free(trsp_store_builder_t *builder)
+{
+    if (builder == NULL)
+        return;
+
+    g_array_unref(builder->recs);
+    g_string_free(builder->strings, TRUE);
+    g_hash_table_destroy(builder->offsets);
+    g_free(builder);
+}
+
+/* Add a string to the string table once and return its offset */
+static guint32 add_string(trsp_store_builder_t *builder, const gchar *str)
+{
+    gpointer offset;
+    guint32 newoffset;
+
+    if (str == NULL)
+        return 0;
+
+    /* the names of the modes repeat a lot */
+    if (g_hash_table_lookup_extended(builder->offsets, str, NULL, &offset))
+        return GPOINTER_TO_UINT(offset);
+
+    newoffset = builder->strings->len;
+    g_string_append_len(builder->strings, str, strlen(str) + 1);
+    g_hash_table_insert(builder->offsets, g_strdup(str),
+                        GUINT_TO_POINTER(newoffset));
+
+    return newoffset;
+}
+
+/*
+ * Add a transponder of a satellite.
+ *
+ * The transponders of a satellite are kept in the order they were added.
+ */
+void trsp_store_builder_add(trsp_store_builder_t *builder, gint catnum,
+                            const trsp_t *trsp)
+{
+    build_rec_t brec;
+
+    memset(&brec, 0, sizeof(brec));
+    brec.catnum = catnum;
+    brec.seq = builder->recs->len;
+    brec.rec.uplow = trsp->uplow;
+    brec.rec.uphigh = trsp->uphigh;
+    brec.rec.downlow = trsp->downlow;
+    brec.rec.downhigh = trsp->downhigh;
+    brec.rec.baud = trsp->baud;
+    brec.rec.invert = trsp->invert;
+    brec.rec.name = add_string(builder, trsp->name);
+    brec.rec.mode = add_string(builder, trsp->mode);
+    g_array_append_val(builder->recs, brec);
+}
+
+guint trsp_store_builder_size(const trsp_store_builder_t *builder)
+{
+    return builder->recs->len;
+}
+
+static gint compare_recs(gconstpointer a, gconstpointer b)
+{
+    const build_rec_t *ra = a;
+    const build_rec_t *rb = b;
+
+    if (ra->catnum != rb->catnum)
+        return (ra->catnum > rb->catnum) - (ra->catnum < rb->catnum);
+
+    return (ra->seq > rb->seq) - (ra->seq < rb->seq);
+}
+
+/* Write the store to a file, which is replaced atomically */
+static gboolean save_store(trsp_store_builder_t *builder, const gchar *path)
+{
+    trsp_store_header_t header;
+    trsp_store_sat_t sat;
+    GArray *sats;
+    GByteArray *buff;
+    GError *err = NULL;
+    build_rec_t *brec;
+    gboolean retval;
+    guint i;
+
+    g_array_sort(builder->recs, compare_recs);
+
+    /* one index entry per run of transponders of a satellite */
+    sats = g_array_new(FALSE, FALSE, sizeof(trsp_store_sat_t));
+    for (i = 0; i < builder->recs->len; i++)
+    {
+        brec = &g_array_index(builder->recs, build_rec_t, i);
+        if (sats->len > 0 &&
+            g_array_index(sats, trsp_store_sat_t, sats->len - 1).catnum ==
+                brec->catnum)
+        {
+            g_array_index(sats, trsp_store_sat_t, sats->len - 1).count++;
+            continue;
+        }
+
+        memset(&sat, 0, sizeof(sat));
+        sat.catnum = brec->catnum;
+        sat.first = i;
+        sat.count = 1;
+        g_array_append_val(sats, sat);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRSP_STORE_MAGIC, sizeof(header.magic));
+    header.version = TRSP_STORE_VERSION;
+    header.satcount = sats->len;
+    header.trspcount = builder->recs->len;
+    header.strings = sizeof(header) + sats->len * sizeof(trsp_store_sat_t) +
+                     builder->recs->len * sizeof(trsp_store_rec_t);
+    header.strsize = builder->strings->len;
+    header.created = g_get_real_time() / G_USEC_PER_SEC;
+
+    buff = g_byte_array_sized_new(header.strings + header.strsize);
+    g_byte_array_append(buff, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(buff, (const guint8 *)sats->data,
+                        sats->len * sizeof(trsp_store_sat_t));
+    for (i = 0; i < builder->recs->len; i++)
+    {
+        brec = &g_array_index(builder->recs, build_rec_t, i);
+        g_byte_array_append(buff, (const guint8 *)&brec->rec,
+                            sizeof(trsp_store_rec_t));
+    }
+    g_byte_array_append(buff, (const guint8 *)builder->strings->str,
+                        builder->strings->len);
+
+    retval = g_file_set_contents(path, (const gchar *)buff->data, buff->len,
+                                 &err);
+    if (!retval)
+    {
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not write %s (%s)"),
+                    __func__, path, err->message);
+        g_clear_error(&err);
+    }
+
+    g_byte_array_unref(buff);
+    g_array_unref(sats);
+
+    return retval;
+}
+
+/*
+ * Get the store in use.
+ *
+ * @return A new reference to the store, or NULL if there is none, in which
+ *         case the transponders are read from the .trsp files.
+ */
+trsp_store_t *trsp_store_get_default(void)
+{
+    trsp_store_t *store;
+    gchar *path;
+
+    g_mutex_lock(&default_lock);
+    if (default_store == NULL && !default_tried)
+    {
+        path = trsp_file_name(TRSP_STORE_NAME);
+        if (g_file_test(path, G_FILE_TEST_EXISTS))
+            default_store = trsp_store_open(path);
+        g_free(path);
+        default_tried = TRUE;
+    }
+    store = default_store ? trsp_store_ref(default_store) : NULL;
+    g_mutex_unlock(&default_lock);
+
+    return store;
+}
+
+static void set_default(trsp_store_t *store)
+{
+    trsp_store_t *old;
+
+    g_mutex_lock(&default_lock);
+    old = default_store;
+    default_store = store;
+    default_tried = TRUE;
+    g_mutex_unlock(&default_lock);
+
+    trsp_store_unref(old);
+}
+
+/*
+ * Replace the store in use.
+ *
+ * The file is replaced atomically and the new store is used from then on;
+ * transponder lists already read are not affected.
+ */
+gboolean trsp_store_commit(trsp_store_builder_t *builder)
+{
+    trsp_store_t *store;
+    gchar *path;
+
+    path = trsp_file_name(TRSP_STORE_NAME);
+    if (!save_store(builder, path))
+    {
+        g_free(path);
+        return FALSE;
+    }
+    store = trsp_store_open(path);
+    g_free(path);
+    if (store == NULL)
+        return FALSE;
+
+    set_default(store);
+
+    return TRUE;
+}
+
+/* Delete the store, so that only the .trsp files are used */
+void trsp_store_forget(void)
+{
+    gchar *path;
+
+    set_default(NULL);
+
+    path = trsp_file_name(TRSP_STORE_NAME);
+    if (g_file_test(path, G_FILE_TEST_EXISTS) && g_unlink(path))
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Failed to delete %s"),
+                    __func__, path);
+    g_free(path);
+}
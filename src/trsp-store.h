@@ -0,0 +1,106 @@
+/*
+  Gpredict: Real-time satellite tracking and orbit prediction program
+
+  Copyright (C)  2001-2019  Alexandru Csete, OZ9AEC
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, visit http://www.fsf.org/
+*/
+#ifndef TRSP_STORE_H
+#define TRSP_STORE_H 1
+
+#include <glib.h>
+
+#include "trsp-conf.h"
+
+#define TRSP_STORE_NAME "transponders.db" /* In the trsp directory */
+#define TRSP_STORE_MAGIC "GPTRSPDB"
+#define TRSP_STORE_VERSION 1
+
+/*
+ * File header.
+ *
+ * The file is a local cache in host byte order: the header is followed by
+ * satcount satellites sorted by catalogue number, by trspcount transponders
+ * in the order of the satellites, and by a table of NUL terminated strings.
+ * Offset 0 of the string table is an empty string, which stands for a
+ * missing one.
+ */
+typedef struct {
+    gchar magic[8];     /* TRSP_STORE_MAGIC, not terminated */
+    guint32 version;    /* TRSP_STORE_VERSION */
+    guint32 satcount;   /* Number of satellites */
+    guint32 trspcount;  /* Number of transponders */
+    guint32 strings;    /* File offset of the string table */
+    guint32 strsize;    /* Size of the string table */
+    guint32 reserved;
+    gint64 created;     /* When the file was written (Unix time) */
+} trsp_store_header_t;
+
+/* The transponders of a satellite */
+typedef struct {
+    gint32 catnum;
+    guint32 first;      /* Index of the first transponder */
+    guint32 count;      /* Number of transponders */
+    guint32 reserved;
+} trsp_store_sat_t;
+
+/* One transponder; see trsp_t */
+typedef struct {
+    gint64 uplow;
+    gint64 uphigh;
+    gint64 downlow;
+    gint64 downhigh;
+    gdouble baud;
+    guint32 name;       /* String table offsets */
+    guint32 mode;
+    gint32 invert;
+    guint32 reserved;
+} trsp_store_rec_t;
+
+/* A store file in memory; see trsp_store_open() */
+typedef struct {
+    gint refcount;
+    GBytes *data;
+    const trsp_store_header_t *header;
+    const trsp_store_sat_t *sats;
+    const trsp_store_rec_t *recs;
+    const gchar *strings;
+} trsp_store_t;
+
+/* A store being put together; see trsp_store_builder_new() */
+typedef struct {
+    GArray *recs;       /* Transponders in the order they were added */
+    GString *strings;
+    GHashTable *offsets; /* String table offsets by string */
+} trsp_store_builder_t;
+
+trsp_store_t *trsp_store_open(const gchar *path);
+trsp_store_t *trsp_store_ref(trsp_store_t *store);
+void trsp_store_unref(trsp_store_t *store);
+
+const trsp_store_rec_t *trsp_store_lookup(const trsp_store_t *store,
+                                          gint catnum, guint *count);
+const gchar *trsp_store_str(const trsp_store_t *store, guint32 offset);
+
+trsp_store_builder_t *trsp_store_builder_new(void);
+void trsp_store_builder_free(trsp_store_builder_t *builder);
+void trsp_store_builder_add(trsp_store_builder_t *builder, gint catnum,
+                            const trsp_t *trsp);
+guint trsp_store_builder_size(const trsp_store_builder_t *builder);
+
+trsp_store_t *trsp_store_get_default(void);
+gboolean trsp_store_commit(trsp_store_builder_t *builder);
+void trsp_store_forget(void);
+
+#endif
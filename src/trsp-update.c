@@ -26,21 +26,22 @@
 */
 
 /*
- * Downloads Frequency list from SATNOGS db and exports json transponder
- * information into satellite files identified by catalog id
+ * Downloads Frequency list from SATNOGS db and imports the json transponder
+ * information into the transponder store, indexed by catalog id
  */
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
-#include <locale.h>
+#include <string.h>
 
 #include "compat.h"
 #include "trsp-update.h"
 #include "gpredict-utils.h"
+#include "json-stream.h"
 #include "sat-cfg.h"
 #include "sat-log.h"
-#include "nxjson/nxjson.h"
+#include "trsp-store.h"
 
 #ifdef HAVE_CONFIG_H
 #include <build-config.h>
@@ -61,38 +62,21 @@ typedef enum {
     TRSP_AUTO_UPDATE_NUM
 } trsp_auto_upd_freq_t;
 
-/* Data structure to hold a TRSP set. */
-struct transponder {
-    char            uuid[30];   /* uuid */
-    int             catnum;     /* Catalog number. */
-    char            description[80];    /* Transponder descriptoion */
-    long long       uplink_low; /* Uplink starting frequency */
-    long long       uplink_high;        /* uplink end frequency  */
-    long long       downlink_low;       /* downlink starting frequency */
-    long long       downlink_high;      /* downlink end frequency */
-    char            mode[20];   /* mode (from modes files) */
-    int             invert;     /* inverting / noninverting */
-    double          baud;       /* baudrate */
-    int             alive;      /* alive or dead */
-};
-
-/* Data structure to hold a MODES set. */
-struct modes {
-    int             id;         /* id */
-    char            name[80];   /* Mode name */
-};
-
-/* Data structure to hold a MODE set. */
+/* State of the import of modes.json */
 typedef struct {
-    guint           modnum;     /* Mode number. */
-    gchar          *modname;    /* Mode description. */
-} new_mode_t;
+    GHashTable     *modes;      /* Mode names keyed by mode id */
+    gint            id;         /* Id of the mode being read */
+    gchar          *name;       /* Name of the mode being read */
+} modes_import_t;
 
-/* Data structure to hold a TRSP list. */
+/* State of the import of the transmitter database */
 typedef struct {
-    guint           catnum;     /* Catalog number. */
-    guint           numtrsp;    /* Number of transponders. */
-} new_trsp_t;
+    GHashTable     *modes;      /* Mode names keyed by mode id */
+    trsp_store_builder_t *builder;
+    trsp_t          trsp;       /* Transmitter being read */
+    gint            catnum;     /* Its catalog number */
+    gint            mode_id;    /* Its mode */
+} trsp_import_t;
 
 #ifndef WIN32
 /* private function prototypes */
@@ -100,290 +84,171 @@ static size_t   my_write_func(void *ptr, size_t size, size_t nmemb,
                               FILE * stream);
 #endif
 
-//int getMODElist_intoHashMap();
 
-//static void check_and_print_mode(gpointer key, gpointer value, gpointer user_data)
-//{
-//    new_mode_t  *nmode = (new_mode_t *) value;
-//    guint      *num = user_data;
-//
-//    *num += 1;
-//
-//    (void) key; /* avoid unused parameter compiler warning */
-//
-//    printf("MODES LIST : %d %s \n", nmode->modnum, nmode->modname);
-//
-//}
+static void mode_member(const gchar * key, const gchar * value,
+                        gpointer data)
+{
+    modes_import_t *imp = data;
 
+    if (!strcmp(key, "id"))
+    {
+        imp->id = (gint) g_ascii_strtoll(value, NULL, 10);
+    }
+    else if (!strcmp(key, "name"))
+    {
+        g_free(imp->name);
+        imp->name = g_strdup(value);
+    }
+}
 
-/** Free a new_mode_t structure. */
-static void free_new_mode(gpointer data)
+static void mode_end(gpointer data)
 {
-    //TODO: remove this.
-    new_mode_t     *mmode;
+    modes_import_t *imp = data;
+    gint           *key;
 
-    mmode = (new_mode_t *) data;
+    if (imp->name != NULL && !g_hash_table_contains(imp->modes, &imp->id))
+    {
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("MODE %d %s"), imp->id, imp->name);
 
-    g_free(mmode->modname);
-    g_free(mmode);
+        key = g_new(gint, 1);
+        *key = imp->id;
+        g_hash_table_insert(imp->modes, key, imp->name);
+        imp->name = NULL;
+    }
+
+    g_free(imp->name);
+    imp->name = NULL;
+    imp->id = 0;
 }
 
-/** Free a new_trsp_t structure. */
-static void free_new_trsp(gpointer data)
+static void trsp_member(const gchar * key, const gchar * value,
+                        gpointer data)
 {
-    //TODO: remove this.
-    new_trsp_t     *mtrsp;
-
-    mtrsp = (new_trsp_t *) data;
+    trsp_import_t  *imp = data;
 
-    g_free(mtrsp);
+    if (!strcmp(key, "description"))
+    {
+        g_free(imp->trsp.name);
+        imp->trsp.name = g_strdup(value);
+    }
+    else if (!strcmp(key, "norad_cat_id"))
+        imp->catnum = (gint) g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "uplink_low"))
+        imp->trsp.uplow = g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "uplink_high"))
+        imp->trsp.uphigh = g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "downlink_low"))
+        imp->trsp.downlow = g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "downlink_high"))
+        imp->trsp.downhigh = g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "mode_id"))
+        imp->mode_id = (gint) g_ascii_strtoll(value, NULL, 10);
+    else if (!strcmp(key, "invert"))
+        imp->trsp.invert = !strcmp(value, "true");
+    else if (!strcmp(key, "baud"))
+        imp->trsp.baud = g_ascii_strtod(value, NULL);
 }
 
-void trsp_update_files(gchar * input_file)
+/** Add the transmitter that has been read to the store. */
+static void trsp_end(gpointer data)
 {
+    trsp_import_t  *imp = data;
+    const gchar    *mode;
 
-    FILE           *mfp;        /* transmitter information json file */
-    size_t          mfplen;     /* size of transmitter information json file */
-    long            flen;       /* holds the file size returned by ftell or -1 on error */
-    int             result;
-    FILE           *ffile;      /* transponder output file in gpredict format */
-    char           *jsn_object; /* json array will be in this buffer before parsing */
-    unsigned int    idx;        /* object index in JSON-Array */
-    new_mode_t     *nmode;
-    new_trsp_t     *ntrsp;
-    GHashTable     *modes_hash; /* hash table to store modes */
-    GHashTable     *trsp_hash;  /* hash table to store satellite list to generate trsp files */
-    guint          *key = NULL;
+    if (imp->catnum > 0)
+    {
+        mode = g_hash_table_lookup(imp->modes, &imp->mode_id);
+        if (mode != NULL)
+            imp->trsp.mode = g_strdup(mode);
+        else
+            imp->trsp.mode = g_strdup_printf("%d", imp->mode_id);
 
-    gchar          *userconfdir;
-    gchar          *trspfile;
-    gchar          *modesfile;
-    gchar          *trspfolder;
+        trsp_store_builder_add(imp->builder, imp->catnum, &imp->trsp);
+    }
 
-    /* force decimal mark to dot when parsing JSON file */
-    setlocale(LC_NUMERIC, "C");
+    g_free(imp->trsp.name);
+    g_free(imp->trsp.mode);
+    memset(&imp->trsp, 0, sizeof(imp->trsp));
+    imp->catnum = 0;
+    imp->mode_id = 0;
+}
 
-    modes_hash =
-        g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_new_mode);
-    trsp_hash =
-        g_hash_table_new_full(g_int_hash, g_int_equal, g_free, free_new_trsp);
+/**
+ * Import the transmitter database.
+ *
+ * @param input_file The transmitter database (JSON).
+ *
+ * The database is read in one pass, with the names of the modes taken from
+ * modes.json, and the transponders of all satellites in it replace the
+ * transponder store. Satellites that are not in the database keep their
+ * .trsp files.
+ */
+void trsp_update_files(gchar * input_file)
+{
+    static const json_stream_parser_t modes_parser = { mode_member, mode_end };
+    static const json_stream_parser_t trsp_parser = { trsp_member, trsp_end };
 
-    userconfdir = get_user_conf_dir();
-    trspfolder = g_strconcat(userconfdir, G_DIR_SEPARATOR_S, "trsp", NULL);
-    modesfile = g_strconcat(trspfolder, "/modes.json", NULL);
+    modes_import_t  modes;
+    trsp_import_t   imp;
+    GMappedFile    *map;
+    GError         *err = NULL;
+    gchar          *modesfile;
+    guint           count;
 
-    mfp = fopen(modesfile, "r");
+    memset(&modes, 0, sizeof(modes));
+    modes.modes = g_hash_table_new_full(g_int_hash, g_int_equal, g_free,
+                                        g_free);
 
-    if (mfp != NULL)
+    /* the modes are optional */
+    modesfile = trsp_file_name("modes.json");
+    map = g_mapped_file_new(modesfile, FALSE, NULL);
+    if (map != NULL)
     {
-        mfplen = 0;
-        fseek(mfp, 0, SEEK_END);
-        flen = ftell(mfp);
+        if (!json_stream_parse(g_mapped_file_get_contents(map),
+                               g_mapped_file_get_length(map),
+                               &modes_parser, &modes))
+            sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Malformed JSON in %s"),
+                        __func__, modesfile);
+        g_mapped_file_unref(map);
+    }
+    g_free(modes.name);
+    g_free(modesfile);
 
-        if (flen > 1)
-        {
-            mfplen = flen;
-            rewind(mfp);
-            jsn_object = g_malloc(mfplen);
-            result = fread(jsn_object, mfplen, 1, mfp);
-
-            if (result == 1)
-            {
-                const nx_json  *json = nx_json_parse(jsn_object, 0);
-
-                if (json)
-                {
-                    idx = 0;
-                    while (1)
-                    {
-                        const nx_json  *json_obj = nx_json_item(json, idx++);
-                        struct modes    m_modes;
-
-                        if (json_obj->type == NX_JSON_NULL)
-                            break;
-
-                        m_modes.id = nx_json_get(json_obj, "id")->int_value;
-                        strncpy(m_modes.name,
-                                nx_json_get(json_obj, "name")->text_value, 79);
-                        m_modes.name[79] = 0;
-
-                        /* add data to hash table */
-                        key = g_try_new0(guint, 1);
-                        *key = m_modes.id;
-
-                        nmode = g_hash_table_lookup(modes_hash, key);
-
-                        if (nmode == NULL)
-                        {
-                            /* create new_mode structure */
-                            nmode = g_try_new(new_mode_t, 1);
-                            nmode->modnum = m_modes.id;
-                            nmode->modname = g_strdup(m_modes.name);
-
-                            g_hash_table_insert(modes_hash, key, nmode);
-
-                        }
-
-                        sat_log_log(SAT_LOG_LEVEL_INFO, _("MODE %d %s"),
-                                    m_modes.id, m_modes.name);
-                    }           // while(1)
-                    nx_json_free(json);
-                }               // if(json)
-            }                   // if(result == 1)
-            g_free(jsn_object);
-        }                       // if(flen > 1)
-        fclose(mfp);
-    }                           // if(mfp)
-
-//    guint num = 0;
-//    printf("---------- PRINTING MODES LIST ------- \n");
-//    g_hash_table_foreach (modes_hash, check_and_print_mode, &num);
-
-    mfp = fopen(input_file, "r");
-    if (mfp != NULL)
+    map = g_mapped_file_new(input_file, FALSE, &err);
+    if (map == NULL)
     {
-        mfplen = 0;
-        fseek(mfp, 0, SEEK_END);
-        flen = ftell(mfp);
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Could not open %s (%s)"),
+                    __func__, input_file, err->message);
+        g_clear_error(&err);
+        g_hash_table_destroy(modes.modes);
+        return;
+    }
 
-        if (flen > 1)
-        {
-            mfplen = flen;
-            rewind(mfp);
-            jsn_object = g_malloc(mfplen);
-            result = fread(jsn_object, mfplen, 1, mfp);
-
-            if (result == 1)
-            {
-                const nx_json  *json = nx_json_parse(jsn_object, 0);
-
-                if (json)
-                {
-                    idx = 0;
-                    while (1)
-                    {
-                        const nx_json  *json_obj = nx_json_item(json, idx++);
-                        struct transponder m_trsp;
-
-                        if (json_obj->type == NX_JSON_NULL)
-                            break;
-
-                        strncpy(m_trsp.description,
-                                nx_json_get(json_obj,
-                                            "description")->text_value, 79);
-                        m_trsp.description[79] = 0;
-                        m_trsp.catnum =
-                            nx_json_get(json_obj, "norad_cat_id")->int_value;
-                        m_trsp.uplink_low =
-                            nx_json_get(json_obj, "uplink_low")->int_value;
-                        m_trsp.uplink_high =
-                            nx_json_get(json_obj, "uplink_high")->int_value;
-                        m_trsp.downlink_low =
-                            nx_json_get(json_obj, "downlink_low")->int_value;
-                        m_trsp.downlink_high =
-                            nx_json_get(json_obj, "downlink_high")->int_value;
-
-                        key = g_try_new0(guint, 1);
-                        *key = nx_json_get(json_obj, "mode_id")->int_value;
-                        nmode = g_hash_table_lookup(modes_hash, key);
-                        if (nmode != NULL)
-                            g_strlcpy(m_trsp.mode, nmode->modname, sizeof(m_trsp.mode));
-                        else
-                            g_snprintf(m_trsp.mode, sizeof(m_trsp.mode), "%lli",
-                                       nx_json_get(json_obj, "mode_id")->int_value);
-
-                        m_trsp.invert =
-                            nx_json_get(json_obj, "invert")->int_value;
-                        m_trsp.baud = nx_json_get(json_obj, "baud")->dbl_value;
-                        m_trsp.alive =
-                            nx_json_get(json_obj, "alive")->int_value;
-
-                        //strcpy(m_trsp.uuid,nx_json_get(json_obj,          "uuid")->text_value);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(">>> Preparing information for transponders of cat_id %d <<<"), m_trsp.catnum, __func__);
-                        ////sat_log_log (SAT_LOG_LEVEL_INFO, _("         uuid : %s"), m_trsp.uuid, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  description : %s"), m_trsp.description, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("        alive : %s"), m_trsp.alive ? "true" : "false", __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("   uplink_low : %Ld"),m_trsp.uplink_low, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("  uplink_high : %Ld"),m_trsp.uplink_high, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" downink_low  : %Ld"),m_trsp.downlink_low, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("downlink_high : %Ld"),m_trsp.downlink_high, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Mode : %s"), m_trsp.mode, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("       Invert : %s"), m_trsp.invert ? "true" : "false", __func__);
-                        // sat_log_log(SAT_LOG_LEVEL_DEBUG, _("         Baud : %lf"),m_trsp.baud, __func__);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _(" norad_cat_id : %Ld"),m_trsp.catnum, __func__);
-                        char            m_catnum[20];
-
-                        sprintf(m_catnum, "%d", m_trsp.catnum);
-                        trspfile = g_strconcat(trspfolder, G_DIR_SEPARATOR_S,
-                                               m_catnum, ".trsp", NULL);
-                        //sat_log_log(SAT_LOG_LEVEL_DEBUG, _("%s: Writing to file : %s "), __func__, trspfile);
-
-                        //first lets delete the file we already have, to make space for the new version
-                        /* check existence and add data to hash table for future check */
-                        key = g_try_new0(guint, 1);
-                        *key = m_trsp.catnum;
-                        ntrsp = g_hash_table_lookup(trsp_hash, key);
-
-                        if (ntrsp == NULL)
-                        {
-                            /* create new_trsp structure */
-                            ntrsp = g_try_new(new_trsp_t, 1);
-                            ntrsp->catnum = m_trsp.catnum;
-                            ntrsp->numtrsp = 1; //our first insertion of transponder to this file
-                            g_hash_table_insert(trsp_hash, key, ntrsp);
-                            if (g_remove(trspfile))
-                                sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                            _("%s: Failed to remove %s"),
-                                            __func__, trspfile);
-                        }
-                        else
-                        {
-                            //TODO: increase number of transponders here
-                            //ntrsp->numtrsp += 1; //number of transponder info in this file
-                            //g_hash_table_replace(trsp_hash, key, ntrsp);
-                        }
-
-                        //now lets write the new version
-                        ffile = g_fopen(trspfile, "a");
-                        if (ffile != NULL)
-                        {
-                            fprintf(ffile, "\n[%s]\n", m_trsp.description);
-                            if (m_trsp.uplink_low > 0)
-                                fprintf(ffile, "UP_LOW=%lld\n",
-                                        m_trsp.uplink_low);
-                            if (m_trsp.uplink_high > 0)
-                                fprintf(ffile, "UP_HIGH=%lld\n",
-                                        m_trsp.uplink_high);
-                            if (m_trsp.downlink_low > 0)
-                                fprintf(ffile, "DOWN_LOW=%lld\n",
-                                        m_trsp.downlink_low);
-                            if (m_trsp.downlink_high > 0)
-                                fprintf(ffile, "DOWN_HIGH=%lld\n",
-                                        m_trsp.downlink_high);
-                            fprintf(ffile, "MODE=%s\n", m_trsp.mode);
-                            if (m_trsp.baud > 0.0)
-                                fprintf(ffile, "BAUD=%.0f\n", m_trsp.baud);
-                            if (m_trsp.invert)
-                                fprintf(ffile, "INVERT=%s\n", "true");
-                            fclose(ffile);
-                        }
-                        else
-                        {
-                            sat_log_log(SAT_LOG_LEVEL_ERROR,
-                                        _
-                                        ("%s: Could not open trsp file for write"),
-                                        __func__);
-                        }
-                    }           // while(1)
-                    nx_json_free(json);
-                }               // if(json)
-            }                   // if(result == 1)
-            g_free(jsn_object);
-        }                       // if(flen > 1)
-        fclose(mfp);
-    }                           // if(mfp)
-
-    g_hash_table_destroy(modes_hash);
+    memset(&imp, 0, sizeof(imp));
+    imp.modes = modes.modes;
+    imp.builder = trsp_store_builder_new();
+
+    /* a partial or empty download must not replace the store */
+    count = 0;
+    if (!json_stream_parse(g_mapped_file_get_contents(map),
+                           g_mapped_file_get_length(map),
+                           &trsp_parser, &imp))
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: Malformed JSON in %s"),
+                    __func__, input_file);
+    else if (trsp_store_builder_size(imp.builder) == 0)
+        sat_log_log(SAT_LOG_LEVEL_ERROR, _("%s: No transponders in %s"),
+                    __func__, input_file);
+    else if (trsp_store_commit(imp.builder))
+        count = trsp_store_builder_size(imp.builder);
+
+    if (count > 0)
+        sat_log_log(SAT_LOG_LEVEL_INFO, _("%s: Imported %u transponders"),
+                    __func__, count);
+
+    g_free(imp.trsp.name);
+    trsp_store_builder_free(imp.builder);
+    g_mapped_file_unref(map);
+    g_hash_table_destroy(modes.modes);
 }
 
 /** Update MODES files from network. */